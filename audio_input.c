@@ -2,127 +2,274 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include <SDL2/SDL.h>
 
-// Ring buffer for audio input (to handle different buffer sizes and timing)
-// Maximum buffer size: 500ms at 48kHz stereo
-#define MAX_RING_BUFFER_SIZE (48000 / 2 * 2)  // 500ms of stereo audio at 48kHz
-
+// Single-producer/single-consumer ring buffer for audio input (to handle different
+// buffer sizes and timing). The input callback only advances write_count and the
+// output callback only advances read_count, so neither ever waits on the other.
+// Counts run freely and wrap; the capacity is a power of two so they can be masked.
 static int16_t *ring_buffer = NULL;
-static int ring_buffer_size = 0;
-static volatile int write_pos = 0;
-static volatile int read_pos = 0;
-static SDL_mutex *ring_mutex = NULL;
-
-void audio_input_init(int buffer_ms) {
-    if (!ring_mutex) {
-        ring_mutex = SDL_CreateMutex();
+static int ring_capacity = 0;
+static int ring_mask = 0;
+static SDL_atomic_t write_count;
+static SDL_atomic_t read_count;
+static SDL_atomic_t flush_requested;  // Set by reset(), applied by the reader
+
+static SDL_atomic_t overrun_count;
+static SDL_atomic_t underrun_count;
+
+// Clock drift compensation (reader side only). The input and output devices run on
+// independent clocks, so the output callback resamples the input by a ratio slightly
+// off 1.0, steered by a PI controller that holds the ring fill at target_frames.
+// Fill error is measured in seconds, so the loop does not depend on the buffer size:
+// natural frequency sqrt(KI) = 0.05 rad/s, damping KP / (2 sqrt(KI)) = 0.8. The fill
+// seen by the output callback steps by whole input blocks as the two callbacks slide
+// past each other, so it is smoothed well below the loop bandwidth.
+#define DRIFT_KP 0.08            // Ratio change per second of fill error
+#define DRIFT_KI 0.0025          // Ratio change per second of fill error, per second
+#define DRIFT_MAX 0.005          // Ratio limit (+/- 5000 ppm)
+#define DRIFT_FILL_SMOOTH_S 2.0  // Fill level smoothing time constant in seconds
+static int16_t *drift_scratch = NULL;  // Input frames consumed by one output block
+static int drift_rate = 48000;
+static int target_frames = 0;
+static int drift_primed = 0;           // Fill has reached the target since init/underrun
+static double drift_phase = 0.0;       // Position between hist[1] and hist[2]
+static double drift_integral = 0.0;
+static double drift_fill = 0.0;        // Smoothed fill in frames
+static float drift_hist[4][2];         // Last four input frames, oldest first
+static SDL_atomic_t drift_ppm;         // Current ratio offset for display
+
+// Samples between the two counts (valid on either side of the ring)
+static int ring_fill(void) {
+    return (int)((unsigned int)SDL_AtomicGet(&write_count) - (unsigned int)SDL_AtomicGet(&read_count));
+}
+
+// Reader side: apply a pending reset by dropping everything written so far
+// (the drift compensation then waits for the ring to refill to its target)
+static void apply_flush(void) {
+    if (SDL_AtomicGet(&flush_requested)) {
+        SDL_AtomicSet(&flush_requested, 0);
+        SDL_AtomicSet(&read_count, SDL_AtomicGet(&write_count));
+        drift_primed = 0;
     }
+}
 
+void audio_input_init(int buffer_ms, int sample_rate, int block_frames) {
     // Clamp buffer size to reasonable range (10ms - 500ms)
     if (buffer_ms < 10) buffer_ms = 10;
     if (buffer_ms > 500) buffer_ms = 500;
+    if (sample_rate <= 0) sample_rate = 48000;
 
-    // Calculate buffer size: (48000 samples/sec * buffer_ms / 1000) * 2 channels
-    ring_buffer_size = (48000 * buffer_ms / 1000) * 2;
+    // Calculate buffer size: (sample_rate * buffer_ms / 1000) * 2 channels, at least two
+    // output blocks (the target, half of it, is then at least one block, so a read never
+    // asks for more than the ring holds once primed), rounded up to a power of two
+    int requested = (sample_rate * buffer_ms / 1000) * 2;
+    if (requested < block_frames * 2 * 2) requested = block_frames * 2 * 2;
+    int capacity = 2;
+    while (capacity < requested) capacity <<= 1;
 
-    // Allocate buffer
-    if (ring_buffer) {
+    // Allocate buffer (and the resampler's scratch, which never holds more than the ring)
+    free(ring_buffer);
+    free(drift_scratch);
+    ring_buffer = (int16_t*)calloc(capacity, sizeof(int16_t));
+    drift_scratch = (int16_t*)calloc(capacity, sizeof(int16_t));
+    if (!ring_buffer || !drift_scratch) {
         free(ring_buffer);
-    }
-    ring_buffer = (int16_t*)malloc(ring_buffer_size * sizeof(int16_t));
-    if (!ring_buffer) {
-        ring_buffer_size = 0;
+        free(drift_scratch);
+        ring_buffer = NULL;
+        drift_scratch = NULL;
+        ring_capacity = 0;
+        ring_mask = 0;
         printf("Failed to allocate audio input ring buffer!\n");
         return;
     }
+    ring_capacity = capacity;
+    ring_mask = capacity - 1;
 
-    write_pos = 0;
-    read_pos = 0;
-    memset(ring_buffer, 0, ring_buffer_size * sizeof(int16_t));
+    // Aim for a half-full ring: equal headroom for jitter in both directions
+    drift_rate = sample_rate;
+    target_frames = requested / 4;
+    drift_primed = 0;
+    SDL_AtomicSet(&drift_ppm, 0);
 
-    printf("Audio input buffer initialized: %d ms (%d samples)\n", buffer_ms, ring_buffer_size);
+    SDL_AtomicSet(&write_count, 0);
+    SDL_AtomicSet(&read_count, 0);
+    SDL_AtomicSet(&flush_requested, 0);
+    SDL_AtomicSet(&overrun_count, 0);
+    SDL_AtomicSet(&underrun_count, 0);
+
+    printf("Audio input buffer initialized: %d ms at %d Hz (%d samples)\n", buffer_ms, sample_rate, ring_capacity);
 }
 
 void audio_input_cleanup(void) {
-    if (ring_buffer) {
-        free(ring_buffer);
-        ring_buffer = NULL;
-    }
-    ring_buffer_size = 0;
-    if (ring_mutex) {
-        SDL_DestroyMutex(ring_mutex);
-        ring_mutex = NULL;
-    }
+    free(ring_buffer);
+    free(drift_scratch);
+    ring_buffer = NULL;
+    drift_scratch = NULL;
+    ring_capacity = 0;
+    ring_mask = 0;
 }
 
 void audio_input_write(const int16_t *samples, int num_samples) {
-    if (!ring_mutex || !ring_buffer || ring_buffer_size == 0) return;
-
-    SDL_LockMutex(ring_mutex);
+    if (!ring_buffer || ring_capacity == 0 || num_samples <= 0) return;
 
-    for (int i = 0; i < num_samples; i++) {
-        ring_buffer[write_pos] = samples[i];
-        write_pos = (write_pos + 1) % ring_buffer_size;
+    unsigned int w = (unsigned int)SDL_AtomicGet(&write_count);
+    int space = ring_capacity - ring_fill();
 
-        // If we're about to overwrite unread data, advance read position
-        if (write_pos == read_pos) {
-            read_pos = (read_pos + 1) % ring_buffer_size;
-        }
+    // Overrun: the reader has fallen behind, drop what does not fit
+    // (whole frames only, so the channels stay in order)
+    int to_write = num_samples;
+    if (to_write > space) {
+        to_write = space & ~1;
+        SDL_AtomicAdd(&overrun_count, 1);
     }
 
-    SDL_UnlockMutex(ring_mutex);
+    // Copy in up to two segments (up to the end of the ring, then from the start)
+    int start = (int)(w & (unsigned int)ring_mask);
+    int first = ring_capacity - start;
+    if (first > to_write) first = to_write;
+    memcpy(ring_buffer + start, samples, first * sizeof(int16_t));
+    memcpy(ring_buffer, samples + first, (to_write - first) * sizeof(int16_t));
+
+    // Publish after the data is in place
+    SDL_AtomicSet(&write_count, (int)(w + (unsigned int)to_write));
 }
 
 int audio_input_read(int16_t *output, int num_samples) {
-    if (!ring_mutex || !ring_buffer || ring_buffer_size == 0) return 0;
+    if (!ring_buffer || ring_capacity == 0 || num_samples <= 0) return 0;
 
-    SDL_LockMutex(ring_mutex);
-
-    // Calculate available samples
-    int available;
-    if (write_pos >= read_pos) {
-        available = write_pos - read_pos;
-    } else {
-        available = ring_buffer_size - read_pos + write_pos;
-    }
+    apply_flush();
+    unsigned int r = (unsigned int)SDL_AtomicGet(&read_count);
+    int available = ring_fill();
 
     // Read at most what's requested or available
-    int to_read = (num_samples < available) ? num_samples : available;
-
-    for (int i = 0; i < to_read; i++) {
-        output[i] = ring_buffer[read_pos];
-        read_pos = (read_pos + 1) % ring_buffer_size;
+    int to_read = num_samples;
+    if (to_read > available) {
+        to_read = available;
+        SDL_AtomicAdd(&underrun_count, 1);
     }
 
-    SDL_UnlockMutex(ring_mutex);
+    int start = (int)(r & (unsigned int)ring_mask);
+    int first = ring_capacity - start;
+    if (first > to_read) first = to_read;
+    memcpy(output, ring_buffer + start, first * sizeof(int16_t));
+    memcpy(output + first, ring_buffer, (to_read - first) * sizeof(int16_t));
+
+    // Release the space after the data has been copied out
+    SDL_AtomicSet(&read_count, (int)(r + (unsigned int)to_read));
 
     return to_read;
 }
 
 int audio_input_available(void) {
-    if (!ring_mutex || !ring_buffer || ring_buffer_size == 0) return 0;
+    if (!ring_buffer || ring_capacity == 0) return 0;
+    return ring_fill();
+}
 
-    SDL_LockMutex(ring_mutex);
+void audio_input_reset(void) {
+    if (!ring_buffer || ring_capacity == 0) return;
 
-    int available;
-    if (write_pos >= read_pos) {
-        available = write_pos - read_pos;
-    } else {
-        available = ring_buffer_size - read_pos + write_pos;
+    // The reader drops the buffered samples on its next read
+    SDL_AtomicSet(&flush_requested, 1);
+}
+
+int audio_input_get_overruns(void) {
+    return SDL_AtomicGet(&overrun_count);
+}
+
+int audio_input_get_underruns(void) {
+    return SDL_AtomicGet(&underrun_count);
+}
+
+// 4-point cubic Hermite (Catmull-Rom) between y1 and y2
+static inline float hermite(float y0, float y1, float y2, float y3, float t) {
+    float c1 = 0.5f * (y2 - y0);
+    float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+    float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+    return ((c3 * t + c2) * t + c1) * t + y1;
+}
+
+static inline int16_t to_sample(float v) {
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)v;
+}
+
+int audio_input_read_adaptive(int16_t *output, int frames) {
+    if (frames <= 0) return 0;
+    if (!ring_buffer || ring_capacity == 0) {
+        memset(output, 0, frames * 2 * sizeof(int16_t));
+        return 0;
+    }
+
+    apply_flush();
+    int fill = ring_fill() / 2;
+
+    // Wait until the ring has filled up to the target before starting (again)
+    if (!drift_primed) {
+        if (fill < target_frames) {
+            memset(output, 0, frames * 2 * sizeof(int16_t));
+            return 0;
+        }
+        drift_primed = 1;
+        drift_phase = 0.0;
+        drift_integral = 0.0;
+        drift_fill = fill;
+        memset(drift_hist, 0, sizeof(drift_hist));
+    }
+
+    // PI controller on the smoothed, relative fill error
+    double dt = (double)frames / drift_rate;
+    drift_fill += (fill - drift_fill) * (1.0 - exp(-dt / DRIFT_FILL_SMOOTH_S));
+    double error = (drift_fill - target_frames) / drift_rate;
+    drift_integral += error * dt;
+    if (drift_integral > DRIFT_MAX / DRIFT_KI) drift_integral = DRIFT_MAX / DRIFT_KI;
+    if (drift_integral < -DRIFT_MAX / DRIFT_KI) drift_integral = -DRIFT_MAX / DRIFT_KI;
+    double offset = DRIFT_KP * error + DRIFT_KI * drift_integral;
+    if (offset > DRIFT_MAX) offset = DRIFT_MAX;
+    if (offset < -DRIFT_MAX) offset = -DRIFT_MAX;
+    double ratio = 1.0 + offset;
+    SDL_AtomicSet(&drift_ppm, (int)lrint(offset * 1e6));
+
+    // Input frames this block consumes, read in one go
+    int needed = (int)(drift_phase + ratio * frames);
+    int got = audio_input_read(drift_scratch, needed * 2) / 2;
+    if (got < needed) {
+        // Ran dry: play out what there is, then wait for the ring to refill
+        drift_primed = 0;
     }
 
-    SDL_UnlockMutex(ring_mutex);
+    int in = 0;
+    double phase = drift_phase;
+    for (int i = 0; i < frames; i++) {
+        float t = (float)phase;
+        output[i * 2] = to_sample(hermite(drift_hist[0][0], drift_hist[1][0], drift_hist[2][0], drift_hist[3][0], t));
+        output[i * 2 + 1] = to_sample(hermite(drift_hist[0][1], drift_hist[1][1], drift_hist[2][1], drift_hist[3][1], t));
 
-    return available;
+        phase += ratio;
+        while (phase >= 1.0) {
+            phase -= 1.0;
+            memmove(drift_hist[0], drift_hist[1], sizeof(drift_hist[0]) * 3);
+            if (in < got) {
+                drift_hist[3][0] = drift_scratch[in * 2];
+                drift_hist[3][1] = drift_scratch[in * 2 + 1];
+                in++;
+            } else {
+                drift_hist[3][0] = 0.0f;
+                drift_hist[3][1] = 0.0f;
+            }
+        }
+    }
+    drift_phase = phase;
+
+    return 1;
 }
 
-void audio_input_reset(void) {
-    if (!ring_mutex || !ring_buffer || ring_buffer_size == 0) return;
+int audio_input_get_target_frames(void) {
+    return target_frames;
+}
 
-    SDL_LockMutex(ring_mutex);
-    write_pos = 0;
-    read_pos = 0;
-    memset(ring_buffer, 0, ring_buffer_size * sizeof(int16_t));
-    SDL_UnlockMutex(ring_mutex);
+int audio_input_get_drift_ppm(void) {
+    return SDL_AtomicGet(&drift_ppm);
 }
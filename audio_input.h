@@ -7,26 +7,54 @@ extern "C" {
 
 #include <stdint.h>
 
+// The ring buffer is lock-free for one writer (input callback) and one reader
+// (output callback); neither blocks the other.
+
 // Initialize audio input ring buffer with specified buffer size in milliseconds
 // buffer_ms: Buffer size in milliseconds (recommended: 50-200ms, default: 100ms)
-void audio_input_init(int buffer_ms);
+// sample_rate: Output device sample rate in Hz (used to size the ring)
+// block_frames: Largest block audio_input_read_adaptive is called with; the ring holds
+// at least two, so it can fill to its target with a block to spare
+// Reallocates the ring - only call while both audio callbacks are stopped or locked.
+void audio_input_init(int buffer_ms, int sample_rate, int block_frames);
 
 // Cleanup audio input resources
 void audio_input_cleanup(void);
 
 // Write samples from input device to ring buffer (called by SDL input callback)
+// Samples that do not fit are dropped and counted as an overrun
 void audio_input_write(const int16_t *samples, int num_samples);
 
 // Read samples from ring buffer for mixing (called by output callback)
-// Returns number of samples actually read (may be less than requested if buffer underrun)
+// Returns number of samples actually read (less than requested counts as an underrun)
 int audio_input_read(int16_t *output, int num_samples);
 
 // Get number of samples available in ring buffer
 int audio_input_available(void);
 
-// Reset ring buffer (clear all data)
+// Read frames stereo frames for mixing, compensating clock drift between the input and
+// output devices (called by output callback instead of audio_input_read). A cubic
+// resampler runs at a ratio steered by a PI controller that holds the ring fill at
+// audio_input_get_target_frames(), half the configured buffer.
+// Always fills output; returns 1 if it holds input, 0 if silence (ring still filling
+// up to the target after init, a reset or an underrun).
+// Call it for every output block while the input device is open, also when the input
+// is muted, so the ring stays at its target and the controller stays locked.
+int audio_input_read_adaptive(int16_t *output, int frames);
+
+// Target ring fill in frames (the input latency added by the ring)
+int audio_input_get_target_frames(void);
+
+// Current resampling ratio offset in parts per million (input clock vs output clock)
+int audio_input_get_drift_ppm(void);
+
+// Reset ring buffer (clear all data, applied by the reader on its next read)
 void audio_input_reset(void);
 
+// Number of overruns (input dropped) and underruns (short reads) since init
+int audio_input_get_overruns(void);
+int audio_input_get_underruns(void);
+
 #ifdef __cplusplus
 }
 #endif
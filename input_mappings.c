@@ -58,14 +58,27 @@ InputAction parse_action(const char *str) {
     if (strcmp(str, "fx_eq_high") == 0) return ACTION_FX_EQ_HIGH;
     if (strcmp(str, "fx_compressor_threshold") == 0) return ACTION_FX_COMPRESSOR_THRESHOLD;
     if (strcmp(str, "fx_compressor_ratio") == 0) return ACTION_FX_COMPRESSOR_RATIO;
+    if (strcmp(str, "fx_mb_low_threshold") == 0) return ACTION_FX_MB_LOW_THRESHOLD;
+    if (strcmp(str, "fx_mb_mid_threshold") == 0) return ACTION_FX_MB_MID_THRESHOLD;
+    if (strcmp(str, "fx_mb_high_threshold") == 0) return ACTION_FX_MB_HIGH_THRESHOLD;
+    if (strcmp(str, "fx_mb_low_gain") == 0) return ACTION_FX_MB_LOW_GAIN;
+    if (strcmp(str, "fx_mb_mid_gain") == 0) return ACTION_FX_MB_MID_GAIN;
+    if (strcmp(str, "fx_mb_high_gain") == 0) return ACTION_FX_MB_HIGH_GAIN;
     if (strcmp(str, "fx_delay_time") == 0) return ACTION_FX_DELAY_TIME;
     if (strcmp(str, "fx_delay_feedback") == 0) return ACTION_FX_DELAY_FEEDBACK;
     if (strcmp(str, "fx_delay_mix") == 0) return ACTION_FX_DELAY_MIX;
+    if (strcmp(str, "fx_ducker_depth") == 0) return ACTION_FX_DUCKER_DEPTH;
+    if (strcmp(str, "fx_convolution_mix") == 0) return ACTION_FX_CONVOLUTION_MIX;
     if (strcmp(str, "fx_distortion_toggle") == 0) return ACTION_FX_DISTORTION_TOGGLE;
     if (strcmp(str, "fx_filter_toggle") == 0) return ACTION_FX_FILTER_TOGGLE;
+    if (strcmp(str, "fx_filter_mode") == 0) return ACTION_FX_FILTER_MODE;
     if (strcmp(str, "fx_eq_toggle") == 0) return ACTION_FX_EQ_TOGGLE;
     if (strcmp(str, "fx_compressor_toggle") == 0) return ACTION_FX_COMPRESSOR_TOGGLE;
+    if (strcmp(str, "fx_multiband_toggle") == 0) return ACTION_FX_MULTIBAND_TOGGLE;
     if (strcmp(str, "fx_delay_toggle") == 0) return ACTION_FX_DELAY_TOGGLE;
+    if (strcmp(str, "fx_delay_sync_toggle") == 0) return ACTION_FX_DELAY_SYNC_TOGGLE;
+    if (strcmp(str, "fx_ducker_toggle") == 0) return ACTION_FX_DUCKER_TOGGLE;
+    if (strcmp(str, "fx_convolution_toggle") == 0) return ACTION_FX_CONVOLUTION_TOGGLE;
     if (strcmp(str, "master_volume") == 0) return ACTION_MASTER_VOLUME;
     if (strcmp(str, "playback_volume") == 0) return ACTION_PLAYBACK_VOLUME;
     if (strcmp(str, "input_volume") == 0) return ACTION_INPUT_VOLUME;
@@ -76,6 +89,7 @@ InputAction parse_action(const char *str) {
     if (strcmp(str, "master_mute") == 0) return ACTION_MASTER_MUTE;
     if (strcmp(str, "playback_mute") == 0) return ACTION_PLAYBACK_MUTE;
     if (strcmp(str, "input_mute") == 0) return ACTION_INPUT_MUTE;
+    if (strcmp(str, "audio_record_toggle") == 0) return ACTION_AUDIO_RECORD_TOGGLE;
     if (strcmp(str, "midi_clock_tempo_sync_toggle") == 0) return ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE;
     if (strcmp(str, "midi_clock_sync_toggle") == 0) return ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE;  // Legacy compatibility
     if (strcmp(str, "midi_transport_receive_toggle") == 0) return ACTION_MIDI_TRANSPORT_RECEIVE_TOGGLE;
@@ -140,14 +154,27 @@ const char* input_action_name(InputAction action) {
         case ACTION_FX_EQ_HIGH: return "fx_eq_high";
         case ACTION_FX_COMPRESSOR_THRESHOLD: return "fx_compressor_threshold";
         case ACTION_FX_COMPRESSOR_RATIO: return "fx_compressor_ratio";
+        case ACTION_FX_MB_LOW_THRESHOLD: return "fx_mb_low_threshold";
+        case ACTION_FX_MB_MID_THRESHOLD: return "fx_mb_mid_threshold";
+        case ACTION_FX_MB_HIGH_THRESHOLD: return "fx_mb_high_threshold";
+        case ACTION_FX_MB_LOW_GAIN: return "fx_mb_low_gain";
+        case ACTION_FX_MB_MID_GAIN: return "fx_mb_mid_gain";
+        case ACTION_FX_MB_HIGH_GAIN: return "fx_mb_high_gain";
         case ACTION_FX_DELAY_TIME: return "fx_delay_time";
         case ACTION_FX_DELAY_FEEDBACK: return "fx_delay_feedback";
         case ACTION_FX_DELAY_MIX: return "fx_delay_mix";
+        case ACTION_FX_DUCKER_DEPTH: return "fx_ducker_depth";
+        case ACTION_FX_CONVOLUTION_MIX: return "fx_convolution_mix";
         case ACTION_FX_DISTORTION_TOGGLE: return "fx_distortion_toggle";
         case ACTION_FX_FILTER_TOGGLE: return "fx_filter_toggle";
+        case ACTION_FX_FILTER_MODE: return "fx_filter_mode";
         case ACTION_FX_EQ_TOGGLE: return "fx_eq_toggle";
         case ACTION_FX_COMPRESSOR_TOGGLE: return "fx_compressor_toggle";
+        case ACTION_FX_MULTIBAND_TOGGLE: return "fx_multiband_toggle";
         case ACTION_FX_DELAY_TOGGLE: return "fx_delay_toggle";
+        case ACTION_FX_DELAY_SYNC_TOGGLE: return "fx_delay_sync_toggle";
+        case ACTION_FX_DUCKER_TOGGLE: return "fx_ducker_toggle";
+        case ACTION_FX_CONVOLUTION_TOGGLE: return "fx_convolution_toggle";
         case ACTION_MASTER_VOLUME: return "master_volume";
         case ACTION_PLAYBACK_VOLUME: return "playback_volume";
         case ACTION_INPUT_VOLUME: return "input_volume";
@@ -158,6 +185,7 @@ const char* input_action_name(InputAction action) {
         case ACTION_MASTER_MUTE: return "master_mute";
         case ACTION_PLAYBACK_MUTE: return "playback_mute";
         case ACTION_INPUT_MUTE: return "input_mute";
+        case ACTION_AUDIO_RECORD_TOGGLE: return "audio_record_toggle";
         case ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE: return "midi_clock_tempo_sync_toggle";
         case ACTION_MIDI_TRANSPORT_RECEIVE_TOGGLE: return "midi_transport_receive_toggle";
         case ACTION_MIDI_SPP_RECEIVE_TOGGLE: return "midi_spp_receive_toggle";
@@ -202,6 +230,7 @@ InputMappings* input_mappings_create(void) {
 
 void input_mappings_destroy(InputMappings *mappings) {
     if (!mappings) return;
+    free(mappings->table.entries);
     free(mappings->midi_mappings);
     free(mappings->keyboard_mappings);
     free(mappings);
@@ -212,6 +241,7 @@ void input_mappings_reset_defaults(InputMappings *mappings) {
 
     mappings->midi_count = 0;
     mappings->keyboard_count = 0;
+    mappings->table.dirty = 1;
 
     // Initialize trigger pads with default configuration
     for (int i = 0; i < MAX_TRIGGER_PADS; i++) {
@@ -318,6 +348,7 @@ int input_mappings_load(InputMappings *mappings, const char *filepath) {
     // Clear existing mappings
     mappings->midi_count = 0;
     mappings->keyboard_count = 0;
+    mappings->table.dirty = 1;
 
     // Reset trigger pads to defaults
     for (int i = 0; i < MAX_TRIGGER_PADS; i++) {
@@ -564,39 +595,173 @@ int input_mappings_save(InputMappings *mappings, const char *filepath) {
     return 0;
 }
 
-int input_mappings_get_midi_event(InputMappings *mappings, int device_id, int cc, int value, InputEvent *out_event) {
-    if (!mappings || !out_event) return 0;
+// --- Lookup tables ---
+// Each control (device/CC, device/note, key) owns a slot with a run of entries in one
+// list, so a query is two array reads. Bindings for "any device" are entered for every
+// device. Built in two passes (count, then fill) so entries keep the file order.
+
+void input_mappings_invalidate(InputMappings *mappings) {
+    if (mappings) mappings->table.dirty = 1;
+}
+
+void input_mappings_set_song_pads(InputMappings *mappings, const TriggerPadConfig *song_pads) {
+    if (!mappings) return;
+    mappings->song_trigger_pads = song_pads;
+    mappings->table.dirty = 1;
+}
+
+static const TriggerPadConfig* table_pad(InputMappings *mappings, int pad) {
+    if (pad < MAX_TRIGGER_PADS) return &mappings->trigger_pads[pad];
+    if (!mappings->song_trigger_pads) return NULL;
+    return &mappings->song_trigger_pads[pad - MAX_TRIGGER_PADS];
+}
+
+// Pass 0 counts the bindings per slot, pass 1 writes them at slot->first + slot->count
+static void table_add(InputBindingTable *t, InputBindingSlot *slot, int entry, int pass) {
+    if (pass == 1) t->entries[slot->first + slot->count] = entry;
+    slot->count++;
+}
+
+static void table_add_midi(InputBindingTable *t, int device_id, int kind, int number, int entry, int pass) {
+    if (number < 0 || number > 127) return;
+    for (int dev = 0; dev < INPUT_MAPPINGS_MAX_DEVICES; dev++) {
+        if (device_id != -1 && device_id != dev) continue;
+        table_add(t, &t->midi[dev][kind][number], entry, pass);
+    }
+}
+
+// Enter every binding once (pass 0 = count, pass 1 = fill)
+static void collect_bindings(InputMappings *mappings, int pass) {
+    InputBindingTable *t = &mappings->table;
 
     for (int i = 0; i < mappings->midi_count; i++) {
-        MidiMapping *m = &mappings->midi_mappings[i];
-        // Match if CC matches and either device matches or mapping is for any device (-1)
-        if (m->cc_number == cc && (m->device_id == -1 || m->device_id == device_id)) {
-            // For continuous controls, always trigger
-            // For buttons, check threshold
-            if (m->continuous || value >= m->threshold) {
-                out_event->action = m->action;
-                out_event->parameter = m->parameter;
-                out_event->value = value;
-                return 1;
-            }
+        const MidiMapping *m = &mappings->midi_mappings[i];
+        table_add_midi(t, m->device_id, INPUT_MIDI_CC, m->cc_number, i, pass);
+    }
+    for (int i = 0; i < MAX_TOTAL_TRIGGER_PADS; i++) {
+        const TriggerPadConfig *pad = table_pad(mappings, i);
+        if (!pad || pad->midi_device == -2) continue;  // -2 = disabled
+        table_add_midi(t, pad->midi_device, INPUT_MIDI_NOTE, pad->midi_note, i, pass);
+    }
+    for (int i = 0; i < mappings->keyboard_count; i++) {
+        int key = mappings->keyboard_mappings[i].key;
+        if (key < 0 || key >= INPUT_MAPPINGS_MAX_KEYS) continue;
+        table_add(t, &t->keys[key], i, pass);
+    }
+}
+
+static void rebuild_table(InputMappings *mappings) {
+    InputBindingTable *t = &mappings->table;
+    InputBindingSlot *midi_slots = &t->midi[0][0][0];
+    const int num_midi_slots = INPUT_MAPPINGS_MAX_DEVICES * INPUT_MIDI_KINDS * 128;
+
+    t->dirty = 0;
+    memset(t->midi, 0, sizeof(t->midi));
+    memset(t->keys, 0, sizeof(t->keys));
+    collect_bindings(mappings, 0);
+
+    // Lay the slots out back to back
+    int total = 0;
+    for (int i = 0; i < num_midi_slots; i++) {
+        midi_slots[i].first = total;
+        total += midi_slots[i].count;
+        midi_slots[i].count = 0;
+    }
+    for (int i = 0; i < INPUT_MAPPINGS_MAX_KEYS; i++) {
+        t->keys[i].first = total;
+        total += t->keys[i].count;
+        t->keys[i].count = 0;
+    }
+
+    if (total > t->entry_capacity) {
+        int *entries = realloc(t->entries, total * sizeof(int));
+        if (!entries) {
+            // Leave the table empty rather than index past the list: every slot starts
+            // at 0 with no entries (the list may not exist yet)
+            fprintf(stderr, "Failed to allocate input mapping table\n");
+            memset(t->midi, 0, sizeof(t->midi));
+            memset(t->keys, 0, sizeof(t->keys));
+            return;
         }
+        t->entries = entries;
+        t->entry_capacity = total;
     }
 
-    return 0;
+    collect_bindings(mappings, 1);
 }
 
-int input_mappings_get_keyboard_event(InputMappings *mappings, int key, InputEvent *out_event) {
-    if (!mappings || !out_event) return 0;
+static InputBindingTable* current_table(InputMappings *mappings) {
+    if (mappings->table.dirty) rebuild_table(mappings);
+    return &mappings->table;
+}
 
-    for (int i = 0; i < mappings->keyboard_count; i++) {
-        KeyboardMapping *k = &mappings->keyboard_mappings[i];
-        if (k->key == key) {
-            out_event->action = k->action;
-            out_event->parameter = k->parameter;
-            out_event->value = 0;
-            return 1;
+int input_mappings_find_midi(InputMappings *mappings, int device_id, int cc, const int **out_indices) {
+    if (!mappings || !out_indices) return 0;
+    if (device_id < 0 || device_id >= INPUT_MAPPINGS_MAX_DEVICES || cc < 0 || cc > 127) return 0;
+    InputBindingTable *t = current_table(mappings);
+    const InputBindingSlot *slot = &t->midi[device_id][INPUT_MIDI_CC][cc];
+    *out_indices = t->entries + slot->first;
+    return slot->count;
+}
+
+int input_mappings_find_note_pads(InputMappings *mappings, int device_id, int note, const int **out_pads) {
+    if (!mappings || !out_pads) return 0;
+    if (device_id < 0 || device_id >= INPUT_MAPPINGS_MAX_DEVICES || note < 0 || note > 127) return 0;
+    InputBindingTable *t = current_table(mappings);
+    const InputBindingSlot *slot = &t->midi[device_id][INPUT_MIDI_NOTE][note];
+    *out_pads = t->entries + slot->first;
+    return slot->count;
+}
+
+int input_mappings_find_keyboard(InputMappings *mappings, int key, const int **out_indices) {
+    if (!mappings || !out_indices) return 0;
+    if (key < 0 || key >= INPUT_MAPPINGS_MAX_KEYS) return 0;
+    InputBindingTable *t = current_table(mappings);
+    const InputBindingSlot *slot = &t->keys[key];
+    *out_indices = t->entries + slot->first;
+    return slot->count;
+}
+
+int input_mappings_get_midi_events(InputMappings *mappings, int device_id, int cc, int value, InputEvent *out_events, int max_events) {
+    if (!out_events) return 0;
+
+    const int *indices;
+    int count = input_mappings_find_midi(mappings, device_id, cc, &indices);
+    int n = 0;
+    for (int i = 0; i < count && n < max_events; i++) {
+        const MidiMapping *m = &mappings->midi_mappings[indices[i]];
+        // For continuous controls, always trigger
+        // For buttons, check threshold
+        if (m->continuous || value >= m->threshold) {
+            out_events[n].action = m->action;
+            out_events[n].parameter = m->parameter;
+            out_events[n].value = value;
+            n++;
         }
     }
+    return n;
+}
 
-    return 0;
+int input_mappings_get_keyboard_events(InputMappings *mappings, int key, InputEvent *out_events, int max_events) {
+    if (!out_events) return 0;
+
+    const int *indices;
+    int count = input_mappings_find_keyboard(mappings, key, &indices);
+    int n = 0;
+    for (int i = 0; i < count && n < max_events; i++) {
+        const KeyboardMapping *k = &mappings->keyboard_mappings[indices[i]];
+        out_events[n].action = k->action;
+        out_events[n].parameter = k->parameter;
+        out_events[n].value = 0;
+        n++;
+    }
+    return n;
+}
+
+int input_mappings_get_midi_event(InputMappings *mappings, int device_id, int cc, int value, InputEvent *out_event) {
+    return input_mappings_get_midi_events(mappings, device_id, cc, value, out_event, 1);
+}
+
+int input_mappings_get_keyboard_event(InputMappings *mappings, int key, InputEvent *out_event) {
+    return input_mappings_get_keyboard_events(mappings, key, out_event, 1);
 }
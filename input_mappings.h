@@ -52,15 +52,28 @@ typedef enum {
     ACTION_FX_EQ_HIGH,             // EQ high band gain
     ACTION_FX_COMPRESSOR_THRESHOLD, // compressor threshold
     ACTION_FX_COMPRESSOR_RATIO,    // compressor ratio
+    ACTION_FX_MB_LOW_THRESHOLD,   // multiband compressor low band threshold
+    ACTION_FX_MB_MID_THRESHOLD,   // multiband compressor mid band threshold
+    ACTION_FX_MB_HIGH_THRESHOLD,  // multiband compressor high band threshold
+    ACTION_FX_MB_LOW_GAIN,        // multiband compressor low band gain
+    ACTION_FX_MB_MID_GAIN,        // multiband compressor mid band gain
+    ACTION_FX_MB_HIGH_GAIN,       // multiband compressor high band gain
     ACTION_FX_DELAY_TIME,          // delay time
     ACTION_FX_DELAY_FEEDBACK,      // delay feedback
     ACTION_FX_DELAY_MIX,           // delay dry/wet mix
+    ACTION_FX_DUCKER_DEPTH,        // sidechain ducker depth
+    ACTION_FX_CONVOLUTION_MIX,     // convolution reverb dry/wet mix
     // Effects toggles (button/trigger)
     ACTION_FX_DISTORTION_TOGGLE,   // toggle distortion on/off
     ACTION_FX_FILTER_TOGGLE,       // toggle filter on/off
+    ACTION_FX_FILTER_MODE,         // cycle filter response (LP/BP/HP/notch)
     ACTION_FX_EQ_TOGGLE,           // toggle EQ on/off
     ACTION_FX_COMPRESSOR_TOGGLE,   // toggle compressor on/off
+    ACTION_FX_MULTIBAND_TOGGLE,    // toggle multiband compressor on/off
     ACTION_FX_DELAY_TOGGLE,        // toggle delay on/off
+    ACTION_FX_DELAY_SYNC_TOGGLE,   // toggle tempo-synced delay time
+    ACTION_FX_DUCKER_TOGGLE,       // toggle sidechain ducker on/off
+    ACTION_FX_CONVOLUTION_TOGGLE,  // toggle convolution reverb on/off
     // Mixer actions (continuous, use MIDI value 0-127)
     ACTION_MASTER_VOLUME,          // master output volume
     ACTION_PLAYBACK_VOLUME,        // playback engine volume
@@ -73,6 +86,7 @@ typedef enum {
     ACTION_MASTER_MUTE,            // toggle master mute
     ACTION_PLAYBACK_MUTE,          // toggle playback mute
     ACTION_INPUT_MUTE,             // toggle input mute
+    ACTION_AUDIO_RECORD_TOGGLE,    // start/stop recording the master output to disk
     // MIDI slave toggles (receive/respond)
     ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE,      // toggle MIDI Clock tempo sync (slave)
     ACTION_MIDI_TRANSPORT_RECEIVE_TOGGLE, // toggle MIDI Start/Stop response (slave)
@@ -126,6 +140,30 @@ typedef struct {
     int phrase_index;        // Index into phrases array (-1 = not using phrase, use action instead)
 } TriggerPadConfig;
 
+// Lookup tables (built from the mappings and trigger pads)
+#define INPUT_MAPPINGS_MAX_DEVICES 3      // MIDI input devices (MIDI_MAX_DEVICES in midi.h)
+#define INPUT_MAPPINGS_MAX_KEYS 256       // Keyboard codes (ASCII plus GUI-only codes)
+#define INPUT_MAPPINGS_MAX_BINDINGS 16    // Actions handled per control by the event queries
+
+typedef enum {
+    INPUT_MIDI_CC = 0,       // Control Change -> MIDI mappings
+    INPUT_MIDI_NOTE,         // Note On -> trigger pads
+    INPUT_MIDI_KINDS
+} InputMidiKind;
+
+typedef struct {
+    int first;               // First entry in the table's entry list
+    int count;               // Number of bindings on this control
+} InputBindingSlot;
+
+typedef struct {
+    InputBindingSlot midi[INPUT_MAPPINGS_MAX_DEVICES][INPUT_MIDI_KINDS][128];
+    InputBindingSlot keys[INPUT_MAPPINGS_MAX_KEYS];
+    int *entries;            // Mapping indices (CC, keys) or pad indices (notes), grouped by slot
+    int entry_capacity;
+    int dirty;               // Rebuilt on the next query
+} InputBindingTable;
+
 // Input mappings configuration (application-wide from regroove.ini)
 typedef struct {
     MidiMapping *midi_mappings;
@@ -135,6 +173,8 @@ typedef struct {
     int keyboard_count;
     int keyboard_capacity;
     TriggerPadConfig trigger_pads[MAX_TRIGGER_PADS];  // A1-A16 only
+    const TriggerPadConfig *song_trigger_pads;        // S1-S16 of the loaded song (NULL = none)
+    InputBindingTable table;
 } InputMappings;
 
 // Initialize input mappings system
@@ -152,7 +192,25 @@ int input_mappings_save(InputMappings *mappings, const char *filepath);
 // Reset to default mappings
 void input_mappings_reset_defaults(InputMappings *mappings);
 
-// Query mappings - returns 1 if action found, 0 otherwise
+// Mark the lookup tables stale. Call after editing the mapping arrays or trigger pads
+// directly; load and reset do this themselves.
+void input_mappings_invalidate(InputMappings *mappings);
+
+// Set the song trigger pads (S1-S16, MAX_SONG_TRIGGER_PADS entries) matched on Note On
+void input_mappings_set_song_pads(InputMappings *mappings, const TriggerPadConfig *song_pads);
+
+// Bindings of one control, in file order: constant-time table lookups. *out_indices points
+// into the table (valid until the mappings change). Returns the number of bindings.
+int input_mappings_find_midi(InputMappings *mappings, int device_id, int cc, const int **out_indices);
+int input_mappings_find_keyboard(InputMappings *mappings, int key, const int **out_indices);
+// Trigger pads on a note: 0-15 = application pads (A1-A16), 16-31 = song pads (S1-S16)
+int input_mappings_find_note_pads(InputMappings *mappings, int device_id, int note, const int **out_pads);
+
+// Query every action bound to a control - returns the number of events written (at most max_events)
+int input_mappings_get_midi_events(InputMappings *mappings, int device_id, int cc, int value, InputEvent *out_events, int max_events);
+int input_mappings_get_keyboard_events(InputMappings *mappings, int key, InputEvent *out_events, int max_events);
+
+// Query mappings - returns 1 if action found, 0 otherwise (first binding only)
 int input_mappings_get_midi_event(InputMappings *mappings, int device_id, int cc, int value, InputEvent *out_event);
 int input_mappings_get_keyboard_event(InputMappings *mappings, int key, InputEvent *out_event);
 
@@ -0,0 +1,474 @@
+// regroove-bench: effects DSP benchmark
+//
+// Feeds synthetic signals and rendered module audio through regroove_effects_process(),
+// one effect at a time and the full chain, across block sizes and sample rates.
+// Reports ns/frame, realtime factor and heap allocations made while processing,
+// and writes the results as JSON for comparing builds.
+//
+// Usage: regroove-bench [-o results.json] [-s seconds] [-i impulse.wav] [module ...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#include "regroove_engine.h"
+#include "regroove_effects.h"
+
+#define BENCH_DEFAULT_SECONDS 10.0
+#define BENCH_WARMUP_SECONDS 0.5
+#define BENCH_MAX_SOURCES 16
+#define BENCH_IR_SECONDS 1.5
+#define BENCH_TEMP_IR "regroove-bench-ir.wav"
+
+static const int bench_sample_rates[] = { 44100, 48000, 96000 };
+static const int bench_block_sizes[] = { 64, 128, 256, 512, 1024 };
+#define NUM_SAMPLE_RATES ((int)(sizeof(bench_sample_rates) / sizeof(bench_sample_rates[0])))
+#define NUM_BLOCK_SIZES ((int)(sizeof(bench_block_sizes) / sizeof(bench_block_sizes[0])))
+
+// --- Allocation counting ---
+// Linked with -Wl,--wrap=malloc,... where the linker supports it (see CMakeLists.txt),
+// so only allocations made by the regroove sources are counted, not the libraries'.
+#ifdef REGROOVE_BENCH_WRAP_MALLOC
+static SDL_atomic_t alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    SDL_AtomicAdd(&alloc_count, 1);
+    return __real_malloc(size);
+}
+void *__wrap_calloc(size_t count, size_t size) {
+    SDL_AtomicAdd(&alloc_count, 1);
+    return __real_calloc(count, size);
+}
+void *__wrap_realloc(void *ptr, size_t size) {
+    SDL_AtomicAdd(&alloc_count, 1);
+    return __real_realloc(ptr, size);
+}
+
+static int allocations_tracked(void) { return 1; }
+static int allocations_get(void) { return SDL_AtomicGet(&alloc_count); }
+#else
+static int allocations_tracked(void) { return 0; }
+static int allocations_get(void) { return 0; }
+#endif
+
+// --- Benchmark configurations ---
+
+typedef enum {
+    BENCH_FX_DISTORTION = 0,
+    BENCH_FX_FILTER,
+    BENCH_FX_EQ,
+    BENCH_FX_COMPRESSOR,
+    BENCH_FX_MULTIBAND,
+    BENCH_FX_DUCKER,
+    BENCH_FX_DELAY,
+    BENCH_FX_CONVOLUTION,
+    BENCH_FX_FULL_CHAIN,
+    BENCH_FX_COUNT
+} BenchEffect;
+
+static const char *bench_effect_names[BENCH_FX_COUNT] = {
+    "distortion", "filter", "eq", "compressor", "multiband",
+    "ducker", "delay", "convolution", "full_chain"
+};
+
+// Enable one effect (or all) with settings that keep every stage doing real work
+static void bench_configure(RegrooveEffects *fx, BenchEffect effect, const char *ir_path) {
+    int all = (effect == BENCH_FX_FULL_CHAIN);
+
+    if (all || effect == BENCH_FX_DISTORTION) {
+        regroove_effects_set_distortion_enabled(fx, 1);
+        regroove_effects_set_distortion_drive(fx, 0.6f);
+        regroove_effects_set_distortion_mix(fx, 0.5f);
+    }
+    if (all || effect == BENCH_FX_FILTER) {
+        regroove_effects_set_filter_enabled(fx, 1);
+        regroove_effects_set_filter_cutoff(fx, 0.6f);
+        regroove_effects_set_filter_resonance(fx, 0.5f);
+    }
+    if (all || effect == BENCH_FX_EQ) {
+        regroove_effects_set_eq_enabled(fx, 1);
+        regroove_effects_set_eq_low(fx, 0.7f);
+        regroove_effects_set_eq_mid(fx, 0.4f);
+        regroove_effects_set_eq_high(fx, 0.6f);
+    }
+    if (all || effect == BENCH_FX_COMPRESSOR) {
+        regroove_effects_set_compressor_enabled(fx, 1);
+        regroove_effects_set_compressor_threshold(fx, 0.3f);
+        regroove_effects_set_compressor_ratio(fx, 0.4f);
+    }
+    if (all || effect == BENCH_FX_MULTIBAND) {
+        regroove_effects_set_multiband_enabled(fx, 1);
+        for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+            regroove_effects_set_multiband_threshold(fx, b, 0.5f);
+        }
+    }
+    if (all || effect == BENCH_FX_DUCKER) {
+        regroove_effects_set_ducker_enabled(fx, 1);
+    }
+    if (all || effect == BENCH_FX_DELAY) {
+        regroove_effects_set_delay_enabled(fx, 1);
+        regroove_effects_set_delay_time(fx, 0.375f);
+        regroove_effects_set_delay_feedback(fx, 0.5f);
+        regroove_effects_set_delay_mix(fx, 0.3f);
+    }
+    if (all || effect == BENCH_FX_CONVOLUTION) {
+        regroove_effects_set_convolution_enabled(fx, 1);
+        regroove_effects_load_convolution_ir(fx, ir_path);
+    }
+}
+
+// --- Sources ---
+
+typedef struct {
+    char name[256];
+    int16_t *buffer;  // Interleaved stereo
+    int frames;
+} BenchSource;
+
+// Seeded LCG so runs are repeatable
+static unsigned int bench_rand_state = 1;
+static float bench_noise(void) {
+    bench_rand_state = bench_rand_state * 1664525u + 1013904223u;
+    return (float)(bench_rand_state >> 8) / 8388608.0f - 1.0f;
+}
+
+static int16_t to_int16(float v) {
+    if (v > 1.0f) v = 1.0f;
+    if (v < -1.0f) v = -1.0f;
+    return (int16_t)(v * 32767.0f);
+}
+
+// White noise at -12 dBFS
+static int source_noise(BenchSource *src, int sample_rate, double seconds) {
+    src->frames = (int)(sample_rate * seconds);
+    src->buffer = (int16_t*)malloc((size_t)src->frames * 2 * sizeof(int16_t));
+    if (!src->buffer) return -1;
+    snprintf(src->name, sizeof(src->name), "noise");
+    for (int i = 0; i < src->frames * 2; i++) {
+        src->buffer[i] = to_int16(0.25f * bench_noise());
+    }
+    return 0;
+}
+
+// 125 BPM four-on-the-floor: decaying sine kick plus noise hats and a saw bass
+static int source_beat(BenchSource *src, int sample_rate, double seconds) {
+    src->frames = (int)(sample_rate * seconds);
+    src->buffer = (int16_t*)malloc((size_t)src->frames * 2 * sizeof(int16_t));
+    if (!src->buffer) return -1;
+    snprintf(src->name, sizeof(src->name), "beat");
+
+    int beat_len = (int)(sample_rate * 60.0 / 125.0);
+    double kick_phase = 0.0, bass_phase = 0.0;
+    for (int i = 0; i < src->frames; i++) {
+        int t = i % beat_len;
+        float kt = (float)t / (float)sample_rate;
+        float kick_freq = 50.0f + 100.0f * expf(-kt * 40.0f);
+        kick_phase += 2.0 * 3.14159265358979 * kick_freq / sample_rate;
+        float kick = sinf((float)kick_phase) * expf(-kt * 8.0f);
+
+        int ht = (i + beat_len / 2) % beat_len;
+        float hat = bench_noise() * expf(-(float)ht / (float)sample_rate * 60.0f) * 0.3f;
+
+        bass_phase += 55.0 / sample_rate;
+        if (bass_phase >= 1.0) bass_phase -= 1.0;
+        float bass = ((float)bass_phase * 2.0f - 1.0f) * 0.2f;
+
+        src->buffer[i * 2] = to_int16(0.5f * kick + hat + bass);
+        src->buffer[i * 2 + 1] = to_int16(0.5f * kick - hat + bass);
+    }
+    return 0;
+}
+
+// Render a module through the playback engine
+static int source_module(BenchSource *src, const char *path, int sample_rate, double seconds) {
+    Regroove *mod = regroove_create(path, (double)sample_rate);
+    if (!mod) {
+        fprintf(stderr, "Could not load module %s\n", path);
+        return -1;
+    }
+
+    int max_frames = (int)(sample_rate * seconds);
+    src->buffer = (int16_t*)calloc((size_t)max_frames * 2, sizeof(int16_t));
+    if (!src->buffer) {
+        regroove_destroy(mod);
+        return -1;
+    }
+
+    const char *name = strrchr(path, '/');
+    if (!name) name = strrchr(path, '\\');
+    snprintf(src->name, sizeof(src->name), "%s", name ? name + 1 : path);
+
+    src->frames = 0;
+    while (src->frames < max_frames) {
+        int chunk = max_frames - src->frames;
+        if (chunk > 1024) chunk = 1024;
+        int rendered = regroove_render_audio(mod, src->buffer + src->frames * 2, chunk);
+        if (rendered <= 0) break;  // End of song
+        src->frames += rendered;
+    }
+    regroove_destroy(mod);
+
+    if (src->frames == 0) {
+        free(src->buffer);
+        src->buffer = NULL;
+        fprintf(stderr, "Module %s rendered no audio\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Exponentially decaying stereo noise, written as a float WAV for the convolver
+static int write_bench_ir(const char *path, int sample_rate, double seconds) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    int frames = (int)(sample_rate * seconds);
+    uint32_t data_size = (uint32_t)frames * 2 * sizeof(float);
+    uint32_t riff_size = 36 + data_size;
+    uint32_t fmt_size = 16, byte_rate = (uint32_t)sample_rate * 2 * sizeof(float);
+    uint32_t rate = (uint32_t)sample_rate;
+    uint16_t format = 3, channels = 2, block_align = 2 * sizeof(float), bits = 32;
+
+    // WAV fields are little-endian, as on every platform regroove targets
+    fwrite("RIFF", 1, 4, f);
+    fwrite(&riff_size, 4, 1, f);
+    fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fmt_size, 4, 1, f);
+    fwrite(&format, 2, 1, f);
+    fwrite(&channels, 2, 1, f);
+    fwrite(&rate, 4, 1, f);
+    fwrite(&byte_rate, 4, 1, f);
+    fwrite(&block_align, 2, 1, f);
+    fwrite(&bits, 2, 1, f);
+    fwrite("data", 1, 4, f);
+    fwrite(&data_size, 4, 1, f);
+    for (int i = 0; i < frames; i++) {
+        float decay = expf(-6.9f * (float)i / (float)frames);  // -60 dB over the length
+        float frame[2] = { bench_noise() * decay, bench_noise() * decay };
+        fwrite(frame, sizeof(float), 2, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+// --- Measurement ---
+
+typedef struct {
+    const char *source;
+    const char *effect;
+    int sample_rate;
+    int block_size;
+    long long frames;
+    double ns_per_frame;
+    double realtime_factor;
+    int allocations;
+} BenchResult;
+
+static int bench_run(const BenchSource *src, BenchEffect effect, int sample_rate, int block_size,
+                     double seconds, const char *ir_path, BenchResult *result) {
+    RegrooveEffects *fx = regroove_effects_create(sample_rate);
+    if (!fx) return -1;
+    bench_configure(fx, effect, ir_path);
+
+    // Wait for the impulse response to be loaded in the background
+    while (regroove_effects_get_convolution_ir_loading(fx)) {
+        SDL_Delay(1);
+    }
+
+    int16_t *block = (int16_t*)malloc((size_t)block_size * 2 * sizeof(int16_t));
+    if (!block) {
+        regroove_effects_destroy(fx);
+        return -1;
+    }
+
+    long long warmup_frames = (long long)(sample_rate * BENCH_WARMUP_SECONDS);
+    long long total_frames = (long long)(sample_rate * seconds);
+    long long pos = 0, processed = 0;
+    Uint64 ticks = 0;
+    int allocs_before = 0;
+
+    for (long long done = -warmup_frames; done < total_frames; done += block_size) {
+        // Copy the next block from the (looping) source
+        for (int i = 0; i < block_size; i++) {
+            block[i * 2] = src->buffer[pos * 2];
+            block[i * 2 + 1] = src->buffer[pos * 2 + 1];
+            if (++pos >= src->frames) pos = 0;
+        }
+
+        // Synthetic sidechain key on the beat for the ducker
+        float beat_phase = fmodf((float)(done + warmup_frames) / (float)sample_rate * 125.0f / 60.0f, 1.0f);
+        regroove_effects_set_sidechain_key(fx, beat_phase < 0.25f ? 1.0f : 0.0f);
+
+        if (done < 0) {
+            regroove_effects_process(fx, block, block_size);
+            if (done + block_size >= 0) allocs_before = allocations_get();
+            continue;
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        regroove_effects_process(fx, block, block_size);
+        ticks += SDL_GetPerformanceCounter() - start;
+        processed += block_size;
+    }
+
+    double seconds_spent = (double)ticks / (double)SDL_GetPerformanceFrequency();
+    result->source = src->name;
+    result->effect = bench_effect_names[effect];
+    result->sample_rate = sample_rate;
+    result->block_size = block_size;
+    result->frames = processed;
+    result->ns_per_frame = processed > 0 ? seconds_spent * 1e9 / (double)processed : 0.0;
+    result->realtime_factor = seconds_spent > 0.0 ? ((double)processed / sample_rate) / seconds_spent : 0.0;
+    result->allocations = allocations_get() - allocs_before;
+
+    free(block);
+    regroove_effects_destroy(fx);
+    return 0;
+}
+
+// --- Output ---
+
+static void json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", (unsigned char)*s);
+        else fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static int write_json(const char *path, const BenchResult *results, int count, double seconds) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Could not write %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"benchmark\": \"regroove-effects\",\n");
+    fprintf(f, "  \"schema\": 1,\n");
+    fprintf(f, "  \"seconds_per_run\": %.2f,\n", seconds);
+    fprintf(f, "  \"allocations_tracked\": %s,\n", allocations_tracked() ? "true" : "false");
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(f, "    {\"source\": ");
+        json_string(f, r->source);
+        fprintf(f, ", \"effect\": \"%s\", \"sample_rate\": %d, \"block_size\": %d, \"frames\": %lld, "
+                   "\"ns_per_frame\": %.3f, \"realtime_factor\": %.1f, \"allocations\": ",
+                r->effect, r->sample_rate, r->block_size, r->frames, r->ns_per_frame, r->realtime_factor);
+        if (allocations_tracked()) fprintf(f, "%d", r->allocations);
+        else fprintf(f, "null");
+        fprintf(f, "}%s\n", (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+    fclose(f);
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-o results.json] [-s seconds] [-i impulse.wav] [module ...]\n", prog);
+    printf("  -o FILE   JSON output (default: regroove-bench.json)\n");
+    printf("  -s SECS   Audio processed per run (default: %.0f)\n", BENCH_DEFAULT_SECONDS);
+    printf("  -i FILE   Impulse response for the convolution runs (default: generated)\n");
+    printf("  module    Module files rendered through the engine as additional sources\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *out_path = "regroove-bench.json";
+    const char *ir_path = NULL;
+    double seconds = BENCH_DEFAULT_SECONDS;
+    const char *modules[BENCH_MAX_SOURCES];
+    int num_modules = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+            if (seconds <= 0.0) seconds = BENCH_DEFAULT_SECONDS;
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            ir_path = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else if (num_modules < BENCH_MAX_SOURCES - 2) {
+            modules[num_modules++] = argv[i];
+        }
+    }
+
+    int generated_ir = 0;
+    if (!ir_path) {
+        if (write_bench_ir(BENCH_TEMP_IR, 48000, BENCH_IR_SECONDS) != 0) {
+            fprintf(stderr, "Could not write %s\n", BENCH_TEMP_IR);
+            return 1;
+        }
+        ir_path = BENCH_TEMP_IR;
+        generated_ir = 1;
+    }
+
+    int max_results = NUM_SAMPLE_RATES * BENCH_MAX_SOURCES * BENCH_FX_COUNT * NUM_BLOCK_SIZES;
+    BenchResult *results = (BenchResult*)calloc(max_results, sizeof(BenchResult));
+    BenchSource *sources = (BenchSource*)calloc(NUM_SAMPLE_RATES * BENCH_MAX_SOURCES, sizeof(BenchSource));
+    if (!results || !sources) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    int num_results = 0, num_sources = 0;
+
+    printf("%-24s %-12s %6s %5s %10s %10s %7s\n", "source", "effect", "rate", "block", "ns/frame", "realtime", "allocs");
+
+    for (int r = 0; r < NUM_SAMPLE_RATES; r++) {
+        int sample_rate = bench_sample_rates[r];
+
+        // Sources are rendered at each rate, like the engine would for the device
+        BenchSource *rate_sources = &sources[num_sources];
+        int count = 0;
+        bench_rand_state = 1;
+        if (source_noise(&rate_sources[count], sample_rate, seconds) == 0) count++;
+        if (source_beat(&rate_sources[count], sample_rate, seconds) == 0) count++;
+        for (int m = 0; m < num_modules; m++) {
+            if (source_module(&rate_sources[count], modules[m], sample_rate, seconds) == 0) count++;
+        }
+        num_sources += count;
+
+        for (int s = 0; s < count; s++) {
+            for (int e = 0; e < BENCH_FX_COUNT; e++) {
+                for (int b = 0; b < NUM_BLOCK_SIZES; b++) {
+                    BenchResult *res = &results[num_results];
+                    if (bench_run(&rate_sources[s], (BenchEffect)e, sample_rate, bench_block_sizes[b],
+                                  seconds, ir_path, res) != 0) {
+                        continue;
+                    }
+                    num_results++;
+
+                    char allocs[16];
+                    if (allocations_tracked()) snprintf(allocs, sizeof(allocs), "%d", res->allocations);
+                    else snprintf(allocs, sizeof(allocs), "-");
+                    printf("%-24.24s %-12s %6d %5d %10.2f %9.0fx %7s\n", res->source, res->effect,
+                           res->sample_rate, res->block_size, res->ns_per_frame, res->realtime_factor, allocs);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    int rc = write_json(out_path, results, num_results, seconds);
+    if (rc == 0) printf("\nWrote %d results to %s\n", num_results, out_path);
+
+    if (generated_ir) remove(BENCH_TEMP_IR);
+    for (int i = 0; i < num_sources; i++) free(sources[i].buffer);
+    free(sources);
+    free(results);
+    return rc == 0 ? 0 : 1;
+}
@@ -17,6 +17,11 @@ extern "C" {
 #include "midi_output.h"
 #include "lcd.h"
 #include "regroove_effects.h"
+#include "regroove_fx_graph.h"
+#include "regroove_mixer.h"
+#include "regroove_latency.h"
+#include "regroove_cue.h"
+#include "regroove_recorder.h"
 #include "audio_input.h"
 }
 
@@ -26,6 +31,7 @@ extern "C" {
 static void handle_input_event(InputEvent *event, bool from_playback = false);
 static void update_phrases(void);
 static void apply_channel_settings(void);
+static void toggle_audio_recording(void);
 
 // -----------------------------------------------------------------------------
 // State & Helper Types
@@ -45,10 +51,17 @@ static float pitch_slider = 0.0f; // -1.0 to 1.0, 0 = 1.0x pitch
 static float step_fade[16] = {0.0f};
 static int current_step = 0;
 static bool loop_enabled = false;
-static bool playing = false;
+static bool playing = false;        // UI thread
+static SDL_atomic_t audio_playing;  // What the audio callback plays (MIDI Start/Stop set it there)
 static int pattern = 1, order = 1, total_rows = 64;
 static float loop_blink = 0.0f;
 
+// Start or stop playback from the UI thread
+static void set_playing(bool on) {
+    playing = on;
+    SDL_AtomicSet(&audio_playing, on ? 1 : 0);
+}
+
 // UI mode state
 enum UIMode {
     UI_MODE_VOLUME = 0,
@@ -109,6 +122,7 @@ static void apply_channel_settings() {
 static std::vector<std::string> audio_device_names;
 static int selected_audio_device = -1;
 static SDL_AudioDeviceID audio_device_id = 0;
+static int audio_block_frames = 256;  // Frames per output callback (as obtained)
 
 // Audio input device state
 static std::vector<std::string> audio_input_device_names;
@@ -124,6 +138,13 @@ static bool spp_active = false;
 static double spp_last_received_time = 0.0;
 static double spp_last_sent_time = 0.0;  // Track when SPP was last sent (to avoid spam on Start)
 
+// MIDI Clock beat-phase alignment: the tempo nudge is this gain times the phase error
+// (in beats), so an error decays over about 1 / gain beats; larger errors are corrected
+// at the maximum nudge. Whole-beat offsets are left to SPP/Start.
+#define BEAT_PHASE_GAIN 0.25
+#define BEAT_PHASE_MAX_NUDGE 0.02
+static float beat_phase_error = 0.0f;    // Last external - local phase (beats, audio thread)
+
 // Pad expansion setting
 static bool expanded_pads = false;
 
@@ -143,23 +164,81 @@ static float input_volume = 0.0f;       // Audio input volume (0.0 - 1.0, defaul
 static bool input_mute = true;          // Input muted by default
 static float input_pan = 0.5f;          // Input pan (0.0 = left, 0.5 = center, 1.0 = right)
 
-// Effects routing (mutually exclusive - only one can be selected)
-enum FXRoute {
-    FX_ROUTE_NONE = 0,
-    FX_ROUTE_MASTER = 1,
-    FX_ROUTE_PLAYBACK = 2,
-    FX_ROUTE_INPUT = 3
-};
-static FXRoute fx_route = FX_ROUTE_PLAYBACK;  // Default: effects on playback
-
 // MIDI input state
 static bool midi_input_enabled = false;
 
+// MIDI input is read by the audio callback (the only reader of the device queues).
+// What only touches the engine is applied there at its frame in the block: CCs mapped
+// to engine controllers (channel volume/pan, pitch), note pads whose actions are all
+// engine playback controls (queued jumps, mutes, retrigger, play/stop), and MIDI
+// Start/Stop/Continue and Song Position Pointer. Every event then goes on to the UI
+// thread, which records it, updates the UI state and runs everything else (mappings
+// to other actions, file and UI actions, learn mode, monitor) as before.
+#define MIDI_INPUT_BLOCK_EVENTS 64      // Engine events applied per audio block
+#define MIDI_INPUT_MIN_SEGMENT 16       // Shortest partial render when splitting at an event
+#define MIDI_INPUT_UI_QUEUE_SIZE 512    // Power of two
+#define MIDI_INPUT_UI_RESERVED 128      // Queue slots applied CCs leave for the other events
+#define MIDI_INPUT_CC_CONTROLLERS 4     // Engine controllers one CC may drive from the audio callback
+
+struct MidiControllerMapping {
+    int count;                          // 0 = handled on the UI thread
+    InputAction action[MIDI_INPUT_CC_CONTROLLERS];
+    int parameter[MIDI_INPUT_CC_CONTROLLERS];
+};
+
+struct MidiControllerEvent {
+    int offset;                         // Frame in the block
+    InputAction action;
+    int parameter;
+    int value;
+    int spp_position;                   // >= 0: Song Position Pointer (action unused)
+};
+
+struct MidiUiEvent {
+    MidiInputEvent event;
+    bool applied;                       // Already applied by the audio callback
+};
+
+// CC -> engine controller map and note -> engine pad action map, published by the UI
+// thread for the audio callback. Transport and SPP are applied there when
+// midi_transport_direct is set.
+static MidiControllerMapping midi_controller_map[MIDI_MAX_DEVICES][128];
+static MidiControllerMapping midi_pad_map[MIDI_MAX_DEVICES][128];
+static bool midi_transport_direct = false;
+static SDL_SpinLock midi_controller_map_lock = 0;
+
+// Controller events of the current block (audio thread)
+static MidiControllerEvent block_controllers[MIDI_INPUT_BLOCK_EVENTS];
+static int block_controller_count = 0;
+static int block_controller_next = 0;
+
+// Audio callback -> UI thread. Events the UI thread still has to run, and the rest of
+// applied pads and transport, are never dropped: when the queue is full they wait in
+// the device queues. Applied controller CCs may lose their UI update (monitor,
+// recording, fader position), counted in midi_ui_dropped.
+static MidiUiEvent midi_ui_queue[MIDI_INPUT_UI_QUEUE_SIZE];
+static SDL_atomic_t midi_ui_head;
+static SDL_atomic_t midi_ui_tail;
+static SDL_atomic_t midi_ui_dropped;
+
 // MIDI output state
-static int midi_output_device = -1;  // -1 = disabled
 static bool midi_output_enabled = false;
-
-// Effects state
+static double render_segment_start = 0.0;  // Offset of the partial render in the audio block (s)
+
+// Effects state: a graph of chains routed to buses; `effects` is the chain being edited
+// (UI faders, pads and MIDI mappings act on it)
+#define FX_GRAPH_CHAINS 3
+static RegrooveFxGraph* fx_graph = NULL;
+static RegrooveMixer* mixer = NULL;
+static RegrooveLatencyCal* latency_cal = NULL;
+static bool latency_result_stored = false;
+static RegrooveRecorder* recorder = NULL;
+
+// Cue/headphone bus on a second output device
+static RegrooveCue* cue_bus = NULL;
+static SDL_AudioDeviceID cue_device_id = 0;
+static int selected_cue_device = -1;
+static int fx_edit_chain = 0;
 static RegrooveEffects* effects = NULL;
 
 // MIDI monitor (circular buffer for recent MIDI messages)
@@ -312,16 +391,6 @@ static void my_row_callback(int ord, int row, void *userdata) {
         }
     }
 
-    // Update MIDI Clock BPM if master mode is enabled
-    // (Actual clock pulses are sent from audio callback for precise timing)
-    if (common_state && common_state->player && midi_output_is_clock_master()) {
-        double bpm = regroove_get_current_bpm(common_state->player);
-        double pitch = regroove_get_pitch(common_state->player);
-        // Lower pitch value = faster playback, so divide BPM by pitch
-        double effective_bpm = bpm / pitch;
-        midi_output_update_clock(effective_bpm, (double)row);
-    }
-
     // Update performance timeline
     if (common_state && common_state->performance) {
         // Check for events to playback at current performance row BEFORE incrementing
@@ -370,11 +439,6 @@ static void my_order_callback(int ord, int pat, void *userdata) {
     if (common_state && common_state->player)
         total_rows = regroove_get_full_pattern_rows(common_state->player);
 
-    // Reset program change tracking so programs are resent at pattern boundaries
-    if (midi_output_enabled) {
-        midi_output_reset_programs();
-    }
-
     // Update MIDI Song Position Pointer at pattern boundaries (if "during playback" mode and interval == 64)
     // The clock thread will send SPP when position changes
     // For smaller intervals, SPP is updated from row callback
@@ -412,10 +476,6 @@ static void my_order_callback(int ord, int pat, void *userdata) {
 static void my_loop_pattern_callback(int order, int pattern, void *userdata) {
     //printf("[LOOP] Loop/retrigger at Order %d (Pattern %d)\n", order, pattern);
     loop_blink = 1.0f;
-    // Reset program change tracking on loop retrigger
-    if (midi_output_enabled) {
-        midi_output_reset_programs();
-    }
 
     // Note: MIDI Clock continues at same tempo across position jumps (loops, Dxx, Bxx commands)
     // The clock pulse rate stays accurate for tempo sync, but MIDI Clock protocol has no
@@ -429,6 +489,33 @@ static void my_loop_song_callback(void *userdata) {
     loop_blink = 1.0f;
 }
 
+// Send a pattern note event to MIDI output, for a row `delay` seconds into the block
+static void send_midi_note_event(int channel, int note, int instrument, int volume,
+                                 int effect_cmd, int effect_param, double delay) {
+    // Check for note-off effect commands (0FFF or EC0)
+    if (effect_cmd == 0x0F && effect_param == 0xFF) {
+        // 0FFF = Note OFF in OctaMED
+        midi_output_stop_channel_at(channel, delay);
+        return;
+    }
+    if (effect_cmd == 0x0E && effect_param == 0xC0) {
+        // EC0 = Note cut
+        midi_output_stop_channel_at(channel, delay);
+        return;
+    }
+
+    // Handle note events
+    if (note == -2) {
+        // Explicit note-off (=== or OFF in pattern)
+        midi_output_stop_channel_at(channel, delay);
+    } else if (note >= 0) {
+        // New note triggered
+        // Use default volume if not specified
+        int vel = (volume >= 0) ? volume : 64;
+        midi_output_handle_note_at(channel, note, instrument, vel, delay);
+    }
+}
+
 static void my_note_callback(int channel, int note, int instrument, int volume,
                              int effect_cmd, int effect_param, void *userdata) {
     (void)userdata;
@@ -447,28 +534,37 @@ static void my_note_callback(int channel, int note, int instrument, int volume,
 
     if (!midi_output_enabled) return;
 
-    // Check for note-off effect commands (0FFF or EC0)
-    if (effect_cmd == 0x0F && effect_param == 0xFF) {
-        // 0FFF = Note OFF in OctaMED
-        midi_output_stop_channel(channel);
-        return;
-    }
-    if (effect_cmd == 0x0E && effect_param == 0xC0) {
-        // EC0 = Note cut
-        midi_output_stop_channel(channel);
-        return;
-    }
+    // With the note lookahead on, notes were already sent by my_note_ahead_callback
+    if (common_state && common_state->player && regroove_get_note_lookahead(common_state->player) > 0.0) return;
 
-    // Handle note events
-    if (note == -2) {
-        // Explicit note-off (=== or OFF in pattern)
-        midi_output_stop_channel(channel);
-    } else if (note >= 0) {
-        // New note triggered
-        // Use default volume if not specified
-        int vel = (volume >= 0) ? volume : 64;
-        midi_output_handle_note(channel, note, instrument, vel);
+    send_midi_note_event(channel, note, instrument, volume, effect_cmd, effect_param, 0.0);
+}
+
+// Notes reported ahead of their row (MIDI output latency compensation). The delay is
+// from the start of the partial render, so the render's offset in the block is added.
+static void my_note_ahead_callback(int channel, int note, int instrument, int volume,
+                                   int effect_cmd, int effect_param, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    send_midi_note_event(channel, note, instrument, volume, effect_cmd, effect_param,
+                         delay + render_segment_start);
+}
+
+static void my_note_cancel_callback(uint64_t channels, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    midi_output_cancel_notes(channels, delay + render_segment_start);
+}
+
+// Before each row's notes: program changes for the next order go out once a MIDI
+// channel is done with this one (rows reported ahead are timed like their notes)
+static void my_note_row_callback(int ord, int row, int next_order, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    if (common_state && common_state->player && regroove_get_note_lookahead(common_state->player) > 0.0) {
+        delay += render_segment_start;
     }
+    midi_output_prepare_programs(ord, row, next_order, delay);
 }
 
 
@@ -490,6 +586,9 @@ static int load_module(const char *path) {
         .on_loop_pattern = my_loop_pattern_callback,
         .on_loop_song = my_loop_song_callback,
         .on_note = my_note_callback,
+        .on_note_ahead = my_note_ahead_callback,
+        .on_note_cancel = my_note_cancel_callback,
+        .on_note_row = my_note_row_callback,
         .userdata = NULL
     };
 
@@ -500,6 +599,11 @@ static int load_module(const char *path) {
     Regroove *mod = common_state->player;
     common_state->num_channels = regroove_get_num_channels(mod);
 
+    // Channel pre-listen plays the same module on the cue bus
+    if (regroove_cue_get_mode(cue_bus) == REGROOVE_CUE_CHANNELS) {
+        regroove_cue_load(cue_bus, path);
+    }
+
     for (int i = 0; i < 16; ++i) step_fade[i] = 0.0f;
 
     for (int i = 0; i < common_state->num_channels; i++) {
@@ -516,49 +620,60 @@ static int load_module(const char *path) {
     total_rows = regroove_get_full_pattern_rows(mod);
 
     loop_enabled = false;
-    playing = false;
+    set_playing(false);
     pitch_slider = 0.0f;
     current_step = 0;
 
     regroove_set_custom_loop_rows(mod, 0); // 0 disables custom loop
     regroove_set_pitch(mod, MapPitchFader(0.0f)); // Reset pitch
 
-    // Clear effects buffers and reset to default parameters
-    if (effects) {
-        regroove_effects_reset(effects);
+    // Clear effects buffers and reset all chains to default parameters
+    for (int c = 0; c < regroove_fx_graph_get_num_chains(fx_graph); c++) {
+        RegrooveEffects *fx = regroove_fx_graph_get_chain(fx_graph, c);
+
+        regroove_effects_reset(fx);
 
         // Disable all effects
-        regroove_effects_set_distortion_enabled(effects, 0);
-        regroove_effects_set_filter_enabled(effects, 0);
-        regroove_effects_set_eq_enabled(effects, 0);
-        regroove_effects_set_compressor_enabled(effects, 0);
-        regroove_effects_set_delay_enabled(effects, 0);
+        regroove_effects_set_distortion_enabled(fx, 0);
+        regroove_effects_set_filter_enabled(fx, 0);
+        regroove_effects_set_eq_enabled(fx, 0);
+        regroove_effects_set_compressor_enabled(fx, 0);
+        regroove_effects_set_multiband_enabled(fx, 0);
+        regroove_effects_set_delay_enabled(fx, 0);
+        regroove_effects_set_convolution_enabled(fx, 0);
 
         // Reset all parameters to defaults from config
-        regroove_effects_set_distortion_drive(effects, common_state->device_config.fx_distortion_drive);
-        regroove_effects_set_distortion_mix(effects, common_state->device_config.fx_distortion_mix);
-        regroove_effects_set_filter_cutoff(effects, common_state->device_config.fx_filter_cutoff);
-        regroove_effects_set_filter_resonance(effects, common_state->device_config.fx_filter_resonance);
-        regroove_effects_set_eq_low(effects, common_state->device_config.fx_eq_low);
-        regroove_effects_set_eq_mid(effects, common_state->device_config.fx_eq_mid);
-        regroove_effects_set_eq_high(effects, common_state->device_config.fx_eq_high);
-        regroove_effects_set_compressor_threshold(effects, common_state->device_config.fx_compressor_threshold);
-        regroove_effects_set_compressor_ratio(effects, common_state->device_config.fx_compressor_ratio);
-        regroove_effects_set_compressor_attack(effects, common_state->device_config.fx_compressor_attack);
-        regroove_effects_set_compressor_release(effects, common_state->device_config.fx_compressor_release);
-        regroove_effects_set_compressor_makeup(effects, common_state->device_config.fx_compressor_makeup);
-        regroove_effects_set_delay_time(effects, common_state->device_config.fx_delay_time);
-        regroove_effects_set_delay_feedback(effects, common_state->device_config.fx_delay_feedback);
-        regroove_effects_set_delay_mix(effects, common_state->device_config.fx_delay_mix);
+        regroove_effects_set_distortion_drive(fx, common_state->device_config.fx_distortion_drive);
+        regroove_effects_set_distortion_mix(fx, common_state->device_config.fx_distortion_mix);
+        regroove_effects_set_filter_cutoff(fx, common_state->device_config.fx_filter_cutoff);
+        regroove_effects_set_filter_resonance(fx, common_state->device_config.fx_filter_resonance);
+        regroove_effects_set_filter_mode(fx, REGROOVE_FX_FILTER_LOWPASS);
+        regroove_effects_set_eq_low(fx, common_state->device_config.fx_eq_low);
+        regroove_effects_set_eq_mid(fx, common_state->device_config.fx_eq_mid);
+        regroove_effects_set_eq_high(fx, common_state->device_config.fx_eq_high);
+        regroove_effects_set_compressor_threshold(fx, common_state->device_config.fx_compressor_threshold);
+        regroove_effects_set_compressor_ratio(fx, common_state->device_config.fx_compressor_ratio);
+        regroove_effects_set_compressor_attack(fx, common_state->device_config.fx_compressor_attack);
+        regroove_effects_set_compressor_release(fx, common_state->device_config.fx_compressor_release);
+        regroove_effects_set_compressor_makeup(fx, common_state->device_config.fx_compressor_makeup);
+        regroove_effects_set_delay_time(fx, common_state->device_config.fx_delay_time);
+        regroove_effects_set_delay_feedback(fx, common_state->device_config.fx_delay_feedback);
+        regroove_effects_set_delay_mix(fx, common_state->device_config.fx_delay_mix);
+        regroove_effects_set_convolution_mix(fx, common_state->device_config.fx_convolution_mix);
     }
 
+    // Impulse response from the .rgx (or config default), loaded in the background
+    char ir_path[COMMON_MAX_PATH];
+    regroove_common_get_convolution_ir(common_state, ir_path, sizeof(ir_path));
+    regroove_fx_graph_load_convolution_ir(fx_graph, ir_path);
+
     // Audio device stays running for input passthrough - just stop playback
-    playing = false;
+    set_playing(false);
     for (int i = 0; i < 16; i++) step_fade[i] = 0.0f;
 
-    // Set metadata for MIDI output (for channel mapping)
+    // Set metadata for MIDI output (for channel mapping and the program schedule)
     if (common_state && common_state->metadata) {
-        midi_output_set_metadata(common_state->metadata);
+        regroove_common_apply_midi_mapping(common_state);
     }
 
     // Auto-switch to PERF mode if performance events were loaded, otherwise VOL mode
@@ -679,10 +794,13 @@ void dispatch_action(GuiAction act, int arg1 = -1, float arg2 = 0.0f, bool shoul
                 apply_channel_settings();
 
                 // Audio device is always running for input passthrough - just set playing flag
-                playing = true;
+                set_playing(true);
                 if (common_state) common_state->paused = 0;  // Update paused state
                 printf("ACT_PLAY: playing flag set to true\n");
 
+                // Notes reported ahead start again from the playing row
+                regroove_common_apply_midi_output_latency(common_state);
+
                 // Send MIDI Start if transport sending is enabled (independent of clock master)
                 if (common_state->device_config.midi_clock_send_transport) {
                     midi_output_send_start();
@@ -692,9 +810,11 @@ void dispatch_action(GuiAction act, int arg1 = -1, float arg2 = 0.0f, bool shoul
         case ACT_STOP:
             if (mod) {
                 // Audio device stays running for input passthrough - just stop playback
-                playing = false;
+                set_playing(false);
                 if (common_state) common_state->paused = 1;  // Update paused state
                 printf("ACT_STOP: playing flag set to false\n");
+                // Drop notes already sent ahead for rows that will not play now
+                if (midi_output_enabled) midi_output_cancel_notes(REGROOVE_ALL_CHANNELS, 0.0);
                 // Notify performance system that playback stopped AND reset to beginning
                 if (common_state && common_state->performance) {
                     regroove_performance_set_playback(common_state->performance, 0);
@@ -912,16 +1032,14 @@ void dispatch_action(GuiAction act, int arg1 = -1, float arg2 = 0.0f, bool shoul
 // -----------------------------------------------------------------------------
 static void trigger_phrase(int phrase_index) {
     // Clear effect buffers to prevent clicks/pops from previous state
-    if (effects) {
-        regroove_effects_reset(effects);
-    }
+    regroove_fx_graph_reset(fx_graph);
 
     // Use common library function
     regroove_common_trigger_phrase(common_state, phrase_index);
 
     // Sync GUI playing state with common_state->paused
     if (!common_state->paused) {
-        playing = true;
+        set_playing(true);
     }
 }
 
@@ -1308,6 +1426,20 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_compressor_ratio(effects, value / 127.0f);
             }
             break;
+        case ACTION_FX_MB_LOW_THRESHOLD:
+        case ACTION_FX_MB_MID_THRESHOLD:
+        case ACTION_FX_MB_HIGH_THRESHOLD:
+            if (effects) {
+                regroove_effects_set_multiband_threshold(effects, action - ACTION_FX_MB_LOW_THRESHOLD, value / 127.0f);
+            }
+            break;
+        case ACTION_FX_MB_LOW_GAIN:
+        case ACTION_FX_MB_MID_GAIN:
+        case ACTION_FX_MB_HIGH_GAIN:
+            if (effects) {
+                regroove_effects_set_multiband_gain(effects, action - ACTION_FX_MB_LOW_GAIN, value / 127.0f);
+            }
+            break;
         case ACTION_FX_DELAY_TIME:
             if (effects) {
                 regroove_effects_set_delay_time(effects, value / 127.0f);
@@ -1323,6 +1455,16 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_delay_mix(effects, value / 127.0f);
             }
             break;
+        case ACTION_FX_DUCKER_DEPTH:
+            if (effects) {
+                regroove_effects_set_ducker_depth(effects, value / 127.0f);
+            }
+            break;
+        case ACTION_FX_CONVOLUTION_MIX:
+            if (effects) {
+                regroove_effects_set_convolution_mix(effects, value / 127.0f);
+            }
+            break;
         case ACTION_FX_DISTORTION_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_distortion_enabled(effects);
@@ -1335,6 +1477,12 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_filter_enabled(effects, !enabled);
             }
             break;
+        case ACTION_FX_FILTER_MODE:
+            if (effects) {
+                int mode = (regroove_effects_get_filter_mode(effects) + 1) % REGROOVE_FX_FILTER_MODE_COUNT;
+                regroove_effects_set_filter_mode(effects, mode);
+            }
+            break;
         case ACTION_FX_EQ_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_eq_enabled(effects);
@@ -1347,12 +1495,36 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_compressor_enabled(effects, !enabled);
             }
             break;
+        case ACTION_FX_MULTIBAND_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_multiband_enabled(effects);
+                regroove_effects_set_multiband_enabled(effects, !enabled);
+            }
+            break;
         case ACTION_FX_DELAY_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_delay_enabled(effects);
                 regroove_effects_set_delay_enabled(effects, !enabled);
             }
             break;
+        case ACTION_FX_DELAY_SYNC_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_delay_sync(effects);
+                regroove_effects_set_delay_sync(effects, !enabled);
+            }
+            break;
+        case ACTION_FX_DUCKER_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_ducker_enabled(effects);
+                regroove_effects_set_ducker_enabled(effects, !enabled);
+            }
+            break;
+        case ACTION_FX_CONVOLUTION_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_convolution_enabled(effects);
+                regroove_effects_set_convolution_enabled(effects, !enabled);
+            }
+            break;
         case ACTION_MASTER_VOLUME:
             // Map MIDI value (0-127) to volume range (0.0-1.0)
             master_volume = value / 127.0f;
@@ -1390,6 +1562,9 @@ static void execute_action(InputAction action, int parameter, float value, void*
         case ACTION_INPUT_MUTE:
             input_mute = !input_mute;
             break;
+        case ACTION_AUDIO_RECORD_TOGGLE:
+            toggle_audio_recording();
+            break;
         case ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE:
             if (common_state) {
                 common_state->device_config.midi_clock_sync = !common_state->device_config.midi_clock_sync;
@@ -1600,6 +1775,9 @@ static void save_mappings_to_config() {
         return;
     }
 
+    // Every edit of the mappings or application pads ends up here
+    input_mappings_invalidate(common_state->input_mappings);
+
     printf("Saving mappings to %s...\n", current_config_file);
 
     // Save the current input mappings (includes trigger pads)
@@ -1626,6 +1804,9 @@ static void save_rgx_metadata() {
     char rgx_path[COMMON_MAX_PATH];
     regroove_metadata_get_rgx_path(common_state->current_module_path, rgx_path, sizeof(rgx_path));
 
+    // MIDI output reads the mapping when it is applied, not on each note
+    regroove_common_apply_midi_mapping(common_state);
+
     // Save metadata
     if (regroove_metadata_save(common_state->metadata, rgx_path) == 0) {
         printf("Saved metadata to %s\n", rgx_path);
@@ -1634,6 +1815,45 @@ static void save_rgx_metadata() {
     }
 }
 
+// Note length selector of an instrument/sample in the MIDI mapping table
+static void draw_note_length_combo(const char *combo_id, int index) {
+    static const char *unit_names[] = { "tk", "row", "ms" };
+    static const struct { int length; RegrooveNoteLengthUnit unit; } presets[] = {
+        { 1, RGX_NOTE_LENGTH_TICKS }, { 2, RGX_NOTE_LENGTH_TICKS }, { 3, RGX_NOTE_LENGTH_TICKS },
+        { 1, RGX_NOTE_LENGTH_ROWS }, { 2, RGX_NOTE_LENGTH_ROWS }, { 4, RGX_NOTE_LENGTH_ROWS }, { 8, RGX_NOTE_LENGTH_ROWS },
+        { 10, RGX_NOTE_LENGTH_MS }, { 50, RGX_NOTE_LENGTH_MS }, { 100, RGX_NOTE_LENGTH_MS }, { 250, RGX_NOTE_LENGTH_MS },
+    };
+
+    RegrooveNoteLengthUnit unit;
+    int length = regroove_metadata_get_note_length(common_state->metadata, index, &unit);
+    char label[32];
+    if (length == 0) {
+        snprintf(label, sizeof(label), "Default");
+    } else {
+        snprintf(label, sizeof(label), "%d %s", length, unit_names[unit]);
+    }
+
+    ImGui::SetNextItemWidth(80.0f);
+    if (ImGui::BeginCombo(combo_id, label)) {
+        if (ImGui::Selectable("Default", length == 0)) {
+            regroove_metadata_set_note_length(common_state->metadata, index, 0, RGX_NOTE_LENGTH_TICKS);
+            save_rgx_metadata();
+        }
+        for (size_t p = 0; p < sizeof(presets) / sizeof(presets[0]); p++) {
+            char p_label[16];
+            snprintf(p_label, sizeof(p_label), "%d %s", presets[p].length, unit_names[presets[p].unit]);
+            if (ImGui::Selectable(p_label, length == presets[p].length && unit == presets[p].unit)) {
+                regroove_metadata_set_note_length(common_state->metadata, index, presets[p].length, presets[p].unit);
+                save_rgx_metadata();
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Note length: the note-off is sent this long after the note-on\n(or earlier, at the next note/off). Default = device setting.");
+    }
+}
+
 // Learn keyboard mapping for current target
 static void learn_keyboard_mapping(int key) {
     if (!common_state || !common_state->input_mappings) return;
@@ -1809,6 +2029,7 @@ static void unlearn_current_target() {
         printf("Removed %d mapping(s)\n", removed_count);
     } else if (song_pad_changed) {
         // Save song pad changes to .rgx file
+        input_mappings_invalidate(common_state->input_mappings);
         regroove_common_save_rgx(common_state);
         printf("Removed song pad mapping\n");
     } else {
@@ -1956,12 +2177,18 @@ static void format_pad_action_text(InputAction action, int parameter, char *line
         }
         case ACTION_FX_DISTORTION_TOGGLE: snprintf(line1, line1_size, "DIST\nTOGGLE"); break;
         case ACTION_FX_FILTER_TOGGLE: snprintf(line1, line1_size, "FILTER\nTOGGLE"); break;
+        case ACTION_FX_FILTER_MODE: snprintf(line1, line1_size, "FILTER\nMODE"); break;
         case ACTION_FX_EQ_TOGGLE: snprintf(line1, line1_size, "EQ\nTOGGLE"); break;
         case ACTION_FX_COMPRESSOR_TOGGLE: snprintf(line1, line1_size, "COMP\nTOGGLE"); break;
+        case ACTION_FX_MULTIBAND_TOGGLE: snprintf(line1, line1_size, "MBAND\nTOGGLE"); break;
         case ACTION_FX_DELAY_TOGGLE: snprintf(line1, line1_size, "DELAY\nTOGGLE"); break;
+        case ACTION_FX_DELAY_SYNC_TOGGLE: snprintf(line1, line1_size, "DELAY\nSYNC"); break;
+        case ACTION_FX_DUCKER_TOGGLE: snprintf(line1, line1_size, "DUCK\nTOGGLE"); break;
+        case ACTION_FX_CONVOLUTION_TOGGLE: snprintf(line1, line1_size, "REVERB\nTOGGLE"); break;
         case ACTION_MASTER_MUTE: snprintf(line1, line1_size, "MASTER\nMUTE"); break;
         case ACTION_PLAYBACK_MUTE: snprintf(line1, line1_size, "PBACK\nMUTE"); break;
         case ACTION_INPUT_MUTE: snprintf(line1, line1_size, "INPUT\nMUTE"); break;
+        case ACTION_AUDIO_RECORD_TOGGLE: snprintf(line1, line1_size, "AUDIO\nREC"); break;
         case ACTION_MIDI_CLOCK_TEMPO_SYNC_TOGGLE: snprintf(line1, line1_size, "SYNC\nTEMPO"); break;
         case ACTION_MIDI_TRANSPORT_RECEIVE_TOGGLE: snprintf(line1, line1_size, "RECV\nSTART"); break;
         case ACTION_MIDI_SPP_RECEIVE_TOGGLE: snprintf(line1, line1_size, "RECV\nSPP"); break;
@@ -2049,6 +2276,7 @@ static void learn_midi_mapping(int device_id, int cc_or_note, bool is_note) {
                 pad->midi_device = device_id;
                 printf("Learned MIDI note mapping: Note %d (device %d) -> Song Pad S%d\n",
                        cc_or_note, device_id, song_pad_idx + 1);
+                input_mappings_invalidate(common_state->input_mappings);
                 // Save to .rgx file
                 regroove_common_save_rgx(common_state);
             }
@@ -2121,9 +2349,13 @@ static void learn_midi_mapping(int device_id, int cc_or_note, bool is_note) {
                  learn_target_action == ACTION_FX_EQ_HIGH ||
                  learn_target_action == ACTION_FX_COMPRESSOR_THRESHOLD ||
                  learn_target_action == ACTION_FX_COMPRESSOR_RATIO ||
+                 (learn_target_action >= ACTION_FX_MB_LOW_THRESHOLD &&
+                  learn_target_action <= ACTION_FX_MB_HIGH_GAIN) ||
                  learn_target_action == ACTION_FX_DELAY_TIME ||
                  learn_target_action == ACTION_FX_DELAY_FEEDBACK ||
-                 learn_target_action == ACTION_FX_DELAY_MIX)) {
+                 learn_target_action == ACTION_FX_DELAY_MIX ||
+                 learn_target_action == ACTION_FX_DUCKER_DEPTH ||
+                 learn_target_action == ACTION_FX_CONVOLUTION_MIX)) {
                 new_mapping.threshold = 0;
                 new_mapping.continuous = 1; // Continuous fader mode
             } else {
@@ -2222,11 +2454,12 @@ void handle_keyboard(SDL_Event &e, SDL_Window *window) {
         return;
     }
 
-    // Query input mappings
+    // Query input mappings (every action bound to the key)
     if (common_state && common_state->input_mappings) {
-        InputEvent event;
-        if (input_mappings_get_keyboard_event(common_state->input_mappings, key, &event)) {
-            handle_input_event(&event);
+        InputEvent events[INPUT_MAPPINGS_MAX_BINDINGS];
+        int count = input_mappings_get_keyboard_events(common_state->input_mappings, key, events, INPUT_MAPPINGS_MAX_BINDINGS);
+        for (int i = 0; i < count; i++) {
+            handle_input_event(&events[i]);
         }
     }
 }
@@ -2248,33 +2481,20 @@ void my_midi_transport_callback(unsigned char message_type, void* userdata) {
     }
 }
 
-// MIDI Song Position Pointer callback (for position sync at pattern boundaries)
-void my_midi_spp_callback(int position, void* userdata) {
-    (void)userdata;
-
-    if (!common_state || !common_state->player) return;
-
-    // Check if SPP receive is enabled
-    if (common_state->device_config.midi_spp_receive == 0) {
-        return; // Ignore incoming SPP
-    }
-
-    // Convert MIDI beats (position) to order and row
+// Row a Song Position Pointer points at in a pattern of pattern_rows rows
+static int midi_spp_target_row(int position, int pattern_rows) {
     // We use 64 MIDI beats per pattern (standard assumption)
-    int target_order = position / 64;
     int beats_within_pattern = position % 64;  // 0-63
-
-    // Get the actual row count for current pattern
-    int pattern_rows = total_rows > 0 ? total_rows : 64;
+    if (pattern_rows <= 0) pattern_rows = 64;
 
     // Convert beats to rows: scale 64 beats to actual pattern row count
     int target_row = (beats_within_pattern * pattern_rows) / 64;
     if (target_row >= pattern_rows) target_row = pattern_rows - 1;
+    return target_row;
+}
 
-    // Get current row to check if sync is needed
-    int current_row = regroove_get_current_row(common_state->player);
-    int row_diff = target_row - current_row;
-
+// Show a received Song Position Pointer (LCD and pads assigned to SPP receive)
+static void show_midi_spp_received() {
     // Mark SPP as active (for LCD display)
     spp_active = true;
     spp_last_received_time = SDL_GetTicks() / 1000.0;
@@ -2294,6 +2514,28 @@ void my_midi_spp_callback(int position, void* userdata) {
             }
         }
     }
+}
+
+// MIDI Song Position Pointer callback (for position sync at pattern boundaries)
+void my_midi_spp_callback(int position, void* userdata) {
+    (void)userdata;
+
+    if (!common_state || !common_state->player) return;
+
+    // Check if SPP receive is enabled
+    if (common_state->device_config.midi_spp_receive == 0) {
+        return; // Ignore incoming SPP
+    }
+
+    // Convert MIDI beats (position) to order and row, using the current pattern's row count
+    int target_order = position / 64;
+    int target_row = midi_spp_target_row(position, total_rows);
+
+    // Get current row to check if sync is needed
+    int current_row = regroove_get_current_row(common_state->player);
+    int row_diff = target_row - current_row;
+
+    show_midi_spp_received();
 
     // Only sync if we're more than 2 rows off (avoids constant micro-adjustments)
     // This prevents "halting" caused by unnecessary row jumps
@@ -2338,248 +2580,872 @@ void my_midi_mapping(unsigned char status, unsigned char cc_or_note, unsigned ch
         return;
     }
 
-    // Handle Note-On messages for trigger pads
+    // Handle Note-On messages for trigger pads (application pads A1-A16, then song pads S1-S16)
     if (msg_type == 0x90 && value > 0) { // Note-On with velocity > 0
-        int note = cc_or_note;
-        bool triggered = false;
-
-        // Check application trigger pads (A1-A16)
         if (common_state && common_state->input_mappings) {
-            for (int i = 0; i < MAX_TRIGGER_PADS; i++) {
-                TriggerPadConfig *pad = &common_state->input_mappings->trigger_pads[i];
-                // Skip if disabled
-                if (pad->midi_device == -2) continue;
-
-                // Match device (if specified) and note
-                if (pad->midi_note == note &&
-                    (pad->midi_device == -1 || pad->midi_device == device_id)) {
-
-                    // Trigger visual feedback
-                    trigger_pad_fade[i] = 1.0f;
-
-                    // Execute the configured action
-                    if (pad->action != ACTION_NONE) {
-                        InputEvent event;
-                        event.action = pad->action;
-                        event.parameter = pad->parameter;
-                        event.value = value;
-                        handle_input_event(&event, false);
-                    }
-                    triggered = true;
-                    break; // Only trigger the first matching pad
-                }
-            }
-        }
-
-        // If not triggered by application pad, check song trigger pads (S1-S16)
-        if (!triggered && common_state && common_state->metadata) {
-            for (int i = 0; i < MAX_SONG_TRIGGER_PADS; i++) {
-                TriggerPadConfig *pad = &common_state->metadata->song_trigger_pads[i];
-                // Skip if disabled
-                if (pad->midi_device == -2) continue;
-
-                // Match device (if specified) and note
-                if (pad->midi_note == note &&
-                    (pad->midi_device == -1 || pad->midi_device == device_id)) {
+            const int *pads;
+            int count = input_mappings_find_note_pads(common_state->input_mappings, device_id, cc_or_note, &pads);
+            for (int i = 0; i < count; i++) {
+                const TriggerPadConfig *pad = (pads[i] < MAX_TRIGGER_PADS)
+                    ? &common_state->input_mappings->trigger_pads[pads[i]]
+                    : &common_state->metadata->song_trigger_pads[pads[i] - MAX_TRIGGER_PADS];
 
-                    // Trigger visual feedback (offset for song pads)
-                    int global_idx = MAX_TRIGGER_PADS + i;
-                    trigger_pad_fade[global_idx] = 1.0f;
+                // Trigger visual feedback
+                trigger_pad_fade[pads[i]] = 1.0f;
 
-                    // Execute the configured action
-                    if (pad->action != ACTION_NONE) {
-                        InputEvent event;
-                        event.action = pad->action;
-                        event.parameter = pad->parameter;
-                        event.value = value;
-                        handle_input_event(&event, false);
-                    }
-                    break; // Only trigger the first matching pad
+                // Execute the configured action
+                if (pad->action != ACTION_NONE) {
+                    InputEvent event;
+                    event.action = pad->action;
+                    event.parameter = pad->parameter;
+                    event.value = value;
+                    handle_input_event(&event, false);
                 }
             }
         }
         return;
     }
 
-    // Handle Control Change messages for input mappings
+    // Handle Control Change messages for input mappings (every action bound to the CC)
     if (msg_type == 0xB0) {
-        // Query input mappings
         if (common_state && common_state->input_mappings) {
-            InputEvent event;
-            if (input_mappings_get_midi_event(common_state->input_mappings, device_id, cc_or_note, value, &event)) {
-                handle_input_event(&event);
+            InputEvent events[INPUT_MAPPINGS_MAX_BINDINGS];
+            int count = input_mappings_get_midi_events(common_state->input_mappings, device_id, cc_or_note, value,
+                                                       events, INPUT_MAPPINGS_MAX_BINDINGS);
+            for (int i = 0; i < count; i++) {
+                handle_input_event(&events[i]);
             }
         }
     }
 }
 
-// -----------------------------------------------------------------------------
-// Audio Callback
-// -----------------------------------------------------------------------------
-static void audio_callback(void *userdata, Uint8 *stream, int len) {
-    int16_t *buffer = (int16_t *)stream;
-    int frames = len / (2 * sizeof(int16_t));
-
-    // Clear buffer first
-    memset(buffer, 0, len);
-
-    // Render playback audio (if playing, player exists, and not muted)
-    if (playing && common_state && common_state->player && !playback_mute) {
-        regroove_render_audio(common_state->player, buffer, frames);
+// Controllers the audio callback can apply itself: continuous engine parameters
+static bool is_engine_controller(InputAction action) {
+    return action == ACTION_CHANNEL_VOLUME || action == ACTION_CHANNEL_PAN || action == ACTION_PITCH_SET;
+}
 
-        // Send MIDI Clock pulses if master mode is enabled
-        if (midi_output_is_clock_master()) {
-            double bpm = regroove_get_current_bpm(common_state->player);
-            double pitch = regroove_get_pitch(common_state->player);
-            // Note: pitch affects sample rate (samplerate * pitch_factor in regroove_engine.c)
-            // Lower pitch = libopenmpt renders at lower samplerate = faster playback = higher effective BPM
-            // Higher pitch = libopenmpt renders at higher samplerate = slower playback = lower effective BPM
-            // So we DIVIDE by pitch, not multiply
-            double effective_bpm = bpm / pitch;
+// Pad actions the audio callback can apply itself: discrete engine playback controls
+// (ACTION_PLAY/ACTION_STOP are handled like MIDI Start/Stop, see midi_transport_direct)
+static bool engine_pad_action(InputAction action, RegrooveApplyAction *out) {
+    switch (action) {
+        case ACTION_QUEUE_NEXT_ORDER:   *out = REGROOVE_APPLY_QUEUE_NEXT_ORDER; return true;
+        case ACTION_QUEUE_PREV_ORDER:   *out = REGROOVE_APPLY_QUEUE_PREV_ORDER; return true;
+        case ACTION_QUEUE_ORDER:        *out = REGROOVE_APPLY_QUEUE_ORDER; return true;
+        case ACTION_QUEUE_PATTERN:      *out = REGROOVE_APPLY_QUEUE_PATTERN; return true;
+        case ACTION_RETRIGGER:          *out = REGROOVE_APPLY_RETRIGGER_PATTERN; return true;
+        case ACTION_CHANNEL_MUTE:       *out = REGROOVE_APPLY_TOGGLE_CHANNEL_MUTE; return true;
+        case ACTION_CHANNEL_SOLO:       *out = REGROOVE_APPLY_TOGGLE_CHANNEL_SOLO; return true;
+        case ACTION_QUEUE_CHANNEL_MUTE: *out = REGROOVE_APPLY_QUEUE_CHANNEL_MUTE; return true;
+        case ACTION_QUEUE_CHANNEL_SOLO: *out = REGROOVE_APPLY_QUEUE_CHANNEL_SOLO; return true;
+        case ACTION_MUTE_ALL:           *out = REGROOVE_APPLY_MUTE_ALL; return true;
+        case ACTION_UNMUTE_ALL:         *out = REGROOVE_APPLY_UNMUTE_ALL; return true;
+        default:                        return false;
+    }
+}
 
-            // Update BPM for clock thread (lock-free, non-blocking)
-            // The dedicated clock thread will handle sending pulses with precise timing
-            midi_output_update_clock(effective_bpm, 0.0);
+// Pad configuration of a pad index from input_mappings_find_note_pads()
+static const TriggerPadConfig *note_pad_config(int pad) {
+    return (pad < MAX_TRIGGER_PADS) ? &common_state->input_mappings->trigger_pads[pad]
+                                    : &common_state->metadata->song_trigger_pads[pad - MAX_TRIGGER_PADS];
+}
 
-            // Note: SPP position is updated by row/order callbacks based on configured interval
-            // The clock thread sends SPP when position changes
+// Rebuild the CC -> engine controller and note -> engine pad maps from the input mapping
+// tables (UI thread, every frame; the lock is only taken when something changed). A CC
+// goes to the audio callback only if every action bound to it is a continuous engine
+// controller, a note only if every pad it triggers has an engine pad action.
+static void update_midi_controller_map() {
+    static MidiControllerMapping map[MIDI_MAX_DEVICES][128];
+    static MidiControllerMapping pad_map[MIDI_MAX_DEVICES][128];
+    memset(map, 0, sizeof(map));
+    memset(pad_map, 0, sizeof(pad_map));
+
+    InputMappings *mappings = common_state ? common_state->input_mappings : NULL;
+
+    // A running phrase is stopped by the next pad, and a recorded performance restarts
+    // from the top on Play: those stay on the UI thread (handle_input_event)
+    bool phrase_active = common_state && common_state->phrase && regroove_phrase_is_active(common_state->phrase);
+    bool transport = common_state && !phrase_active &&
+                     !(common_state->performance && regroove_performance_get_event_count(common_state->performance) > 0);
+    for (int dev = 0; mappings && dev < MIDI_MAX_DEVICES; dev++) {
+        for (int cc = 0; cc < 128; cc++) {
+            const int *indices;
+            int count = input_mappings_find_midi(mappings, dev, cc, &indices);
+            if (count == 0 || count > MIDI_INPUT_CC_CONTROLLERS) continue;
+
+            bool engine_only = true;
+            for (int i = 0; i < count && engine_only; i++) {
+                const MidiMapping *m = &mappings->midi_mappings[indices[i]];
+                engine_only = m->continuous && is_engine_controller(m->action);
+            }
+            if (!engine_only) continue;
+
+            for (int i = 0; i < count; i++) {
+                const MidiMapping *m = &mappings->midi_mappings[indices[i]];
+                map[dev][cc].action[i] = m->action;
+                map[dev][cc].parameter[i] = m->parameter;
+            }
+            map[dev][cc].count = count;
         }
+    }
 
-        // Apply effects if routed to playback
-        if (effects && fx_route == FX_ROUTE_PLAYBACK) {
-            regroove_effects_process(effects, buffer, frames, 48000);
-        }
+    for (int dev = 0; mappings && common_state->metadata && !phrase_active && dev < MIDI_MAX_DEVICES; dev++) {
+        for (int note = 0; note < 128; note++) {
+            const int *pads;
+            int count = input_mappings_find_note_pads(mappings, dev, note, &pads);
+            if (count == 0 || count > MIDI_INPUT_CC_CONTROLLERS) continue;
+
+            bool engine_only = true;
+            for (int i = 0; i < count && engine_only; i++) {
+                InputAction action = note_pad_config(pads[i])->action;
+                RegrooveApplyAction unused;
+                engine_only = engine_pad_action(action, &unused) ||
+                              (transport && (action == ACTION_PLAY || action == ACTION_STOP));
+            }
+            if (!engine_only) continue;
 
-        // Apply playback volume and pan
-        float pb_vol = playback_volume;
-        float pb_pan = playback_pan;
-        for (int i = 0; i < frames; i++) {
-            // Left channel (i*2): full at pan=0.0 (left), silent at pan=1.0 (right)
-            float left_gain = pb_vol * (1.0f - pb_pan);
-            buffer[i * 2] = (int16_t)(buffer[i * 2] * left_gain);
-            // Right channel (i*2+1): silent at pan=0.0 (left), full at pan=1.0 (right)
-            float right_gain = pb_vol * pb_pan;
-            buffer[i * 2 + 1] = (int16_t)(buffer[i * 2 + 1] * right_gain);
+            for (int i = 0; i < count; i++) {
+                const TriggerPadConfig *pad = note_pad_config(pads[i]);
+                pad_map[dev][note].action[i] = pad->action;
+                pad_map[dev][note].parameter[i] = pad->parameter;
+            }
+            pad_map[dev][note].count = count;
         }
-    } else if (effects && fx_route == FX_ROUTE_PLAYBACK) {
-        // When not playing but effects are routed to playback, process effects on silence
-        // to allow delay/reverb tails to decay naturally instead of being cut off
-        regroove_effects_process(effects, buffer, frames, 48000);
     }
 
-    // Mix in audio input when not muted and device is active
-    if (!input_mute && input_volume > 0.0f && audio_input_device_id) {
-        // Check if enough data is available in ring buffer
-        int needed_samples = frames * 2;  // stereo
-        int available = audio_input_available();
-
-        if (available >= needed_samples) {
-            // Create a temporary buffer for input processing
-            int16_t *input_temp = (int16_t*)malloc(frames * 2 * sizeof(int16_t));
-            if (input_temp) {
-                // Read from ring buffer
-                int read = audio_input_read(input_temp, needed_samples);
-                if (read < needed_samples) {
-                    // Fill remainder with silence if underrun
-                    memset(input_temp + read, 0, (needed_samples - read) * sizeof(int16_t));
-                }
+    if (memcmp(map, midi_controller_map, sizeof(map)) != 0 ||
+        memcmp(pad_map, midi_pad_map, sizeof(pad_map)) != 0 || transport != midi_transport_direct) {
+        SDL_AtomicLock(&midi_controller_map_lock);
+        memcpy(midi_controller_map, map, sizeof(map));
+        memcpy(midi_pad_map, pad_map, sizeof(pad_map));
+        midi_transport_direct = transport;
+        SDL_AtomicUnlock(&midi_controller_map_lock);
+    }
+}
 
-            // Apply effects if routed to input
-            if (effects && fx_route == FX_ROUTE_INPUT) {
-                regroove_effects_process(effects, input_temp, frames, 48000);
-            }
+// A controller the audio callback already applied to the engine: log and record it and
+// move the fader, without sending it to the engine again (it would arrive late)
+static void sync_applied_midi_controller(const MidiInputEvent *ev) {
+    add_to_midi_monitor(ev->device_id, "CC", ev->data1, ev->data2, false);
 
-            // Apply input volume, pan, and mix with playback
-            float in_vol = input_volume;
-            float in_pan = input_pan;
-            for (int i = 0; i < frames; i++) {
-                // Left channel (i*2): full at pan=0.0 (left), silent at pan=1.0 (right)
-                float left_gain = in_vol * (1.0f - in_pan);
-                int32_t mixed_left = buffer[i * 2] + (int32_t)(input_temp[i * 2] * left_gain);
-                if (mixed_left > 32767) mixed_left = 32767;
-                if (mixed_left < -32768) mixed_left = -32768;
-                buffer[i * 2] = (int16_t)mixed_left;
+    if (!common_state || !common_state->input_mappings) return;
+    InputEvent events[INPUT_MAPPINGS_MAX_BINDINGS];
+    int count = input_mappings_get_midi_events(common_state->input_mappings, ev->device_id, ev->data1, ev->data2,
+                                               events, INPUT_MAPPINGS_MAX_BINDINGS);
+
+    for (int i = 0; i < count; i++) {
+        const InputEvent &event = events[i];
+        if (common_state->performance && regroove_performance_is_recording(common_state->performance)) {
+            regroove_performance_record_event(common_state->performance, event.action, event.parameter, event.value);
+        }
 
-                // Right channel (i*2+1): silent at pan=0.0 (left), full at pan=1.0 (right)
-                float right_gain = in_vol * in_pan;
-                int32_t mixed_right = buffer[i * 2 + 1] + (int32_t)(input_temp[i * 2 + 1] * right_gain);
-                if (mixed_right > 32767) mixed_right = 32767;
-                if (mixed_right < -32768) mixed_right = -32768;
-                buffer[i * 2 + 1] = (int16_t)mixed_right;
-            }
+        switch (event.action) {
+            case ACTION_CHANNEL_VOLUME:
+                if (event.parameter >= 0 && event.parameter < MAX_CHANNELS) channels[event.parameter].volume = event.value / 127.0f;
+                break;
+            case ACTION_CHANNEL_PAN:
+                if (event.parameter >= 0 && event.parameter < MAX_CHANNELS) channels[event.parameter].pan = event.value / 127.0f;
+                break;
+            case ACTION_PITCH_SET:
+                pitch_slider = 1.0f - (event.value / 127.0f) * 2.0f;
+                break;
+            default:
+                break;
+        }
+    }
+}
 
-                free(input_temp);
-            }
+// A note pad the audio callback already applied to the engine: show, record and mirror it
+static void sync_applied_midi_pads(const MidiInputEvent *ev) {
+    add_to_midi_monitor(ev->device_id, "Note On", ev->data1, ev->data2, false);
+
+    if (!common_state || !common_state->input_mappings || !common_state->metadata) return;
+    const int *pads;
+    int count = input_mappings_find_note_pads(common_state->input_mappings, ev->device_id, ev->data1, &pads);
+    bool clear_solo = false;
+    for (int i = 0; i < count; i++) {
+        const TriggerPadConfig *pad = note_pad_config(pads[i]);
+        trigger_pad_fade[pads[i]] = 1.0f;
+        if (common_state->performance && regroove_performance_is_recording(common_state->performance)) {
+            regroove_performance_record_event(common_state->performance, pad->action, pad->parameter, ev->data2);
         }
-    } else if (effects && fx_route == FX_ROUTE_INPUT) {
-        // When input is muted/unavailable but effects are routed to input, process effects on silence
-        // to allow delay/reverb tails to decay naturally instead of being cut off
-        int16_t *silent_temp = (int16_t*)calloc(frames * 2, sizeof(int16_t));
-        if (silent_temp) {
-            regroove_effects_process(effects, silent_temp, frames, 48000);
-            // Mix the effect tail with the buffer
-            for (int i = 0; i < frames * 2; i++) {
-                int32_t mixed = buffer[i] + silent_temp[i];
-                if (mixed > 32767) mixed = 32767;
-                if (mixed < -32768) mixed = -32768;
-                buffer[i] = (int16_t)mixed;
-            }
-            free(silent_temp);
+        if (pad->action == ACTION_CHANNEL_MUTE || pad->action == ACTION_MUTE_ALL || pad->action == ACTION_UNMUTE_ALL) {
+            clear_solo = true;
         }
     }
 
-    // Apply effects if routed to master (after mixing)
-    if (effects && fx_route == FX_ROUTE_MASTER) {
-        regroove_effects_process(effects, buffer, frames, 48000);
+    // The mixer follows the engine's mutes
+    if (clear_solo) {
+        for (int i = 0; i < MAX_CHANNELS; i++) channels[i].solo = false;
     }
+    update_channel_mute_states();
+}
 
-    // Apply master volume, pan, and mute
-    if (!master_mute) {
-        float m_vol = master_volume;
-        float m_pan = master_pan;
-        for (int i = 0; i < frames; i++) {
-            // Left channel (i*2): full at pan=0.0 (left), silent at pan=1.0 (right)
-            float left_gain = m_vol * (1.0f - m_pan);
-            buffer[i * 2] = (int16_t)(buffer[i * 2] * left_gain);
-            // Right channel (i*2+1): silent at pan=0.0 (left), full at pan=1.0 (right)
-            float right_gain = m_vol * m_pan;
-            buffer[i * 2 + 1] = (int16_t)(buffer[i * 2 + 1] * right_gain);
-        }
+// Start/Stop the audio callback already applied (MIDI transport or a Play/Stop pad): the
+// rest of ACT_PLAY/ACT_STOP
+static void sync_applied_transport(bool started) {
+    if (!common_state || !common_state->player) return;
+    // The callback only switched audio_playing; the UI's own transport state follows here
+    playing = started;
+    common_state->paused = started ? 0 : 1;
+    if (started) {
+        apply_channel_settings();
+        regroove_common_apply_midi_output_latency(common_state);
+        if (common_state->device_config.midi_clock_send_transport) midi_output_send_start();
     } else {
-        // Master mute - silence everything
-        memset(buffer, 0, len);
+        if (common_state->performance) {
+            regroove_performance_set_playback(common_state->performance, 0);
+            regroove_performance_reset(common_state->performance);
+        }
+        if (common_state->device_config.midi_clock_send_transport) midi_output_send_stop();
     }
-
 }
 
-// Audio input callback - captures audio from input device
-static void audio_input_callback(void *userdata, Uint8 *stream, int len) {
-    (void)userdata;
-
-    int16_t *samples = (int16_t*)stream;
-    int num_samples = len / sizeof(int16_t);  // Total samples (stereo)
+// An event the audio callback already applied: everything but the engine change
+static void sync_applied_midi_event(const MidiInputEvent *ev) {
+    switch (ev->status) {
+        case 0xFA:
+        case 0xFB:
+        case 0xFC:
+            printf("[MIDI Transport] Received %s (0x%02X) on device %d, applied in the audio callback\n",
+                   ev->status == 0xFA ? "Start" : ev->status == 0xFB ? "Continue" : "Stop",
+                   ev->status, ev->device_id);
+            sync_applied_transport(ev->status != 0xFC);
+            return;
+        case 0xF2:
+            printf("[MIDI SPP] Received Song Position: %d MIDI beats\n", ev->data1 | (ev->data2 << 7));
+            show_midi_spp_received();
+            return;
+        default:
+            break;
+    }
 
-    // Write to ring buffer using the audio_input module
-    audio_input_write(samples, num_samples);
+    if ((ev->status & 0xF0) == 0xB0) {
+        sync_applied_midi_controller(ev);
+        return;
+    }
 
-    // Debug: Check if we're getting any signal (first time only)
-    static bool first_signal_check = true;
-    if (first_signal_check) {
-        int max_sample = 0;
-        for (int i = 0; i < num_samples; i++) {
-            int abs_val = abs(samples[i]);
-            if (abs_val > max_sample) max_sample = abs_val;
-        }
-        if (max_sample > 100) {
-            printf("Audio input receiving signal (max amplitude: %d)\n", max_sample);
-            first_signal_check = false;
-        }
+    // Note pads: Play/Stop pads went through the transport path
+    sync_applied_midi_pads(ev);
+    if (!common_state || !common_state->input_mappings || !common_state->metadata) return;
+    const int *pads;
+    int count = input_mappings_find_note_pads(common_state->input_mappings, ev->device_id, ev->data1, &pads);
+    for (int i = 0; i < count; i++) {
+        InputAction action = note_pad_config(pads[i])->action;
+        if (action == ACTION_PLAY || action == ACTION_STOP) sync_applied_transport(action == ACTION_PLAY);
     }
 }
 
-// -----------------------------------------------------------------------------
-// Main UI
-// -----------------------------------------------------------------------------
+// Handle the MIDI input passed on by the audio callback (UI thread, once per frame).
+// Without an audio device, read the device queues here instead.
+static void process_midi_input() {
+    if (!midi_input_enabled) return;
+    update_midi_controller_map();
+
+    if (!audio_device_id) {
+        midi_process_events();
+        return;
+    }
+
+    int tail = SDL_AtomicGet(&midi_ui_tail);
+    while (tail != SDL_AtomicGet(&midi_ui_head)) {
+        MidiUiEvent *e = &midi_ui_queue[tail & (MIDI_INPUT_UI_QUEUE_SIZE - 1)];
+        if (e->applied) {
+            sync_applied_midi_event(&e->event);
+        } else {
+            midi_dispatch_event(&e->event);
+        }
+        SDL_AtomicSet(&midi_ui_tail, ++tail);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Audio Callback
+// -----------------------------------------------------------------------------
+
+// Free slots in the queue to the UI thread (audio thread)
+static int midi_ui_queue_space() {
+    return MIDI_INPUT_UI_QUEUE_SIZE - (SDL_AtomicGet(&midi_ui_head) - SDL_AtomicGet(&midi_ui_tail));
+}
+
+// Hand an event to the UI thread (audio thread). Applied CCs leave the reserved slots
+// to the others; read_midi_input only reads an event when one slot is free
+static void queue_midi_ui_event(const MidiInputEvent *event, bool applied) {
+    int head = SDL_AtomicGet(&midi_ui_head);
+    bool update_only = applied && (event->status & 0xF0) == 0xB0;
+    if (midi_ui_queue_space() <= (update_only ? MIDI_INPUT_UI_RESERVED : 0)) {
+        SDL_AtomicAdd(&midi_ui_dropped, 1);
+        return;
+    }
+    MidiUiEvent *slot = &midi_ui_queue[head & (MIDI_INPUT_UI_QUEUE_SIZE - 1)];
+    slot->event = *event;
+    slot->applied = applied;
+    SDL_AtomicSet(&midi_ui_head, head + 1);
+}
+
+// Frame of the current block an event received at `time` is applied at
+static int midi_event_offset(double time, double block_start, int frames) {
+    int offset = (int)((time - block_start) * common_state->sample_rate);
+    if (offset < 0) offset = 0;
+    if (offset > frames - 1) offset = frames - 1;
+    // Events come in time order; keep offsets monotonic after clamping
+    if (block_controller_count > 0 && offset < block_controllers[block_controller_count - 1].offset) {
+        offset = block_controllers[block_controller_count - 1].offset;
+    }
+    return offset;
+}
+
+// Add the actions of a CC or note mapping to the block (false if the block is full)
+static bool add_midi_block_events(const MidiControllerMapping *m, int offset, int value) {
+    if (m->count == 0 || block_controller_count + m->count > MIDI_INPUT_BLOCK_EVENTS) return false;
+    for (int i = 0; i < m->count; i++) {
+        MidiControllerEvent *c = &block_controllers[block_controller_count++];
+        c->offset = offset;
+        c->action = m->action[i];
+        c->parameter = m->parameter[i];
+        c->value = value;
+        c->spp_position = -1;
+    }
+    return true;
+}
+
+// Read the MIDI input received since the last block. Events are placed at the same
+// distance from this block's start as they arrived after the previous callback, so
+// they are all late by one block but keep their spacing.
+static void read_midi_input(int frames) {
+    block_controller_count = 0;
+    block_controller_next = 0;
+    if (!midi_input_enabled || !common_state || common_state->sample_rate <= 0) return;
+
+    double now = midi_get_time();
+    double block_start = now - (double)frames / common_state->sample_rate;
+    bool map_locked = !learn_mode_active && SDL_AtomicTryLock(&midi_controller_map_lock);
+    bool transport = map_locked && midi_transport_direct;
+
+    // With the UI queue full, the rest waits in the device queues for the next block
+    MidiInputEvent event;
+    while (midi_ui_queue_space() > 0 && midi_read_event(now, &event)) {
+        bool applied = false;
+        int offset = midi_event_offset(event.time, block_start, frames);
+        if (map_locked && (event.status & 0xF0) == 0xB0) {
+            applied = add_midi_block_events(&midi_controller_map[event.device_id][event.data1 & 0x7F],
+                                            offset, event.data2);
+        } else if (map_locked && (event.status & 0xF0) == 0x90 && event.data2 > 0) {
+            applied = add_midi_block_events(&midi_pad_map[event.device_id][event.data1 & 0x7F],
+                                            offset, event.data2);
+        } else if (transport && (event.status == 0xFA || event.status == 0xFB || event.status == 0xFC) &&
+                   midi_is_transport_control_enabled()) {
+            MidiControllerMapping m = {};
+            m.action[0] = (event.status == 0xFC) ? ACTION_STOP : ACTION_PLAY;
+            m.count = 1;
+            applied = add_midi_block_events(&m, offset, 0);
+        } else if (transport && event.status == 0xF2 && common_state->device_config.midi_spp_receive &&
+                   block_controller_count < MIDI_INPUT_BLOCK_EVENTS) {
+            MidiControllerEvent *c = &block_controllers[block_controller_count++];
+            c->offset = offset;
+            c->action = ACTION_NONE;
+            c->parameter = 0;
+            c->value = 0;
+            c->spp_position = event.data1 | (event.data2 << 7);
+            applied = true;
+        }
+        queue_midi_ui_event(&event, applied);
+    }
+
+    if (map_locked) SDL_AtomicUnlock(&midi_controller_map_lock);
+}
+
+// Sync to a Song Position Pointer when more than 2 rows off (as my_midi_spp_callback)
+static void apply_midi_spp(Regroove *player, int position) {
+    int pattern_rows = regroove_get_pattern_num_rows(player, regroove_get_current_pattern(player));
+    int target_row = midi_spp_target_row(position, pattern_rows);
+    int row_diff = target_row - regroove_get_current_row(player);
+    if (row_diff < -2 || row_diff > 2) {
+        regroove_set_position_row(player, target_row);
+    }
+}
+
+// Apply the block's controller events up to (not including) frame `until`
+static void apply_midi_controllers(int until) {
+    Regroove *player = common_state ? common_state->player : NULL;
+    while (block_controller_next < block_controller_count &&
+           block_controllers[block_controller_next].offset < until) {
+        const MidiControllerEvent *c = &block_controllers[block_controller_next++];
+        if (!player) continue;
+        if (c->spp_position >= 0) {
+            apply_midi_spp(player, c->spp_position);
+            continue;
+        }
+        RegrooveApplyAction pad_action;
+        if (engine_pad_action(c->action, &pad_action)) {
+            regroove_apply_action(player, pad_action, c->parameter);
+            continue;
+        }
+        switch (c->action) {
+            case ACTION_CHANNEL_VOLUME:
+                regroove_apply_channel_volume(player, c->parameter, c->value / 127.0);
+                break;
+            case ACTION_CHANNEL_PAN:
+                regroove_apply_channel_panning(player, c->parameter, c->value / 127.0);
+                break;
+            case ACTION_PITCH_SET:
+                // Same mapping as ACTION_PITCH_SET on the UI thread (MIDI 127 = fast)
+                regroove_apply_pitch(player, MapPitchFader(1.0f - (c->value / 127.0f) * 2.0f));
+                break;
+            case ACTION_PLAY:
+                // The rest of ACT_PLAY follows on the UI thread (sync_applied_transport)
+                SDL_AtomicSet(&audio_playing, 1);
+                break;
+            case ACTION_STOP:
+                SDL_AtomicSet(&audio_playing, 0);
+                // Drop notes already sent ahead for rows that will not play now
+                if (midi_output_enabled) {
+                    midi_output_cancel_notes(REGROOVE_ALL_CHANNELS, (double)c->offset / common_state->sample_rate);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Block has a MIDI Start/Continue (or Play pad) for the audio callback to apply
+static bool block_has_start() {
+    for (int i = block_controller_next; i < block_controller_count; i++) {
+        if (block_controllers[i].action == ACTION_PLAY) return true;
+    }
+    return false;
+}
+
+// Render playback, split at the controller events so each applies at its frame.
+// Segments before a Start or after a Stop stay silent.
+static void render_playback(Regroove *player, int16_t *buffer, int frames) {
+    int done = 0;
+    render_segment_start = 0.0;
+    while (block_controller_next < block_controller_count) {
+        int offset = block_controllers[block_controller_next].offset;
+        if (offset - done >= MIDI_INPUT_MIN_SEGMENT && frames - offset >= MIDI_INPUT_MIN_SEGMENT) {
+            if (SDL_AtomicGet(&audio_playing)) regroove_render_audio(player, buffer + done * 2, offset - done);
+            done = offset;
+            render_segment_start = (double)done / common_state->sample_rate;
+        }
+        apply_midi_controllers(offset + 1);
+    }
+    if (SDL_AtomicGet(&audio_playing)) regroove_render_audio(player, buffer + done * 2, frames - done);
+    render_segment_start = 0.0;
+}
+
+// Nudge playback so the row grid converges onto the external MIDI Clock beats.
+// Tempo sync (main loop) matches the tempo; this closes the remaining phase error,
+// so pattern boundaries, and the queued jumps and loops that fire on them, land on
+// the master's beats. Called before rendering each block.
+static void update_beat_phase_alignment(int frames) {
+    Regroove *player = common_state->player;
+    double nudge = 1.0;
+
+    if (common_state->device_config.midi_clock_phase_align && midi_is_clock_sync_enabled()) {
+        double external = midi_get_clock_beats();
+        double tempo = midi_get_clock_tempo();
+        if (external >= 0.0 && tempo > 0.0) {
+            // The block about to be rendered is heard roughly one block from now
+            external += (double)frames / common_state->sample_rate * tempo / 60.0;
+            double error = external - regroove_get_beat_position(player);
+            error -= floor(error + 0.5);  // Nearest beat: -0.5 .. 0.5
+            beat_phase_error = (float)error;
+
+            double correction = error * BEAT_PHASE_GAIN;
+            if (correction > BEAT_PHASE_MAX_NUDGE) correction = BEAT_PHASE_MAX_NUDGE;
+            if (correction < -BEAT_PHASE_MAX_NUDGE) correction = -BEAT_PHASE_MAX_NUDGE;
+            nudge = 1.0 + correction;
+        }
+    }
+    regroove_set_tempo_nudge(player, nudge);
+}
+
+static void audio_callback(void *userdata, Uint8 *stream, int len) {
+    int16_t *buffer = (int16_t *)stream;
+    int frames = len / (2 * sizeof(int16_t));
+
+    // Clear buffer first
+    memset(buffer, 0, len);
+
+    // Notes triggered while rendering go out when this block is heard
+    if (midi_output_enabled && common_state) {
+        midi_output_begin_block(frames, common_state->sample_rate);
+        if (common_state->player) {
+            // Tick length for note lengths in ticks/rows (effective BPM, see the clock below)
+            double bpm = regroove_get_current_bpm(common_state->player) / regroove_get_pitch(common_state->player) *
+                         regroove_get_tempo_nudge(common_state->player);
+            midi_output_set_tick_time(bpm > 0.0 ? 2.5 / bpm : 0.0, regroove_get_current_speed(common_state->player));
+        }
+    }
+
+    // MIDI input received since the last block (controllers are applied below)
+    read_midi_input(frames);
+
+    // Latency calibration owns the output while it runs (test signal out, raw input in)
+    if (regroove_latency_get_state(latency_cal) == REGROOVE_LATENCY_RUNNING) {
+        int16_t *cal_input = regroove_fx_graph_get_bus_buffer(fx_graph, REGROOVE_FX_BUS_INPUT);
+        int cal_frames = regroove_fx_graph_get_max_frames(fx_graph);
+        if (!cal_input || cal_frames <= 0) cal_frames = frames;
+        for (int offset = 0; offset < frames; offset += cal_frames) {
+            int chunk = frames - offset;
+            if (chunk > cal_frames) chunk = cal_frames;
+            // The ring's actual fill is what it delays this chunk's input by
+            int ring_frames = audio_input_available() / 2;
+            int has_input = cal_input && audio_input_device_id && audio_input_read_adaptive(cal_input, chunk);
+            regroove_latency_process(latency_cal, buffer + offset * 2, has_input ? cal_input : NULL,
+                                     ring_frames, chunk);
+        }
+        apply_midi_controllers(frames);
+        return;
+    }
+
+    // Render playback audio (if playing or starting in this block, player exists, and not muted)
+    if ((SDL_AtomicGet(&audio_playing) || block_has_start()) && common_state && common_state->player && !playback_mute) {
+        update_beat_phase_alignment(frames);
+        render_playback(common_state->player, buffer, frames);
+        regroove_recorder_push(recorder, REGROOVE_RECORDER_PLAYBACK, buffer, frames);
+
+        // Send MIDI Clock pulses if master mode is enabled
+        if (midi_output_is_clock_master()) {
+            double bpm = regroove_get_current_bpm(common_state->player);
+            double pitch = regroove_get_pitch(common_state->player);
+            // Note: pitch affects sample rate (samplerate * pitch_factor in regroove_engine.c)
+            // Lower pitch = libopenmpt renders at lower samplerate = faster playback = higher effective BPM
+            // Higher pitch = libopenmpt renders at higher samplerate = slower playback = lower effective BPM
+            // So we DIVIDE by pitch, not multiply (the phase nudge speeds up above 1.0)
+            double effective_bpm = bpm / pitch * regroove_get_tempo_nudge(common_state->player);
+
+            // Queue a pulse per tick the engine crossed in this block, timed by frame
+            // (sent by the MIDI output scheduler when the block is heard)
+            midi_output_send_clock_pulses(frames, common_state->sample_rate, effective_bpm,
+                                          regroove_get_beat_position(common_state->player));
+
+            // Note: SPP position is updated by row/order callbacks based on configured interval
+            // The clock thread sends SPP when position changes
+        }
+
+        // Tempo-synced effects follow the effective BPM (see pitch note above)
+        regroove_fx_graph_set_tempo(fx_graph, regroove_get_current_bpm(common_state->player) /
+                                              regroove_get_pitch(common_state->player));
+        regroove_fx_graph_set_sidechain_key(fx_graph, regroove_get_sidechain_level(common_state->player));
+
+        // Apply effect chains routed to playback
+        regroove_fx_graph_process_bus(fx_graph, REGROOVE_FX_BUS_PLAYBACK, buffer, frames);
+    } else {
+        // When not playing but effects are routed to playback, process effects on silence
+        // to allow delay/reverb tails to decay naturally instead of being cut off
+        // (returns immediately once the chains have gone to sleep)
+        apply_midi_controllers(frames);
+        regroove_recorder_push(recorder, REGROOVE_RECORDER_PLAYBACK, NULL, frames);
+        regroove_fx_graph_set_sidechain_key(fx_graph, 0.0f);
+        regroove_fx_graph_process_bus(fx_graph, REGROOVE_FX_BUS_PLAYBACK, buffer, frames);
+    }
+
+    // Mix in audio input when not muted and device is active.
+    // Uses the graph's preallocated input bus (processed in bus-sized chunks).
+    int16_t *input_bus = regroove_fx_graph_get_bus_buffer(fx_graph, REGROOVE_FX_BUS_INPUT);
+    int bus_frames = regroove_fx_graph_get_max_frames(fx_graph);
+    bool input_live = !input_mute && input_volume > 0.0f && audio_input_device_id;
+
+    // Mixer strips follow the MIX panel (gain changes are ramped over the block).
+    // When input is muted/unavailable, chains on the input bus still run on silence
+    // so delay/reverb tails decay naturally; the tails go through the input strip at
+    // full volume, centred, i.e. at the pan law's centre gain.
+    regroove_mixer_set_pan_law(mixer, common_state ? (RegrooveMixerPanLaw)common_state->device_config.mixer_pan_law
+                                                   : REGROOVE_MIXER_PAN_LINEAR);
+    regroove_mixer_set_volume(mixer, REGROOVE_MIXER_PLAYBACK, playback_volume);
+    regroove_mixer_set_pan(mixer, REGROOVE_MIXER_PLAYBACK, playback_pan);
+    regroove_mixer_set_volume(mixer, REGROOVE_MIXER_INPUT, input_live ? input_volume : 1.0f);
+    regroove_mixer_set_pan(mixer, REGROOVE_MIXER_INPUT, input_live ? input_pan : 0.5f);
+    regroove_mixer_set_volume(mixer, REGROOVE_MIXER_MASTER, master_volume);
+    regroove_mixer_set_pan(mixer, REGROOVE_MIXER_MASTER, master_pan);
+    regroove_mixer_set_mute(mixer, REGROOVE_MIXER_MASTER, master_mute);
+
+    // Without master chains the master strip is folded into the mixing pass
+    int master_fx = regroove_fx_graph_bus_has_chains(fx_graph, REGROOVE_FX_BUS_MASTER);
+
+    if (input_bus && bus_frames > 0 &&
+        (input_live || !regroove_fx_graph_bus_is_sleeping(fx_graph, REGROOVE_FX_BUS_INPUT))) {
+        for (int offset = 0; offset < frames; offset += bus_frames) {
+            int chunk = frames - offset;
+            if (chunk > bus_frames) chunk = bus_frames;
+            int needed_samples = chunk * 2;  // stereo
+
+            if (input_live) {
+                // Read from ring buffer, resampled to follow the input device's clock
+                // (silence while the ring fills up to its target latency)
+                audio_input_read_adaptive(input_bus, chunk);
+            } else {
+                // Muted: still consume the ring (see below), then feed the chains silence
+                if (audio_input_device_id) audio_input_read_adaptive(input_bus, chunk);
+                memset(input_bus, 0, needed_samples * sizeof(int16_t));
+            }
+            regroove_recorder_push(recorder, REGROOVE_RECORDER_INPUT, input_bus, chunk);
+
+            // Apply effect chains routed to input
+            regroove_fx_graph_process_bus(fx_graph, REGROOVE_FX_BUS_INPUT, input_bus, chunk);
+
+            // Playback and input gain/pan and sum in one pass
+            regroove_mixer_process(mixer, buffer + offset * 2, input_bus, chunk, !master_fx);
+        }
+    } else {
+        // Keep consuming the input ring while the device is open but muted. Otherwise it
+        // fills up and overruns, and on unmute the drift controller starts from a full
+        // ring, winds up at its ratio limit and plays the stale audio
+        if (input_bus && bus_frames > 0 && audio_input_device_id) {
+            for (int offset = 0; offset < frames; offset += bus_frames) {
+                int chunk = frames - offset;
+                if (chunk > bus_frames) chunk = bus_frames;
+                audio_input_read_adaptive(input_bus, chunk);
+            }
+        }
+        regroove_recorder_push(recorder, REGROOVE_RECORDER_INPUT, NULL, frames);
+        regroove_mixer_process(mixer, buffer, NULL, frames, !master_fx);
+    }
+
+    if (master_fx) {
+        // Apply effect chains routed to master (after mixing), then master volume/pan/mute
+        regroove_fx_graph_process_bus(fx_graph, REGROOVE_FX_BUS_MASTER, buffer, frames);
+        regroove_mixer_apply_master(mixer, buffer, frames);
+    }
+
+    // Disk recorder: copies into its ring only, the writer thread does the disk I/O
+    regroove_recorder_push(recorder, REGROOVE_RECORDER_MASTER, buffer, frames);
+
+    // Cue bus: publish the player position and hand over the master mix (never blocks)
+    if (cue_device_id) {
+        Regroove *player = common_state ? common_state->player : NULL;
+        if (player) {
+            regroove_cue_follow(cue_bus, SDL_AtomicGet(&audio_playing) != 0, regroove_get_current_order(player),
+                                regroove_get_current_row(player), regroove_get_pitch(player));
+        } else {
+            regroove_cue_follow(cue_bus, 0, 0, 0, 1.0);
+        }
+        regroove_cue_push_master(cue_bus, buffer, frames);
+    }
+}
+
+// Cue device callback - renders the cue bus on its own device
+static void cue_audio_callback(void *userdata, Uint8 *stream, int len) {
+    (void)userdata;
+    regroove_cue_process(cue_bus, (int16_t *)stream, len / (2 * sizeof(int16_t)));
+}
+
+// Audio input callback - captures audio from input device
+static void audio_input_callback(void *userdata, Uint8 *stream, int len) {
+    (void)userdata;
+
+    int16_t *samples = (int16_t*)stream;
+    int num_samples = len / sizeof(int16_t);  // Total samples (stereo)
+
+    // Write to ring buffer using the audio_input module
+    audio_input_write(samples, num_samples);
+
+    // Debug: Check if we're getting any signal (first time only)
+    static bool first_signal_check = true;
+    if (first_signal_check) {
+        int max_sample = 0;
+        for (int i = 0; i < num_samples; i++) {
+            int abs_val = abs(samples[i]);
+            if (abs_val > max_sample) max_sample = abs_val;
+        }
+        if (max_sample > 100) {
+            printf("Audio input receiving signal (max amplitude: %d)\n", max_sample);
+            first_signal_check = false;
+        }
+    }
+}
+
+// Open an audio input device at the current output sample rate (input is mixed sample-for-sample)
+static SDL_AudioDeviceID open_audio_input_device(const char *name) {
+    SDL_AudioSpec input_spec, obtained_spec;
+    SDL_zero(input_spec);
+    input_spec.freq = common_state ? common_state->sample_rate : COMMON_DEFAULT_SAMPLE_RATE;
+    input_spec.format = AUDIO_S16SYS;
+    input_spec.channels = 2;
+    input_spec.samples = 256;
+    input_spec.callback = audio_input_callback;
+    input_spec.userdata = NULL;
+
+    // Drop anything left from a previous input device
+    audio_input_reset();
+
+    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(name, 1, &input_spec, &obtained_spec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (dev > 0) {
+        printf("Audio input opened: %s (%d Hz, requested: %d samples, obtained: %d samples)\n",
+               name ? name : "Default", obtained_spec.freq, input_spec.samples, obtained_spec.samples);
+    }
+    return dev;
+}
+
+// Open the cue output device at the main output's sample rate (SDL converts if needed).
+// The device is returned paused; the caller starts it.
+static SDL_AudioDeviceID open_cue_device(const char *name) {
+    SDL_AudioSpec cue_spec, obtained_spec;
+    SDL_zero(cue_spec);
+    cue_spec.freq = common_state ? common_state->sample_rate : COMMON_DEFAULT_SAMPLE_RATE;
+    cue_spec.format = AUDIO_S16SYS;
+    cue_spec.channels = 2;
+    cue_spec.samples = 256;
+    cue_spec.callback = cue_audio_callback;
+    cue_spec.userdata = NULL;
+
+    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(name, 0, &cue_spec, &obtained_spec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (dev == 0) return 0;
+
+    // The main callback writes into the hand-off ring: keep it out while it is reallocated
+    if (audio_device_id) SDL_LockAudioDevice(audio_device_id);
+    int prepared = regroove_cue_prepare(cue_bus, obtained_spec.freq, obtained_spec.samples);
+    if (audio_device_id) SDL_UnlockAudioDevice(audio_device_id);
+    if (prepared != 0) {
+        SDL_CloseAudioDevice(dev);
+        return 0;
+    }
+
+    printf("Cue output opened: %s (%d Hz, %d samples)\n", name ? name : "Default", obtained_spec.freq, obtained_spec.samples);
+    return dev;
+}
+
+static void close_cue_device() {
+    if (!cue_device_id) return;
+    SDL_CloseAudioDevice(cue_device_id);
+    cue_device_id = 0;
+}
+
+// Open an audio output device (NULL = default) and let it choose its native sample rate.
+// The obtained rate is propagated to the engine, effects and input ring. The device
+// is returned paused; the caller starts it.
+static SDL_AudioDeviceID open_audio_output_device(const char *name) {
+    SDL_AudioSpec spec, obtained;
+    SDL_zero(spec);
+    spec.freq = common_state ? common_state->sample_rate : COMMON_DEFAULT_SAMPLE_RATE;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = 2;
+    spec.samples = 256;
+    spec.callback = audio_callback;
+    spec.userdata = NULL;
+
+    SDL_AudioDeviceID dev = SDL_OpenAudioDevice(name, 0, &spec, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (dev == 0) return 0;
+
+    int rate = obtained.freq;
+    int rate_changed = common_state && common_state->sample_rate != rate;
+    if (common_state) {
+        common_state->audio_device_id = dev;
+        regroove_common_set_sample_rate(common_state, rate);
+    }
+    // Device is still paused, so the callback cannot observe the reallocation
+    if (fx_graph && regroove_fx_graph_prepare(fx_graph, rate, obtained.samples) != 0) {
+        fprintf(stderr, "Failed to prepare effects buses for %d Hz / %d frames\n", rate, obtained.samples);
+    }
+    int block_changed = obtained.samples != audio_block_frames;
+    audio_block_frames = obtained.samples;
+    if (rate_changed || block_changed) {
+        // The input callback may still be running at the old rate: keep it out of the ring
+        if (audio_input_device_id) SDL_LockAudioDevice(audio_input_device_id);
+        audio_input_init(common_state->device_config.audio_input_buffer_ms, rate, audio_block_frames);
+        if (audio_input_device_id) SDL_UnlockAudioDevice(audio_input_device_id);
+    }
+    if (rate_changed) {
+        // Input must run at the output rate: reopen it if it is active
+        if (audio_input_device_id && selected_audio_input_device >= 0 &&
+            selected_audio_input_device < (int)audio_input_device_names.size()) {
+            SDL_CloseAudioDevice(audio_input_device_id);
+            audio_input_device_id = open_audio_input_device(audio_input_device_names[selected_audio_input_device].c_str());
+            if (audio_input_device_id > 0) {
+                SDL_PauseAudioDevice(audio_input_device_id, 0);
+            } else {
+                selected_audio_input_device = -1;
+            }
+        }
+
+        // The cue bus follows the output rate as well
+        if (cue_device_id && selected_cue_device >= 0 && selected_cue_device < (int)audio_device_names.size()) {
+            close_cue_device();
+            cue_device_id = open_cue_device(audio_device_names[selected_cue_device].c_str());
+            if (cue_device_id > 0) {
+                SDL_PauseAudioDevice(cue_device_id, 0);
+            } else {
+                selected_cue_device = -1;
+            }
+        }
+    }
+    printf("Audio output opened: %s (%d Hz, %d samples)\n", name ? name : "Default", rate, obtained.samples);
+    return dev;
+}
+
+// Start a round-trip latency measurement (output must be looped back to the input)
+static void start_latency_calibration() {
+    if (!latency_cal || !common_state || !audio_input_device_id) return;
+    // Flush the input ring first: the sequence starts once it has refilled to its target
+    // and the drift compensation is primed, and the ring's fill is subtracted per block
+    audio_input_reset();
+    if (regroove_latency_start(latency_cal, common_state->sample_rate) == 0) {
+        latency_result_stored = false;
+        printf("Latency calibration started\n");
+    }
+}
+
+// Called once per UI frame: runs the analysis and stores a successful result in the config
+static void update_latency_calibration() {
+    regroove_latency_poll(latency_cal);
+    RegrooveLatencyState state = regroove_latency_get_state(latency_cal);
+    if (latency_result_stored || (state != REGROOVE_LATENCY_DONE && state != REGROOVE_LATENCY_FAILED)) return;
+
+    latency_result_stored = true;
+    if (state == REGROOVE_LATENCY_DONE) {
+        common_state->device_config.audio_roundtrip_latency_ms = regroove_latency_get_ms(latency_cal);
+        regroove_common_save_device_config(common_state, current_config_file);
+        printf("Round-trip latency: %.2f ms (confidence %.1f)\n",
+               regroove_latency_get_ms(latency_cal), regroove_latency_get_confidence(latency_cal));
+    } else {
+        printf("Latency calibration failed (confidence %.1f) - is the output looped back to the input?\n",
+               regroove_latency_get_confidence(latency_cal));
+    }
+}
+
+// Start/stop recording the master (and with stems, pre-FX playback and input) to
+// timestamped WAV files in the working directory
+static void toggle_audio_recording() {
+    if (!recorder || !common_state) return;
+
+    if (regroove_recorder_is_recording(recorder)) {
+        regroove_recorder_stop(recorder);
+        return;
+    }
+
+    char base_path[64];
+    time_t now = time(NULL);
+    strftime(base_path, sizeof(base_path), "regroove-%Y%m%d-%H%M%S", localtime(&now));
+
+    // Line the input up with what was heard when it was played: the measured device
+    // round trip plus the input ring's delay, which the stored value leaves out
+    int input_offset = (int)(common_state->device_config.audio_roundtrip_latency_ms *
+                             common_state->sample_rate / 1000.0f);
+    if (audio_input_device_id) input_offset += audio_input_get_target_frames();
+    if (regroove_recorder_start(recorder, base_path, common_state->sample_rate,
+                                common_state->device_config.record_stems, input_offset) != 0) {
+        printf("Failed to start audio recording\n");
+    }
+}
+
+// Mixer FX buttons: toggle the edited chain between a bus and unassigned
+static void toggle_fx_bus(RegrooveFxBus bus) {
+    RegrooveFxBus current = regroove_fx_graph_get_chain_bus(fx_graph, fx_edit_chain);
+    regroove_fx_graph_set_chain_bus(fx_graph, fx_edit_chain, current == bus ? REGROOVE_FX_BUS_NONE : bus);
+}
+
+// Lit when the edited chain is on the bus, dimmed when only another chain is
+static ImVec4 fx_bus_button_color(RegrooveFxBus bus) {
+    if (regroove_fx_graph_get_chain_bus(fx_graph, fx_edit_chain) == bus) return ImVec4(0.70f, 0.60f, 0.20f, 1.0f);
+    if (regroove_fx_graph_bus_has_chains(fx_graph, bus)) return ImVec4(0.45f, 0.40f, 0.18f, 1.0f);
+    return ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
+}
+
+// -----------------------------------------------------------------------------
+// Main UI
+// -----------------------------------------------------------------------------
 
 static void ApplyFlatBlackRedSkin()
 {
@@ -3561,8 +4427,16 @@ static void ShowMainUI() {
                         is_effect_enabled = regroove_effects_get_eq_enabled(effects);
                     } else if (pad->action == ACTION_FX_COMPRESSOR_TOGGLE) {
                         is_effect_enabled = regroove_effects_get_compressor_enabled(effects);
+                    } else if (pad->action == ACTION_FX_MULTIBAND_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_multiband_enabled(effects);
                     } else if (pad->action == ACTION_FX_DELAY_TOGGLE) {
                         is_effect_enabled = regroove_effects_get_delay_enabled(effects);
+                    } else if (pad->action == ACTION_FX_DELAY_SYNC_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_delay_sync(effects);
+                    } else if (pad->action == ACTION_FX_DUCKER_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_ducker_enabled(effects);
+                    } else if (pad->action == ACTION_FX_CONVOLUTION_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_convolution_enabled(effects);
                     }
                 }
 
@@ -3986,8 +4860,16 @@ static void ShowMainUI() {
                         is_effect_enabled = regroove_effects_get_eq_enabled(effects);
                     } else if (pad->action == ACTION_FX_COMPRESSOR_TOGGLE) {
                         is_effect_enabled = regroove_effects_get_compressor_enabled(effects);
+                    } else if (pad->action == ACTION_FX_MULTIBAND_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_multiband_enabled(effects);
                     } else if (pad->action == ACTION_FX_DELAY_TOGGLE) {
                         is_effect_enabled = regroove_effects_get_delay_enabled(effects);
+                    } else if (pad->action == ACTION_FX_DELAY_SYNC_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_delay_sync(effects);
+                    } else if (pad->action == ACTION_FX_DUCKER_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_ducker_enabled(effects);
+                    } else if (pad->action == ACTION_FX_CONVOLUTION_TOGGLE) {
+                        is_effect_enabled = regroove_effects_get_convolution_enabled(effects);
                     }
                 }
 
@@ -5336,68 +6218,97 @@ static void ShowMainUI() {
         ImGui::TextWrapped("Send MIDI notes to external synths based on tracker playback. Effect commands 0FFF and EC0 trigger note-off.");
         ImGui::Dummy(ImVec2(0, 8.0f));
 
-        ImGui::Text("MIDI Output:");
-        ImGui::SameLine(150.0f);
-
-        const char* midi_out_label = (midi_output_device == -1) ? "Disabled" : "Port";
-        if (midi_output_device >= 0) {
-            char port_name[128];
-            if (midi_output_get_port_name(midi_output_device, port_name, sizeof(port_name)) == 0) {
-                midi_out_label = port_name;
-            }
-        }
-
+        // One row per output port: device, and whether it carries clock/transport and SPP.
+        // Instruments are routed to ports in the MIDI output mapping (.rgx).
         // Get MIDI output port count (separate from input ports)
         int num_midi_output_ports = midi_output_list_ports();
 
-        if (ImGui::BeginCombo("##midi_output", midi_out_label)) {
-            // Disabled option
-            if (ImGui::Selectable("Disabled", midi_output_device == -1)) {
-                if (midi_output_enabled) {
-                    midi_output_deinit();
-                    midi_output_enabled = false;
-                }
-                midi_output_device = -1;
-                if (common_state) {
-                    common_state->device_config.midi_output_device = -1;
-                    regroove_common_save_device_config(common_state, current_config_file);
-                }
-                printf("MIDI output disabled\n");
+        for (int port = 0; port < MIDI_OUT_MAX_DEVICES && common_state; port++) {
+            // Additional outputs are shown once the previous one is configured
+            int device = regroove_common_get_midi_output_device(common_state, port);
+            if (port > 0 && device < 0 && regroove_common_get_midi_output_device(common_state, port - 1) < 0) break;
+
+            ImGui::PushID(port);
+            ImGui::Text("MIDI Output %d:", port + 1);
+            ImGui::SameLine(150.0f);
+
+            const char* midi_out_label = (device == -1) ? "Disabled" : "Port";
+            char current_name[128];
+            if (device >= 0 && midi_output_get_port_name(device, current_name, sizeof(current_name)) == 0) {
+                midi_out_label = current_name;
             }
 
-            // List MIDI output ports
-            for (int i = 0; i < num_midi_output_ports; i++) {
-                char label[128];
-                char port_name[128];
-                if (midi_output_get_port_name(i, port_name, sizeof(port_name)) == 0) {
-                    snprintf(label, sizeof(label), "%s", port_name);
-                } else {
-                    snprintf(label, sizeof(label), "Port %d", i);
+            ImGui::SetNextItemWidth(220.0f);
+            if (ImGui::BeginCombo("##midi_output", midi_out_label)) {
+                // Disabled option
+                if (ImGui::Selectable("Disabled", device == -1)) {
+                    midi_output_close(port);
+                    regroove_common_set_midi_output_device(common_state, port, -1);
+                    regroove_common_save_device_config(common_state, current_config_file);
+                    printf("MIDI output %d disabled\n", port + 1);
                 }
 
-                if (ImGui::Selectable(label, midi_output_device == i)) {
-                    // Reinitialize MIDI output with new device
-                    if (midi_output_enabled) {
-                        midi_output_deinit();
+                // List MIDI output ports
+                for (int i = 0; i < num_midi_output_ports; i++) {
+                    char label[128];
+                    char port_name[128];
+                    if (midi_output_get_port_name(i, port_name, sizeof(port_name)) == 0) {
+                        snprintf(label, sizeof(label), "%s", port_name);
+                    } else {
+                        snprintf(label, sizeof(label), "Port %d", i);
                     }
 
-                    if (midi_output_init(i) == 0) {
-                        midi_output_device = i;
-                        midi_output_enabled = true;
-                        if (common_state) {
-                            common_state->device_config.midi_output_device = i;
-                            regroove_common_save_device_config(common_state, current_config_file);
+                    if (ImGui::Selectable(label, device == i)) {
+                        // Reopen this output on the new device
+                        if (midi_output_open(port, i) == 0) {
+                            regroove_common_set_midi_output_device(common_state, port, i);
+                            regroove_common_apply_midi_output_sync(common_state);
+                            printf("MIDI output %d enabled on port %d\n", port + 1, i);
+                        } else {
+                            regroove_common_set_midi_output_device(common_state, port, -1);
+                            fprintf(stderr, "Failed to initialize MIDI output %d on port %d\n", port + 1, i);
                         }
-                        printf("MIDI output enabled on port %d\n", i);
-                    } else {
-                        midi_output_device = -1;
-                        midi_output_enabled = false;
-                        fprintf(stderr, "Failed to initialize MIDI output on port %d\n", i);
+                        regroove_common_save_device_config(common_state, current_config_file);
                     }
                 }
+                ImGui::EndCombo();
             }
-            ImGui::EndCombo();
+
+            // Per-port sync selection
+            if (device >= 0) {
+                bool port_clock = (common_state->device_config.midi_output_clock_ports >> port) & 1;
+                bool port_spp = (common_state->device_config.midi_output_spp_ports >> port) & 1;
+                ImGui::SameLine();
+                if (ImGui::Checkbox("Clock", &port_clock)) {
+                    common_state->device_config.midi_output_clock_ports ^= (1 << port);
+                    regroove_common_apply_midi_output_sync(common_state);
+                    regroove_common_save_device_config(common_state, current_config_file);
+                }
+                ImGui::SameLine();
+                if (ImGui::Checkbox("SPP", &port_spp)) {
+                    common_state->device_config.midi_output_spp_ports ^= (1 << port);
+                    regroove_common_apply_midi_output_sync(common_state);
+                    regroove_common_save_device_config(common_state, current_config_file);
+                }
+
+                // Synth latency: notes are sent this much ahead of the audio
+                int latency_ms = regroove_common_get_midi_output_latency(common_state, port);
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(90.0f);
+                if (ImGui::InputInt("ms##latency", &latency_ms, 1, 10)) {
+                    if (latency_ms < -500) latency_ms = -500;
+                    if (latency_ms > 1000) latency_ms = 1000;
+                    regroove_common_set_midi_output_latency(common_state, port, latency_ms);
+                    regroove_common_apply_midi_output_latency(common_state);
+                    regroove_common_save_device_config(common_state, current_config_file);
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Latency of this output: its notes are sent this much ahead of the audio");
+                }
+            }
+            ImGui::PopID();
         }
+        midi_output_enabled = midi_output_is_open(-1);
 
         ImGui::Dummy(ImVec2(0, 8.0f));
 
@@ -5407,12 +6318,13 @@ static void ShowMainUI() {
             bool hold_notes = (common_state->device_config.midi_output_note_duration == 1);
             if (ImGui::Checkbox("Hold notes until next note/off", &hold_notes)) {
                 common_state->device_config.midi_output_note_duration = hold_notes ? 1 : 0;
+                regroove_common_apply_midi_output_note_duration(common_state);
                 save_mappings_to_config();
             }
             ImGui::SameLine();
             ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(?)");
             if (ImGui::IsItemHovered()) {
-                ImGui::SetTooltip("When enabled, MIDI notes are held until the next note or note-off command.\nWhen disabled, notes are immediately released after being triggered.");
+                ImGui::SetTooltip("When enabled, MIDI notes are held until the next note or note-off command.\nWhen disabled, notes are released one tick after being triggered.\nInstruments with a note length (MIDI mapping) always use their own.");
             }
 
             // ===== MIDI MASTER SECTION =====
@@ -5574,24 +6486,34 @@ static void ShowMainUI() {
                 ImGui::SetTooltip("When ENABLED: Playback tempo adjusts to match incoming MIDI Clock.\nWhen DISABLED: Incoming tempo is shown in LCD [>120] but doesn't affect playback (visual only).");
             }
 
-            // MIDI Clock sync threshold (only shown when sync is enabled)
+            // Locked clock status (only shown when sync is enabled)
             if (clock_sync) {
                 ImGui::Indent(20.0f);
-                ImGui::Text("Sync threshold (%%):");
-                ImGui::SameLine();
-                float threshold = common_state->device_config.midi_clock_sync_threshold;
-                ImGui::SetNextItemWidth(100.0f);
-                if (ImGui::SliderFloat("##clock_threshold", &threshold, 0.1f, 5.0f, "%.1f%%")) {
-                    common_state->device_config.midi_clock_sync_threshold = threshold;
+                double clock_tempo = midi_get_clock_tempo();
+                double clock_phase = midi_get_clock_beat_phase();
+                if (clock_tempo <= 0.0) {
+                    ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "No clock received");
+                } else if (clock_phase < 0.0) {
+                    ImGui::Text("Locked: %.2f BPM", clock_tempo);
+                } else {
+                    ImGui::Text("Locked: %.2f BPM, beat %.0f + %.2f", clock_tempo,
+                                floor(midi_get_clock_beats()), clock_phase);
+                }
+
+                bool phase_align = (common_state->device_config.midi_clock_phase_align == 1);
+                if (ImGui::Checkbox("Align rows to the external beat", &phase_align)) {
+                    common_state->device_config.midi_clock_phase_align = phase_align ? 1 : 0;
                     save_mappings_to_config();
                 }
                 ImGui::SameLine();
                 ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(?)");
                 if (ImGui::IsItemHovered()) {
-                    ImGui::SetTooltip("Minimum tempo change %% to apply pitch adjustment.\n"
-                                      "Lower = more responsive but may cause pitch wobble\n"
-                                      "Higher = more stable but less precise sync\n"
-                                      "Default: 0.5%% (recommended for most cases)");
+                    ImGui::SetTooltip("Follows the beat position counted from MIDI Start/SPP and nudges the tempo\n"
+                                      "slightly (max 2%%) until our rows sit on the master's beats, so queued\n"
+                                      "jumps and loops land on the master's bars.");
+                }
+                if (phase_align && playing && clock_phase >= 0.0) {
+                    ImGui::Text("Phase offset: %+.3f beats", beat_phase_error);
                 }
                 ImGui::Unindent(20.0f);
             }
@@ -5666,17 +6588,19 @@ static void ShowMainUI() {
 
                 ImGui::BeginChild("##midi_mapping", ImVec2(child_width, 250.0f), true);
 
-                ImGui::Columns(5, "midi_mapping_columns");
+                ImGui::Columns(6, "midi_mapping_columns");
                 ImGui::SetColumnWidth(0, 60.0f);   // Index
                 ImGui::SetColumnWidth(1, 80.0f);   // Type
                 ImGui::SetColumnWidth(2, 100.0f);  // MIDI Channel
                 ImGui::SetColumnWidth(3, 90.0f);   // Program
-                // Column 4 auto-sized (remaining width) - Name
+                ImGui::SetColumnWidth(4, 90.0f);   // Note length
+                // Column 5 auto-sized (remaining width) - Name
 
                 ImGui::Text("Index"); ImGui::NextColumn();
                 ImGui::Text("Type"); ImGui::NextColumn();
                 ImGui::Text("MIDI Ch"); ImGui::NextColumn();
                 ImGui::Text("Program"); ImGui::NextColumn();
+                ImGui::Text("Length"); ImGui::NextColumn();
                 ImGui::Text("Name"); ImGui::NextColumn();
                 ImGui::Separator();
 
@@ -5708,7 +6632,12 @@ static void ShowMainUI() {
                     if (common_state->metadata->instrument_midi_channels[i] == -2) {
                         snprintf(channel_label, sizeof(channel_label), "None");
                     } else if (midi_channel >= 0 && midi_channel < 16) {
-                        snprintf(channel_label, sizeof(channel_label), "Ch %d", midi_channel + 1);
+                        int midi_port = regroove_metadata_get_midi_port(common_state->metadata, i);
+                        if (midi_port > 0) {
+                            snprintf(channel_label, sizeof(channel_label), "O%d:Ch %d", midi_port + 1, midi_channel + 1);
+                        } else {
+                            snprintf(channel_label, sizeof(channel_label), "Ch %d", midi_channel + 1);
+                        }
                     } else {
                         // Default to Ch 1 if no valid channel set
                         snprintf(channel_label, sizeof(channel_label), "Ch 1");
@@ -5730,6 +6659,19 @@ static void ShowMainUI() {
                                 save_rgx_metadata();
                             }
                         }
+
+                        // Output port (MIDI Output 1-4 in settings)
+                        ImGui::Separator();
+                        int midi_port = regroove_metadata_get_midi_port(common_state->metadata, i);
+                        for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+                            char port_label[24];
+                            snprintf(port_label, sizeof(port_label), "Output %d%s", port + 1,
+                                     midi_output_is_open(port) ? "" : " (closed)");
+                            if (ImGui::Selectable(port_label, midi_port == port)) {
+                                regroove_metadata_set_midi_port(common_state->metadata, i, port);
+                                save_rgx_metadata();
+                            }
+                        }
                         ImGui::EndCombo();
                     }
                     ImGui::NextColumn();
@@ -5765,6 +6707,12 @@ static void ShowMainUI() {
                     }
                     ImGui::NextColumn();
 
+                    // Note length selector
+                    char len_combo_id[32];
+                    snprintf(len_combo_id, sizeof(len_combo_id), "##len_i%d", i);
+                    draw_note_length_combo(len_combo_id, i);
+                    ImGui::NextColumn();
+
                     // Name column - editable text field with custom override
                     char name_input_id[32];
                     snprintf(name_input_id, sizeof(name_input_id), "##name_i%d", i);
@@ -5832,7 +6780,12 @@ static void ShowMainUI() {
                     if (common_state->metadata->instrument_midi_channels[i] == -2) {
                         snprintf(channel_label, sizeof(channel_label), "None");
                     } else if (midi_channel >= 0 && midi_channel < 16) {
-                        snprintf(channel_label, sizeof(channel_label), "Ch %d", midi_channel + 1);
+                        int midi_port = regroove_metadata_get_midi_port(common_state->metadata, i);
+                        if (midi_port > 0) {
+                            snprintf(channel_label, sizeof(channel_label), "O%d:Ch %d", midi_port + 1, midi_channel + 1);
+                        } else {
+                            snprintf(channel_label, sizeof(channel_label), "Ch %d", midi_channel + 1);
+                        }
                     } else {
                         // Default to Ch 1 if no valid channel set
                         snprintf(channel_label, sizeof(channel_label), "Ch 1");
@@ -5854,6 +6807,19 @@ static void ShowMainUI() {
                                 save_rgx_metadata();
                             }
                         }
+
+                        // Output port (MIDI Output 1-4 in settings)
+                        ImGui::Separator();
+                        int midi_port = regroove_metadata_get_midi_port(common_state->metadata, i);
+                        for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+                            char port_label[24];
+                            snprintf(port_label, sizeof(port_label), "Output %d%s", port + 1,
+                                     midi_output_is_open(port) ? "" : " (closed)");
+                            if (ImGui::Selectable(port_label, midi_port == port)) {
+                                regroove_metadata_set_midi_port(common_state->metadata, i, port);
+                                save_rgx_metadata();
+                            }
+                        }
                         ImGui::EndCombo();
                     }
                     ImGui::NextColumn();
@@ -5889,7 +6855,13 @@ static void ShowMainUI() {
                     }
                     ImGui::NextColumn();
 
-                    // Name column - editable text field with custom override
+                    // Note length selector
+                    char len_combo_id[32];
+                    snprintf(len_combo_id, sizeof(len_combo_id), "##len_s%d", i);
+                    draw_note_length_combo(len_combo_id, i);
+                    ImGui::NextColumn();
+
+                    // Name column - editable text field with custom override
                     char name_input_id[32];
                     snprintf(name_input_id, sizeof(name_input_id), "##name_s%d", i);
 
@@ -5997,6 +6969,9 @@ static void ShowMainUI() {
             midi_monitor_count = 0;
             midi_monitor_head = 0;
         }
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Dropped: %d (device queues full)   %d (not shown, applied in the audio callback)",
+                           midi_get_dropped_events(), SDL_AtomicGet(&midi_ui_dropped));
 
         ImGui::Dummy(ImVec2(0, 20.0f));
         ImGui::Separator();
@@ -6304,6 +7279,7 @@ static void ShowMainUI() {
 
             // Auto-save if any changes were made
             if (song_pads_changed) {
+                input_mappings_invalidate(common_state->input_mappings);
                 regroove_common_save_rgx(common_state);
             }
 
@@ -6471,9 +7447,12 @@ static void ShowMainUI() {
                             act == ACTION_FX_EQ_HIGH ||
                             act == ACTION_FX_COMPRESSOR_THRESHOLD ||
                             act == ACTION_FX_COMPRESSOR_RATIO ||
+                            (act >= ACTION_FX_MB_LOW_THRESHOLD && act <= ACTION_FX_MB_HIGH_GAIN) ||
                             act == ACTION_FX_DELAY_TIME ||
                             act == ACTION_FX_DELAY_FEEDBACK ||
-                            act == ACTION_FX_DELAY_MIX) {
+                            act == ACTION_FX_DELAY_MIX ||
+                            act == ACTION_FX_DUCKER_DEPTH ||
+                            act == ACTION_FX_CONVOLUTION_MIX) {
                             new_midi_continuous = 1;
                             new_midi_threshold = 0;
                         } else {
@@ -6517,11 +7496,11 @@ static void ShowMainUI() {
             // Add button
             if (ImGui::Button("Add MIDI Mapping", ImVec2(200.0f, 0.0f))) {
                 if (common_state->input_mappings->midi_count < common_state->input_mappings->midi_capacity) {
-                    // Check if this CC/device combo already exists, remove it
+                    // A CC can drive several actions; only replace the same binding
                     for (int i = 0; i < common_state->input_mappings->midi_count; i++) {
                         MidiMapping *m = &common_state->input_mappings->midi_mappings[i];
-                        if (m->cc_number == new_midi_cc &&
-                            (m->device_id == new_midi_device || m->device_id == -1 || new_midi_device == -1)) {
+                        if (m->cc_number == new_midi_cc && m->device_id == new_midi_device &&
+                            m->action == new_midi_action && m->parameter == new_midi_parameter) {
                             for (int j = i; j < common_state->input_mappings->midi_count - 1; j++) {
                                 common_state->input_mappings->midi_mappings[j] =
                                     common_state->input_mappings->midi_mappings[j + 1];
@@ -6606,11 +7585,10 @@ static void ShowMainUI() {
             ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.2f, 1.0f), "MASTER");
             ImGui::Dummy(ImVec2(0, 4.0f));
 
-            // FX button (mutually exclusive routing)
-            ImVec4 fxCol = (fx_route == FX_ROUTE_MASTER) ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, fxCol);
+            // FX button (routes the edited effects chain to this bus)
+            ImGui::PushStyleColor(ImGuiCol_Button, fx_bus_button_color(REGROOVE_FX_BUS_MASTER));
             if (ImGui::Button("FX##master_fx", ImVec2(sliderW, SOLO_SIZE))) {
-                fx_route = (fx_route == FX_ROUTE_MASTER) ? FX_ROUTE_NONE : FX_ROUTE_MASTER;
+                toggle_fx_bus(REGROOVE_FX_BUS_MASTER);
             }
             ImGui::PopStyleColor();
             ImGui::Dummy(ImVec2(0, 2.0f));
@@ -6663,11 +7641,10 @@ static void ShowMainUI() {
             ImGui::TextColored(ImVec4(0.6f, 0.8f, 1.0f, 1.0f), "PLAYBACK");
             ImGui::Dummy(ImVec2(0, 4.0f));
 
-            // FX button (mutually exclusive routing)
-            ImVec4 fxCol = (fx_route == FX_ROUTE_PLAYBACK) ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, fxCol);
+            // FX button (routes the edited effects chain to this bus)
+            ImGui::PushStyleColor(ImGuiCol_Button, fx_bus_button_color(REGROOVE_FX_BUS_PLAYBACK));
             if (ImGui::Button("FX##playback_fx", ImVec2(sliderW, SOLO_SIZE))) {
-                fx_route = (fx_route == FX_ROUTE_PLAYBACK) ? FX_ROUTE_NONE : FX_ROUTE_PLAYBACK;
+                toggle_fx_bus(REGROOVE_FX_BUS_PLAYBACK);
             }
             ImGui::PopStyleColor();
             ImGui::Dummy(ImVec2(0, 2.0f));
@@ -6720,11 +7697,10 @@ static void ShowMainUI() {
             ImGui::TextColored(ImVec4(0.8f, 1.0f, 0.6f, 1.0f), "INPUT");
             ImGui::Dummy(ImVec2(0, 4.0f));
 
-            // FX button (mutually exclusive routing)
-            ImVec4 fxCol = (fx_route == FX_ROUTE_INPUT) ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
-            ImGui::PushStyleColor(ImGuiCol_Button, fxCol);
+            // FX button (routes the edited effects chain to this bus)
+            ImGui::PushStyleColor(ImGuiCol_Button, fx_bus_button_color(REGROOVE_FX_BUS_INPUT));
             if (ImGui::Button("FX##input_fx", ImVec2(sliderW, SOLO_SIZE))) {
-                fx_route = (fx_route == FX_ROUTE_INPUT) ? FX_ROUTE_NONE : FX_ROUTE_INPUT;
+                toggle_fx_bus(REGROOVE_FX_BUS_INPUT);
             }
             ImGui::PopStyleColor();
             ImGui::Dummy(ImVec2(0, 2.0f));
@@ -6903,8 +7879,17 @@ static void ShowMainUI() {
                 ImGui::Text("Resonance");
                 ImGui::Dummy(ImVec2(0, 4.0f));
 
-                // Spacer to align with faders that have enable buttons
-                ImGui::Dummy(ImVec2(sliderW, SOLO_SIZE));
+                // Filter response cycle (aligned with the enable buttons)
+                int filter_mode = regroove_effects_get_filter_mode(effects);
+                char mode_label[32];
+                snprintf(mode_label, sizeof(mode_label), "%s##filter_mode", regroove_effects_filter_mode_name(filter_mode));
+                if (ImGui::Button(mode_label, ImVec2(sliderW, SOLO_SIZE))) {
+                    if (learn_mode_active) start_learn_for_action(ACTION_FX_FILTER_MODE);
+                    else regroove_effects_set_filter_mode(effects, (filter_mode + 1) % REGROOVE_FX_FILTER_MODE_COUNT);
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Filter response: LP / BP / HP / Notch");
+                }
                 ImGui::Dummy(ImVec2(0, 6.0f));
 
                 float reso = regroove_effects_get_filter_resonance(effects);
@@ -7094,6 +8079,128 @@ static void ShowMainUI() {
             // Add group spacing (wider gap between effect groups)
             group_gap_offset += (spacing - fx_spacing);
 
+            // --- MULTIBAND COMPRESSOR GROUP (per-band threshold, band gains via MIDI) ---
+            float mb_start_x = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+            ImGui::SetCursorPos(ImVec2(mb_start_x, origin.y + 8.0f));
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "MULTIBAND");
+
+            for (int band = 0; band < REGROOVE_FX_MB_BANDS; band++) {
+                static const char *band_names[REGROOVE_FX_MB_BANDS] = { "Low", "Mid", "High" };
+                float colX = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+                ImGui::SetCursorPos(ImVec2(colX, origin.y + 24.0f));
+                ImGui::BeginGroup();
+                ImGui::PushID(band);
+                ImGui::Text("%s", band_names[band]);
+                ImGui::Dummy(ImVec2(0, 4.0f));
+
+                if (band == REGROOVE_FX_MB_LOW) {
+                    int mb_en = regroove_effects_get_multiband_enabled(effects);
+                    ImVec4 enCol = mb_en ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
+                    ImGui::PushStyleColor(ImGuiCol_Button, enCol);
+                    if (ImGui::Button("E##mb_en", ImVec2(sliderW, SOLO_SIZE))) {
+                        if (learn_mode_active) start_learn_for_action(ACTION_FX_MULTIBAND_TOGGLE);
+                        else regroove_effects_set_multiband_enabled(effects, !mb_en);
+                    }
+                    ImGui::PopStyleColor();
+                } else {
+                    // Spacer to align with faders that have enable buttons
+                    ImGui::Dummy(ImVec2(sliderW, SOLO_SIZE));
+                }
+                ImGui::Dummy(ImVec2(0, 6.0f));
+
+                float threshold = regroove_effects_get_multiband_threshold(effects, band);
+                if (ImGui::VSliderFloat("##fx_mb_thresh", ImVec2(sliderW, sliderH), &threshold, 0.0f, 1.0f, "")) {
+                    if (learn_mode_active && ImGui::IsItemActive()) {
+                        start_learn_for_action((InputAction)(ACTION_FX_MB_LOW_THRESHOLD + band));
+                    } else {
+                        regroove_effects_set_multiband_threshold(effects, band, threshold);
+                    }
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s band threshold: %.1f dB", band_names[band], -40.0f + threshold * 40.0f);
+                }
+                ImGui::Dummy(ImVec2(0, 8.0f));
+                if (ImGui::Button("R##mb_thresh_reset", ImVec2(sliderW, MUTE_SIZE))) {
+                    regroove_effects_set_multiband_threshold(effects, band, 0.7f); // Reset to -12dB
+                }
+                ImGui::PopID();
+                ImGui::EndGroup();
+                col_index++;
+            }
+
+            // Add group spacing (wider gap between effect groups)
+            group_gap_offset += (spacing - fx_spacing);
+
+            // --- DUCKER GROUP (sidechain keyed from a tracker channel, see Settings) ---
+            float duck_start_x = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+            ImGui::SetCursorPos(ImVec2(duck_start_x, origin.y + 8.0f));
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "DUCK");
+
+            // Depth (with enable)
+            {
+                float colX = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+                ImGui::SetCursorPos(ImVec2(colX, origin.y + 24.0f));
+                ImGui::BeginGroup();
+                ImGui::Text("Depth");
+                ImGui::Dummy(ImVec2(0, 4.0f));
+
+                int duck_en = regroove_effects_get_ducker_enabled(effects);
+                ImVec4 enCol = duck_en ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
+                ImGui::PushStyleColor(ImGuiCol_Button, enCol);
+                if (ImGui::Button("E##duck_en", ImVec2(sliderW, SOLO_SIZE))) {
+                    if (learn_mode_active) start_learn_for_action(ACTION_FX_DUCKER_TOGGLE);
+                    else regroove_effects_set_ducker_enabled(effects, !duck_en);
+                }
+                ImGui::PopStyleColor();
+                if (ImGui::IsItemHovered() && common_state && common_state->player &&
+                    regroove_get_sidechain_channel(common_state->player) < 0) {
+                    ImGui::SetTooltip("No sidechain key channel set (Settings > Effects Routing)");
+                }
+                ImGui::Dummy(ImVec2(0, 6.0f));
+
+                float depth = regroove_effects_get_ducker_depth(effects);
+                if (ImGui::VSliderFloat("##fx_duck_depth", ImVec2(sliderW, sliderH), &depth, 0.0f, 1.0f, "")) {
+                    if (learn_mode_active && ImGui::IsItemActive()) {
+                        start_learn_for_action(ACTION_FX_DUCKER_DEPTH);
+                    } else {
+                        regroove_effects_set_ducker_depth(effects, depth);
+                    }
+                }
+                ImGui::Dummy(ImVec2(0, 8.0f));
+                if (ImGui::Button("R##duck_depth_reset", ImVec2(sliderW, MUTE_SIZE))) {
+                    regroove_effects_set_ducker_depth(effects, 0.7f);
+                }
+                ImGui::EndGroup();
+                col_index++;
+            }
+
+            // Release (with reset button)
+            {
+                float colX = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+                ImGui::SetCursorPos(ImVec2(colX, origin.y + 24.0f));
+                ImGui::BeginGroup();
+                ImGui::Text("Release");
+                ImGui::Dummy(ImVec2(0, 4.0f));
+
+                // Spacer to align with faders that have enable buttons
+                ImGui::Dummy(ImVec2(sliderW, SOLO_SIZE));
+                ImGui::Dummy(ImVec2(0, 6.0f));
+
+                float release = regroove_effects_get_ducker_release(effects);
+                if (ImGui::VSliderFloat("##fx_duck_release", ImVec2(sliderW, sliderH), &release, 0.0f, 1.0f, "")) {
+                    regroove_effects_set_ducker_release(effects, release);
+                }
+                ImGui::Dummy(ImVec2(0, 8.0f));
+                if (ImGui::Button("R##duck_release_reset", ImVec2(sliderW, MUTE_SIZE))) {
+                    regroove_effects_set_ducker_release(effects, 0.3f);
+                }
+                ImGui::EndGroup();
+                col_index++;
+            }
+
+            // Add group spacing (wider gap between effect groups)
+            group_gap_offset += (spacing - fx_spacing);
+
             // --- DELAY GROUP ---
             float delay_start_x = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
             ImGui::SetCursorPos(ImVec2(delay_start_x, origin.y + 8.0f));
@@ -7104,7 +8211,9 @@ static void ShowMainUI() {
                 float colX = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
                 ImGui::SetCursorPos(ImVec2(colX, origin.y + 24.0f));
                 ImGui::BeginGroup();
-                ImGui::Text("Time");
+                // In sync mode the fader selects a note division
+                ImGui::Text("%s", regroove_effects_get_delay_sync(effects)
+                                  ? regroove_effects_get_delay_division_name(effects) : "Time");
                 ImGui::Dummy(ImVec2(0, 4.0f));
 
                 int delay_en = regroove_effects_get_delay_enabled(effects);
@@ -7141,8 +8250,18 @@ static void ShowMainUI() {
                 ImGui::Text("Feedback");
                 ImGui::Dummy(ImVec2(0, 4.0f));
 
-                // Spacer to align with faders that have enable buttons
-                ImGui::Dummy(ImVec2(sliderW, SOLO_SIZE));
+                // Tempo sync toggle (aligned with the enable buttons)
+                int delay_sync = regroove_effects_get_delay_sync(effects);
+                ImVec4 syncCol = delay_sync ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
+                ImGui::PushStyleColor(ImGuiCol_Button, syncCol);
+                if (ImGui::Button("S##delay_sync", ImVec2(sliderW, SOLO_SIZE))) {
+                    if (learn_mode_active) start_learn_for_action(ACTION_FX_DELAY_SYNC_TOGGLE);
+                    else regroove_effects_set_delay_sync(effects, !delay_sync);
+                }
+                ImGui::PopStyleColor();
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Sync delay time to song tempo");
+                }
                 ImGui::Dummy(ImVec2(0, 6.0f));
 
                 float feedback = regroove_effects_get_delay_feedback(effects);
@@ -7188,6 +8307,61 @@ static void ShowMainUI() {
                 ImGui::EndGroup();
                 col_index++;
             }
+
+            // Add group spacing (wider gap between effect groups)
+            group_gap_offset += (spacing - fx_spacing);
+
+            // --- CONVOLUTION REVERB GROUP (impulse response from .rgx or Settings) ---
+            float reverb_start_x = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+            ImGui::SetCursorPos(ImVec2(reverb_start_x, origin.y + 8.0f));
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "REVERB");
+
+            // Mix (with enable)
+            {
+                float colX = origin.x + col_index * (sliderW + fx_spacing) + group_gap_offset;
+                ImGui::SetCursorPos(ImVec2(colX, origin.y + 24.0f));
+                ImGui::BeginGroup();
+                ImGui::Text("Mix");
+                ImGui::Dummy(ImVec2(0, 4.0f));
+
+                int conv_en = regroove_effects_get_convolution_enabled(effects);
+                ImVec4 enCol = conv_en ? ImVec4(0.70f, 0.60f, 0.20f, 1.0f) : ImVec4(0.26f, 0.27f, 0.30f, 1.0f);
+                ImGui::PushStyleColor(ImGuiCol_Button, enCol);
+                if (ImGui::Button("E##conv_en", ImVec2(sliderW, SOLO_SIZE))) {
+                    if (learn_mode_active) start_learn_for_action(ACTION_FX_CONVOLUTION_TOGGLE);
+                    else regroove_effects_set_convolution_enabled(effects, !conv_en);
+                }
+                ImGui::PopStyleColor();
+                if (ImGui::IsItemHovered()) {
+                    const char *ir = regroove_effects_get_convolution_ir(effects);
+                    const char *ir_name = strrchr(ir, '/');
+                    if (!ir_name) ir_name = strrchr(ir, '\\');
+                    ir_name = ir_name ? ir_name + 1 : ir;
+                    if (regroove_effects_get_convolution_ir_loading(effects)) {
+                        ImGui::SetTooltip("Loading impulse response %s...", ir_name);
+                    } else if (regroove_effects_get_convolution_ir_loaded(effects)) {
+                        ImGui::SetTooltip("Impulse response: %s", ir_name);
+                    } else {
+                        ImGui::SetTooltip("No impulse response loaded (Settings > Effects Defaults or .rgx [Convolution])");
+                    }
+                }
+                ImGui::Dummy(ImVec2(0, 6.0f));
+
+                float mix = regroove_effects_get_convolution_mix(effects);
+                if (ImGui::VSliderFloat("##fx_conv_mix", ImVec2(sliderW, sliderH), &mix, 0.0f, 1.0f, "")) {
+                    if (learn_mode_active && ImGui::IsItemActive()) {
+                        start_learn_for_action(ACTION_FX_CONVOLUTION_MIX);
+                    } else {
+                        regroove_effects_set_convolution_mix(effects, mix);
+                    }
+                }
+                ImGui::Dummy(ImVec2(0, 8.0f));
+                if (ImGui::Button("R##conv_mix_reset", ImVec2(sliderW, MUTE_SIZE))) {
+                    regroove_effects_set_convolution_mix(effects, 0.3f);
+                }
+                ImGui::EndGroup();
+                col_index++;
+            }
         }
     }
     else if (ui_mode == UI_MODE_SETTINGS) {
@@ -7231,18 +8405,8 @@ static void ShowMainUI() {
                         SDL_CloseAudioDevice(audio_device_id);
                     }
 
-                    SDL_AudioSpec spec;
-                    SDL_zero(spec);
-                    spec.freq = 48000;
-                    spec.format = AUDIO_S16SYS;
-                    spec.channels = 2;
-                    spec.samples = 256;
-                    spec.callback = audio_callback;
-                    spec.userdata = NULL;
-
-                    audio_device_id = SDL_OpenAudioDevice(NULL, 0, &spec, NULL, 0); // NULL = default device
+                    audio_device_id = open_audio_output_device(NULL); // NULL = default device
                     if (audio_device_id > 0) {
-                        common_state->audio_device_id = audio_device_id;
                         SDL_PauseAudioDevice(audio_device_id, 0); // Start immediately
                         printf("Audio output switched to: Default\n");
                     } else {
@@ -7266,18 +8430,8 @@ static void ShowMainUI() {
                             SDL_CloseAudioDevice(audio_device_id);
                         }
 
-                        SDL_AudioSpec spec;
-                        SDL_zero(spec);
-                        spec.freq = 48000;
-                        spec.format = AUDIO_S16SYS;
-                        spec.channels = 2;
-                        spec.samples = 256;
-                        spec.callback = audio_callback;
-                        spec.userdata = NULL;
-
-                        audio_device_id = SDL_OpenAudioDevice(audio_device_names[i].c_str(), 0, &spec, NULL, 0);
+                        audio_device_id = open_audio_output_device(audio_device_names[i].c_str());
                         if (audio_device_id > 0) {
-                            common_state->audio_device_id = audio_device_id;
                             SDL_PauseAudioDevice(audio_device_id, 0); // Start immediately
                             printf("Audio output switched to: %s\n", audio_device_names[i].c_str());
                         } else {
@@ -7338,17 +8492,8 @@ static void ShowMainUI() {
                         audio_input_device_id = 0;
                     }
 
-                    // Open new input device
-                    SDL_AudioSpec input_spec, obtained_spec;
-                    SDL_zero(input_spec);
-                    input_spec.freq = 48000;
-                    input_spec.format = AUDIO_S16SYS;
-                    input_spec.channels = 2;
-                    input_spec.samples = 256;
-                    input_spec.callback = audio_input_callback;
-                    input_spec.userdata = NULL;
-
-                    audio_input_device_id = SDL_OpenAudioDevice(audio_input_device_names[i].c_str(), 1, &input_spec, &obtained_spec, SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+                    // Open new input device (at the output sample rate)
+                    audio_input_device_id = open_audio_input_device(audio_input_device_names[i].c_str());
                     if (audio_input_device_id > 0) {
                         selected_audio_input_device = i;
                         SDL_PauseAudioDevice(audio_input_device_id, 0); // Start capturing immediately
@@ -7358,8 +8503,7 @@ static void ShowMainUI() {
                             common_state->device_config.audio_input_device = i;
                             regroove_common_save_device_config(common_state, current_config_file);
                         }
-                        printf("Audio input set to: %s (requested: %d samples, obtained: %d samples)\n",
-                               audio_input_device_names[i].c_str(), input_spec.samples, obtained_spec.samples);
+                        printf("Audio input set to: %s\n", audio_input_device_names[i].c_str());
                     } else {
                         printf("Failed to open audio input device: %s\n", SDL_GetError());
                         selected_audio_input_device = -1;
@@ -7387,8 +8531,12 @@ static void ShowMainUI() {
             if (buffer_ms > 500) buffer_ms = 500;
             common_state->device_config.audio_input_buffer_ms = buffer_ms;
 
-            // Reinitialize the ring buffer with new size
-            audio_input_init(buffer_ms);
+            // Reinitialize the ring buffer with new size (both callbacks locked out)
+            if (audio_input_device_id) SDL_LockAudioDevice(audio_input_device_id);
+            if (audio_device_id) SDL_LockAudioDevice(audio_device_id);
+            audio_input_init(buffer_ms, common_state->sample_rate, audio_block_frames);
+            if (audio_device_id) SDL_UnlockAudioDevice(audio_device_id);
+            if (audio_input_device_id) SDL_UnlockAudioDevice(audio_input_device_id);
 
             // Save to config
             regroove_common_save_device_config(common_state, current_config_file);
@@ -7397,6 +8545,238 @@ static void ShowMainUI() {
         ImGui::PopItemWidth();
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(Lower = less latency, Higher = more stable)");
+        if (audio_input_device_id) {
+            ImGui::Dummy(ImVec2(0, 4.0f));
+            ImGui::Text("Input Ring:");
+            ImGui::SameLine(150.0f);
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Fill: %d / %d frames   Drift: %+d ppm   Overruns: %d   Underruns: %d",
+                               audio_input_available() / 2, audio_input_get_target_frames(), audio_input_get_drift_ppm(),
+                               audio_input_get_overruns(), audio_input_get_underruns());
+        }
+
+        // Round-trip latency calibration (plays a test sequence, needs output looped back to input)
+        ImGui::Dummy(ImVec2(0, 8.0f));
+        ImGui::Text("Round Trip:");
+        ImGui::SameLine(150.0f);
+        RegrooveLatencyState cal_state = regroove_latency_get_state(latency_cal);
+        bool cal_busy = cal_state == REGROOVE_LATENCY_RUNNING || cal_state == REGROOVE_LATENCY_CAPTURED ||
+                        cal_state == REGROOVE_LATENCY_ANALYZING;
+        bool cal_disabled = cal_busy || !audio_input_device_id;
+        if (cal_disabled) ImGui::BeginDisabled();
+        if (ImGui::Button(cal_busy ? "Measuring...##latency_cal" : "Calibrate##latency_cal")) {
+            start_latency_calibration();
+        }
+        if (cal_disabled) ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("Loop the output back to the input (cable or speaker/mic), then click.\n"
+                              "Plays a short noise sequence and measures the output-to-input delay.");
+        }
+        ImGui::SameLine();
+        if (cal_state == REGROOVE_LATENCY_FAILED) {
+            ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Failed - no test signal on the input");
+        } else if (common_state->device_config.audio_roundtrip_latency_ms > 0.0f) {
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "%.1f ms", common_state->device_config.audio_roundtrip_latency_ms);
+        } else {
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), audio_input_device_id ? "Not calibrated" : "Not calibrated (select an input device)");
+        }
+
+        // Pan law of the playback and input strips (master pan is a balance control,
+        // except under the linear law)
+        ImGui::Dummy(ImVec2(0, 8.0f));
+        ImGui::Text("Pan Law:");
+        ImGui::SameLine(150.0f);
+        ImGui::PushItemWidth(200.0f);
+        int pan_law = common_state->device_config.mixer_pan_law;
+        if (ImGui::BeginCombo("##mixer_pan_law", regroove_mixer_pan_law_name((RegrooveMixerPanLaw)pan_law))) {
+            for (int i = 0; i < REGROOVE_MIXER_PAN_LAW_COUNT; i++) {
+                bool is_selected = (i == pan_law);
+                if (ImGui::Selectable(regroove_mixer_pan_law_name((RegrooveMixerPanLaw)i), is_selected)) {
+                    common_state->device_config.mixer_pan_law = i;
+                    regroove_common_save_device_config(common_state, current_config_file);
+                }
+                if (is_selected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::PopItemWidth();
+
+        ImGui::Dummy(ImVec2(0, 20.0f));
+        ImGui::Separator();
+        ImGui::Dummy(ImVec2(0, 20.0f));
+
+        // Recording Section (disk recorder for the master output)
+        ImGui::TextColored(COLOR_SECTION_HEADING, "RECORDING");
+        ImGui::Separator();
+        ImGui::Dummy(ImVec2(0, 12.0f));
+
+        ImGui::Text("Record:");
+        ImGui::SameLine(150.0f);
+        bool is_recording = regroove_recorder_is_recording(recorder) != 0;
+        if (is_recording) ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.90f, 0.16f, 0.18f, 1.0f));
+        if (ImGui::Button(is_recording ? "Stop##audio_rec" : "Record##audio_rec", ImVec2(80.0f, 0.0f))) {
+            if (learn_mode_active) start_learn_for_action(ACTION_AUDIO_RECORD_TOGGLE);
+            else toggle_audio_recording();
+        }
+        if (is_recording) ImGui::PopStyleColor();
+        ImGui::SameLine();
+        if (is_recording) {
+            int64_t rec_seconds = regroove_recorder_get_frames(recorder) / common_state->sample_rate;
+            int rec_overruns = regroove_recorder_get_overruns(recorder);
+            ImGui::TextColored(rec_overruns ? ImVec4(0.9f, 0.4f, 0.4f, 1.0f) : ImVec4(0.6f, 0.6f, 0.6f, 1.0f),
+                               "%d:%02d   Dropped blocks: %d", (int)(rec_seconds / 60), (int)(rec_seconds % 60), rec_overruns);
+        } else {
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(WAV files in the working directory)");
+        }
+
+        ImGui::Dummy(ImVec2(0, 8.0f));
+        ImGui::Text("Record Stems:");
+        ImGui::SameLine(150.0f);
+        bool record_stems = common_state->device_config.record_stems != 0;
+        if (is_recording) ImGui::BeginDisabled();
+        if (ImGui::Checkbox("##record_stems", &record_stems)) {
+            common_state->device_config.record_stems = record_stems ? 1 : 0;
+            regroove_common_save_device_config(common_state, current_config_file);
+        }
+        if (is_recording) ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(Also record playback and input before effects)");
+
+        ImGui::Dummy(ImVec2(0, 20.0f));
+        ImGui::Separator();
+        ImGui::Dummy(ImVec2(0, 20.0f));
+
+        // Cue / Headphones Section (second output device for pre-listening)
+        ImGui::TextColored(COLOR_SECTION_HEADING, "CUE / HEADPHONES");
+        ImGui::Separator();
+        ImGui::Dummy(ImVec2(0, 12.0f));
+
+        ImGui::Text("Cue Output:");
+        ImGui::SameLine(150.0f);
+
+        const char* current_cue_label = (selected_cue_device >= 0 && selected_cue_device < (int)audio_device_names.size())
+            ? audio_device_names[selected_cue_device].c_str()
+            : "Disabled";
+
+        if (ImGui::BeginCombo("##cue_device", current_cue_label)) {
+            if (ImGui::Selectable("Disabled", selected_cue_device == -1)) {
+                if (selected_cue_device != -1) { // Only if actually changing
+                    close_cue_device();
+                    selected_cue_device = -1;
+                    common_state->device_config.audio_cue_device = -1;
+                    regroove_common_save_device_config(common_state, current_config_file);
+                    printf("Cue output disabled\n");
+                }
+            }
+
+            for (int i = 0; i < (int)audio_device_names.size(); i++) {
+                if (ImGui::Selectable(audio_device_names[i].c_str(), selected_cue_device == i)) {
+                    close_cue_device();
+                    cue_device_id = open_cue_device(audio_device_names[i].c_str());
+                    if (cue_device_id > 0) {
+                        selected_cue_device = i;
+                        SDL_PauseAudioDevice(cue_device_id, 0);
+                        common_state->device_config.audio_cue_device = i;
+                        regroove_common_save_device_config(common_state, current_config_file);
+                    } else {
+                        printf("Failed to open cue device: %s\n", SDL_GetError());
+                        selected_cue_device = -1;
+                    }
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        ImGui::Dummy(ImVec2(0, 8.0f));
+        ImGui::Text("Cue Source:");
+        ImGui::SameLine(150.0f);
+        ImGui::PushItemWidth(200.0f);
+        RegrooveCueMode cue_mode = regroove_cue_get_mode(cue_bus);
+        if (ImGui::BeginCombo("##cue_mode", regroove_cue_mode_name(cue_mode))) {
+            for (int i = 0; i < REGROOVE_CUE_MODE_COUNT; i++) {
+                bool is_selected = (i == (int)cue_mode);
+                if (ImGui::Selectable(regroove_cue_mode_name((RegrooveCueMode)i), is_selected) && !is_selected) {
+                    // Channel pre-listen runs a second copy of the playing module
+                    if (i == REGROOVE_CUE_CHANNELS && common_state->current_module_path[0] != '\0') {
+                        regroove_cue_load(cue_bus, common_state->current_module_path);
+                    }
+                    regroove_cue_set_playing(cue_bus, 0);
+                    regroove_cue_set_mode(cue_bus, (RegrooveCueMode)i);
+                }
+                if (is_selected) {
+                    ImGui::SetItemDefaultFocus();
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::PopItemWidth();
+
+        if (cue_mode == REGROOVE_CUE_MODULE) {
+            ImGui::Dummy(ImVec2(0, 8.0f));
+            ImGui::Text("Cue Module:");
+            ImGui::SameLine(150.0f);
+            if (ImGui::Button("Load Selected File##cue", ImVec2(150.0f, 0.0f)) && common_state->file_list) {
+                char path[COMMON_MAX_PATH];
+                if (regroove_filelist_get_current_path(common_state->file_list, path, sizeof(path))) {
+                    if (regroove_cue_load(cue_bus, path) != 0) {
+                        printf("Failed to load cue module: %s\n", path);
+                    }
+                }
+            }
+            ImGui::SameLine();
+            bool cue_playing = regroove_cue_get_playing(cue_bus) != 0;
+            if (ImGui::Button(cue_playing ? "Stop##cue" : "Play##cue", ImVec2(80.0f, 0.0f))) {
+                regroove_cue_set_playing(cue_bus, !cue_playing);
+            }
+            ImGui::SameLine();
+            const char* cue_path = regroove_cue_get_path(cue_bus);
+            const char* cue_name = strrchr(cue_path, '/');
+            if (!cue_name) cue_name = strrchr(cue_path, '\\');
+            cue_name = cue_name ? cue_name + 1 : cue_path;
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "%s", cue_name[0] ? cue_name : "(none)");
+        } else if (cue_mode == REGROOVE_CUE_CHANNELS) {
+            ImGui::Dummy(ImVec2(0, 8.0f));
+            ImGui::Text("Cue Channels:");
+            ImGui::SameLine(150.0f);
+            int cue_channels = common_state->num_channels;
+            if (cue_channels > REGROOVE_CUE_MAX_CHANNELS) cue_channels = REGROOVE_CUE_MAX_CHANNELS;
+            ImGui::BeginGroup();
+            for (int ch = 0; ch < cue_channels; ch++) {
+                if (ch % 8 != 0) ImGui::SameLine();
+                bool cued = regroove_cue_get_channel(cue_bus, ch) != 0;
+                char label[24];
+                snprintf(label, sizeof(label), "%d##cue_ch%d", ch + 1, ch);
+                if (ImGui::Checkbox(label, &cued)) {
+                    regroove_cue_set_channel(cue_bus, ch, cued);
+                }
+            }
+            if (cue_channels == 0) {
+                ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(no module loaded)");
+            }
+            ImGui::EndGroup();
+        }
+
+        ImGui::Dummy(ImVec2(0, 8.0f));
+        ImGui::Text("Cue Mix:");
+        ImGui::SameLine(150.0f);
+        ImGui::PushItemWidth(200.0f);
+        float cue_mix = regroove_cue_get_mix(cue_bus);
+        if (ImGui::SliderFloat("##cue_mix", &cue_mix, 0.0f, 1.0f, "%.2f")) {
+            regroove_cue_set_mix(cue_bus, cue_mix);
+        }
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "(0 = cue only, 1 = master only)");
+
+        ImGui::Text("Cue Volume:");
+        ImGui::SameLine(150.0f);
+        ImGui::PushItemWidth(200.0f);
+        float cue_volume = regroove_cue_get_volume(cue_bus);
+        if (ImGui::SliderFloat("##cue_volume", &cue_volume, 0.0f, 1.0f, "%.2f")) {
+            regroove_cue_set_volume(cue_bus, cue_volume);
+        }
+        ImGui::PopItemWidth();
 
         ImGui::Dummy(ImVec2(0, 20.0f));
         ImGui::Separator();
@@ -7651,6 +9031,7 @@ static void ShowMainUI() {
                         common_state->input_mappings->keyboard_mappings[j + 1];
                 }
                 common_state->input_mappings->keyboard_count--;
+                input_mappings_invalidate(common_state->input_mappings);
                 printf("Deleted keyboard mapping at index %d\n", delete_kb_index);
             }
 
@@ -7705,9 +9086,10 @@ static void ShowMainUI() {
             // Add button
             if (ImGui::Button("Add Keyboard Mapping", ImVec2(200.0f, 0.0f))) {
                 if (common_state->input_mappings->keyboard_count < common_state->input_mappings->keyboard_capacity) {
-                    // Remove any existing mapping for this key
+                    // A key can drive several actions; only replace the same binding
                     for (int i = 0; i < common_state->input_mappings->keyboard_count; i++) {
-                        if (common_state->input_mappings->keyboard_mappings[i].key == new_kb_key) {
+                        KeyboardMapping *k = &common_state->input_mappings->keyboard_mappings[i];
+                        if (k->key == new_kb_key && k->action == new_kb_action && k->parameter == new_kb_parameter) {
                             for (int j = i; j < common_state->input_mappings->keyboard_count - 1; j++) {
                                 common_state->input_mappings->keyboard_mappings[j] =
                                     common_state->input_mappings->keyboard_mappings[j + 1];
@@ -7738,6 +9120,111 @@ static void ShowMainUI() {
         ImGui::Separator();
         ImGui::Dummy(ImVec2(0, 20.0f));
 
+        // Effects Routing Section
+        ImGui::TextColored(COLOR_SECTION_HEADING, "EFFECTS ROUTING");
+        ImGui::Separator();
+        ImGui::TextWrapped("Each chain runs on one bus; chains sharing a bus run top to bottom. "
+                           "The selected chain is controlled by the effects panel, pads and MIDI.");
+        ImGui::Dummy(ImVec2(0, 8.0f));
+
+        for (int c = 0; c < regroove_fx_graph_get_num_chains(fx_graph); c++) {
+            RegrooveEffects *chain = regroove_fx_graph_get_chain(fx_graph, c);
+            ImGui::PushID(c);
+
+            char chain_label[32];
+            snprintf(chain_label, sizeof(chain_label), "Chain %d", c + 1);
+            if (ImGui::RadioButton(chain_label, fx_edit_chain == c)) {
+                fx_edit_chain = c;
+                effects = chain;
+            }
+
+            ImGui::SameLine(150.0f);
+            ImGui::SetNextItemWidth(120.0f);
+            RegrooveFxBus bus = regroove_fx_graph_get_chain_bus(fx_graph, c);
+            if (ImGui::BeginCombo("##fx_bus", regroove_fx_graph_bus_name(bus))) {
+                for (int b = REGROOVE_FX_BUS_NONE; b < REGROOVE_FX_BUS_COUNT; b++) {
+                    if (ImGui::Selectable(regroove_fx_graph_bus_name((RegrooveFxBus)b), bus == b)) {
+                        regroove_fx_graph_set_chain_bus(fx_graph, c, (RegrooveFxBus)b);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+
+            // Stage order: the arrow moves a stage one position earlier
+            ImGui::SameLine(290.0f);
+            for (int pos = 0; pos < REGROOVE_FX_STAGE_COUNT; pos++) {
+                ImGui::PushID(pos);
+                if (pos > 0) {
+                    ImGui::SameLine();
+                    if (ImGui::ArrowButton("##fx_stage_earlier", ImGuiDir_Left)) {
+                        // Swap under the audio lock so the callback never sees a half-updated order
+                        if (audio_device_id) SDL_LockAudioDevice(audio_device_id);
+                        regroove_effects_move_stage(chain, pos, -1);
+                        if (audio_device_id) SDL_UnlockAudioDevice(audio_device_id);
+                    }
+                    ImGui::SameLine(0.0f, 2.0f);
+                }
+                ImGui::TextUnformatted(regroove_effects_stage_name(regroove_effects_get_stage(chain, pos)));
+                ImGui::PopID();
+            }
+
+            ImGui::PopID();
+        }
+
+        // Sidechain key for the ducker stage (stored per song in the .rgx)
+        if (common_state && common_state->player && common_state->metadata) {
+            Regroove *player = common_state->player;
+            int key_ch = regroove_get_sidechain_channel(player);
+            RegrooveSidechainSource key_src = regroove_get_sidechain_source(player);
+            bool key_changed = false;
+
+            ImGui::Dummy(ImVec2(0, 8.0f));
+            ImGui::Text("Duck Key:");
+            ImGui::SameLine(150.0f);
+            ImGui::SetNextItemWidth(120.0f);
+            char key_label[16];
+            if (key_ch >= 0) snprintf(key_label, sizeof(key_label), "CH %d", key_ch + 1);
+            else snprintf(key_label, sizeof(key_label), "None");
+            if (ImGui::BeginCombo("##duck_key_ch", key_label)) {
+                if (ImGui::Selectable("None", key_ch < 0)) {
+                    key_ch = -1;
+                    key_changed = true;
+                }
+                for (int ch = 0; ch < regroove_get_num_channels(player); ch++) {
+                    char ch_label[16];
+                    snprintf(ch_label, sizeof(ch_label), "CH %d", ch + 1);
+                    if (ImGui::Selectable(ch_label, key_ch == ch)) {
+                        key_ch = ch;
+                        key_changed = true;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::SameLine(290.0f);
+            ImGui::SetNextItemWidth(120.0f);
+            const char *src_names[] = { "VU", "Note" };
+            int src = (int)key_src;
+            if (ImGui::Combo("##duck_key_src", &src, src_names, 2)) {
+                key_src = (RegrooveSidechainSource)src;
+                key_changed = true;
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("VU follows the audible channel; Note keys on pattern notes (works on muted channels)");
+            }
+
+            if (key_changed) {
+                regroove_set_sidechain(player, key_ch, key_src);
+                common_state->metadata->sidechain_channel = key_ch;
+                common_state->metadata->sidechain_source = (int)key_src;
+                save_rgx_metadata();
+            }
+        }
+
+        ImGui::Dummy(ImVec2(0, 20.0f));
+        ImGui::Separator();
+        ImGui::Dummy(ImVec2(0, 20.0f));
+
         // Effect Default Parameters Section
         ImGui::TextColored(COLOR_SECTION_HEADING, "EFFECT DEFAULT PARAMETERS");
         ImGui::Separator();
@@ -7865,6 +9352,34 @@ static void ShowMainUI() {
                 config_changed = true;
             }
 
+            ImGui::Dummy(ImVec2(0, 12.0f));
+
+            // Convolution reverb parameters
+            ImGui::TextColored(COLOR_SECTION_HEADING, "REVERB");
+            ImGui::Separator();
+
+            ImGui::Text("Impulse Response:");
+            ImGui::SameLine(200.0f);
+            ImGui::SetNextItemWidth(320.0f);
+            ImGui::InputText("##conv_ir", common_state->device_config.fx_convolution_ir, COMMON_MAX_PATH);
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                config_changed = true;
+                // Apply now unless the song's .rgx has its own impulse response
+                char ir_path[COMMON_MAX_PATH];
+                regroove_common_get_convolution_ir(common_state, ir_path, sizeof(ir_path));
+                regroove_fx_graph_load_convolution_ir(fx_graph, ir_path);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("WAV file (mono/stereo, up to %d s). A song's .rgx [Convolution] ir= overrides it.",
+                                  REGROOVE_CONV_MAX_IR_SECONDS);
+            }
+
+            ImGui::Text("Reverb Mix:");
+            ImGui::SameLine(200.0f);
+            if (ImGui::SliderFloat("##conv_mix", &common_state->device_config.fx_convolution_mix, 0.0f, 1.0f, "%.2f")) {
+                config_changed = true;
+            }
+
             if (config_changed) {
                 regroove_common_save_device_config(common_state, current_config_file);
             }
@@ -8177,7 +9692,6 @@ int main(int argc, char* argv[]) {
 
     // Initialize MIDI output if configured
     if (regroove_common_init_midi_output(common_state) == 0) {
-        midi_output_device = common_state->device_config.midi_output_device;
         midi_output_enabled = true;
     }
 
@@ -8208,7 +9722,7 @@ int main(int argc, char* argv[]) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) return 1;
 
     // Initialize audio input ring buffer with configured size
-    audio_input_init(common_state->device_config.audio_input_buffer_ms);
+    audio_input_init(common_state->device_config.audio_input_buffer_ms, common_state->sample_rate, audio_block_frames);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
@@ -8220,30 +9734,71 @@ int main(int argc, char* argv[]) {
     SDL_GLContext gl_ctx = SDL_GL_CreateContext(window);
     SDL_GL_MakeCurrent(window, gl_ctx);
     SDL_GL_SetSwapInterval(1);
-    SDL_AudioSpec spec;
-    SDL_zero(spec);
-    spec.freq = 48000;
-    spec.format = AUDIO_S16SYS;
-    spec.channels = 2;
-    spec.samples = 256;
-    spec.callback = audio_callback;
-    spec.userdata = NULL;
+    // Initialize effects graph (chains and buses are sized for the device on open)
+    fx_graph = regroove_fx_graph_create(FX_GRAPH_CHAINS, common_state->sample_rate);
+    if (!fx_graph) {
+        fprintf(stderr, "Failed to initialize effects system\n");
+        return 1;
+    }
+    regroove_fx_graph_set_chain_bus(fx_graph, 0, REGROOVE_FX_BUS_PLAYBACK);  // Default: effects on playback
+    effects = regroove_fx_graph_get_chain(fx_graph, fx_edit_chain);
+
+    // Initialize mixer (MIX panel volume/pan/mute)
+    mixer = regroove_mixer_create();
+    if (!mixer) {
+        fprintf(stderr, "Failed to initialize mixer\n");
+        return 1;
+    }
+
+    // Round-trip latency calibration (run from the settings panel)
+    latency_cal = regroove_latency_create();
+    if (!latency_cal) {
+        fprintf(stderr, "Failed to initialize latency calibration\n");
+        return 1;
+    }
+
+    // Disk recorder (rings and writer thread are set up when recording starts)
+    recorder = regroove_recorder_create();
+    if (!recorder) {
+        fprintf(stderr, "Failed to initialize recorder\n");
+        return 1;
+    }
+
+    // Cue/headphone bus (device opened below if configured)
+    cue_bus = regroove_cue_create(common_state->sample_rate);
+    if (!cue_bus) {
+        fprintf(stderr, "Failed to initialize cue bus\n");
+        return 1;
+    }
+
     // Open audio device (use selected device or NULL for default)
+    // Also stores the device ID and obtained sample rate in common state
     const char* device_name = NULL;
     if (selected_audio_device >= 0) {
         device_name = SDL_GetAudioDeviceName(selected_audio_device, 0);
     }
-    audio_device_id = SDL_OpenAudioDevice(device_name, 0, &spec, NULL, 0);
+    audio_device_id = open_audio_output_device(device_name);
     if (audio_device_id == 0) {
         fprintf(stderr, "SDL_OpenAudioDevice failed: %s\n", SDL_GetError());
         return 1;
     }
-    // Store audio device ID in common state for use by common functions
-    common_state->audio_device_id = audio_device_id;
 
     // Start audio device immediately (for input passthrough to work without playback)
     SDL_PauseAudioDevice(audio_device_id, 0);
     printf("Audio output device started (always active for input passthrough)\n");
+
+    // Reopen the cue output if one was configured
+    if (common_state->device_config.audio_cue_device >= 0) {
+        refresh_audio_devices();
+        int cue_index = common_state->device_config.audio_cue_device;
+        if (cue_index < (int)audio_device_names.size()) {
+            cue_device_id = open_cue_device(audio_device_names[cue_index].c_str());
+            if (cue_device_id > 0) {
+                selected_cue_device = cue_index;
+                SDL_PauseAudioDevice(cue_device_id, 0);
+            }
+        }
+    }
     // Initialize LCD display
     lcd_display = lcd_init(LCD_COLS, LCD_ROWS);
     if (!lcd_display) {
@@ -8251,13 +9806,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Initialize effects
-    effects = regroove_effects_create();
-    if (!effects) {
-        fprintf(stderr, "Failed to initialize effects system\n");
-        return 1;
-    }
-
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ApplyFlatBlackRedSkin();
@@ -8300,6 +9848,9 @@ int main(int argc, char* argv[]) {
     }
     bool running = true;
     while (running) {
+        update_latency_calibration();
+        regroove_cue_collect(cue_bus);
+        process_midi_input();
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
             ImGui_ImplSDL2_ProcessEvent(&e);
@@ -8324,20 +9875,15 @@ int main(int argc, char* argv[]) {
                     if (target_pitch < 0.25) target_pitch = 0.25;
                     if (target_pitch > 3.0) target_pitch = 3.0;
 
-                    // Only update pitch if change is significant (configurable threshold)
-                    // This prevents audible pitch shifts from minor MIDI tempo jitter
+                    // The clock tempo is already filtered by the receive loop, so follow it
+                    // continuously; the glide only rounds off steps when the clock relocks
                     double current_pitch = regroove_get_pitch(common_state->player);
-                    double pitch_diff = fabs(target_pitch - current_pitch);
-                    double pitch_change_percent = (pitch_diff / current_pitch) * 100.0;
-                    float threshold = common_state->device_config.midi_clock_sync_threshold;
-                    if (threshold < 0.1f) threshold = 0.1f;
-                    if (threshold > 5.0f) threshold = 5.0f;
-
-                    if (pitch_change_percent > threshold) {
-                        // Update pitch
-                        regroove_common_set_pitch(common_state, target_pitch);
+                    double new_pitch = current_pitch + (target_pitch - current_pitch) * 0.25;
+                    if (fabs(target_pitch - current_pitch) < 0.00001) new_pitch = target_pitch;
+                    if (new_pitch != current_pitch) {
+                        regroove_common_set_pitch(common_state, new_pitch);
                         // Update UI slider to reflect MIDI-controlled pitch
-                        pitch_slider = (float)(target_pitch - 1.0);
+                        pitch_slider = (float)(new_pitch - 1.0);
                     }
                 }
             }
@@ -8365,13 +9911,24 @@ int main(int argc, char* argv[]) {
         SDL_PauseAudioDevice(audio_input_device_id, 1);
         SDL_CloseAudioDevice(audio_input_device_id);
     }
+    close_cue_device();
 
     regroove_common_destroy(common_state);
 
     // Cleanup effects
-    if (effects) {
-        regroove_effects_destroy(effects);
+    if (fx_graph) {
+        regroove_fx_graph_destroy(fx_graph);
+        fx_graph = NULL;
+        effects = NULL;
     }
+    regroove_mixer_destroy(mixer);
+    mixer = NULL;
+    regroove_latency_destroy(latency_cal);
+    latency_cal = NULL;
+    regroove_cue_destroy(cue_bus);
+    cue_bus = NULL;
+    regroove_recorder_destroy(recorder);  // Finalizes a running recording
+    recorder = NULL;
 
     // Cleanup LCD display
     if (lcd_display) {
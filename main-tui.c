@@ -10,6 +10,7 @@
 #include "midi.h"
 #include "midi_output.h"
 #include "regroove_effects.h"
+#include "regroove_mixer.h"
 
 static volatile int running = 1;
 static struct termios orig_termios;
@@ -24,6 +25,7 @@ static int midi_output_enabled = 0;
 
 // Effects state
 static RegrooveEffects* effects = NULL;
+static RegrooveMixer* mixer = NULL;
 
 // No local phrase state needed - using phrase engine via common_state
 
@@ -89,10 +91,6 @@ static void update_phrases() {
 // --- CALLBACKS for UI feedback ---
 static void my_order_callback(int order, int pattern, void *userdata) {
     printf("[ORDER] Now at Order %d (Pattern %d)\n", order, pattern);
-    // Reset program change tracking so programs are resent at pattern boundaries
-    if (midi_output_enabled) {
-        midi_output_reset_programs();
-    }
 }
 static void my_row_callback(int order, int row, void *userdata) {
     //printf("[ROW] Order %d, Row %d\n", order, row);
@@ -136,57 +134,102 @@ static void my_row_callback(int order, int row, void *userdata) {
 static void my_loop_callback(int order, int pattern, void *userdata) {
     printf("[LOOP] Pattern looped at Order %d (Pattern %d)\n", order, pattern);
     (void)userdata;
-    // Reset program change tracking on loop retrigger
-    if (midi_output_enabled) {
-        midi_output_reset_programs();
-    }
 }
 
 static void my_song_callback(void *userdata) {
     printf("[SONG] looped back to start\n");
 }
 
-static void my_note_callback(int channel, int note, int instrument, int volume,
-                             int effect_cmd, int effect_param, void *userdata) {
-    (void)userdata;
-    if (!midi_output_enabled) return;
-
+// Send a pattern note event to MIDI output, for a row `delay` seconds into the block
+static void send_midi_note_event(int channel, int note, int instrument, int volume,
+                                 int effect_cmd, int effect_param, double delay) {
     // Check for note-off effect commands (0FFF or EC0)
     if (effect_cmd == 0x0F && effect_param == 0xFF) {
         // 0FFF = Note OFF in OctaMED
-        midi_output_stop_channel(channel);
+        midi_output_stop_channel_at(channel, delay);
         return;
     }
     if (effect_cmd == 0x0E && effect_param == 0xC0) {
         // EC0 = Note cut
-        midi_output_stop_channel(channel);
+        midi_output_stop_channel_at(channel, delay);
         return;
     }
 
     // Handle note events
     if (note == -2) {
         // Explicit note-off (=== or OFF in pattern)
-        midi_output_stop_channel(channel);
+        midi_output_stop_channel_at(channel, delay);
     } else if (note >= 0) {
         // New note triggered
         // Use default volume if not specified
         int vel = (volume >= 0) ? volume : 64;
-        midi_output_handle_note(channel, note, instrument, vel);
+        midi_output_handle_note_at(channel, note, instrument, vel, delay);
     }
 }
 
+static void my_note_callback(int channel, int note, int instrument, int volume,
+                             int effect_cmd, int effect_param, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+
+    // With the note lookahead on, notes were already sent by my_note_ahead_callback
+    if (common_state && common_state->player && regroove_get_note_lookahead(common_state->player) > 0.0) return;
+
+    send_midi_note_event(channel, note, instrument, volume, effect_cmd, effect_param, 0.0);
+}
+
+// Notes reported ahead of their row (MIDI output latency compensation)
+static void my_note_ahead_callback(int channel, int note, int instrument, int volume,
+                                   int effect_cmd, int effect_param, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    send_midi_note_event(channel, note, instrument, volume, effect_cmd, effect_param, delay);
+}
+
+static void my_note_cancel_callback(uint64_t channels, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    midi_output_cancel_notes(channels, delay);
+}
+
+// Before each row's notes: program changes for the next order go out once a MIDI
+// channel is done with this one
+static void my_note_row_callback(int order, int row, int next_order, double delay, void *userdata) {
+    (void)userdata;
+    if (!midi_output_enabled) return;
+    midi_output_prepare_programs(order, row, next_order, delay);
+}
+
 // --- SDL audio callback ---
 static void audio_callback(void *userdata, Uint8 *stream, int len) {
     (void)userdata;
     if (!common_state || !common_state->player) return;
     int16_t *buffer = (int16_t *)stream;
     int frames = len / (2 * sizeof(int16_t));
+
+    // Notes triggered while rendering go out when this block is heard
+    if (midi_output_enabled) {
+        midi_output_begin_block(frames, common_state->sample_rate);
+        // Tick length for note lengths in ticks/rows (effective BPM)
+        double bpm = regroove_get_current_bpm(common_state->player) / regroove_get_pitch(common_state->player) *
+                     regroove_get_tempo_nudge(common_state->player);
+        midi_output_set_tick_time(bpm > 0.0 ? 2.5 / bpm : 0.0, regroove_get_current_speed(common_state->player));
+    }
     regroove_render_audio(common_state->player, buffer, frames);
 
-    // Apply effects if available
+    // Apply effects if available (tempo is the effective BPM, see pitch handling in the engine)
     if (effects) {
-        regroove_effects_process(effects, buffer, frames, 48000);
+        regroove_effects_set_tempo(effects, regroove_get_current_bpm(common_state->player) /
+                                            regroove_get_pitch(common_state->player));
+        regroove_effects_set_sidechain_key(effects, regroove_get_sidechain_level(common_state->player));
+        regroove_effects_process(effects, buffer, frames);
     }
+
+    // Playback and master volume/pan/mute in one pass. The TUI has always played at
+    // unity, so its strips use the balance law (0 dB when centred) rather than the
+    // GUI's mixer_pan_law; untouched, the pass is skipped
+    regroove_mixer_set_pan_law(mixer, REGROOVE_MIXER_PAN_BALANCE);
+    regroove_mixer_process(mixer, buffer, NULL, frames, 1);
 }
 
 // --- Only one set of global callbacks ---
@@ -216,13 +259,16 @@ static int load_module(const char *path, struct RegrooveCallbacks *cbs) {
         regroove_effects_set_filter_enabled(effects, 0);
         regroove_effects_set_eq_enabled(effects, 0);
         regroove_effects_set_compressor_enabled(effects, 0);
+        regroove_effects_set_multiband_enabled(effects, 0);
         regroove_effects_set_delay_enabled(effects, 0);
+        regroove_effects_set_convolution_enabled(effects, 0);
 
         // Reset all parameters to defaults from config
         regroove_effects_set_distortion_drive(effects, common_state->device_config.fx_distortion_drive);
         regroove_effects_set_distortion_mix(effects, common_state->device_config.fx_distortion_mix);
         regroove_effects_set_filter_cutoff(effects, common_state->device_config.fx_filter_cutoff);
         regroove_effects_set_filter_resonance(effects, common_state->device_config.fx_filter_resonance);
+        regroove_effects_set_filter_mode(effects, REGROOVE_FX_FILTER_LOWPASS);
         regroove_effects_set_eq_low(effects, common_state->device_config.fx_eq_low);
         regroove_effects_set_eq_mid(effects, common_state->device_config.fx_eq_mid);
         regroove_effects_set_eq_high(effects, common_state->device_config.fx_eq_high);
@@ -234,11 +280,17 @@ static int load_module(const char *path, struct RegrooveCallbacks *cbs) {
         regroove_effects_set_delay_time(effects, common_state->device_config.fx_delay_time);
         regroove_effects_set_delay_feedback(effects, common_state->device_config.fx_delay_feedback);
         regroove_effects_set_delay_mix(effects, common_state->device_config.fx_delay_mix);
+        regroove_effects_set_convolution_mix(effects, common_state->device_config.fx_convolution_mix);
+
+        // Impulse response from the .rgx (or config default), loaded in the background
+        char ir_path[COMMON_MAX_PATH];
+        regroove_common_get_convolution_ir(common_state, ir_path, sizeof(ir_path));
+        regroove_effects_load_convolution_ir(effects, ir_path);
     }
 
-    // Set metadata for MIDI output (for channel mapping)
+    // Set metadata for MIDI output (for channel mapping and the program schedule)
     if (common_state && common_state->metadata) {
-        midi_output_set_metadata(common_state->metadata);
+        regroove_common_apply_midi_mapping(common_state);
     }
 
     printf("\nPlayback paused (press SPACE or MIDI Play to start)\n");
@@ -557,6 +609,20 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_compressor_ratio(effects, value / 127.0f);
             }
             break;
+        case ACTION_FX_MB_LOW_THRESHOLD:
+        case ACTION_FX_MB_MID_THRESHOLD:
+        case ACTION_FX_MB_HIGH_THRESHOLD:
+            if (effects) {
+                regroove_effects_set_multiband_threshold(effects, action - ACTION_FX_MB_LOW_THRESHOLD, value / 127.0f);
+            }
+            break;
+        case ACTION_FX_MB_LOW_GAIN:
+        case ACTION_FX_MB_MID_GAIN:
+        case ACTION_FX_MB_HIGH_GAIN:
+            if (effects) {
+                regroove_effects_set_multiband_gain(effects, action - ACTION_FX_MB_LOW_GAIN, value / 127.0f);
+            }
+            break;
         case ACTION_FX_DELAY_TIME:
             if (effects) {
                 regroove_effects_set_delay_time(effects, value / 127.0f);
@@ -572,6 +638,16 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 regroove_effects_set_delay_mix(effects, value / 127.0f);
             }
             break;
+        case ACTION_FX_DUCKER_DEPTH:
+            if (effects) {
+                regroove_effects_set_ducker_depth(effects, value / 127.0f);
+            }
+            break;
+        case ACTION_FX_CONVOLUTION_MIX:
+            if (effects) {
+                regroove_effects_set_convolution_mix(effects, value / 127.0f);
+            }
+            break;
         case ACTION_FX_DISTORTION_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_distortion_enabled(effects);
@@ -586,6 +662,13 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 printf("Filter: %s\n", enabled ? "OFF" : "ON");
             }
             break;
+        case ACTION_FX_FILTER_MODE:
+            if (effects) {
+                int mode = (regroove_effects_get_filter_mode(effects) + 1) % REGROOVE_FX_FILTER_MODE_COUNT;
+                regroove_effects_set_filter_mode(effects, mode);
+                printf("Filter mode: %s\n", regroove_effects_filter_mode_name(mode));
+            }
+            break;
         case ACTION_FX_EQ_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_eq_enabled(effects);
@@ -600,6 +683,13 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 printf("Compressor: %s\n", enabled ? "OFF" : "ON");
             }
             break;
+        case ACTION_FX_MULTIBAND_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_multiband_enabled(effects);
+                regroove_effects_set_multiband_enabled(effects, !enabled);
+                printf("Multiband compressor: %s\n", enabled ? "OFF" : "ON");
+            }
+            break;
         case ACTION_FX_DELAY_TOGGLE:
             if (effects) {
                 int enabled = regroove_effects_get_delay_enabled(effects);
@@ -607,6 +697,56 @@ static void execute_action(InputAction action, int parameter, float value, void*
                 printf("Delay: %s\n", enabled ? "OFF" : "ON");
             }
             break;
+        case ACTION_FX_DELAY_SYNC_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_delay_sync(effects);
+                regroove_effects_set_delay_sync(effects, !enabled);
+                printf("Delay sync: %s\n", enabled ? "OFF" : "ON");
+            }
+            break;
+        case ACTION_FX_DUCKER_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_ducker_enabled(effects);
+                regroove_effects_set_ducker_enabled(effects, !enabled);
+                printf("Ducker: %s\n", enabled ? "OFF" : "ON");
+            }
+            break;
+        case ACTION_FX_CONVOLUTION_TOGGLE:
+            if (effects) {
+                int enabled = regroove_effects_get_convolution_enabled(effects);
+                regroove_effects_set_convolution_enabled(effects, !enabled);
+                if (!enabled && !regroove_effects_get_convolution_ir_loaded(effects) &&
+                    !regroove_effects_get_convolution_ir_loading(effects)) {
+                    printf("Convolution: ON (no impulse response loaded)\n");
+                } else {
+                    printf("Convolution: %s\n", enabled ? "OFF" : "ON");
+                }
+            }
+            break;
+        case ACTION_MASTER_VOLUME:
+            regroove_mixer_set_volume(mixer, REGROOVE_MIXER_MASTER, value / 127.0f);
+            break;
+        case ACTION_PLAYBACK_VOLUME:
+            regroove_mixer_set_volume(mixer, REGROOVE_MIXER_PLAYBACK, value / 127.0f);
+            break;
+        case ACTION_MASTER_PAN:
+            regroove_mixer_set_pan(mixer, REGROOVE_MIXER_MASTER, value / 127.0f);
+            break;
+        case ACTION_PLAYBACK_PAN:
+            regroove_mixer_set_pan(mixer, REGROOVE_MIXER_PLAYBACK, value / 127.0f);
+            break;
+        case ACTION_MASTER_MUTE: {
+            int mute = !regroove_mixer_get_mute(mixer, REGROOVE_MIXER_MASTER);
+            regroove_mixer_set_mute(mixer, REGROOVE_MIXER_MASTER, mute);
+            printf("Master: %s\n", mute ? "MUTED" : "UNMUTED");
+            break;
+        }
+        case ACTION_PLAYBACK_MUTE: {
+            int mute = !regroove_mixer_get_mute(mixer, REGROOVE_MIXER_PLAYBACK);
+            regroove_mixer_set_mute(mixer, REGROOVE_MIXER_PLAYBACK, mute);
+            printf("Playback: %s\n", mute ? "MUTED" : "UNMUTED");
+            break;
+        }
         default:
             break;
     }
@@ -644,69 +784,36 @@ void my_midi_mapping(unsigned char status, unsigned char cc_or_note, unsigned ch
 
     unsigned char msg_type = status & 0xF0;
 
-    // Handle Note-On messages for trigger pads
+    // Handle Note-On messages for trigger pads (application pads A1-A16, then song pads S1-S16)
     if (msg_type == 0x90 && value > 0) { // Note-On with velocity > 0
-        int note = cc_or_note;
-        int triggered = 0;
-
-        // Check application trigger pads (A1-A16)
         if (common_state && common_state->input_mappings) {
-            for (int i = 0; i < MAX_TRIGGER_PADS; i++) {
-                TriggerPadConfig *pad = &common_state->input_mappings->trigger_pads[i];
-                // Skip if disabled
-                if (pad->midi_device == -2) continue;
-
-                // Match device (if specified) and note
-                if (pad->midi_note == note &&
-                    (pad->midi_device == -1 || pad->midi_device == device_id)) {
-
-                    // Execute the configured action
-                    if (pad->action != ACTION_NONE) {
-                        InputEvent event;
-                        event.action = pad->action;
-                        event.parameter = pad->parameter;
-                        event.value = value;
-                        handle_input_event(&event);
-                    }
-                    triggered = 1;
-                    break; // Only trigger the first matching pad
-                }
-            }
-        }
-
-        // If not triggered by application pad, check song trigger pads (S1-S16)
-        if (!triggered && common_state && common_state->metadata) {
-            for (int i = 0; i < MAX_SONG_TRIGGER_PADS; i++) {
-                TriggerPadConfig *pad = &common_state->metadata->song_trigger_pads[i];
-                // Skip if disabled
-                if (pad->midi_device == -2) continue;
-
-                // Match device (if specified) and note
-                if (pad->midi_note == note &&
-                    (pad->midi_device == -1 || pad->midi_device == device_id)) {
-
-                    // Execute the configured action
-                    if (pad->action != ACTION_NONE) {
-                        InputEvent event;
-                        event.action = pad->action;
-                        event.parameter = pad->parameter;
-                        event.value = value;
-                        handle_input_event(&event);
-                    }
-                    break; // Only trigger the first matching pad
+            const int *pads;
+            int count = input_mappings_find_note_pads(common_state->input_mappings, device_id, cc_or_note, &pads);
+            for (int i = 0; i < count; i++) {
+                const TriggerPadConfig *pad = (pads[i] < MAX_TRIGGER_PADS)
+                    ? &common_state->input_mappings->trigger_pads[pads[i]]
+                    : &common_state->metadata->song_trigger_pads[pads[i] - MAX_TRIGGER_PADS];
+
+                // Execute the configured action
+                if (pad->action != ACTION_NONE) {
+                    InputEvent event;
+                    event.action = pad->action;
+                    event.parameter = pad->parameter;
+                    event.value = value;
+                    handle_input_event(&event);
                 }
             }
         }
         return;
     }
 
-    // Handle Control Change messages for input mappings
-    if (msg_type == 0xB0) {
-        // Query input mappings
-        InputEvent event;
-        if (common_state && common_state->input_mappings &&
-            input_mappings_get_midi_event(common_state->input_mappings, device_id, cc_or_note, value, &event)) {
-            handle_input_event(&event);
+    // Handle Control Change messages for input mappings (every action bound to the CC)
+    if (msg_type == 0xB0 && common_state && common_state->input_mappings) {
+        InputEvent events[INPUT_MAPPINGS_MAX_BINDINGS];
+        int count = input_mappings_get_midi_events(common_state->input_mappings, device_id, cc_or_note, value,
+                                                   events, INPUT_MAPPINGS_MAX_BINDINGS);
+        for (int i = 0; i < count; i++) {
+            handle_input_event(&events[i]);
         }
     }
 }
@@ -815,6 +922,9 @@ int main(int argc, char *argv[]) {
         .on_loop_pattern = my_loop_callback,
         .on_loop_song = my_song_callback,
         .on_note = my_note_callback,
+        .on_note_ahead = my_note_ahead_callback,
+        .on_note_cancel = my_note_cancel_callback,
+        .on_note_row = my_note_row_callback,
         .userdata = NULL
     };
     global_cbs = cbs;
@@ -826,9 +936,9 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    SDL_AudioSpec spec;
+    SDL_AudioSpec spec, obtained;
     SDL_zero(spec);
-    spec.freq = 48000;
+    spec.freq = common_state->sample_rate;
     spec.format = AUDIO_S16SYS;
     spec.channels = 2;
     spec.samples = 256;
@@ -842,7 +952,7 @@ int main(int argc, char *argv[]) {
     }
 
     // Initialize effects
-    effects = regroove_effects_create();
+    effects = regroove_effects_create(common_state->sample_rate);
     if (!effects) {
         fprintf(stderr, "Failed to initialize effects system\n");
         regroove_common_destroy(common_state);
@@ -850,13 +960,23 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    // Initialize mixer (master/playback volume, pan and mute)
+    mixer = regroove_mixer_create();
+    if (!mixer) {
+        fprintf(stderr, "Failed to initialize mixer\n");
+        regroove_effects_destroy(effects);
+        regroove_common_destroy(common_state);
+        SDL_Quit();
+        return 1;
+    }
+
     // Open audio device (use selected device or NULL for default)
     const char* device_name = NULL;
     int selected_audio_device = common_state->device_config.audio_device;
     if (selected_audio_device >= 0) {
         device_name = SDL_GetAudioDeviceName(selected_audio_device, 0);
     }
-    audio_device_id = SDL_OpenAudioDevice(device_name, 0, &spec, NULL, 0);
+    audio_device_id = SDL_OpenAudioDevice(device_name, 0, &spec, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
     if (audio_device_id == 0) {
         fprintf(stderr, "SDL_OpenAudioDevice failed: %s\n", SDL_GetError());
         regroove_common_destroy(common_state);
@@ -865,6 +985,10 @@ int main(int argc, char *argv[]) {
     }
     // Store audio device ID in common state for use by common functions
     common_state->audio_device_id = audio_device_id;
+
+    // Run the engine and effects at the device's native rate (device is still paused)
+    regroove_common_set_sample_rate(common_state, obtained.freq);
+    regroove_effects_set_sample_rate(effects, obtained.freq);
     signal(SIGINT, handle_sigint);
 
     tty_make_raw_nonblocking();
@@ -905,13 +1029,17 @@ int main(int argc, char *argv[]) {
     while (running) {
         int k = read_key_nonblocking();
         if (k != -1) {
-            // Query input mappings for keyboard event
-            InputEvent event;
-            if (common_state->input_mappings &&
-                input_mappings_get_keyboard_event(common_state->input_mappings, k, &event)) {
-                handle_input_event(&event);
+            // Query input mappings for keyboard events (every action bound to the key)
+            if (common_state->input_mappings) {
+                InputEvent events[INPUT_MAPPINGS_MAX_BINDINGS];
+                int count = input_mappings_get_keyboard_events(common_state->input_mappings, k, events, INPUT_MAPPINGS_MAX_BINDINGS);
+                for (int i = 0; i < count; i++) {
+                    handle_input_event(&events[i]);
+                }
             }
         }
+        // MIDI input queued since the last pass
+        midi_process_events();
         if (common_state->player) regroove_process_commands(common_state->player);
         SDL_Delay(10);
     }
@@ -930,6 +1058,7 @@ int main(int argc, char *argv[]) {
     if (effects) {
         regroove_effects_destroy(effects);
     }
+    regroove_mixer_destroy(mixer);
 
     SDL_Quit();
     return 0;
@@ -1,29 +1,69 @@
 #include "midi.h"
 #ifndef _WIN32
 #include <unistd.h>
-#include <sys/time.h>
 #else
 #include <windows.h>
 #endif
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
 #include <rtmidi_c.h>
+#include <SDL2/SDL.h>
 
 static RtMidiInPtr midiin[MIDI_MAX_DEVICES] = {NULL};
 static MidiEventCallback midi_cb = NULL;
 static void *cb_userdata = NULL;
 
-// MIDI Clock synchronization state
-static int clock_sync_enabled = 0;
-static double clock_bpm = 0.0;
-static double last_clock_time = 0.0;
-static int clock_pulse_count = 0;
+// Input event queues: one single-producer/single-consumer ring per device. The
+// producer is the device's RtMidi callback thread, the consumer whoever reads events
+// (see midi_read_event), so no application code runs on RtMidi's threads.
+#define MIDI_INPUT_QUEUE_SIZE 512   // Power of two
+
+typedef struct {
+    MidiInputEvent events[MIDI_INPUT_QUEUE_SIZE];
+    SDL_atomic_t head;              // Next slot to write (producer)
+    SDL_atomic_t tail;              // Next slot to read (consumer)
+} MidiInputQueue;
+
+static MidiInputQueue input_queue[MIDI_MAX_DEVICES];
+static SDL_atomic_t input_dropped;
+
+// MIDI Clock receive: a second-order delay-locked loop (DLL) follows the pulse
+// times of one source device. Pulse times come from RtMidi's per-message delta
+// timestamps, not from when the callback happened to run, so scheduling jitter on
+// our side does not reach the tempo estimate.
+#define CLOCK_DLL_BANDWIDTH_LOCKING 2.0   // Hz, for the first beats after (re)lock
+#define CLOCK_DLL_BANDWIDTH 0.5           // Hz, once locked
+#define CLOCK_LOCKING_PULSES 48
+#define CLOCK_OUTLIER_FRACTION 0.5        // |error| above this part of a period is an outlier
+#define CLOCK_MAX_OUTLIERS 6              // In a row: the tempo jumped, lock again
+#define CLOCK_MAX_MISSED_PULSES 4         // Dropped pulses bridged without relocking
+#define CLOCK_MISSED_TOLERANCE 0.1        // Part of a period a bridged pulse may be off
+#define CLOCK_TIMEOUT 1.0                 // Seconds without pulses: clock stopped
+#define CLOCK_MIN_PERIOD 0.0025           // 1000 BPM
+#define CLOCK_MAX_PERIOD 0.125            // 20 BPM
+#define CLOCK_PI 3.14159265358979323846
 
-// Fixed-size circular buffer for interval averaging
-#define INTERVAL_BUFFER_SIZE 24  // Average over one beat
-static double interval_buffer[INTERVAL_BUFFER_SIZE];
-static int interval_buffer_index = 0;
-static int interval_buffer_filled = 0;
+static int clock_sync_enabled = 0;
+static SDL_SpinLock clock_lock = 0;       // Guards the state below (RtMidi threads, readers)
+static int clock_source = -1;             // Device the DLL follows, -1 = none
+static int clock_dll_state = 0;           // 0 = idle, 1 = first pulse seen, 2 = locked
+static double clock_t0 = 0.0;             // Filtered time of the last pulse (device timeline)
+static double clock_t1 = 0.0;             // Predicted time of the next pulse
+static double clock_period = 0.0;         // Filtered pulse period (seconds)
+static int clock_locked_pulses = 0;
+static int clock_outliers = 0;
+static double clock_last_wall = 0.0;      // midi_now() of the last pulse
+static int clock_running = 0;             // Between Start/Continue and Stop
+static int clock_position_valid = 0;      // Start or SPP seen, song_pulse is meaningful
+static long clock_song_pulse = 0;         // Pulses since Start (position of the last pulse)
+
+// Per-device timeline: the first message is placed at the wall time, later ones at
+// the previous message plus RtMidi's delta. offset maps it back onto midi_now().
+static double device_time[MIDI_MAX_DEVICES];
+static double device_offset[MIDI_MAX_DEVICES];
+static int device_time_started[MIDI_MAX_DEVICES];
 
 #define MIDI_CLOCK 0xF8
 #define MIDI_START 0xFA
@@ -36,8 +76,12 @@ static int transport_control_enabled = 0;
 static MidiTransportCallback transport_cb = NULL;
 static void *transport_userdata = NULL;
 
-// Get current time in microseconds
-static double get_time_us(void) {
+// SPP (Song Position Pointer) callback - for position sync
+static MidiSPPCallback spp_cb = NULL;
+static void *spp_userdata = NULL;
+
+// Monotonic time in seconds
+static double midi_now(void) {
 #ifdef _WIN32
     static LARGE_INTEGER frequency = {0};
     LARGE_INTEGER counter;
@@ -48,79 +92,174 @@ static double get_time_us(void) {
     }
 
     QueryPerformanceCounter(&counter);
-    return (double)counter.QuadPart * 1000000.0 / (double)frequency.QuadPart;
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
 #else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (double)tv.tv_sec * 1000000.0 + (double)tv.tv_usec;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
 #endif
 }
 
-// Process MIDI Clock message (0xF8)
-static void process_midi_clock(void) {
-    double current_time = get_time_us();
+// Advance a device's timeline for a received message and return the message time
+static double device_message_time(int device_id, double dt, double now) {
+    if (!device_time_started[device_id] || dt < 0.0 || dt > CLOCK_TIMEOUT) {
+        // First message, or a delta too old to trust: start again from the wall clock
+        device_time[device_id] = now;
+        device_offset[device_id] = 0.0;
+        device_time_started[device_id] = 1;
+        return now;
+    }
+    device_time[device_id] += dt;
 
-    // Always process clock for visual indication, even if sync is disabled
-    // If this is not the first pulse, calculate interval
-    if (clock_pulse_count > 0) {
-        double interval = current_time - last_clock_time;
-
-        // Ignore unrealistic intervals (< 1ms or > 1 second)
-        if (interval > 1000.0 && interval < 1000000.0) {
-            // Add to circular buffer
-            interval_buffer[interval_buffer_index] = interval;
-            interval_buffer_index = (interval_buffer_index + 1) % INTERVAL_BUFFER_SIZE;
-
-            // Mark buffer as filled once we've wrapped around
-            if (interval_buffer_index == 0) {
-                interval_buffer_filled = 1;
-            }
-
-            // Calculate average from buffer
-            int count = interval_buffer_filled ? INTERVAL_BUFFER_SIZE : interval_buffer_index;
-            double sum = 0.0;
-            for (int i = 0; i < count; i++) {
-                sum += interval_buffer[i];
-            }
-            double avg_interval = sum / count;
-
-            // Calculate BPM from average pulse interval
-            // BPM = 60,000,000 microseconds/minute / (avg_interval * 24 pulses/beat)
-            clock_bpm = 60000000.0 / (avg_interval * PULSES_PER_QUARTER_NOTE);
+    // The callback never runs before the message arrived, so the smallest offset
+    // seen is the best one; creep up slowly to follow drift between the clocks
+    double offset = now - device_time[device_id];
+    if (offset < device_offset[device_id]) {
+        device_offset[device_id] = offset;
+    } else {
+        device_offset[device_id] += (offset - device_offset[device_id]) * 0.01;
+    }
+    return device_time[device_id];
+}
+
+static void clock_relock(double t) {
+    clock_dll_state = 1;
+    clock_t0 = t;
+    clock_locked_pulses = 0;
+    clock_outliers = 0;
+}
+
+// One DLL step for a pulse at time t (clock_lock held, on an RtMidi thread: no I/O,
+// the audio callback spins on the lock to read the clock)
+static void clock_dll_update(double t) {
+    if (clock_dll_state == 0 || t - clock_t0 > CLOCK_TIMEOUT) {
+        clock_relock(t);
+        return;
+    }
 
+    if (clock_dll_state == 1) {
+        // Second pulse: the first interval seeds the loop
+        double interval = t - clock_t0;
+        if (interval < CLOCK_MIN_PERIOD || interval > CLOCK_MAX_PERIOD) {
+            clock_relock(t);
+            return;
         }
-    } else {
-        printf("[MIDI Clock] First pulse received\n");
+        clock_period = interval;
+        clock_t0 = t;
+        clock_t1 = t + interval;
+        clock_dll_state = 2;
+        return;
     }
 
-    // Update state
-    last_clock_time = current_time;
-    clock_pulse_count++;
+    double e = t - clock_t1;
+
+    // A pulse whole periods late: the ones in between were dropped on the way
+    int missed = (int)floor(e / clock_period + 0.5);
+    if (missed >= 1 && missed <= CLOCK_MAX_MISSED_PULSES &&
+        fabs(e - missed * clock_period) < clock_period * CLOCK_MISSED_TOLERANCE) {
+        clock_t1 += missed * clock_period;
+        clock_song_pulse += missed;
+        e -= missed * clock_period;
+    }
+
+    if (fabs(e) > clock_period * CLOCK_OUTLIER_FRACTION) {
+        // Late delivery or a tempo jump: coast on the prediction, relock if it persists
+        if (++clock_outliers >= CLOCK_MAX_OUTLIERS) {
+            clock_relock(t);
+            return;
+        }
+        clock_t0 = clock_t1;
+        clock_t1 += clock_period;
+        return;
+    }
+    clock_outliers = 0;
+
+    // Critically damped second-order loop, bandwidth relative to the pulse rate
+    double bandwidth = clock_locked_pulses < CLOCK_LOCKING_PULSES ? CLOCK_DLL_BANDWIDTH_LOCKING : CLOCK_DLL_BANDWIDTH;
+    double omega = 2.0 * CLOCK_PI * bandwidth * clock_period;
+    double b = sqrt(2.0) * omega;
+    double c = omega * omega;
+
+    clock_t0 = clock_t1;
+    clock_t1 += b * e + clock_period;
+    clock_period += c * e;
+    if (clock_period < CLOCK_MIN_PERIOD) clock_period = CLOCK_MIN_PERIOD;
+    if (clock_period > CLOCK_MAX_PERIOD) clock_period = CLOCK_MAX_PERIOD;
+    if (clock_locked_pulses < CLOCK_LOCKING_PULSES) clock_locked_pulses++;
 }
 
-// SPP (Song Position Pointer) callback - for position sync
-typedef void (*MidiSPPCallback)(int position, void* userdata);
-static MidiSPPCallback spp_cb = NULL;
-static void *spp_userdata = NULL;
+// Process MIDI Clock message (0xF8)
+static void process_midi_clock(int device_id, double t, double now) {
+    // Always process clock for visual indication, even if sync is disabled
+    SDL_AtomicLock(&clock_lock);
+
+    // Follow one device; another one takes over when it stops sending
+    if (clock_source != device_id && clock_source >= 0 && now - clock_last_wall < CLOCK_TIMEOUT) {
+        SDL_AtomicUnlock(&clock_lock);
+        return;
+    }
+    if (clock_source != device_id) {
+        clock_source = device_id;
+        clock_dll_state = 0;
+    }
+
+    clock_dll_update(t);
+    clock_last_wall = now;
+    if (clock_running) clock_song_pulse++;
+
+    SDL_AtomicUnlock(&clock_lock);
+}
+
+// Transport messages move the song position the clock pulses count from
+static void process_midi_transport(unsigned char status) {
+    SDL_AtomicLock(&clock_lock);
+    if (status == MIDI_START) {
+        // The first pulse after Start is the first beat of the song
+        clock_song_pulse = -1;
+        clock_position_valid = 1;
+        clock_running = 1;
+    } else if (status == MIDI_CONTINUE) {
+        clock_running = 1;
+    } else {
+        clock_running = 0;
+    }
+    SDL_AtomicUnlock(&clock_lock);
+}
 
-// Generic MIDI event handler
+// Queue an event for the consumer (RtMidi thread of the device only)
+static void queue_input_event(int device_id, double t, unsigned char status,
+                              unsigned char data1, unsigned char data2) {
+    MidiInputQueue *q = &input_queue[device_id];
+    int head = SDL_AtomicGet(&q->head);
+    if (head - SDL_AtomicGet(&q->tail) >= MIDI_INPUT_QUEUE_SIZE) {
+        SDL_AtomicAdd(&input_dropped, 1);
+        return;
+    }
+    MidiInputEvent *event = &q->events[head & (MIDI_INPUT_QUEUE_SIZE - 1)];
+    event->time = t + device_offset[device_id];  // Back onto midi_get_time()
+    event->device_id = device_id;
+    event->status = status;
+    event->data1 = data1;
+    event->data2 = data2;
+    SDL_AtomicSet(&q->head, head + 1);  // Publish
+}
+
+// Generic MIDI event handler (RtMidi thread): clock pulses feed the receive loop here,
+// everything else is queued with its timestamp
 static void handle_midi_event(int device_id, double dt, const unsigned char *msg, size_t sz) {
+    double now = midi_now();
+    double t = device_message_time(device_id, dt, now);
+
     // Handle single-byte system real-time messages
     if (sz == 1) {
         if (msg[0] == MIDI_CLOCK) {
-            process_midi_clock();
+            process_midi_clock(device_id, t, now);
             return;
         }
-        // Handle transport control messages
+        // Transport moves the clock position now, the callback runs from the queue
         if (msg[0] == MIDI_START || msg[0] == MIDI_STOP || msg[0] == MIDI_CONTINUE) {
-            const char* msg_name = (msg[0] == MIDI_START) ? "Start" :
-                                   (msg[0] == MIDI_STOP) ? "Stop" : "Continue";
-            printf("[MIDI Transport] Received %s (0x%02X) on device %d, control %s\n",
-                   msg_name, msg[0], device_id, transport_control_enabled ? "ENABLED" : "disabled");
-
-            if (transport_control_enabled && transport_cb) {
-                transport_cb(msg[0], transport_userdata);
-            }
+            process_midi_transport(msg[0]);
+            queue_input_event(device_id, t, msg[0], 0, 0);
             return;
         }
     }
@@ -128,6 +267,64 @@ static void handle_midi_event(int device_id, double dt, const unsigned char *msg
     // Handle 3-byte Song Position Pointer (0xF2 + LSB + MSB)
     if (sz == 3 && msg[0] == 0xF2) {
         int position = msg[1] | (msg[2] << 7);  // Combine 7-bit bytes
+
+        // One MIDI beat is a sixteenth (6 pulses); the next pulse plays at the position
+        SDL_AtomicLock(&clock_lock);
+        clock_song_pulse = (long)position * 6 - 1;
+        clock_position_valid = 1;
+        SDL_AtomicUnlock(&clock_lock);
+
+        queue_input_event(device_id, t, msg[0], msg[1], msg[2]);
+        return;
+    }
+
+    // Handle regular 3-byte messages (Note On/Off, CC)
+    if (sz >= 3) {
+        queue_input_event(device_id, t, msg[0], msg[1], msg[2]);
+    }
+}
+
+int midi_read_event(double until, MidiInputEvent *event) {
+    if (!event) return 0;
+
+    // Oldest event over all devices, so devices interleave in time order
+    MidiInputQueue *oldest = NULL;
+    for (int dev = 0; dev < MIDI_MAX_DEVICES; dev++) {
+        MidiInputQueue *q = &input_queue[dev];
+        int tail = SDL_AtomicGet(&q->tail);
+        if (SDL_AtomicGet(&q->head) == tail) continue;
+        MidiInputEvent *e = &q->events[tail & (MIDI_INPUT_QUEUE_SIZE - 1)];
+        if (e->time > until) continue;
+        if (!oldest || e->time < oldest->events[SDL_AtomicGet(&oldest->tail) & (MIDI_INPUT_QUEUE_SIZE - 1)].time) {
+            oldest = q;
+        }
+    }
+    if (!oldest) return 0;
+
+    int tail = SDL_AtomicGet(&oldest->tail);
+    *event = oldest->events[tail & (MIDI_INPUT_QUEUE_SIZE - 1)];
+    SDL_AtomicSet(&oldest->tail, tail + 1);  // Free the slot
+    return 1;
+}
+
+void midi_dispatch_event(const MidiInputEvent *event) {
+    if (!event) return;
+    unsigned char status = event->status;
+
+    if (status == MIDI_START || status == MIDI_STOP || status == MIDI_CONTINUE) {
+        const char* msg_name = (status == MIDI_START) ? "Start" :
+                               (status == MIDI_STOP) ? "Stop" : "Continue";
+        printf("[MIDI Transport] Received %s (0x%02X) on device %d, control %s\n",
+               msg_name, status, event->device_id, transport_control_enabled ? "ENABLED" : "disabled");
+
+        if (transport_control_enabled && transport_cb) {
+            transport_cb(status, transport_userdata);
+        }
+        return;
+    }
+
+    if (status == 0xF2) {
+        int position = event->data1 | (event->data2 << 7);
         printf("[MIDI SPP] Received Song Position: %d MIDI beats\n", position);
         if (spp_cb) {
             spp_cb(position, spp_userdata);
@@ -135,12 +332,30 @@ static void handle_midi_event(int device_id, double dt, const unsigned char *msg
         return;
     }
 
-    // Handle regular 3-byte messages (Note On/Off, CC)
-    if (midi_cb && sz >= 3) {
-        midi_cb(msg[0], msg[1], msg[2], device_id, cb_userdata);
+    if (midi_cb) {
+        midi_cb(status, event->data1, event->data2, event->device_id, cb_userdata);
     }
 }
 
+int midi_process_events(void) {
+    MidiInputEvent event;
+    int count = 0;
+    double now = midi_now();
+    while (midi_read_event(now, &event)) {
+        midi_dispatch_event(&event);
+        count++;
+    }
+    return count;
+}
+
+double midi_get_time(void) {
+    return midi_now();
+}
+
+int midi_get_dropped_events(void) {
+    return SDL_AtomicGet(&input_dropped);
+}
+
 // Device-specific callback wrappers
 static void rtmidi_event_callback_0(double dt, const unsigned char *msg, size_t sz, void *userdata) {
     handle_midi_event(0, dt, msg, sz);
@@ -203,6 +418,9 @@ int midi_init_multi(MidiEventCallback cb, void *userdata, const int *ports, int
     midi_cb = cb;
     cb_userdata = userdata;
 
+    // The queues are left as they are: the consumer may still be reading them
+    SDL_AtomicSet(&input_dropped, 0);
+
     int opened = 0;
     RtMidiCCallback callbacks[MIDI_MAX_DEVICES] = {rtmidi_event_callback_0, rtmidi_event_callback_1, rtmidi_event_callback_2};
 
@@ -253,17 +471,61 @@ int midi_is_clock_sync_enabled(void) {
     return clock_sync_enabled;
 }
 
+// Clock is locked and still arriving (clock_lock held)
+static int clock_is_locked(double now) {
+    return clock_dll_state == 2 && now - clock_last_wall < CLOCK_TIMEOUT;
+}
+
 double midi_get_clock_tempo(void) {
-    return clock_bpm;
+    double now = midi_now();
+    double bpm = 0.0;
+    SDL_AtomicLock(&clock_lock);
+    if (clock_is_locked(now)) {
+        bpm = 60.0 / (clock_period * PULSES_PER_QUARTER_NOTE);
+    }
+    SDL_AtomicUnlock(&clock_lock);
+    return bpm;
+}
+
+double midi_get_clock_beats(void) {
+    double now = midi_now();
+    double beats = -1.0;
+    SDL_AtomicLock(&clock_lock);
+    if (clock_is_locked(now) && clock_position_valid) {
+        double pulses = (double)clock_song_pulse;
+        if (clock_running && clock_song_pulse >= 0) {
+            // Interpolate from the filtered time of the last pulse, on the source's timeline
+            double t = now - device_offset[clock_source];
+            double fraction = (t - clock_t0) / clock_period;
+            if (fraction < 0.0) fraction = 0.0;
+            if (fraction > 1.0) fraction = 1.0;
+            pulses += fraction;
+        }
+        if (pulses < 0.0) pulses = 0.0;
+        beats = pulses / PULSES_PER_QUARTER_NOTE;
+    }
+    SDL_AtomicUnlock(&clock_lock);
+    return beats;
+}
+
+double midi_get_clock_beat_phase(void) {
+    double beats = midi_get_clock_beats();
+    return beats >= 0.0 ? beats - floor(beats) : -1.0;
 }
 
 void midi_reset_clock(void) {
-    clock_bpm = 0.0;
-    clock_pulse_count = 0;
-    last_clock_time = 0.0;
-    interval_buffer_index = 0;
-    interval_buffer_filled = 0;
-    memset(interval_buffer, 0, sizeof(interval_buffer));
+    SDL_AtomicLock(&clock_lock);
+    clock_source = -1;
+    clock_dll_state = 0;
+    clock_period = 0.0;
+    clock_locked_pulses = 0;
+    clock_outliers = 0;
+    clock_last_wall = 0.0;
+    clock_running = 0;
+    clock_position_valid = 0;
+    clock_song_pulse = 0;
+    memset(device_time_started, 0, sizeof(device_time_started));
+    SDL_AtomicUnlock(&clock_lock);
 }
 
 void midi_set_transport_control_enabled(int enabled) {
@@ -10,6 +10,15 @@ extern "C" {
 
 typedef void (*MidiEventCallback)(unsigned char status, unsigned char data1, unsigned char data2, int device_id, void *userdata);
 
+// Received MIDI event, timestamped from RtMidi's message deltas
+typedef struct {
+    double time;            // Arrival time in seconds, on the midi_get_time() clock
+    int device_id;
+    unsigned char status;   // Channel message, Start/Stop/Continue (0xFA/0xFC/0xFB) or SPP (0xF2)
+    unsigned char data1;
+    unsigned char data2;
+} MidiInputEvent;
+
 /**
  * Initialize MIDI input and set the event callback.
  * Returns 0 on success, -1 on failure.
@@ -24,6 +33,40 @@ int midi_init(MidiEventCallback cb, void *userdata, int port);
  */
 int midi_init_multi(MidiEventCallback cb, void *userdata, const int *ports, int num_ports);
 
+/**
+ * Received events are not handled on RtMidi's threads: each device queues them
+ * (lock-free, single producer/single consumer) and one consumer thread reads them.
+ * The event, transport and SPP callbacks run on that thread, from midi_dispatch_event().
+ */
+
+/**
+ * Take the oldest queued event (over all devices) that arrived at or before `until`
+ * (midi_get_time() seconds). Only one thread may read events.
+ * Returns 1 if an event was read, 0 if none is due.
+ */
+int midi_read_event(double until, MidiInputEvent *event);
+
+/**
+ * Run the registered callback for an event read with midi_read_event()
+ * (the event callback, or the transport/SPP callbacks).
+ */
+void midi_dispatch_event(const MidiInputEvent *event);
+
+/**
+ * Read and dispatch every event received so far. Returns the number of events.
+ */
+int midi_process_events(void);
+
+/**
+ * Current time on the clock event timestamps use (seconds, monotonic).
+ */
+double midi_get_time(void);
+
+/**
+ * Events dropped because a device queue was full (since init).
+ */
+int midi_get_dropped_events(void);
+
 /**
  * Deinitialize MIDI input.
  */
@@ -59,10 +102,24 @@ int midi_is_clock_sync_enabled(void);
 
 /**
  * Get the tempo calculated from incoming MIDI Clock messages.
+ * The pulse times are tracked by a delay-locked loop, so the value changes smoothly.
  * Returns BPM as a double, or 0.0 if no clock is being received.
  */
 double midi_get_clock_tempo(void);
 
+/**
+ * Get the external song position in beats (quarter notes) since MIDI Start,
+ * or since the last Song Position Pointer, interpolated to the current time.
+ * Returns -1.0 if no clock is locked or no Start/SPP has been received.
+ */
+double midi_get_clock_beats(void);
+
+/**
+ * Get the position within the current external beat (0.0 - 1.0),
+ * or -1.0 if unknown (see midi_get_clock_beats).
+ */
+double midi_get_clock_beat_phase(void);
+
 /**
  * Reset MIDI Clock timing (call when playback stops or tempo changes externally).
  */
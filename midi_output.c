@@ -1,62 +1,589 @@
 #include "midi_output.h"
 #include "regroove_metadata.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <errno.h>
 #include <rtmidi/rtmidi_c.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_thread.h>
 
-// MIDI output state
-static RtMidiOutPtr midi_out = NULL;
-static int midi_out_device_id = -1;
-static RegrooveMetadata *current_metadata = NULL;  // For channel mapping
-
 // Maximum tracker channels (matches regroove engine)
 #define MAX_TRACKER_CHANNELS 64
 
 // Track active notes per tracker channel
 typedef struct {
     int active;           // Is a note currently playing?
+    int port;             // MIDI output port (0 - MIDI_OUT_MAX_DEVICES-1)
     int midi_channel;     // MIDI channel (0-15)
     int midi_note;        // MIDI note number (0-127)
+    double off_time;      // When its timed note-off is heard (midi_time_ns(), 0 = held)
 } ActiveNote;
 
 static ActiveNote active_notes[MAX_TRACKER_CHANNELS];
 
-// Track current program on each MIDI channel
-static int current_program[16];  // Track program for each MIDI channel (0-15)
+// Timed note-offs of a tracker channel are dropped once its serial has moved on
+// (the note was stopped earlier, by the next note or an off command)
+static SDL_atomic_t note_serial[MAX_TRACKER_CHANNELS];
+
+// Note length of instruments without their own (length 0 = hold until the next
+// note/off command), and the tick length for lengths in ticks and rows (audio thread)
+static int default_note_length = 0;
+static RegrooveNoteLengthUnit default_note_length_unit = RGX_NOTE_LENGTH_TICKS;
+static double tick_seconds = 0.02;  // 125 BPM
+static int ticks_per_row = 6;
+
+// Track current program on each MIDI channel of each port
+static int current_program[MIDI_OUT_MAX_DEVICES][16];
+
+// Routing of each instrument, read from the metadata by midi_output_set_metadata so
+// notes do not look it up
+typedef struct {
+    int port;             // MIDI output port
+    int midi_channel;     // MIDI channel (0-15), -2 = no MIDI output
+    int program;          // -1 = no program change
+    int length;           // Note length (0 = default_note_length)
+    RegrooveNoteLengthUnit length_unit;
+} InstrumentRoute;
 
-// MIDI Clock master state
+typedef struct {
+    InstrumentRoute routes[RGX_MAX_INSTRUMENTS];
+    int note_offset;      // Global note offset (semitones)
+} InstrumentRouting;
+
+// midi_output_set_metadata builds a new routing and hands it over under the lock. The
+// audio thread picks it up when it gets the lock (keeping the one it has otherwise) and
+// hands back the one it replaces for the next set_metadata to free. Only a pickup sets
+// routing_retired, and only after a set_metadata that emptied it
+static InstrumentRouting *routing_pending = NULL;
+static InstrumentRouting *routing_retired = NULL;
+static SDL_SpinLock routing_lock = 0;
+static InstrumentRouting *routing = NULL;  // Audio thread (NULL = default routing)
+
+// Program changes prepared ahead (see midi_output_prepare_programs). Per order and
+// port/MIDI channel: the program its first note in the order plays with, and the row
+// after its last note, from which it is free to change. Swapped under the lock; the
+// audio thread skips preparing while it is taken
+typedef struct {
+    int program;          // -1 = no program change needed
+    int free_row;
+} ProgramScheduleEntry;
+
+#define PROGRAM_SCHEDULE_SLOTS (MIDI_OUT_MAX_DEVICES * 16)
+static ProgramScheduleEntry *program_schedule = NULL;  // num_orders x PROGRAM_SCHEDULE_SLOTS
+static int program_schedule_orders = 0;
+static SDL_SpinLock program_schedule_lock = 0;
+
+// MIDI Clock master state. Pulses are generated in the audio callback from the
+// engine's tick position (see midi_output_send_clock_pulses), so they follow playback
+// including pitch changes, jumps and loops, and fall on the ticks.
 static int clock_master_enabled = 0;
-static double clock_pulse_accumulator = 0.0;  // Accumulate fractional pulses
-static double last_bpm = 0.0;  // Track BPM for pulse timing
+static double clock_last_pulse = 0.0;      // Due time of the last pulse queued (ns, 0 = none yet)
+static SDL_atomic_t clock_reset_requested; // Start was sent: pulses start afresh
 
-// Dedicated MIDI clock thread for reliable timing
+// SPP thread (sends Song Position Pointer updates off the audio thread)
 static SDL_Thread *clock_thread = NULL;
 static SDL_atomic_t clock_thread_running;
-static SDL_atomic_t target_bpm_atomic;  // Lock-free BPM updates from audio thread (stored as int32, divide by 1000)
 static SDL_atomic_t clock_running;       // Is clock actively running (playing)?
 static SDL_atomic_t spp_position_atomic; // Current SPP position (MIDI beats) from audio callback
 
-#define BPM_SCALE 1000  // Scale factor for atomic BPM storage (allows 3 decimal places)
-
 // SPP sending configuration (from device config)
 static int spp_send_mode = 0;      // 0=disabled, 1=on stop only, 2=during playback
 static int spp_send_interval = 64; // Rows between SPP messages (when mode=2)
 
-// Forward declaration
+// Output scheduler. Every message goes through a bounded lock-free queue that any
+// thread may push to (audio callback, clock thread, UI); a scheduler thread drains
+// it and is the only caller of RtMidi for the port, sending each message at its due
+// time. Each port has its own queue and thread, so a slow (DIN) port never holds up
+// the others. Messages from the audio callback are due when their block is heard,
+// on a timeline that advances with the rendered frames (so they go out evenly spaced
+// however the callbacks bunch up); messages from other threads are due immediately.
+#define MIDI_OUT_QUEUE_SIZE 1024    // Power of two
+#define MIDI_OUT_PENDING_MAX 1024   // Messages waiting for their due time
+#define MIDI_OUT_LEAD_NS 2000000    // Wait on the queue until this close to the due time
+
+// Timed note-offs (note lengths) wait in a timer wheel instead of the heap: one slot
+// per millisecond, so inserting and expiring are O(1) however many notes are held.
+// Note-offs further ahead than the wheel's span stay in their slot for more rounds.
+#define MIDI_OUT_WHEEL_SLOTS 256        // Power of two
+#define MIDI_OUT_WHEEL_TICK_NS 1000000  // Slot width
+#define MIDI_OUT_TIMERS_MAX 1024        // Timed note-offs waiting
+
+typedef struct {
+    SDL_atomic_t sequence;      // Slot state (bounded MPMC queue after D. Vyukov)
+    Uint64 due;                 // midi_time_ns()
+    Uint64 row_time;            // When the row of a note reported ahead is heard
+    int channel;                // Tracker channel of a note reported ahead or timed note-off
+                                // (-1 = none: not cancellable)
+    int generation;             // Cancel generation when it was queued
+    int serial;                 // Note serial of a timed note-off on channel (-1 = not timed)
+    unsigned char msg[3];
+    unsigned char len;
+    unsigned char flush;        // Send everything queued before this message first
+} MidiOutSlot;
+
+typedef struct {
+    Uint64 due;
+    Uint64 row_time;
+    int channel;
+    int generation;
+    unsigned int order;         // Dequeue order, keeps equal due times in sequence
+    unsigned char msg[3];
+    unsigned char len;
+} MidiOutPending;
+
+typedef struct {
+    Uint64 due;
+    int next;                   // Next timer in the same wheel slot (or free list), -1 = none
+    int channel;                // Tracker channel
+    int serial;                 // note_serial[channel] when the note started
+    unsigned char msg[3];
+} MidiOutTimer;
+
+typedef struct {
+    RtMidiOutPtr out;
+    int device_id;              // RtMidi port number (valid while out is set)
+    SDL_atomic_t open;          // Producers may queue messages
+    int send_clock;             // MIDI Clock and Start/Stop/Continue go to this port
+    int send_spp;               // Song Position Pointer goes to this port
+    int latency_ms;             // Note messages go out this much before their audio
+    MidiOutSlot queue[MIDI_OUT_QUEUE_SIZE];
+    SDL_atomic_t enqueue_pos;
+    SDL_sem *wake;
+    SDL_atomic_t audio_queued;  // The audio callback queued messages (it does not post wake)
+    SDL_Thread *thread;
+    SDL_atomic_t running;
+    MidiOutPending heap[MIDI_OUT_PENDING_MAX];  // Scheduler thread only
+    MidiOutTimer timers[MIDI_OUT_TIMERS_MAX];   // Scheduler thread only
+    int wheel[MIDI_OUT_WHEEL_SLOTS];            // First timer per slot, -1 = empty
+    int timer_free;                             // Free list of timers
+    int timer_count;
+    Uint64 wheel_tick;                          // Next wheel tick to expire
+} MidiOutPort;
+
+static MidiOutPort out_ports[MIDI_OUT_MAX_DEVICES] = {
+    [0] = { .send_clock = 1, .send_spp = 1 },  // Sync goes to the first port by default
+};
+static SDL_atomic_t out_dropped;
+
+// Cancelling notes reported ahead. Each note-on reported ahead of its row carries the
+// cancel generation current when it was queued; the scheduler drops it if a cancel
+// issued since then covers its channel and row time. Each cancel carries a channel
+// mask, so one engine event is one entry however many channels it affects. Only the
+// last MIDI_OUT_CANCEL_HISTORY cancels are kept; a note queued before all of them is
+// only checked against those (it is never dropped just for being older).
+// No lock: the audio thread must not wait for a scheduler. Each entry is published by
+// its sequence number (generation + 1, 0 while it is written); a scheduler that finds
+// another number, before or after reading it, skips the entry.
+#define MIDI_OUT_CANCEL_HISTORY 64  // Power of two
+
+typedef struct {
+    SDL_atomic_t sequence;      // Generation + 1 of the cancel held (0 = being written)
+    uint64_t channels;          // Tracker channel mask (bit n = channel n)
+    Uint64 from;                // Drop notes of rows heard at or after this time
+} MidiOutCancel;
+
+static MidiOutCancel cancel_history[MIDI_OUT_CANCEL_HISTORY];
+static SDL_atomic_t cancel_generation;     // Cancels issued so far
+
+// Audio callback timeline (audio thread only, except audio_thread_id)
+static void *audio_thread_id = NULL;   // SDL_threadID of the audio callback
+static Uint64 block_anchor = 0;        // Timeline origin (ns)
+static double block_frames = 0.0;      // Frames rendered since the origin
+static int block_rate = 0;
+static Uint64 block_due = 0;           // Due time of messages from the current block
+
+// Forward declarations
 static int midi_clock_thread_func(void *data);
+static int midi_scheduler_thread_func(void *data);
+
+// Monotonic time in nanoseconds. On POSIX this is the clock the scheduler sleeps
+// on with absolute deadlines (SDL's performance counter may be a different clock).
+static Uint64 midi_time_ns(void) {
+#ifdef _WIN32
+    return (Uint64)((double)SDL_GetPerformanceCounter() * 1e9 / (double)SDL_GetPerformanceFrequency());
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint64)ts.tv_sec * 1000000000ull + (Uint64)ts.tv_nsec;
+#endif
+}
 
-// Get MIDI channel for instrument (using metadata if available)
-static int get_midi_channel_for_instrument(int instrument) {
-    if (current_metadata) {
-        // Use custom mapping from metadata
-        return regroove_metadata_get_midi_channel(current_metadata, instrument);
+// Sleep until an absolute midi_time_ns() deadline
+static void sleep_until_ns(Uint64 deadline) {
+#ifdef _WIN32
+    Uint64 now = midi_time_ns();
+    if (deadline > now) SDL_Delay((Uint32)((deadline - now) / 1000000));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline / 1000000000ull);
+    ts.tv_nsec = (long)(deadline % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
     }
+#endif
+}
+
+static MidiOutPort* open_port(int port) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES) return NULL;
+    if (!SDL_AtomicGet(&out_ports[port].open)) return NULL;
+    return &out_ports[port];
+}
+
+static int on_audio_thread(void) {
+    return SDL_AtomicGetPtr(&audio_thread_id) == (void *)(uintptr_t)SDL_ThreadID();
+}
+
+// Time `delay` seconds after the current block is heard (on the audio thread) or after
+// now (on any other)
+static double time_after(double delay) {
+    return (double)(on_audio_thread() ? block_due : midi_time_ns()) + delay * 1e9;
+}
+
+// Queue a message for a port's scheduler thread (any thread, never blocks). due is a
+// midi_time_ns() time, or 0 for the default: the current block's time on the audio
+// thread, now on any other. A note reported ahead passes its tracker channel and the
+// time its row is heard, so it can be cancelled (channel -1 = not cancellable); a timed
+// note-off passes its tracker channel and note serial instead (serial -1 = not timed).
+// Returns 0 on success, -1 if the queue is full (dropped)
+static int queue_message_at(MidiOutPort *p, const unsigned char *msg, int len, int flush, Uint64 due,
+                            int channel, Uint64 row_time, int serial) {
+    int from_audio = on_audio_thread();
+    if (due == 0) due = from_audio ? block_due : midi_time_ns();
+
+    // Claim a slot: its sequence equals the position while it is free
+    // (positions run freely and wrap, so they are compared as differences)
+    MidiOutSlot *slot;
+    unsigned int pos = (unsigned int)SDL_AtomicGet(&p->enqueue_pos);
+    for (;;) {
+        slot = &p->queue[pos & (MIDI_OUT_QUEUE_SIZE - 1)];
+        int diff = (int)((unsigned int)SDL_AtomicGet(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&p->enqueue_pos, (int)pos, (int)(pos + 1))) break;
+        } else if (diff < 0) {
+            SDL_AtomicAdd(&out_dropped, 1);
+            return -1;
+        }
+        pos = (unsigned int)SDL_AtomicGet(&p->enqueue_pos);
+    }
+
+    slot->due = due;
+    slot->row_time = row_time;
+    slot->channel = channel;
+    slot->generation = SDL_AtomicGet(&cancel_generation);
+    slot->serial = serial;
+    memcpy(slot->msg, msg, len);
+    slot->len = (unsigned char)len;
+    slot->flush = (unsigned char)flush;
+    SDL_AtomicSet(&slot->sequence, (int)(pos + 1));  // Publish
+
+    // Immediate messages wake the scheduler. The audio thread must not make syscalls,
+    // so its messages only raise a flag the scheduler polls every millisecond
+    if (from_audio) {
+        SDL_AtomicSet(&p->audio_queued, 1);
+    } else if (p->wake) {
+        SDL_SemPost(p->wake);
+    }
+    return 0;
+}
+
+static int queue_message(MidiOutPort *p, const unsigned char *msg, int len, int flush) {
+    return queue_message_at(p, msg, len, flush, 0, -1, 0, -1);
+}
 
-    // Default fallback: simple wraparound
-    return instrument % 16;
+// Queue a note message of a row heard `delay` seconds from the current block, ahead by
+// the port's latency (past due times go out immediately). channel: tracker channel of
+// a cancellable note-on or a timed note-off (serial >= 0), -1 for anything else
+static void queue_note_message(MidiOutPort *p, const unsigned char *msg, int len, double delay, int channel,
+                               int serial) {
+    double row_time = time_after(delay);
+    double due = row_time - p->latency_ms * 1e6;
+    if (due < 1.0) due = 1.0;
+    queue_message_at(p, msg, len, 0, (Uint64)due, channel, (Uint64)row_time, serial);
+}
+
+// Serial of the note playing on a tracker channel (see note_serial)
+static int current_note_serial(int tracker_channel) {
+    return SDL_AtomicGet(&note_serial[tracker_channel]) & 0x7fffffff;
+}
+
+// Record a cancel (see cancel_history)
+static void cancel_notes_from(uint64_t channels, Uint64 from) {
+    int generation = SDL_AtomicAdd(&cancel_generation, 1);
+    MidiOutCancel *c = &cancel_history[generation & (MIDI_OUT_CANCEL_HISTORY - 1)];
+    SDL_AtomicSet(&c->sequence, 0);
+    SDL_MemoryBarrierRelease();
+    c->channels = channels;
+    c->from = from;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&c->sequence, generation + 1);
+}
+
+// Scheduler thread: has a cancel since the note was queued dropped it?
+static int note_cancelled(const MidiOutPending *item) {
+    if (item->channel < 0) return 0;
+    if (SDL_AtomicGet(&cancel_generation) == item->generation) return 0;
+
+    int generation = SDL_AtomicGet(&cancel_generation);
+    int oldest = item->generation;
+    if (generation - oldest > MIDI_OUT_CANCEL_HISTORY) oldest = generation - MIDI_OUT_CANCEL_HISTORY;
+    for (int i = oldest; i != generation; i++) {
+        MidiOutCancel *c = &cancel_history[i & (MIDI_OUT_CANCEL_HISTORY - 1)];
+        // Skip an entry still being written (the cancel races this send either way) or
+        // already reused by a newer cancel (beyond the history)
+        if (SDL_AtomicGet(&c->sequence) != i + 1) continue;
+        SDL_MemoryBarrierAcquire();
+        uint64_t channels = c->channels;
+        Uint64 from = c->from;
+        SDL_MemoryBarrierAcquire();
+        if (SDL_AtomicGet(&c->sequence) != i + 1) continue;
+        if (((channels >> item->channel) & 1) && item->row_time >= from) return 1;
+    }
+    return 0;
+}
+
+static void send_pending(RtMidiOutPtr midi_out, const MidiOutPending *item) {
+    if (note_cancelled(item)) return;
+    rtmidi_out_send_message(midi_out, item->msg, item->len);
+}
+
+// Queue a sync message (clock, transport or SPP) to every port that carries it
+static void queue_sync_message(const unsigned char *msg, int len, int flush, int spp, Uint64 due) {
+    for (int i = 0; i < MIDI_OUT_MAX_DEVICES; i++) {
+        MidiOutPort *p = open_port(i);
+        if (!p || !(spp ? p->send_spp : p->send_clock)) continue;
+        queue_message_at(p, msg, len, flush, due, -1, 0, -1);
+    }
+}
+
+void midi_output_begin_block(int frames, int sample_rate) {
+    if (frames <= 0 || sample_rate <= 0) return;
+
+    SDL_AtomicSetPtr(&audio_thread_id, (void *)(uintptr_t)SDL_ThreadID());
+
+    Uint64 now = midi_time_ns();
+    double block_ticks = (double)frames * 1e9 / sample_rate;
+    double expected = (double)block_anchor + block_frames * 1e9 / sample_rate;
+    double error = (double)now - expected;
+
+    if (sample_rate != block_rate || block_anchor == 0 || fabs(error) > 4.0 * block_ticks) {
+        // First block, rate change or dropout: restart the timeline here
+        block_anchor = now;
+        block_frames = 0.0;
+        block_rate = sample_rate;
+        expected = (double)now;
+    } else {
+        // Follow the callbacks slowly, so the timeline tracks the audio clock, not their jitter
+        block_anchor += (Sint64)(error / 64.0);
+        expected += error / 64.0;
+    }
+
+    // This block's messages are due when it starts playing, one block from now
+    block_due = (Uint64)(expected + block_ticks);
+    block_frames += frames;
+}
+
+int midi_output_get_dropped(void) {
+    return SDL_AtomicGet(&out_dropped);
+}
+
+// Scheduler thread: timer wheel of timed note-offs
+static void wheel_init(MidiOutPort *p) {
+    for (int i = 0; i < MIDI_OUT_WHEEL_SLOTS; i++) {
+        p->wheel[i] = -1;
+    }
+    for (int i = 0; i < MIDI_OUT_TIMERS_MAX; i++) {
+        p->timers[i].next = (i + 1 < MIDI_OUT_TIMERS_MAX) ? i + 1 : -1;
+    }
+    p->timer_free = 0;
+    p->timer_count = 0;
+    p->wheel_tick = midi_time_ns() / MIDI_OUT_WHEEL_TICK_NS + 1;
+}
+
+static void send_timer(RtMidiOutPtr midi_out, const MidiOutTimer *t) {
+    // Dropped if the note was stopped earlier (it got its note-off then)
+    if (current_note_serial(t->channel) != t->serial) return;
+    rtmidi_out_send_message(midi_out, t->msg, 3);
+}
+
+// Add a timed note-off (O(1)). Returns -1 if all timers are in use
+static int wheel_insert(MidiOutPort *p, RtMidiOutPtr midi_out, const MidiOutSlot *slot) {
+    if (p->timer_free < 0) return -1;
+
+    int index = p->timer_free;
+    MidiOutTimer *t = &p->timers[index];
+    t->due = slot->due;
+    t->channel = slot->channel;
+    t->serial = slot->serial;
+    memcpy(t->msg, slot->msg, sizeof(t->msg));
+    if (t->due <= midi_time_ns()) {
+        send_timer(midi_out, t);
+        return 0;
+    }
+    p->timer_free = t->next;
+
+    // Round up to the slot's tick, so a timer never fires early
+    Uint64 tick = (t->due + MIDI_OUT_WHEEL_TICK_NS - 1) / MIDI_OUT_WHEEL_TICK_NS;
+    if (tick < p->wheel_tick) tick = p->wheel_tick;
+    int *head = &p->wheel[tick & (MIDI_OUT_WHEEL_SLOTS - 1)];
+    t->next = *head;
+    *head = index;
+    p->timer_count++;
+    return 0;
+}
+
+// Send the timed note-offs due by now (all of them when flushing), visiting the
+// slots of the ticks passed since the last call
+static void wheel_expire(MidiOutPort *p, RtMidiOutPtr midi_out, Uint64 now, int flush) {
+    Uint64 now_tick = now / MIDI_OUT_WHEEL_TICK_NS;
+    if (now_tick < p->wheel_tick && !flush) return;
+
+    Uint64 slots = flush ? MIDI_OUT_WHEEL_SLOTS : now_tick - p->wheel_tick + 1;
+    if (slots > MIDI_OUT_WHEEL_SLOTS) slots = MIDI_OUT_WHEEL_SLOTS;
+    for (Uint64 i = 0; i < slots && p->timer_count > 0; i++) {
+        int *link = &p->wheel[(p->wheel_tick + i) & (MIDI_OUT_WHEEL_SLOTS - 1)];
+        while (*link >= 0) {
+            MidiOutTimer *t = &p->timers[*link];
+            if (!flush && t->due > now) {
+                link = &t->next;  // A later round
+                continue;
+            }
+            int index = *link;
+            *link = t->next;
+            send_timer(midi_out, t);
+            t->next = p->timer_free;
+            p->timer_free = index;
+            p->timer_count--;
+        }
+    }
+    if (now_tick >= p->wheel_tick) p->wheel_tick = now_tick + 1;
+}
+
+// Start of the next non-empty wheel slot (0 = none). Timers due in a later round
+// make it early, which only costs a wakeup
+static Uint64 wheel_next_due(const MidiOutPort *p) {
+    if (p->timer_count == 0) return 0;
+    for (Uint64 i = 0; i < MIDI_OUT_WHEEL_SLOTS; i++) {
+        Uint64 tick = p->wheel_tick + i;
+        if (p->wheel[tick & (MIDI_OUT_WHEEL_SLOTS - 1)] >= 0) return tick * MIDI_OUT_WHEEL_TICK_NS;
+    }
+    return 0;
+}
+
+// Scheduler thread: min-heap of pending messages ordered by (due, order)
+static int pending_before(const MidiOutPending *a, const MidiOutPending *b) {
+    if (a->due != b->due) return a->due < b->due;
+    return (int)(a->order - b->order) < 0;
+}
+
+static void pending_push(MidiOutPending *heap, int *count, const MidiOutPending *item) {
+    int i = (*count)++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!pending_before(item, &heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = *item;
+}
+
+static void pending_pop(MidiOutPending *heap, int *count) {
+    MidiOutPending last = heap[--(*count)];
+    int i = 0;
+    for (;;) {
+        int child = i * 2 + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && pending_before(&heap[child + 1], &heap[child])) child++;
+        if (!pending_before(&heap[child], &last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*count > 0) heap[i] = last;
+}
+
+static int midi_scheduler_thread_func(void *data) {
+    MidiOutPort *p = (MidiOutPort *)data;
+    RtMidiOutPtr midi_out = p->out;
+    MidiOutPending *heap = p->heap;
+    int count = 0;
+    unsigned int dequeue_pos = 0;
+    unsigned int order = 0;
+
+    wheel_init(p);
+
+    for (;;) {
+        int running = SDL_AtomicGet(&p->running);
+
+        // Move everything queued so far into the pending heap (the flag is cleared
+        // first: anything flagged after this is found by the next round)
+        SDL_AtomicSet(&p->audio_queued, 0);
+        for (;;) {
+            MidiOutSlot *slot = &p->queue[dequeue_pos & (MIDI_OUT_QUEUE_SIZE - 1)];
+            if ((unsigned int)SDL_AtomicGet(&slot->sequence) != dequeue_pos + 1) break;
+
+            if (slot->flush) {
+                // All notes off / stop: whatever was queued before goes out first
+                while (count > 0) {
+                    send_pending(midi_out, &heap[0]);
+                    pending_pop(heap, &count);
+                }
+                wheel_expire(p, midi_out, midi_time_ns(), 1);
+                rtmidi_out_send_message(midi_out, slot->msg, slot->len);
+            } else if (slot->serial >= 0 && wheel_insert(p, midi_out, slot) == 0) {
+                // Timed note-off, waiting in the wheel
+            } else if (count < MIDI_OUT_PENDING_MAX) {
+                // (a timed note-off lands here only when the wheel is full)
+                MidiOutPending item;
+                item.due = slot->due;
+                item.row_time = slot->row_time;
+                item.channel = slot->serial >= 0 ? -1 : slot->channel;
+                item.generation = slot->generation;
+                item.order = order++;
+                memcpy(item.msg, slot->msg, sizeof(item.msg));
+                item.len = slot->len;
+                pending_push(heap, &count, &item);
+            } else {
+                SDL_AtomicAdd(&out_dropped, 1);
+            }
+
+            SDL_AtomicSet(&slot->sequence, (int)(dequeue_pos + MIDI_OUT_QUEUE_SIZE));  // Free the slot
+            dequeue_pos++;
+        }
+
+        // Send what is due (everything once stopping)
+        Uint64 now = midi_time_ns();
+        while (count > 0 && (heap[0].due <= now || !running)) {
+            send_pending(midi_out, &heap[0]);
+            pending_pop(heap, &count);
+        }
+        wheel_expire(p, midi_out, now, !running);
+        if (!running) break;
+
+        // Close to the next due time: sleep to the absolute deadline. Otherwise wait on
+        // the queue until the lead time, woken early by immediate messages and, in 1 ms
+        // steps, by messages from the audio callback (due as soon as one block ahead,
+        // sooner with port latency, so they cannot wait for a far-off note-off).
+        Uint64 next_due = count > 0 ? heap[0].due : 0;
+        Uint64 timer_due = wheel_next_due(p);
+        if (timer_due && (!next_due || timer_due < next_due)) next_due = timer_due;
+        if (next_due && next_due <= now + MIDI_OUT_LEAD_NS) {
+            sleep_until_ns(next_due);
+            continue;
+        }
+        Uint32 wait_ms = 1;
+        if (next_due) {
+            wait_ms = (Uint32)((next_due - now - MIDI_OUT_LEAD_NS) / 1000000);
+            if (wait_ms < 1) wait_ms = 1;
+            if (wait_ms > 10) wait_ms = 10;
+        }
+        for (Uint32 waited = 0; waited < wait_ms && !SDL_AtomicGet(&p->audio_queued); waited++) {
+            if (SDL_SemWaitTimeout(p->wake, 1) == 0) break;
+        }
+    }
+
+    return 0;
 }
 
 // Convert tracker note to MIDI note number
@@ -101,90 +628,179 @@ int midi_output_get_port_name(int port, char *name_out, int bufsize) {
     return 0;
 }
 
-int midi_output_init(int device_id) {
-    if (midi_out != NULL) {
-        midi_output_deinit();
+static void start_clock_thread(void) {
+    if (clock_thread) return;
+
+    SDL_AtomicSet(&clock_reset_requested, 1);
+    SDL_AtomicSet(&clock_running, 0);
+    SDL_AtomicSet(&spp_position_atomic, 0);
+
+    SDL_AtomicSet(&clock_thread_running, 1);
+    clock_thread = SDL_CreateThread(midi_clock_thread_func, "MIDI Clock", NULL);
+    if (!clock_thread) {
+        fprintf(stderr, "Failed to create MIDI clock thread\n");
+    } else {
+        printf("[MIDI Output] Clock thread created\n");
+    }
+}
+
+static void stop_clock_thread(void) {
+    if (!clock_thread) return;
+    SDL_AtomicSet(&clock_thread_running, 0);
+    SDL_WaitThread(clock_thread, NULL);
+    clock_thread = NULL;
+    printf("[MIDI Output] Clock thread stopped\n");
+}
+
+int midi_output_open(int port, int device_id) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES) return -1;
+    MidiOutPort *p = &out_ports[port];
+    if (p->out != NULL) {
+        midi_output_close(port);
     }
 
     // Create RtMidi output
-    midi_out = rtmidi_out_create_default();
-    if (!midi_out) {
+    p->out = rtmidi_out_create_default();
+    if (!p->out) {
         fprintf(stderr, "Failed to create RtMidi output\n");
         return -1;
     }
 
     // Get device count
-    unsigned int num_devices = rtmidi_get_port_count(midi_out);
+    unsigned int num_devices = rtmidi_get_port_count(p->out);
     if (device_id < 0 || device_id >= (int)num_devices) {
         fprintf(stderr, "Invalid MIDI output device ID: %d (available: %u)\n", device_id, num_devices);
-        rtmidi_out_free(midi_out);
-        midi_out = NULL;
+        rtmidi_out_free(p->out);
+        p->out = NULL;
         return -1;
     }
 
     // Open the device
     char port_name[256];
     int bufsize = sizeof(port_name);
-    int name_len = rtmidi_get_port_name(midi_out, device_id, port_name, &bufsize);
+    int name_len = rtmidi_get_port_name(p->out, device_id, port_name, &bufsize);
     if (name_len < 0) {
         snprintf(port_name, sizeof(port_name), "Port %d", device_id);
     }
 
-    rtmidi_open_port(midi_out, device_id, "Regroove MIDI Out");
+    char client_name[64];
+    snprintf(client_name, sizeof(client_name), "Regroove MIDI Out %d", port + 1);
+    rtmidi_open_port(p->out, device_id, client_name);
 
-    midi_out_device_id = device_id;
+    p->device_id = device_id;
 
-    // Initialize active notes tracking
-    memset(active_notes, 0, sizeof(active_notes));
-
-    // Initialize program tracking (-1 = no program set yet)
+    // Initialize note and program tracking for this port (-1 = no program set yet)
+    for (int i = 0; i < MAX_TRACKER_CHANNELS; i++) {
+        if (active_notes[i].port == port) active_notes[i].active = 0;
+    }
     for (int i = 0; i < 16; i++) {
-        current_program[i] = -1;
+        current_program[port][i] = -1;
     }
 
-    // Initialize atomic variables
-    SDL_AtomicSet(&clock_thread_running, 0);
-    SDL_AtomicSet(&target_bpm_atomic, 120 * BPM_SCALE);  // Default 120 BPM
-    SDL_AtomicSet(&clock_running, 0);
-    SDL_AtomicSet(&spp_position_atomic, 0);
+    // Start the port's scheduler (the only thread that sends to it)
+    for (int i = 0; i < MIDI_OUT_QUEUE_SIZE; i++) {
+        SDL_AtomicSet(&p->queue[i].sequence, i);
+    }
+    SDL_AtomicSet(&p->enqueue_pos, 0);
+    SDL_AtomicSet(&p->audio_queued, 0);
+    p->wake = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&p->running, 1);
+    char thread_name[32];
+    snprintf(thread_name, sizeof(thread_name), "MIDI Out %d", port + 1);
+    p->thread = SDL_CreateThread(midi_scheduler_thread_func, thread_name, p);
+    if (!p->thread) {
+        fprintf(stderr, "Failed to create MIDI output scheduler thread\n");
+        SDL_DestroySemaphore(p->wake);
+        p->wake = NULL;
+        rtmidi_close_port(p->out);
+        rtmidi_out_free(p->out);
+        p->out = NULL;
+        return -1;
+    }
+    SDL_AtomicSet(&p->open, 1);
 
-    // Start the clock thread
-    SDL_AtomicSet(&clock_thread_running, 1);
-    clock_thread = SDL_CreateThread(midi_clock_thread_func, "MIDI Clock", NULL);
-    if (!clock_thread) {
-        fprintf(stderr, "Failed to create MIDI clock thread\n");
-    } else {
-        printf("[MIDI Output] Clock thread created\n");
+    // One SPP thread serves all ports
+    start_clock_thread();
+
+    printf("MIDI output %d initialized on device %d: %s\n", port + 1, device_id, port_name);
+    return 0;
+}
+
+void midi_output_close(int port) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES) return;
+    MidiOutPort *p = &out_ports[port];
+    if (!p->out) return;
+
+    // Send all notes off on all channels before closing
+    for (int ch = 0; ch < 16; ch++) {
+        midi_output_all_notes_off(port, ch);
     }
+    SDL_AtomicSet(&p->open, 0);
+
+    // The scheduler sends everything still queued before it exits
+    if (p->thread) {
+        SDL_AtomicSet(&p->running, 0);
+        SDL_SemPost(p->wake);
+        SDL_WaitThread(p->thread, NULL);
+        p->thread = NULL;
+    }
+    SDL_DestroySemaphore(p->wake);
+    p->wake = NULL;
+
+    rtmidi_close_port(p->out);
+    rtmidi_out_free(p->out);
+    p->out = NULL;
 
-    printf("MIDI output initialized on device %d: %s\n", device_id, port_name);
+    for (int i = 0; i < MAX_TRACKER_CHANNELS; i++) {
+        if (active_notes[i].port == port) active_notes[i].active = 0;
+    }
+
+    if (!midi_output_is_open(-1)) stop_clock_thread();
+}
+
+int midi_output_is_open(int port) {
+    if (port >= 0) return open_port(port) != NULL;
+    for (int i = 0; i < MIDI_OUT_MAX_DEVICES; i++) {
+        if (open_port(i)) return 1;
+    }
     return 0;
 }
 
+int midi_output_get_device(int port) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES || !out_ports[port].out) return -1;
+    return out_ports[port].device_id;
+}
+
+void midi_output_set_port_sync(int port, int send_clock, int send_spp) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES) return;
+    out_ports[port].send_clock = send_clock ? 1 : 0;
+    out_ports[port].send_spp = send_spp ? 1 : 0;
+}
+
+void midi_output_set_port_latency(int port, int latency_ms) {
+    if (port < 0 || port >= MIDI_OUT_MAX_DEVICES) return;
+    out_ports[port].latency_ms = latency_ms;
+}
+
+int midi_output_init(int device_id) {
+    midi_output_deinit();
+    return midi_output_open(0, device_id);
+}
+
 void midi_output_deinit(void) {
     // Stop the clock thread first
-    if (clock_thread) {
-        SDL_AtomicSet(&clock_thread_running, 0);
-        SDL_WaitThread(clock_thread, NULL);
-        clock_thread = NULL;
-        printf("[MIDI Output] Clock thread stopped\n");
-    }
-
-    if (midi_out) {
-        // Send all notes off on all channels before closing
-        for (int ch = 0; ch < 16; ch++) {
-            midi_output_all_notes_off(ch);
-        }
+    stop_clock_thread();
 
-        rtmidi_close_port(midi_out);
-        rtmidi_out_free(midi_out);
-        midi_out = NULL;
-        midi_out_device_id = -1;
+    for (int i = 0; i < MIDI_OUT_MAX_DEVICES; i++) {
+        midi_output_close(i);
     }
 }
 
-void midi_output_note_on(int channel, int note, int velocity) {
-    if (!midi_out) return;
+// Note messages of a row heard `delay` seconds from the current block (0 = this block).
+// tracker_channel tags a note-on reported ahead so it can be cancelled (-1 = not)
+static void send_note_on(int port, int channel, int note, int velocity, double delay, int tracker_channel) {
+    MidiOutPort *p = open_port(port);
+    if (!p) return;
     if (channel < 0 || channel > 15) return;
     if (note < 0 || note > 127) return;
     if (velocity < 0) velocity = 0;
@@ -196,11 +812,14 @@ void midi_output_note_on(int channel, int note, int velocity) {
     msg[1] = note;
     msg[2] = velocity;
 
-    rtmidi_out_send_message(midi_out, msg, 3);
+    queue_note_message(p, msg, 3, delay, tracker_channel, -1);
 }
 
-void midi_output_note_off(int channel, int note) {
-    if (!midi_out) return;
+// A timed note-off (the end of a note length) passes the note's tracker channel and
+// serial: it is dropped if the note is stopped before (tracker_channel -1 = not timed)
+static void send_note_off(int port, int channel, int note, double delay, int tracker_channel, int serial) {
+    MidiOutPort *p = open_port(port);
+    if (!p) return;
     if (channel < 0 || channel > 15) return;
     if (note < 0 || note > 127) return;
 
@@ -210,11 +829,35 @@ void midi_output_note_off(int channel, int note) {
     msg[1] = note;
     msg[2] = 0;
 
-    rtmidi_out_send_message(midi_out, msg, 3);
+    if (tracker_channel < 0) serial = -1;
+    queue_note_message(p, msg, 3, delay, serial >= 0 ? tracker_channel : -1, serial);
 }
 
-void midi_output_all_notes_off(int channel) {
-    if (!midi_out) return;
+static void send_program_change(int port, int channel, int program, double delay) {
+    MidiOutPort *p = open_port(port);
+    if (!p) return;
+    if (channel < 0 || channel > 15) return;
+    if (program < 0 || program > 127) return;
+
+    // Send MIDI program change message (0xC0 + channel)
+    unsigned char msg[2];
+    msg[0] = 0xC0 | channel;
+    msg[1] = program;
+
+    queue_note_message(p, msg, 2, delay, -1, -1);
+}
+
+void midi_output_note_on(int port, int channel, int note, int velocity) {
+    send_note_on(port, channel, note, velocity, 0.0, -1);
+}
+
+void midi_output_note_off(int port, int channel, int note) {
+    send_note_off(port, channel, note, 0.0, -1, -1);
+}
+
+void midi_output_all_notes_off(int port, int channel) {
+    MidiOutPort *p = open_port(port);
+    if (!p) return;
     if (channel < 0 || channel > 15) return;
 
     // Send All Notes Off controller (CC 123, value 0)
@@ -223,47 +866,109 @@ void midi_output_all_notes_off(int channel) {
     msg[1] = 123;
     msg[2] = 0;
 
-    rtmidi_out_send_message(midi_out, msg, 3);
+    queue_message(p, msg, 3, 1);
 }
 
-void midi_output_program_change(int channel, int program) {
-    if (!midi_out) return;
-    if (channel < 0 || channel > 15) return;
-    if (program < 0 || program > 127) return;
+void midi_output_program_change(int port, int channel, int program) {
+    send_program_change(port, channel, program, 0.0);
+}
 
-    // Send MIDI program change message (0xC0 + channel)
-    unsigned char msg[2];
-    msg[0] = 0xC0 | channel;
-    msg[1] = program;
+// Length of an instrument's notes in seconds (0 = hold until the next note/off command)
+static double note_length_seconds(const InstrumentRoute *route) {
+    int length = default_note_length;
+    RegrooveNoteLengthUnit unit = default_note_length_unit;
+    if (route->length > 0) {
+        length = route->length;
+        unit = route->length_unit;
+    }
 
-    rtmidi_out_send_message(midi_out, msg, 2);
+    switch (unit) {
+        case RGX_NOTE_LENGTH_ROWS: return length * ticks_per_row * tick_seconds;
+        case RGX_NOTE_LENGTH_MS: return length / 1000.0;
+        default: return length * tick_seconds;
+    }
+}
+
+// Stop the note playing on a tracker channel at a row heard `delay` seconds from the
+// current block. Its timed note-off is dropped if it would come later; if it comes
+// before, the note is already off
+static void stop_active_note(int tracker_channel, double delay) {
+    ActiveNote *a = &active_notes[tracker_channel];
+    if (!a->active) return;
+    a->active = 0;
+
+    if (a->off_time > 0.0) {
+        if (a->off_time < time_after(delay)) return;
+        SDL_AtomicAdd(&note_serial[tracker_channel], 1);
+    }
+    send_note_off(a->port, a->midi_channel, a->midi_note, delay, -1, -1);
 }
 
 int midi_output_handle_note(int tracker_channel, int note, int instrument, int volume) {
-    if (!midi_out) return -1;
+    return midi_output_handle_note_at(tracker_channel, note, instrument, volume, 0.0);
+}
+
+// Default routing of an instrument: simple wraparound
+static void default_route(int instrument_index, InstrumentRoute *route) {
+    route->port = 0;
+    route->midi_channel = instrument_index % 16;
+    route->program = -1;
+    route->length = 0;
+    route->length_unit = RGX_NOTE_LENGTH_TICKS;
+}
+
+// Audio thread: the routing to play notes with, picking up one handed over
+static const InstrumentRouting *current_routing(void) {
+    if (SDL_AtomicTryLock(&routing_lock)) {
+        if (routing_pending) {
+            routing_retired = routing;
+            routing = routing_pending;
+            routing_pending = NULL;
+        }
+        SDL_AtomicUnlock(&routing_lock);
+    }
+    return routing;
+}
+
+int midi_output_handle_note_at(int tracker_channel, int note, int instrument, int volume, double delay) {
+    if (!midi_output_is_open(-1)) return -1;
     if (tracker_channel < 0 || tracker_channel >= MAX_TRACKER_CHANNELS) return -1;
+    const InstrumentRouting *routing_now = current_routing();
 
     // Convert 1-based instrument number to 0-based index for metadata lookup
     // Tracker instruments are numbered 01, 02, 03... but arrays are 0-indexed
     int instrument_index = (instrument > 0) ? (instrument - 1) : instrument;
-
-    // Get MIDI channel for this instrument
-    int midi_channel = get_midi_channel_for_instrument(instrument_index);
+    if (instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
+        return 0;  // No instrument, no MIDI channel
+    }
+    InstrumentRoute fallback;
+    const InstrumentRoute *route = &fallback;
+    if (routing_now) {
+        route = &routing_now->routes[instrument_index];
+    } else {
+        default_route(instrument_index, &fallback);
+    }
+    int midi_channel = route->midi_channel;
 
     // Skip if MIDI output is disabled for this instrument (-2)
     if (midi_channel == -2) {
         return 0;  // No MIDI output for this instrument
     }
 
+    // Skip instruments routed to a port that is not open
+    int port = route->port;
+    if (!open_port(port)) {
+        return 0;
+    }
+
     // Send program change if the program for this instrument differs from current channel program
-    if (current_metadata && instrument_index >= 0 && instrument_index < 256) {
-        int program = regroove_metadata_get_program(current_metadata, instrument_index);
-        if (program >= 0 && program <= 127) {
-            // Only send if this program is different from what's currently on this MIDI channel
-            if (current_program[midi_channel] != program) {
-                midi_output_program_change(midi_channel, program);
-                current_program[midi_channel] = program;
-            }
+    // (normally it was already sent ahead, see midi_output_prepare_programs)
+    int program = route->program;
+    if (program >= 0 && program <= 127) {
+        // Only send if this program is different from what's currently on this MIDI channel
+        if (current_program[port][midi_channel] != program) {
+            send_program_change(port, midi_channel, program, delay);
+            current_program[port][midi_channel] = program;
         }
     }
 
@@ -271,10 +976,7 @@ int midi_output_handle_note(int tracker_channel, int note, int instrument, int v
     int midi_note = tracker_note_to_midi(note);
 
     // Apply global note offset
-    if (current_metadata) {
-        int offset = regroove_metadata_get_note_offset(current_metadata);
-        midi_note += offset;
-    }
+    if (routing_now) midi_note += routing_now->note_offset;
 
     // Clamp to valid MIDI range after offset
     if (midi_note < 0) midi_note = 0;
@@ -285,70 +987,165 @@ int midi_output_handle_note(int tracker_channel, int note, int instrument, int v
     if (velocity > 127) velocity = 127;
 
     // If there's an active note on this tracker channel, stop it first
-    if (active_notes[tracker_channel].active) {
-        midi_output_note_off(active_notes[tracker_channel].midi_channel,
-                            active_notes[tracker_channel].midi_note);
-        active_notes[tracker_channel].active = 0;
-    }
+    stop_active_note(tracker_channel, delay);
 
-    // Send new note-on
+    // Send new note-on (cancellable until it is sent)
     if (velocity > 0) {
-        midi_output_note_on(midi_channel, midi_note, velocity);
+        send_note_on(port, midi_channel, midi_note, velocity, delay, tracker_channel);
 
         // Track this note
         active_notes[tracker_channel].active = 1;
+        active_notes[tracker_channel].port = port;
         active_notes[tracker_channel].midi_channel = midi_channel;
         active_notes[tracker_channel].midi_note = midi_note;
+
+        // Instruments with a note length get their note-off now, timed to its end
+        double length = note_length_seconds(route);
+        active_notes[tracker_channel].off_time = 0.0;
+        if (length > 0.0) {
+            active_notes[tracker_channel].off_time = time_after(delay + length);
+            send_note_off(port, midi_channel, midi_note, delay + length,
+                          tracker_channel, current_note_serial(tracker_channel));
+        }
     }
 
     return 0;
 }
 
 void midi_output_stop_channel(int tracker_channel) {
-    if (!midi_out) return;
+    midi_output_stop_channel_at(tracker_channel, 0.0);
+}
+
+void midi_output_stop_channel_at(int tracker_channel, double delay) {
     if (tracker_channel < 0 || tracker_channel >= MAX_TRACKER_CHANNELS) return;
 
     // Stop active note on this tracker channel
-    if (active_notes[tracker_channel].active) {
-        midi_output_note_off(active_notes[tracker_channel].midi_channel,
-                            active_notes[tracker_channel].midi_note);
-        active_notes[tracker_channel].active = 0;
-    }
+    stop_active_note(tracker_channel, delay);
+}
+
+void midi_output_cancel_notes(uint64_t tracker_channels, double delay) {
+    if (!tracker_channels) return;
+    double from = time_after(delay);
+    cancel_notes_from(tracker_channels, from > 0.0 ? (Uint64)from : 0);
 }
 
 void midi_output_reset(void) {
-    if (!midi_out) return;
+    if (!midi_output_is_open(-1)) return;
 
     // Stop all active notes
     for (int i = 0; i < MAX_TRACKER_CHANNELS; i++) {
         if (active_notes[i].active) {
-            midi_output_note_off(active_notes[i].midi_channel,
+            midi_output_note_off(active_notes[i].port,
+                                active_notes[i].midi_channel,
                                 active_notes[i].midi_note);
         }
     }
 
-    // Clear tracking state
+    // Clear tracking state, and drop notes reported ahead and timed note-offs that are
+    // still waiting (the notes are stopped here)
     memset(active_notes, 0, sizeof(active_notes));
+    cancel_notes_from(~(uint64_t)0, 0);
+    for (int i = 0; i < MAX_TRACKER_CHANNELS; i++) {
+        SDL_AtomicAdd(&note_serial[i], 1);
+    }
 
     // Reset program tracking
-    for (int i = 0; i < 16; i++) {
-        current_program[i] = -1;
-    }
+    midi_output_reset_programs();
 
-    // Send all notes off on all MIDI channels
-    for (int ch = 0; ch < 16; ch++) {
-        midi_output_all_notes_off(ch);
+    // Send all notes off on all MIDI channels of every port
+    for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+        for (int ch = 0; ch < 16; ch++) {
+            midi_output_all_notes_off(port, ch);
+        }
     }
 }
 
 void midi_output_set_metadata(RegrooveMetadata *metadata) {
-    current_metadata = metadata;
+    InstrumentRouting *new_routing = (InstrumentRouting *)malloc(sizeof(InstrumentRouting));
+    if (!new_routing) return;  // Keep the current routing
+    for (int i = 0; i < RGX_MAX_INSTRUMENTS; i++) {
+        InstrumentRoute *route = &new_routing->routes[i];
+        if (metadata) {
+            route->port = regroove_metadata_get_midi_port(metadata, i);
+            route->midi_channel = regroove_metadata_get_midi_channel(metadata, i);
+            route->program = regroove_metadata_get_program(metadata, i);
+            route->length = regroove_metadata_get_note_length(metadata, i, &route->length_unit);
+        } else {
+            default_route(i, route);
+        }
+    }
+    new_routing->note_offset = metadata ? regroove_metadata_get_note_offset(metadata) : 0;
+
+    SDL_AtomicLock(&routing_lock);
+    InstrumentRouting *unused = routing_pending;  // Never picked up
+    InstrumentRouting *retired = routing_retired;
+    routing_pending = new_routing;
+    routing_retired = NULL;
+    SDL_AtomicUnlock(&routing_lock);
+    free(unused);
+    free(retired);
+}
+
+void midi_output_set_program_schedule(int num_orders, const int *programs, const int *free_rows) {
+    ProgramScheduleEntry *schedule = NULL;
+    if (num_orders > 0 && programs && free_rows) {
+        schedule = (ProgramScheduleEntry *)malloc((size_t)num_orders * PROGRAM_SCHEDULE_SLOTS * sizeof(ProgramScheduleEntry));
+        if (!schedule) num_orders = 0;
+        for (int i = 0; schedule && i < num_orders * PROGRAM_SCHEDULE_SLOTS; i++) {
+            schedule[i].program = programs[i];
+            schedule[i].free_row = free_rows[i];
+        }
+    } else {
+        num_orders = 0;
+    }
+
+    SDL_AtomicLock(&program_schedule_lock);
+    ProgramScheduleEntry *old = program_schedule;
+    program_schedule = schedule;
+    program_schedule_orders = num_orders;
+    SDL_AtomicUnlock(&program_schedule_lock);
+    free(old);
+}
+
+void midi_output_prepare_programs(int order, int row, int next_order, double delay) {
+    if (next_order < 0) return;
+    if (!SDL_AtomicTryLock(&program_schedule_lock)) return;
+
+    if (order >= 0 && order < program_schedule_orders && next_order < program_schedule_orders) {
+        const ProgramScheduleEntry *current = &program_schedule[order * PROGRAM_SCHEDULE_SLOTS];
+        const ProgramScheduleEntry *next = &program_schedule[next_order * PROGRAM_SCHEDULE_SLOTS];
+        for (int slot = 0; slot < PROGRAM_SCHEDULE_SLOTS; slot++) {
+            // The channel has played its last note of this order: switch it now to the
+            // program its first note of the next order needs, rather than on that note
+            if (current[slot].free_row != row) continue;
+            int program = next[slot].program;
+            int port = slot / 16;
+            int channel = slot % 16;
+            if (program < 0 || current_program[port][channel] == program || !open_port(port)) continue;
+            send_program_change(port, channel, program, delay);
+            current_program[port][channel] = program;
+        }
+    }
+
+    SDL_AtomicUnlock(&program_schedule_lock);
+}
+
+void midi_output_set_default_note_length(int length, RegrooveNoteLengthUnit unit) {
+    default_note_length = length > 0 ? length : 0;
+    default_note_length_unit = unit;
+}
+
+void midi_output_set_tick_time(double seconds, int speed) {
+    if (seconds > 0.0) tick_seconds = seconds;
+    if (speed > 0) ticks_per_row = speed;
 }
 
 void midi_output_reset_programs(void) {
     // Reset program tracking so program changes will be resent
-    for (int i = 0; i < 16; i++) {
-        current_program[i] = -1;
+    for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+        for (int i = 0; i < 16; i++) {
+            current_program[port][i] = -1;
+        }
     }
 }
 
@@ -360,70 +1157,35 @@ int midi_output_is_clock_master(void) {
     return clock_master_enabled;
 }
 
-static int clock_debug_counter = 0;
-
-static int clock_pulse_debug_count = 0;
-static Uint64 clock_pulse_debug_start = 0;
-static Uint64 clock_pulse_last = 0;
-
 void midi_output_send_clock(void) {
-    if (!midi_out || !clock_master_enabled) return;
-
-    Uint64 now = SDL_GetPerformanceCounter();
-
-    // Debug: measure actual pulse rate every 24 pulses (1 beat)
-    if (clock_pulse_debug_count == 0) {
-        clock_pulse_debug_start = now;
-    }
-    clock_pulse_debug_count++;
-
-    if (clock_pulse_debug_count >= 24) {
-        double elapsed_sec = (double)(now - clock_pulse_debug_start) / SDL_GetPerformanceFrequency();
-        double measured_bpm = 60.0 / elapsed_sec;  // 24 pulses = 1 beat
-
-        // Also measure interval from last pulse
-        double pulse_interval = 0;
-        if (clock_pulse_last > 0) {
-            pulse_interval = (double)(now - clock_pulse_last) / SDL_GetPerformanceFrequency() * 1000.0;  // ms
-        }
-
-        printf("[MIDI Clock] Measured: %.2f BPM (24 pulses in %.3f sec, last interval: %.3f ms)\n",
-               measured_bpm, elapsed_sec, pulse_interval);
-        clock_pulse_debug_count = 0;
-    }
-
-    clock_pulse_last = now;
+    if (!clock_master_enabled) return;
 
     // Send MIDI Clock message (0xF8)
     unsigned char msg[1];
     msg[0] = 0xF8;
 
-    rtmidi_out_send_message(midi_out, msg, 1);
+    queue_sync_message(msg, 1, 0, 0, 0);
 }
 
 void midi_output_send_start(void) {
-    if (!midi_out) return;
+    if (!midi_output_is_open(-1)) return;
 
-    // Signal clock thread to start sending pulses
+    // Pulses start afresh from the next audio block (no spacing to earlier ones)
+    SDL_AtomicSet(&clock_reset_requested, 1);
     SDL_AtomicSet(&clock_running, 1);
 
-    // Reset clock accumulator when starting playback (if clock master is enabled)
-    if (clock_master_enabled) {
-        clock_pulse_accumulator = 0.0;
-    }
-
     // Send MIDI Start message (0xFA)
     unsigned char msg[1];
     msg[0] = 0xFA;
 
     printf("[MIDI Output] Sending Start (0xFA)\n");
-    rtmidi_out_send_message(midi_out, msg, 1);
+    queue_sync_message(msg, 1, 0, 0, 0);
 }
 
 void midi_output_send_stop(void) {
-    if (!midi_out) return;
+    if (!midi_output_is_open(-1)) return;
 
-    // Signal clock thread to stop sending pulses
+    // Stop sending pulses
     SDL_AtomicSet(&clock_running, 0);
 
     // Send MIDI Stop message (0xFC)
@@ -431,21 +1193,21 @@ void midi_output_send_stop(void) {
     msg[0] = 0xFC;
 
     printf("[MIDI Output] Sending Stop (0xFC)\n");
-    rtmidi_out_send_message(midi_out, msg, 1);
+    queue_sync_message(msg, 1, 1, 0, 0);
 }
 
 void midi_output_send_continue(void) {
-    if (!midi_out || !clock_master_enabled) return;
+    if (!clock_master_enabled) return;
 
     // Send MIDI Continue message (0xFB)
     unsigned char msg[1];
     msg[0] = 0xFB;
 
-    rtmidi_out_send_message(midi_out, msg, 1);
+    queue_sync_message(msg, 1, 0, 0, 0);
 }
 
 void midi_output_send_song_position(int position) {
-    if (!midi_out) return;
+    if (!midi_output_is_open(-1)) return;
 
     // Clamp position to valid range (0-16383)
     if (position < 0) position = 0;
@@ -460,50 +1222,19 @@ void midi_output_send_song_position(int position) {
 
     printf("[MIDI Output] Sending Song Position: %d MIDI beats (0x%02X 0x%02X 0x%02X)\n",
            position, msg[0], msg[1], msg[2]);
-    rtmidi_out_send_message(midi_out, msg, 3);
+    queue_sync_message(msg, 3, 0, 1, 0);
 }
 
-// MIDI Clock thread - runs with precise timing independent of audio callback
+// SPP thread - sends Song Position Pointer updates posted by the audio callback
+// (clock pulses come from the audio callback, see midi_output_send_clock_pulses)
 static int midi_clock_thread_func(void *data) {
     (void)data;  // Unused
 
-    double current_bpm = 120.0;  // Start with default
-    double last_target_bpm = 120.0;
-    Uint64 next_pulse_tick = SDL_GetPerformanceCounter();  // Track ideal next pulse time
-    const Uint64 perf_freq = SDL_GetPerformanceFrequency();
-    Uint64 last_bpm_update = SDL_GetPerformanceCounter();
-
-    // Smoothing buffer for incoming BPM (libopenmpt gives estimates that fluctuate)
-    #define BPM_SMOOTH_SAMPLES 8
-    double bpm_smooth_buffer[BPM_SMOOTH_SAMPLES] = {120.0};
-    int bpm_smooth_index = 0;
-    int bpm_smooth_filled = 0;
-
-    // SPP tracking
     int last_sent_spp = -1;  // Last SPP position we sent
 
     printf("[MIDI Clock Thread] Started\n");
 
     while (SDL_AtomicGet(&clock_thread_running)) {
-        // Check if clock should be running
-        int is_playing = SDL_AtomicGet(&clock_running);
-
-        if (!is_playing) {
-            // Not playing, but still check for SPP updates (SPP works independently of clock)
-            if (spp_send_mode > 0) {
-                int current_spp = SDL_AtomicGet(&spp_position_atomic);
-                if (current_spp != last_sent_spp && current_spp >= 0) {
-                    midi_output_send_song_position(current_spp);
-                    last_sent_spp = current_spp;
-                }
-            }
-            SDL_Delay(10);
-            next_pulse_tick = SDL_GetPerformanceCounter();
-            last_bpm_update = SDL_GetPerformanceCounter();
-            continue;
-        }
-
-        // Handle SPP independently of clock (even if clock is disabled)
         if (spp_send_mode > 0) {
             int current_spp = SDL_AtomicGet(&spp_position_atomic);
             if (current_spp != last_sent_spp && current_spp >= 0) {
@@ -511,104 +1242,13 @@ static int midi_clock_thread_func(void *data) {
                 last_sent_spp = current_spp;
             }
         }
-
-        // If clock is not enabled, skip clock pulse generation
-        if (!clock_master_enabled) {
-            SDL_Delay(10);
-            next_pulse_tick = SDL_GetPerformanceCounter();
-            last_bpm_update = SDL_GetPerformanceCounter();
-            continue;
-        }
-
-        // Get target BPM from audio thread (lock-free)
-        int bpm_scaled = SDL_AtomicGet(&target_bpm_atomic);
-        double target_bpm = (double)bpm_scaled / BPM_SCALE;
-
-        if (target_bpm > 0.0) {
-            Uint64 now = SDL_GetPerformanceCounter();
-            Uint64 time_since_update = now - last_bpm_update;
-            double ms_since_update = (time_since_update * 1000.0) / perf_freq;
-
-            // Only update BPM if it changed significantly or enough time has passed
-            if (fabs(target_bpm - last_target_bpm) > 0.05 || ms_since_update > 100.0) {
-                // Add to smoothing buffer
-                bpm_smooth_buffer[bpm_smooth_index] = target_bpm;
-                bpm_smooth_index = (bpm_smooth_index + 1) % BPM_SMOOTH_SAMPLES;
-                if (!bpm_smooth_filled && bpm_smooth_index == 0) {
-                    bpm_smooth_filled = 1;
-                }
-
-                // Calculate smoothed BPM (moving average)
-                double sum = 0.0;
-                int count = bpm_smooth_filled ? BPM_SMOOTH_SAMPLES : (bpm_smooth_index > 0 ? bpm_smooth_index : 1);
-                for (int i = 0; i < count; i++) {
-                    sum += bpm_smooth_buffer[i];
-                }
-                double smoothed_target = sum / count;
-
-                if (fabs(smoothed_target - current_bpm) > 0.1) {
-                    printf("[MIDI Clock] BPM update: %.3f -> %.3f (raw: %.3f, smoothed over %d samples)\n",
-                           current_bpm, smoothed_target, target_bpm, count);
-                }
-
-                current_bpm = smoothed_target;
-                last_target_bpm = target_bpm;
-                last_bpm_update = now;
-            }
-        }
-
-        // Calculate timing for next clock pulse
-        // MIDI Clock = 24 PPQN (pulses per quarter note)
-        if (current_bpm > 0.0) {
-            double pulses_per_second = (current_bpm / 60.0) * 24.0;
-            double seconds_per_pulse = 1.0 / pulses_per_second;
-            Uint64 ticks_per_pulse = (Uint64)(seconds_per_pulse * perf_freq);
-
-            // Check if it's time for next pulse
-            Uint64 current_tick = SDL_GetPerformanceCounter();
-
-            if (current_tick >= next_pulse_tick) {
-                // Send clock pulse
-                midi_output_send_clock();
-
-                // Schedule next pulse at exact interval (prevents drift accumulation)
-                next_pulse_tick += ticks_per_pulse;
-
-                // If we're way behind (>10ms), resync to avoid burst catching up
-                if (current_tick > next_pulse_tick + (perf_freq / 100)) {
-                    next_pulse_tick = current_tick + ticks_per_pulse;
-                }
-            } else {
-                // Sleep until near next pulse time
-                Sint64 ticks_until_next = (Sint64)(next_pulse_tick - current_tick);
-                if (ticks_until_next > 0) {
-                    Uint32 sleep_ms = (Uint32)((ticks_until_next * 1000) / perf_freq);
-                    if (sleep_ms > 1) {
-                        SDL_Delay(sleep_ms - 1);  // Sleep most of the time, busy-wait the rest
-                    }
-                }
-            }
-        } else {
-            SDL_Delay(10);
-        }
+        SDL_Delay(10);
     }
 
     printf("[MIDI Clock Thread] Stopped\n");
     return 0;
 }
 
-void midi_output_update_clock(double bpm, double row_fraction) {
-    (void)row_fraction;  // Unused in new implementation
-
-    if (bpm <= 0.0) return;
-
-    // Update target BPM atomically (lock-free communication to clock thread)
-    int bpm_scaled = (int)(bpm * BPM_SCALE);
-    SDL_AtomicSet(&target_bpm_atomic, bpm_scaled);
-
-    last_bpm = bpm;
-}
-
 void midi_output_set_spp_config(int mode, int interval) {
     spp_send_mode = mode;
     spp_send_interval = interval;
@@ -619,26 +1259,50 @@ void midi_output_update_position(int spp_position) {
     SDL_AtomicSet(&spp_position_atomic, spp_position);
 }
 
-// Call this from audio callback to send clock pulses at precise intervals
+// Queue one clock pulse on the block timeline
+static void queue_clock_pulse(double due) {
+    unsigned char msg[1] = { 0xF8 };
+    queue_sync_message(msg, 1, 0, 0, (Uint64)due);
+    clock_last_pulse = due;
+}
+
+// Call this from the audio callback after rendering, once per block. With the
+// tracker tempo convention (a beat is 24 ticks at 2.5 / tempo seconds each), one
+// 24 PPQN pulse is exactly one tick, so a pulse goes out at each tick the engine
+// crossed in this block: the engine's beat position gives the tick position at the
+// block end, and the frames per tick at the effective tempo place each tick before
+// it. Jumps and loops move the ticks with the song; the pulses only keep at least
+// half a tick apart (no doubled pulse) and do not skip a tick across block edges.
 // frames: number of audio frames rendered
 // sample_rate: audio sample rate (e.g., 48000)
-void midi_output_send_clock_pulses(int frames, double sample_rate, double bpm) {
-    if (!midi_out || !clock_master_enabled || bpm <= 0.0 || sample_rate <= 0.0) return;
-
-    // Calculate how many clock pulses should occur in this audio buffer
-    // MIDI Clock = 24 pulses per quarter note (PPQN)
-    // pulses_per_second = (BPM / 60) * 24
-    double pulses_per_second = (bpm / 60.0) * 24.0;
-
-    // How many pulses should occur in this number of frames?
-    double pulses_this_buffer = (frames / sample_rate) * pulses_per_second;
-
-    // Accumulate fractional pulses
-    clock_pulse_accumulator += pulses_this_buffer;
+// bpm: current tempo in beats per minute (adjusted for pitch and the phase nudge)
+// beat_position: regroove_get_beat_position() after rendering the block
+void midi_output_send_clock_pulses(int frames, double sample_rate, double bpm, double beat_position) {
+    if (!clock_master_enabled || !SDL_AtomicGet(&clock_running)) return;
+    if (frames <= 0 || bpm <= 0.0 || sample_rate <= 0.0) return;
+
+    if (SDL_AtomicGet(&clock_reset_requested)) {
+        SDL_AtomicSet(&clock_reset_requested, 0);
+        clock_last_pulse = 0.0;
+    }
 
-    // Send whole pulses
-    while (clock_pulse_accumulator >= 1.0) {
-        midi_output_send_clock();
-        clock_pulse_accumulator -= 1.0;
+    // MIDI Clock = 24 pulses per quarter note (PPQN), one per tick
+    double frames_per_tick = sample_rate * 60.0 / (bpm * 24.0);
+    double tick_ns = frames_per_tick * 1e9 / sample_rate;
+    double end = beat_position * 24.0;
+    double start = end - frames / frames_per_tick;
+
+    // Each tick crossed in this block, at its frame on the block timeline
+    for (double tick = ceil(start); tick < end; tick += 1.0) {
+        double due = (double)block_due + (tick - start) * tick_ns;
+        if (clock_last_pulse > 0.0) {
+            double gap = due - clock_last_pulse;
+            if (gap < 0.5 * tick_ns) continue;  // Already sent with the last block
+            if (gap > 1.5 * tick_ns && gap < 2.5 * tick_ns) {
+                // The tick between fell past the last block's end and before this one's start
+                queue_clock_pulse(clock_last_pulse + 0.5 * gap);
+            }
+        }
+        queue_clock_pulse(due);
     }
 }
@@ -2,13 +2,14 @@
 #define MIDI_OUTPUT_H
 
 #include "regroove_metadata.h"
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Maximum number of MIDI output devices
-#define MIDI_OUT_MAX_DEVICES 1  // Single device for now
+// Maximum number of MIDI output ports open at once
+#define MIDI_OUT_MAX_DEVICES 4
 
 // List available MIDI output ports
 // Returns the number of output ports found
@@ -21,31 +22,70 @@ int midi_output_list_ports(void);
 // Returns 0 on success, -1 on failure
 int midi_output_get_port_name(int port, char *name_out, int bufsize);
 
-// Initialize MIDI output device
+// Open a MIDI output device as output port `port` (0 - MIDI_OUT_MAX_DEVICES-1),
+// replacing what was open there. Instruments are routed to ports by the metadata.
+// Returns 0 on success, -1 on failure
+int midi_output_open(int port, int device_id);
+
+// Close one output port (sends what is still queued first)
+void midi_output_close(int port);
+
+// Check if an output port is open (port -1 = any port)
+int midi_output_is_open(int port);
+
+// Get the device open on an output port (-1 = closed)
+int midi_output_get_device(int port);
+
+// Choose which ports carry MIDI Clock and Start/Stop/Continue, and which carry
+// Song Position Pointer (default: port 0 only)
+void midi_output_set_port_sync(int port, int send_clock, int send_spp);
+
+// Set the latency of an output port (the synth's response plus the interface), in ms.
+// Its note messages are sent this much earlier than the audio they belong to; the
+// player's note lookahead (regroove_set_note_lookahead) must cover the largest value
+// for rows to be known that early. Negative values delay the port instead.
+void midi_output_set_port_latency(int port, int latency_ms);
+
+// Initialize MIDI output device on port 0 (closes all other ports)
 // Returns 0 on success, -1 on failure
 int midi_output_init(int device_id);
 
-// Cleanup MIDI output
+// Cleanup MIDI output (sends what is still queued, then closes all ports)
 void midi_output_deinit(void);
 
+// All output is queued and sent by a scheduler thread per port, so none of the
+// functions below block on MIDI I/O and they may be called from any thread.
+
+// Call at the start of every audio callback: messages sent from the audio thread
+// during the block are timestamped to go out when the block is heard
+// frames: number of audio frames in this buffer
+// sample_rate: audio sample rate (e.g., 48000)
+void midi_output_begin_block(int frames, int sample_rate);
+
+// Messages dropped because the queue was full (since init)
+int midi_output_get_dropped(void);
+
 // Send note-on message
+// port: output port
 // channel: 0-15 (MIDI channels)
 // note: 0-127 (MIDI note number)
 // velocity: 0-127 (MIDI velocity)
-void midi_output_note_on(int channel, int note, int velocity);
+void midi_output_note_on(int port, int channel, int note, int velocity);
 
 // Send note-off message
+// port: output port
 // channel: 0-15 (MIDI channels)
 // note: 0-127 (MIDI note number)
-void midi_output_note_off(int channel, int note);
+void midi_output_note_off(int port, int channel, int note);
 
-// Send all notes off on a channel
-void midi_output_all_notes_off(int channel);
+// Send all notes off on a channel of a port
+void midi_output_all_notes_off(int port, int channel);
 
 // Send program change message
+// port: output port
 // channel: 0-15 (MIDI channels)
 // program: 0-127 (MIDI program number)
-void midi_output_program_change(int channel, int program);
+void midi_output_program_change(int port, int channel, int program);
 
 // Track active notes per channel (internal state management)
 // This is called by the engine callback to manage note-on/note-off
@@ -55,17 +95,55 @@ int midi_output_handle_note(int tracker_channel, int note, int instrument, int v
 // Stop note on a tracker channel (called when effect command detected)
 void midi_output_stop_channel(int tracker_channel);
 
-// Reset all MIDI output state (stop all notes)
+// Variants for notes reported ahead of their row (audio thread, see regroove_set_note_lookahead)
+// delay: seconds from the start of the current audio block to the row
+int midi_output_handle_note_at(int tracker_channel, int note, int instrument, int volume, double delay);
+void midi_output_stop_channel_at(int tracker_channel, double delay);
+
+// Drop the note-ons reported ahead on the tracker channels in the mask (bit n =
+// channel n, all bits set = all) that are due from `delay` seconds after the start of
+// the current audio block and have not been sent yet, because their rows will not play
+// as predicted (jump, loop, mute). Note-offs are never dropped, so no note is left
+// hanging.
+void midi_output_cancel_notes(uint64_t tracker_channels, double delay);
+
+// Reset all MIDI output state (stop all notes, drop notes reported ahead)
 void midi_output_reset(void);
 
-// Set metadata for MIDI channel mapping (can be NULL to use default mapping)
+// Set metadata for MIDI port/channel mapping (can be NULL to use default mapping)
+// The mapping is read here, not on each note: call again after changing it. Not from
+// the audio thread, which picks the new mapping up with its next note
 void midi_output_set_metadata(RegrooveMetadata *metadata);
 
+// Program changes to prepare ahead, per order of the song (from the pattern data and
+// the instrument mapping). programs/free_rows: num_orders x MIDI_OUT_MAX_DEVICES x 16
+// entries (port-major): the program the first note of each port/MIDI channel in the
+// order plays with (-1 = none), and the row after its last note in the order
+// (0 = no notes). num_orders 0 clears the schedule
+void midi_output_set_program_schedule(int num_orders, const int *programs, const int *free_rows);
+
+// Send the program changes the predicted next order needs on the MIDI channels that
+// are done with this order from this row, so they are not sent on the next order's
+// first notes. Notes still send their program if it was not prepared (or mispredicted)
+// Call for each row whose notes are reported (audio thread, see on_note_row)
+void midi_output_prepare_programs(int order, int row, int next_order, double delay);
+
+// Note length of instruments without their own in the metadata (see
+// regroove_metadata_set_note_length). Each note gets its note-off that long after
+// the note-on, or earlier at the next note/off command. length: 0 = hold until then
+void midi_output_set_default_note_length(int length, RegrooveNoteLengthUnit unit);
+
+// Current tick length for note lengths in ticks and rows
+// Call this from the audio callback before rendering
+// seconds: length of one tick (2.5 / effective BPM); speed: ticks per row
+void midi_output_set_tick_time(double seconds, int speed);
+
 // Reset program change tracking (forces program changes to be resent)
-// Call this on pattern/order boundaries to ensure correct programs are loaded
+// Not needed at order changes: programs are tracked per MIDI channel and prepared ahead
 void midi_output_reset_programs(void);
 
 // MIDI Clock master functions
+// Clock, Start/Stop/Continue and SPP go to the ports chosen with midi_output_set_port_sync
 // Enable/disable sending MIDI Clock messages
 void midi_output_set_clock_master(int enabled);
 
@@ -88,18 +166,14 @@ void midi_output_send_continue(void);
 // position: MIDI beats (16th notes) from start of song
 void midi_output_send_song_position(int position);
 
-// Update MIDI Clock based on playback position
-// Call this regularly during playback (e.g., in row callback)
-// bpm: Current tempo in beats per minute
-// row_fraction: Fraction of row completed (0.0 to 1.0)
-void midi_output_update_clock(double bpm, double row_fraction);
-
-// Send MIDI Clock pulses based on audio frames rendered
-// Call this from audio callback for precise timing
+// Queue the MIDI Clock pulses that fall in the block just rendered: one per tick the
+// engine crossed, each timed to its frame
+// Call this from the audio callback after rendering, after midi_output_begin_block
 // frames: number of audio frames in this buffer
 // sample_rate: audio sample rate (e.g., 48000)
-// bpm: current tempo in beats per minute (adjusted for pitch)
-void midi_output_send_clock_pulses(int frames, double sample_rate, double bpm);
+// bpm: current tempo in beats per minute (adjusted for pitch and the phase nudge)
+// beat_position: regroove_get_beat_position() after rendering (24 ticks per beat)
+void midi_output_send_clock_pulses(int frames, double sample_rate, double bpm, double beat_position);
 
 // Configure SPP sending behavior (for clock thread)
 // mode: 0=disabled, 1=on stop only, 2=during playback
@@ -158,6 +158,7 @@ RegrooveCommonState* regroove_common_create(void) {
 
     state->paused = 1;
     state->pitch = 1.0;
+    state->sample_rate = COMMON_DEFAULT_SAMPLE_RATE;
 
     // Initialize device config to defaults
     state->device_config.midi_device_0 = -1;      // Not configured
@@ -165,11 +166,24 @@ RegrooveCommonState* regroove_common_create(void) {
     state->device_config.midi_device_2 = -1;      // Not configured
     state->device_config.audio_device = -1;       // Default device
     state->device_config.audio_input_device = -1; // Disabled
+    state->device_config.audio_cue_device = -1;   // Disabled
     state->device_config.audio_input_buffer_ms = 100; // 100ms default buffer
+    state->device_config.mixer_pan_law = 2;       // Linear (legacy levels)
+    state->device_config.audio_roundtrip_latency_ms = 0.0f; // Not calibrated
+    state->device_config.record_stems = 0;        // Master only
     state->device_config.midi_output_device = -1; // Disabled
+    state->device_config.midi_output_device_1 = -1; // Not configured
+    state->device_config.midi_output_device_2 = -1; // Not configured
+    state->device_config.midi_output_device_3 = -1; // Not configured
+    state->device_config.midi_output_clock_ports = 1; // First output (default)
+    state->device_config.midi_output_spp_ports = 1;   // First output (default)
+    state->device_config.midi_output_latency_ms = 0;   // No latency compensation (default)
+    state->device_config.midi_output_latency_ms_1 = 0;
+    state->device_config.midi_output_latency_ms_2 = 0;
+    state->device_config.midi_output_latency_ms_3 = 0;
     state->device_config.midi_output_note_duration = 1; // Hold notes (default)
     state->device_config.midi_clock_sync = 0;     // Disabled (default)
-    state->device_config.midi_clock_sync_threshold = 0.5f; // 0.5% threshold (default)
+    state->device_config.midi_clock_phase_align = 1; // Enabled (default)
     state->device_config.midi_clock_master = 0;   // Disabled (default)
     state->device_config.midi_clock_send_transport = 0; // Disabled (default)
     state->device_config.midi_spp_speed_compensation = 1; // Enabled (default) - compensate for sender's speed
@@ -200,6 +214,8 @@ RegrooveCommonState* regroove_common_create(void) {
     state->device_config.fx_delay_time = 0.375f;
     state->device_config.fx_delay_feedback = 0.4f;
     state->device_config.fx_delay_mix = 0.3f;
+    state->device_config.fx_convolution_mix = 0.3f;
+    state->device_config.fx_convolution_ir[0] = '\0';
 
     // Initialize metadata
     state->metadata = regroove_metadata_create();
@@ -234,6 +250,9 @@ int regroove_common_load_mappings(RegrooveCommonState *state, const char *ini_pa
     if (!state->input_mappings) {
         state->input_mappings = input_mappings_create();
         if (!state->input_mappings) return -1;
+        if (state->metadata) {
+            input_mappings_set_song_pads(state->input_mappings, state->metadata->song_trigger_pads);
+        }
     }
 
     // Try to load from file
@@ -280,16 +299,45 @@ int regroove_common_load_mappings(RegrooveCommonState *state, const char *ini_pa
                     state->device_config.audio_device = atoi(value);
                 } else if (strcmp(key, "audio_input_device") == 0) {
                     state->device_config.audio_input_device = atoi(value);
+                } else if (strcmp(key, "audio_cue_device") == 0) {
+                    state->device_config.audio_cue_device = atoi(value);
                 } else if (strcmp(key, "audio_input_buffer_ms") == 0) {
                     state->device_config.audio_input_buffer_ms = atoi(value);
+                } else if (strcmp(key, "mixer_pan_law") == 0) {
+                    state->device_config.mixer_pan_law = atoi(value);
+                    if (state->device_config.mixer_pan_law < 0 || state->device_config.mixer_pan_law > 2) {
+                        state->device_config.mixer_pan_law = 2;
+                    }
+                } else if (strcmp(key, "audio_roundtrip_latency_ms") == 0) {
+                    state->device_config.audio_roundtrip_latency_ms = atof(value);
+                } else if (strcmp(key, "record_stems") == 0) {
+                    state->device_config.record_stems = atoi(value) ? 1 : 0;
                 } else if (strcmp(key, "midi_output_device") == 0) {
                     state->device_config.midi_output_device = atoi(value);
+                } else if (strcmp(key, "midi_output_device_1") == 0) {
+                    state->device_config.midi_output_device_1 = atoi(value);
+                } else if (strcmp(key, "midi_output_device_2") == 0) {
+                    state->device_config.midi_output_device_2 = atoi(value);
+                } else if (strcmp(key, "midi_output_device_3") == 0) {
+                    state->device_config.midi_output_device_3 = atoi(value);
+                } else if (strcmp(key, "midi_output_clock_ports") == 0) {
+                    state->device_config.midi_output_clock_ports = atoi(value);
+                } else if (strcmp(key, "midi_output_spp_ports") == 0) {
+                    state->device_config.midi_output_spp_ports = atoi(value);
+                } else if (strcmp(key, "midi_output_latency_ms") == 0) {
+                    state->device_config.midi_output_latency_ms = atoi(value);
+                } else if (strcmp(key, "midi_output_latency_ms_1") == 0) {
+                    state->device_config.midi_output_latency_ms_1 = atoi(value);
+                } else if (strcmp(key, "midi_output_latency_ms_2") == 0) {
+                    state->device_config.midi_output_latency_ms_2 = atoi(value);
+                } else if (strcmp(key, "midi_output_latency_ms_3") == 0) {
+                    state->device_config.midi_output_latency_ms_3 = atoi(value);
                 } else if (strcmp(key, "midi_output_note_duration") == 0) {
                     state->device_config.midi_output_note_duration = atoi(value);
                 } else if (strcmp(key, "midi_clock_sync") == 0) {
                     state->device_config.midi_clock_sync = atoi(value);
-                } else if (strcmp(key, "midi_clock_sync_threshold") == 0) {
-                    state->device_config.midi_clock_sync_threshold = atof(value);
+                } else if (strcmp(key, "midi_clock_phase_align") == 0) {
+                    state->device_config.midi_clock_phase_align = atoi(value) ? 1 : 0;
                 } else if (strcmp(key, "midi_clock_master") == 0) {
                     state->device_config.midi_clock_master = atoi(value);
                 } else if (strcmp(key, "midi_clock_send_transport") == 0) {
@@ -346,6 +394,10 @@ int regroove_common_load_mappings(RegrooveCommonState *state, const char *ini_pa
                     state->device_config.fx_delay_feedback = atof(value);
                 } else if (strcmp(key, "fx_delay_mix") == 0) {
                     state->device_config.fx_delay_mix = atof(value);
+                } else if (strcmp(key, "fx_convolution_mix") == 0) {
+                    state->device_config.fx_convolution_mix = atof(value);
+                } else if (strcmp(key, "fx_convolution_ir") == 0) {
+                    snprintf(state->device_config.fx_convolution_ir, COMMON_MAX_PATH, "%s", value);
                 }
             }
         }
@@ -435,7 +487,7 @@ int regroove_common_load_module(RegrooveCommonState *state, const char *path,
     }
 
     // Create new module (use the resolved module path)
-    Regroove *mod = regroove_create(module_to_load, 48000.0);
+    Regroove *mod = regroove_create(module_to_load, (double)state->sample_rate);
     if (!mod) {
         return -1;
     }
@@ -529,6 +581,15 @@ int regroove_common_load_module(RegrooveCommonState *state, const char *path,
             snprintf(state->metadata->module_file, RGX_MAX_FILEPATH, "%s", filename);
             printf("Loaded module %s (no .rgx loaded, starting fresh)\n", filename);
         }
+
+        // Song pads are matched through the input mapping tables
+        input_mappings_set_song_pads(state->input_mappings, state->metadata->song_trigger_pads);
+    }
+
+    // Apply sidechain key channel (from .rgx, disabled for fresh modules)
+    if (state->metadata) {
+        regroove_set_sidechain(mod, state->metadata->sidechain_channel,
+                               (RegrooveSidechainSource)state->metadata->sidechain_source);
     }
 
     // Set callbacks if provided
@@ -536,6 +597,9 @@ int regroove_common_load_module(RegrooveCommonState *state, const char *path,
         regroove_set_callbacks(mod, callbacks);
     }
 
+    // Report notes ahead for the MIDI output latency compensation
+    regroove_common_apply_midi_output_latency(state);
+
     // Note: Audio device is NOT paused here anymore
     // GUI needs audio always active for input passthrough
     // TUI can pause/unpause as needed via regroove_common_play_pause()
@@ -604,12 +668,16 @@ void regroove_common_play_pause(RegrooveCommonState *state, int play) {
                 regroove_performance_set_playback(state->performance, 1);
             }
         }
+        // Notes reported ahead start again from the playing row
+        regroove_common_apply_midi_output_latency(state);
     } else if (!play && !state->paused) {
         // Stopping playback - reset performance
         if (state->performance) {
             regroove_performance_set_playback(state->performance, 0);
             regroove_performance_reset(state->performance);
         }
+        // Drop notes already sent ahead for rows that will not play now
+        if (midi_output_is_open(-1)) midi_output_cancel_notes(REGROOVE_ALL_CHANNELS, 0.0);
     }
 
     state->paused = !play;
@@ -700,6 +768,21 @@ void regroove_common_set_pitch(RegrooveCommonState *state, double pitch) {
     regroove_set_pitch(state->player, state->pitch);
 }
 
+void regroove_common_set_sample_rate(RegrooveCommonState *state, int sample_rate) {
+    if (!state || sample_rate <= 0) return;
+
+    if (state->audio_device_id) {
+        SDL_LockAudioDevice(state->audio_device_id);
+    }
+    state->sample_rate = sample_rate;
+    if (state->player) {
+        regroove_set_samplerate(state->player, (double)sample_rate);
+    }
+    if (state->audio_device_id) {
+        SDL_UnlockAudioDevice(state->audio_device_id);
+    }
+}
+
 // Save device configuration to existing INI file
 // Simple approach: append [devices] section if missing, or rewrite entire file if it exists
 int regroove_common_save_device_config(RegrooveCommonState *state, const char *filepath) {
@@ -732,11 +815,24 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
         fprintf(f, "midi_device_2 = %d\n", state->device_config.midi_device_2);
         fprintf(f, "audio_device = %d\n", state->device_config.audio_device);
         fprintf(f, "audio_input_device = %d\n", state->device_config.audio_input_device);
+        fprintf(f, "audio_cue_device = %d\n", state->device_config.audio_cue_device);
         fprintf(f, "audio_input_buffer_ms = %d\n", state->device_config.audio_input_buffer_ms);
+        fprintf(f, "mixer_pan_law = %d\n", state->device_config.mixer_pan_law);
+        fprintf(f, "audio_roundtrip_latency_ms = %.2f\n", state->device_config.audio_roundtrip_latency_ms);
+        fprintf(f, "record_stems = %d\n", state->device_config.record_stems);
         fprintf(f, "midi_output_device = %d\n", state->device_config.midi_output_device);
+        fprintf(f, "midi_output_device_1 = %d\n", state->device_config.midi_output_device_1);
+        fprintf(f, "midi_output_device_2 = %d\n", state->device_config.midi_output_device_2);
+        fprintf(f, "midi_output_device_3 = %d\n", state->device_config.midi_output_device_3);
+        fprintf(f, "midi_output_clock_ports = %d\n", state->device_config.midi_output_clock_ports);
+        fprintf(f, "midi_output_spp_ports = %d\n", state->device_config.midi_output_spp_ports);
+        fprintf(f, "midi_output_latency_ms = %d\n", state->device_config.midi_output_latency_ms);
+        fprintf(f, "midi_output_latency_ms_1 = %d\n", state->device_config.midi_output_latency_ms_1);
+        fprintf(f, "midi_output_latency_ms_2 = %d\n", state->device_config.midi_output_latency_ms_2);
+        fprintf(f, "midi_output_latency_ms_3 = %d\n", state->device_config.midi_output_latency_ms_3);
         fprintf(f, "midi_output_note_duration = %d\n", state->device_config.midi_output_note_duration);
         fprintf(f, "midi_clock_sync = %d\n", state->device_config.midi_clock_sync);
-        fprintf(f, "midi_clock_sync_threshold = %.2f\n", state->device_config.midi_clock_sync_threshold);
+        fprintf(f, "midi_clock_phase_align = %d\n", state->device_config.midi_clock_phase_align);
         fprintf(f, "midi_clock_master = %d\n", state->device_config.midi_clock_master);
         fprintf(f, "midi_clock_send_transport = %d\n", state->device_config.midi_clock_send_transport);
         fprintf(f, "midi_clock_send_spp = %d\n", state->device_config.midi_clock_send_spp);
@@ -765,6 +861,8 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
         fprintf(f, "fx_delay_time = %.2f\n", state->device_config.fx_delay_time);
         fprintf(f, "fx_delay_feedback = %.2f\n", state->device_config.fx_delay_feedback);
         fprintf(f, "fx_delay_mix = %.2f\n", state->device_config.fx_delay_mix);
+        fprintf(f, "fx_convolution_mix = %.2f\n", state->device_config.fx_convolution_mix);
+        fprintf(f, "fx_convolution_ir = %s\n", state->device_config.fx_convolution_ir);
         fprintf(f, "\n");
 
         fclose(f);
@@ -782,11 +880,24 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
         fprintf(f, "midi_device_2 = %d\n", state->device_config.midi_device_2);
         fprintf(f, "audio_device = %d\n", state->device_config.audio_device);
         fprintf(f, "audio_input_device = %d\n", state->device_config.audio_input_device);
+        fprintf(f, "audio_cue_device = %d\n", state->device_config.audio_cue_device);
         fprintf(f, "audio_input_buffer_ms = %d\n", state->device_config.audio_input_buffer_ms);
+        fprintf(f, "mixer_pan_law = %d\n", state->device_config.mixer_pan_law);
+        fprintf(f, "audio_roundtrip_latency_ms = %.2f\n", state->device_config.audio_roundtrip_latency_ms);
+        fprintf(f, "record_stems = %d\n", state->device_config.record_stems);
         fprintf(f, "midi_output_device = %d\n", state->device_config.midi_output_device);
+        fprintf(f, "midi_output_device_1 = %d\n", state->device_config.midi_output_device_1);
+        fprintf(f, "midi_output_device_2 = %d\n", state->device_config.midi_output_device_2);
+        fprintf(f, "midi_output_device_3 = %d\n", state->device_config.midi_output_device_3);
+        fprintf(f, "midi_output_clock_ports = %d\n", state->device_config.midi_output_clock_ports);
+        fprintf(f, "midi_output_spp_ports = %d\n", state->device_config.midi_output_spp_ports);
+        fprintf(f, "midi_output_latency_ms = %d\n", state->device_config.midi_output_latency_ms);
+        fprintf(f, "midi_output_latency_ms_1 = %d\n", state->device_config.midi_output_latency_ms_1);
+        fprintf(f, "midi_output_latency_ms_2 = %d\n", state->device_config.midi_output_latency_ms_2);
+        fprintf(f, "midi_output_latency_ms_3 = %d\n", state->device_config.midi_output_latency_ms_3);
         fprintf(f, "midi_output_note_duration = %d\n", state->device_config.midi_output_note_duration);
         fprintf(f, "midi_clock_sync = %d\n", state->device_config.midi_clock_sync);
-        fprintf(f, "midi_clock_sync_threshold = %.2f\n", state->device_config.midi_clock_sync_threshold);
+        fprintf(f, "midi_clock_phase_align = %d\n", state->device_config.midi_clock_phase_align);
         fprintf(f, "midi_clock_master = %d\n", state->device_config.midi_clock_master);
         fprintf(f, "midi_clock_send_transport = %d\n", state->device_config.midi_clock_send_transport);
         fprintf(f, "midi_clock_send_spp = %d\n", state->device_config.midi_clock_send_spp);
@@ -815,6 +926,8 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
         fprintf(f, "fx_delay_time = %.2f\n", state->device_config.fx_delay_time);
         fprintf(f, "fx_delay_feedback = %.2f\n", state->device_config.fx_delay_feedback);
         fprintf(f, "fx_delay_mix = %.2f\n", state->device_config.fx_delay_mix);
+        fprintf(f, "fx_convolution_mix = %.2f\n", state->device_config.fx_convolution_mix);
+        fprintf(f, "fx_convolution_ir = %s\n", state->device_config.fx_convolution_ir);
 
         fclose(f);
         return 0;
@@ -847,10 +960,23 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
                 fprintf(f_write, "midi_device_1 = %d\n", state->device_config.midi_device_1);
                 fprintf(f_write, "audio_device = %d\n", state->device_config.audio_device);
                 fprintf(f_write, "audio_input_device = %d\n", state->device_config.audio_input_device);
+                fprintf(f_write, "audio_cue_device = %d\n", state->device_config.audio_cue_device);
+                fprintf(f_write, "mixer_pan_law = %d\n", state->device_config.mixer_pan_law);
+                fprintf(f_write, "audio_roundtrip_latency_ms = %.2f\n", state->device_config.audio_roundtrip_latency_ms);
+                fprintf(f_write, "record_stems = %d\n", state->device_config.record_stems);
                 fprintf(f_write, "midi_output_device = %d\n", state->device_config.midi_output_device);
+                fprintf(f_write, "midi_output_device_1 = %d\n", state->device_config.midi_output_device_1);
+                fprintf(f_write, "midi_output_device_2 = %d\n", state->device_config.midi_output_device_2);
+                fprintf(f_write, "midi_output_device_3 = %d\n", state->device_config.midi_output_device_3);
+                fprintf(f_write, "midi_output_clock_ports = %d\n", state->device_config.midi_output_clock_ports);
+                fprintf(f_write, "midi_output_spp_ports = %d\n", state->device_config.midi_output_spp_ports);
+                fprintf(f_write, "midi_output_latency_ms = %d\n", state->device_config.midi_output_latency_ms);
+                fprintf(f_write, "midi_output_latency_ms_1 = %d\n", state->device_config.midi_output_latency_ms_1);
+                fprintf(f_write, "midi_output_latency_ms_2 = %d\n", state->device_config.midi_output_latency_ms_2);
+                fprintf(f_write, "midi_output_latency_ms_3 = %d\n", state->device_config.midi_output_latency_ms_3);
                 fprintf(f_write, "midi_output_note_duration = %d\n", state->device_config.midi_output_note_duration);
                 fprintf(f_write, "midi_clock_sync = %d\n", state->device_config.midi_clock_sync);
-                fprintf(f_write, "midi_clock_sync_threshold = %.2f\n", state->device_config.midi_clock_sync_threshold);
+                fprintf(f_write, "midi_clock_phase_align = %d\n", state->device_config.midi_clock_phase_align);
                 fprintf(f_write, "midi_clock_master = %d\n", state->device_config.midi_clock_master);
                 fprintf(f_write, "midi_clock_send_transport = %d\n", state->device_config.midi_clock_send_transport);
                 fprintf(f_write, "midi_clock_send_spp = %d\n", state->device_config.midi_clock_send_spp);
@@ -878,6 +1004,8 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
                 fprintf(f_write, "fx_delay_time = %.2f\n", state->device_config.fx_delay_time);
                 fprintf(f_write, "fx_delay_feedback = %.2f\n", state->device_config.fx_delay_feedback);
                 fprintf(f_write, "fx_delay_mix = %.2f\n", state->device_config.fx_delay_mix);
+                fprintf(f_write, "fx_convolution_mix = %.2f\n", state->device_config.fx_convolution_mix);
+                fprintf(f_write, "fx_convolution_ir = %s\n", state->device_config.fx_convolution_ir);
                 devices_written = 1;
             }
             in_devices_section = (strstr(line, "[devices]") != NULL);
@@ -894,10 +1022,23 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
                 fprintf(f_write, "midi_device_1 = %d\n", state->device_config.midi_device_1);
                 fprintf(f_write, "audio_device = %d\n", state->device_config.audio_device);
                 fprintf(f_write, "audio_input_device = %d\n", state->device_config.audio_input_device);
+                fprintf(f_write, "audio_cue_device = %d\n", state->device_config.audio_cue_device);
+                fprintf(f_write, "mixer_pan_law = %d\n", state->device_config.mixer_pan_law);
+                fprintf(f_write, "audio_roundtrip_latency_ms = %.2f\n", state->device_config.audio_roundtrip_latency_ms);
+                fprintf(f_write, "record_stems = %d\n", state->device_config.record_stems);
                 fprintf(f_write, "midi_output_device = %d\n", state->device_config.midi_output_device);
+                fprintf(f_write, "midi_output_device_1 = %d\n", state->device_config.midi_output_device_1);
+                fprintf(f_write, "midi_output_device_2 = %d\n", state->device_config.midi_output_device_2);
+                fprintf(f_write, "midi_output_device_3 = %d\n", state->device_config.midi_output_device_3);
+                fprintf(f_write, "midi_output_clock_ports = %d\n", state->device_config.midi_output_clock_ports);
+                fprintf(f_write, "midi_output_spp_ports = %d\n", state->device_config.midi_output_spp_ports);
+                fprintf(f_write, "midi_output_latency_ms = %d\n", state->device_config.midi_output_latency_ms);
+                fprintf(f_write, "midi_output_latency_ms_1 = %d\n", state->device_config.midi_output_latency_ms_1);
+                fprintf(f_write, "midi_output_latency_ms_2 = %d\n", state->device_config.midi_output_latency_ms_2);
+                fprintf(f_write, "midi_output_latency_ms_3 = %d\n", state->device_config.midi_output_latency_ms_3);
                 fprintf(f_write, "midi_output_note_duration = %d\n", state->device_config.midi_output_note_duration);
                 fprintf(f_write, "midi_clock_sync = %d\n", state->device_config.midi_clock_sync);
-                fprintf(f_write, "midi_clock_sync_threshold = %.2f\n", state->device_config.midi_clock_sync_threshold);
+                fprintf(f_write, "midi_clock_phase_align = %d\n", state->device_config.midi_clock_phase_align);
                 fprintf(f_write, "midi_clock_master = %d\n", state->device_config.midi_clock_master);
                 fprintf(f_write, "midi_clock_send_transport = %d\n", state->device_config.midi_clock_send_transport);
                 fprintf(f_write, "midi_clock_send_spp = %d\n", state->device_config.midi_clock_send_spp);
@@ -925,6 +1066,8 @@ int regroove_common_save_device_config(RegrooveCommonState *state, const char *f
                 fprintf(f_write, "fx_delay_time = %.2f\n", state->device_config.fx_delay_time);
                 fprintf(f_write, "fx_delay_feedback = %.2f\n", state->device_config.fx_delay_feedback);
                 fprintf(f_write, "fx_delay_mix = %.2f\n", state->device_config.fx_delay_mix);
+                fprintf(f_write, "fx_convolution_mix = %.2f\n", state->device_config.fx_convolution_mix);
+                fprintf(f_write, "fx_convolution_ir = %s\n", state->device_config.fx_convolution_ir);
                 devices_written = 1;
                 // Skip the old line (don't write it)
             }
@@ -964,13 +1107,34 @@ int regroove_common_save_default_config(const char *filepath) {
     fprintf(f, "# Audio devices (-1 = default for output, -1 = disabled for input)\n");
     fprintf(f, "audio_device = -1\n");
     fprintf(f, "audio_input_device = -1\n");
+    fprintf(f, "# Cue/headphone output device (-1 = disabled)\n");
+    fprintf(f, "audio_cue_device = -1\n");
     fprintf(f, "# Audio input buffer size in milliseconds (10-500, default: 100)\n");
     fprintf(f, "audio_input_buffer_ms = 100\n");
+    fprintf(f, "# Pan law of playback/input: 0=constant power (-3 dB), 1=balance (0 dB), 2=linear (-6 dB, default)\n");
+    fprintf(f, "mixer_pan_law = 2\n");
+    fprintf(f, "# Measured output-to-input round trip in ms (0 = not calibrated, set by Calibrate in the GUI).\n");
+    fprintf(f, "# Output and input device buffering plus the loopback path, without the input buffer\n");
+    fprintf(f, "audio_roundtrip_latency_ms = 0\n");
+    fprintf(f, "# Disk recorder: 0=master only, 1=also record pre-FX playback and input\n");
+    fprintf(f, "record_stems = 0\n");
     fprintf(f, "midi_output_device = -1\n");
+    fprintf(f, "# Additional MIDI outputs (instruments are routed to them in the .rgx)\n");
+    fprintf(f, "midi_output_device_1 = -1\n");
+    fprintf(f, "midi_output_device_2 = -1\n");
+    fprintf(f, "midi_output_device_3 = -1\n");
+    fprintf(f, "# Outputs carrying MIDI Clock/transport and SPP (bit N = output N, 1 = first output only)\n");
+    fprintf(f, "midi_output_clock_ports = 1\n");
+    fprintf(f, "midi_output_spp_ports = 1\n");
+    fprintf(f, "# Latency of each MIDI output in ms: its notes are sent this much ahead of the audio\n");
+    fprintf(f, "midi_output_latency_ms = 0\n");
+    fprintf(f, "midi_output_latency_ms_1 = 0\n");
+    fprintf(f, "midi_output_latency_ms_2 = 0\n");
+    fprintf(f, "midi_output_latency_ms_3 = 0\n");
     fprintf(f, "# MIDI Clock sync: 0=disabled, 1=sync tempo to incoming MIDI clock\n");
     fprintf(f, "midi_clock_sync = 0\n");
-    fprintf(f, "# MIDI Clock sync threshold: tempo change %% to apply pitch adjustment (0.1-5.0, default 0.5)\n");
-    fprintf(f, "midi_clock_sync_threshold = 0.5\n");
+    fprintf(f, "# MIDI Clock phase align: 0=tempo only, 1=also align rows to the external beat\n");
+    fprintf(f, "midi_clock_phase_align = 1\n");
     fprintf(f, "# MIDI Clock master: 0=disabled, 1=send MIDI clock as master\n");
     fprintf(f, "midi_clock_master = 0\n");
     fprintf(f, "# MIDI transport messages: 0=disabled, 1=send Start/Stop when master\n");
@@ -1010,7 +1174,10 @@ int regroove_common_save_default_config(const char *filepath) {
     fprintf(f, "fx_compressor_makeup = 0.65\n");
     fprintf(f, "fx_delay_time = 0.375\n");
     fprintf(f, "fx_delay_feedback = 0.40\n");
-    fprintf(f, "fx_delay_mix = 0.30\n\n");
+    fprintf(f, "fx_delay_mix = 0.30\n");
+    fprintf(f, "fx_convolution_mix = 0.30\n");
+    fprintf(f, "# Impulse response WAV for the convolution reverb (empty = none; .rgx [Convolution] overrides)\n");
+    fprintf(f, "fx_convolution_ir = \n\n");
 
     // MIDI mappings section
     fprintf(f, "[midi]\n");
@@ -1142,19 +1309,166 @@ int regroove_common_save_rgx(RegrooveCommonState *state) {
     return 0;
 }
 
+// Get the configured device of a MIDI output port (-1 = not configured)
+int regroove_common_get_midi_output_device(const RegrooveCommonState *state, int port) {
+    if (!state) return -1;
+    switch (port) {
+        case 0: return state->device_config.midi_output_device;
+        case 1: return state->device_config.midi_output_device_1;
+        case 2: return state->device_config.midi_output_device_2;
+        case 3: return state->device_config.midi_output_device_3;
+        default: return -1;
+    }
+}
+
+// Set the configured device of a MIDI output port (-1 = not configured)
+void regroove_common_set_midi_output_device(RegrooveCommonState *state, int port, int device) {
+    if (!state) return;
+    switch (port) {
+        case 0: state->device_config.midi_output_device = device; break;
+        case 1: state->device_config.midi_output_device_1 = device; break;
+        case 2: state->device_config.midi_output_device_2 = device; break;
+        case 3: state->device_config.midi_output_device_3 = device; break;
+        default: break;
+    }
+}
+
+// Apply the per-port clock/SPP selection from the config
+void regroove_common_apply_midi_output_sync(RegrooveCommonState *state) {
+    if (!state) return;
+    for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+        midi_output_set_port_sync(port,
+                                  (state->device_config.midi_output_clock_ports >> port) & 1,
+                                  (state->device_config.midi_output_spp_ports >> port) & 1);
+    }
+}
+
+// Get the configured latency of a MIDI output port in ms
+int regroove_common_get_midi_output_latency(const RegrooveCommonState *state, int port) {
+    if (!state) return 0;
+    switch (port) {
+        case 0: return state->device_config.midi_output_latency_ms;
+        case 1: return state->device_config.midi_output_latency_ms_1;
+        case 2: return state->device_config.midi_output_latency_ms_2;
+        case 3: return state->device_config.midi_output_latency_ms_3;
+        default: return 0;
+    }
+}
+
+// Set the configured latency of a MIDI output port in ms
+void regroove_common_set_midi_output_latency(RegrooveCommonState *state, int port, int latency_ms) {
+    if (!state) return;
+    switch (port) {
+        case 0: state->device_config.midi_output_latency_ms = latency_ms; break;
+        case 1: state->device_config.midi_output_latency_ms_1 = latency_ms; break;
+        case 2: state->device_config.midi_output_latency_ms_2 = latency_ms; break;
+        case 3: state->device_config.midi_output_latency_ms_3 = latency_ms; break;
+        default: break;
+    }
+}
+
+// Apply the per-port latencies; the player reports notes as far ahead as the slowest
+// configured port needs (no lookahead when no latency is set)
+void regroove_common_apply_midi_output_latency(RegrooveCommonState *state) {
+    if (!state) return;
+    int max_latency = 0;
+    for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+        int latency = regroove_common_get_midi_output_latency(state, port);
+        midi_output_set_port_latency(port, latency);
+        if (regroove_common_get_midi_output_device(state, port) >= 0 && latency > max_latency) {
+            max_latency = latency;
+        }
+    }
+    if (state->player) {
+        regroove_set_note_lookahead(state->player, max_latency / 1000.0);
+    }
+}
+
+void regroove_common_apply_midi_output_note_duration(RegrooveCommonState *state) {
+    if (!state) return;
+    // "Immediate off" still needs a length the synth can hear: one tick
+    midi_output_set_default_note_length(state->device_config.midi_output_note_duration ? 0 : 1,
+                                        RGX_NOTE_LENGTH_TICKS);
+}
+
+void regroove_common_apply_midi_mapping(RegrooveCommonState *state) {
+    if (!state) return;
+    midi_output_set_metadata(state->metadata);
+    if (!state->player || !state->metadata) {
+        midi_output_set_program_schedule(0, NULL, NULL);
+        return;
+    }
+
+    // Per order and port/MIDI channel: the program of its first note, and the row
+    // after its last note (see midi_output_set_program_schedule)
+    int num_orders = regroove_get_num_orders(state->player);
+    int slots = MIDI_OUT_MAX_DEVICES * 16;
+    int *programs = (int *)malloc((size_t)num_orders * slots * sizeof(int));
+    int *free_rows = (int *)malloc((size_t)num_orders * slots * sizeof(int));
+    int first_rows[MIDI_OUT_MAX_DEVICES * 16];
+    if (num_orders <= 0 || !programs || !free_rows) {
+        free(programs);
+        free(free_rows);
+        midi_output_set_program_schedule(0, NULL, NULL);
+        return;
+    }
+
+    for (int order = 0; order < num_orders; order++) {
+        int *order_programs = programs + order * slots;
+        int *order_free_rows = free_rows + order * slots;
+        for (int slot = 0; slot < slots; slot++) {
+            order_programs[slot] = -1;
+            order_free_rows[slot] = 0;
+            first_rows[slot] = -1;
+        }
+
+        const RegrooveInstrumentRun *runs;
+        int num_runs = regroove_get_pattern_instruments(state->player,
+                                                        regroove_get_order_pattern(state->player, order), &runs);
+        for (int i = 0; i < num_runs; i++) {
+            // Same instrument numbering as midi_output_handle_note
+            int instrument_index = (runs[i].instrument > 0) ? (runs[i].instrument - 1) : runs[i].instrument;
+            int channel = regroove_metadata_get_midi_channel(state->metadata, instrument_index);
+            int port = regroove_metadata_get_midi_port(state->metadata, instrument_index);
+            if (channel < 0 || channel > 15 || port < 0 || port >= MIDI_OUT_MAX_DEVICES) continue;
+
+            int slot = port * 16 + channel;
+            if (first_rows[slot] < 0 || runs[i].first_row < first_rows[slot]) {
+                first_rows[slot] = runs[i].first_row;
+                order_programs[slot] = regroove_metadata_get_program(state->metadata, instrument_index);
+            }
+            if (runs[i].last_row + 1 > order_free_rows[slot]) {
+                order_free_rows[slot] = runs[i].last_row + 1;
+            }
+        }
+    }
+
+    midi_output_set_program_schedule(num_orders, programs, free_rows);
+    free(programs);
+    free(free_rows);
+}
+
 // MIDI output initialization (applies all config settings)
 int regroove_common_init_midi_output(RegrooveCommonState *state) {
     if (!state) return -1;
-    if (state->device_config.midi_output_device < 0) return -1;  // Not configured
 
-    // Initialize MIDI output device
-    if (midi_output_init(state->device_config.midi_output_device) != 0) {
-        fprintf(stderr, "Failed to initialize MIDI output on device %d\n",
-                state->device_config.midi_output_device);
-        return -1;
+    // Open every configured output port
+    int opened = 0;
+    for (int port = 0; port < MIDI_OUT_MAX_DEVICES; port++) {
+        int device = regroove_common_get_midi_output_device(state, port);
+        if (device < 0) continue;  // Not configured
+        if (midi_output_open(port, device) != 0) {
+            fprintf(stderr, "Failed to initialize MIDI output %d on device %d\n", port + 1, device);
+            continue;
+        }
+        printf("MIDI output %d enabled on device %d\n", port + 1, device);
+        opened++;
     }
+    if (opened == 0) return -1;
 
-    printf("MIDI output enabled on device %d\n", state->device_config.midi_output_device);
+    regroove_common_apply_midi_output_sync(state);
+    regroove_common_apply_midi_output_latency(state);
+    regroove_common_apply_midi_output_note_duration(state);
 
     // Apply MIDI Clock master mode from config
     if (state->device_config.midi_clock_master) {
@@ -1251,3 +1565,28 @@ int regroove_common_phrase_is_active(const RegrooveCommonState *state) {
     if (!state || !state->phrase) return 0;
     return regroove_phrase_is_active(state->phrase);
 }
+
+int regroove_common_get_convolution_ir(RegrooveCommonState *state, char *out, size_t out_size) {
+    if (!state || !out || out_size == 0) return -1;
+    out[0] = '\0';
+
+    const char *ir = (state->metadata) ? state->metadata->convolution_ir : "";
+    if (ir[0] == '\0') {
+        snprintf(out, out_size, "%s", state->device_config.fx_convolution_ir);
+        return 0;
+    }
+
+    // Absolute paths are used as-is, relative ones are next to the module (and its .rgx)
+    int absolute = (ir[0] == '/' || ir[0] == '\\' || (ir[0] != '\0' && ir[1] == ':'));
+    const char *slash = strrchr(state->current_module_path, '/');
+    const char *backslash = strrchr(state->current_module_path, '\\');
+    if (backslash > slash) slash = backslash;
+
+    if (absolute || !slash) {
+        snprintf(out, out_size, "%s", ir);
+    } else {
+        int dir_len = (int)(slash - state->current_module_path) + 1;
+        snprintf(out, out_size, "%.*s%s", dir_len, state->current_module_path, ir);
+    }
+    return 0;
+}
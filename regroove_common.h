@@ -16,6 +16,9 @@ extern "C" {
 #define COMMON_MAX_PATH 1024
 #define COMMON_MAX_FILES 4096
 
+// Sample rate requested from the audio device (the obtained rate may differ)
+#define COMMON_DEFAULT_SAMPLE_RATE 48000
+
 // File list management
 typedef struct {
     char **filenames;     // Array of filenames (not full paths)
@@ -47,11 +50,29 @@ typedef struct {
     int midi_device_2;      // MIDI device 2 port (-1 = not configured)
     int audio_device;       // Audio output device index (-1 = default)
     int audio_input_device; // Audio input device index (-1 = disabled)
+    int audio_cue_device;   // Cue/headphone output device index (-1 = disabled)
     int audio_input_buffer_ms; // Audio input buffer size in ms (10-500, default: 100)
+    int mixer_pan_law;      // Playback/input pan law: 0 = constant power, 1 = balance, 2 = linear (default)
+    // Measured output-to-input round trip in ms (0 = not calibrated): output device and
+    // driver buffering, the loopback path and input device/driver buffering. The input
+    // ring's delay (audio_input_get_target_frames()) is measured and subtracted, so
+    // users of the input ring add it back.
+    float audio_roundtrip_latency_ms;
+    int record_stems;       // Disk recorder: 0 = master only, 1 = also pre-FX playback and input
     int midi_output_device; // MIDI output device port (-1 = disabled)
-    int midi_output_note_duration; // 0 = immediate off, 1 = hold until next note/off command
+    int midi_output_device_1; // Second MIDI output port (-1 = not configured)
+    int midi_output_device_2; // Third MIDI output port (-1 = not configured)
+    int midi_output_device_3; // Fourth MIDI output port (-1 = not configured)
+    int midi_output_clock_ports; // Bit N = send MIDI Clock/transport on output N (default: 1 = first output)
+    int midi_output_spp_ports; // Bit N = send SPP on output N (default: 1 = first output)
+    int midi_output_latency_ms;   // Latency of the first MIDI output in ms: its notes are sent this much earlier (default: 0)
+    int midi_output_latency_ms_1; // Latency of the second MIDI output in ms
+    int midi_output_latency_ms_2; // Latency of the third MIDI output in ms
+    int midi_output_latency_ms_3; // Latency of the fourth MIDI output in ms
+    int midi_output_note_duration; // 0 = off after one tick, 1 = hold until next note/off command
+                                   // (instruments with a note length in the .rgx use their own)
     int midi_clock_sync;    // 0 = disabled, 1 = sync tempo to incoming MIDI clock (default: 0)
-    float midi_clock_sync_threshold; // Tempo change threshold % to apply pitch adjustment (0.1-5.0, default: 0.5)
+    int midi_clock_phase_align; // 0 = tempo only, 1 = also align the row grid to the external beat (default: 1)
     int midi_clock_master;  // 0 = disabled, 1 = send MIDI clock as master (default: 0)
     int midi_clock_send_transport; // 0 = disabled, 1 = send MIDI Start/Stop/Continue when master (default: 0)
     int midi_clock_send_spp; // 0 = disabled, 1 = on stop only (standard MIDI), 2 = during playback (regroove-to-regroove) (default: 2)
@@ -82,6 +103,8 @@ typedef struct {
     float fx_delay_time;            // 0.0 - 1.0
     float fx_delay_feedback;        // 0.0 - 1.0
     float fx_delay_mix;             // 0.0 - 1.0
+    float fx_convolution_mix;       // 0.0 - 1.0
+    char fx_convolution_ir[COMMON_MAX_PATH];  // Default impulse response WAV ("" = none)
 } RegrooveDeviceConfig;
 
 // Common playback state
@@ -96,6 +119,7 @@ typedef struct {
     int paused;
     int num_channels;
     double pitch;
+    int sample_rate;               // Obtained output device sample rate (Hz)
     unsigned int audio_device_id;  // SDL_AudioDeviceID for device-specific audio control
     char current_module_path[COMMON_MAX_PATH];  // Track current module for .rgx saving
 } RegrooveCommonState;
@@ -128,16 +152,41 @@ void regroove_common_pitch_up(RegrooveCommonState *state);
 void regroove_common_pitch_down(RegrooveCommonState *state);
 void regroove_common_set_pitch(RegrooveCommonState *state, double pitch);
 
+// Apply the audio device's obtained sample rate to the current and future modules
+void regroove_common_set_sample_rate(RegrooveCommonState *state, int sample_rate);
+
 // Phrase playback functions (wrappers around phrase engine)
 void regroove_common_set_phrase_callback(RegrooveCommonState *state, PhraseActionCallback callback, void *userdata);
 void regroove_common_trigger_phrase(RegrooveCommonState *state, int phrase_index);
 void regroove_common_update_phrases(RegrooveCommonState *state);
 int regroove_common_phrase_is_active(const RegrooveCommonState *state);
 
-// MIDI output initialization (applies all config settings)
-// Returns 0 on success, -1 on failure
+// MIDI output initialization: opens every configured output port and applies all config settings
+// Returns 0 if at least one port opened, -1 on failure
 int regroove_common_init_midi_output(RegrooveCommonState *state);
 
+// Configured device of a MIDI output port (0 = midi_output_device, 1-3 = midi_output_device_N)
+int regroove_common_get_midi_output_device(const RegrooveCommonState *state, int port);
+void regroove_common_set_midi_output_device(RegrooveCommonState *state, int port, int device);
+
+// Apply midi_output_clock_ports/midi_output_spp_ports to the open outputs
+void regroove_common_apply_midi_output_sync(RegrooveCommonState *state);
+
+// Configured latency of a MIDI output port in ms (0 = midi_output_latency_ms, 1-3 = midi_output_latency_ms_N)
+int regroove_common_get_midi_output_latency(const RegrooveCommonState *state, int port);
+void regroove_common_set_midi_output_latency(RegrooveCommonState *state, int port, int latency_ms);
+
+// Apply the per-port latencies to MIDI output, and set the player's note lookahead to
+// the largest one so notes can be sent that far ahead of the audio
+void regroove_common_apply_midi_output_latency(RegrooveCommonState *state);
+
+// Apply midi_output_note_duration as the note length of instruments without their own
+void regroove_common_apply_midi_output_note_duration(RegrooveCommonState *state);
+
+// Apply the song's instrument mapping to MIDI output, with the program changes each
+// order needs (from the pattern data). Call after loading and after mapping changes
+void regroove_common_apply_midi_mapping(RegrooveCommonState *state);
+
 // Save device configuration to existing INI file
 int regroove_common_save_device_config(RegrooveCommonState *state, const char *filepath);
 
@@ -147,6 +196,11 @@ int regroove_common_save_default_config(const char *filepath);
 // Save metadata and performance to .rgx file
 int regroove_common_save_rgx(RegrooveCommonState *state);
 
+// Resolve the convolution impulse response for the current module: the .rgx [Convolution] ir
+// (relative to the module's directory) or else the device config default.
+// Returns 0 and fills out ("" = none)
+int regroove_common_get_convolution_ir(RegrooveCommonState *state, char *out, size_t out_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,660 @@
+#include "regroove_convolver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_thread.h>
+
+#define CONV_PI 3.14159265358979323846
+
+// Derived partition sizes
+#define HEAD_BLOCK REGROOVE_CONV_HEAD_BLOCK
+#define HEAD_FFT (2 * HEAD_BLOCK)
+#define HEAD_BINS (HEAD_BLOCK + 1)
+#define HEAD_SPECTRUM (4 * HEAD_BINS)        // floats: left then right half spectrum
+#define TAIL_BLOCK REGROOVE_CONV_TAIL_BLOCK
+#define TAIL_FFT (2 * TAIL_BLOCK)
+#define TAIL_BINS (TAIL_BLOCK + 1)
+#define TAIL_SPECTRUM (4 * TAIL_BINS)
+#define HEAD_LENGTH (2 * TAIL_BLOCK)         // IR samples covered by the head segment
+#define TAIL_RATIO (TAIL_BLOCK / HEAD_BLOCK) // Head blocks per tail block
+#define TAIL_SLICES (TAIL_RATIO - 1)         // Head blocks the tail multiply is spread over
+
+// Radix-2 complex FFT plan (interleaved re/im)
+typedef struct {
+    int n;
+    int *bitrev;
+    float *twiddle;  // n/2 complex twiddles e^(-2*pi*i*k/n)
+} FftPlan;
+
+// Impulse response prepared for a sample rate, plus the frequency-domain delay
+// lines that depend on its partition count (allocated with it, so swapping an
+// IR in never allocates on the audio thread)
+typedef struct {
+    int length;       // IR length in samples (after resampling)
+    int head_parts;   // 0 = empty IR (unloaded)
+    int tail_parts;
+    int tail_slice;   // Tail partitions multiplied per head block
+    float *head_h;    // head_parts partition spectra
+    float *tail_h;    // tail_parts partition spectra
+    float *head_fdl;  // Input spectra, newest at head_fdl_pos
+    float *tail_fdl;
+    int head_fdl_pos;
+    int tail_fdl_pos;
+} ConvIR;
+
+struct RegrooveConvolver {
+    int sample_rate;
+    FftPlan head_plan;
+    FftPlan tail_plan;
+    float *scratch;               // TAIL_FFT complex, audio thread only
+
+    // Audio thread state
+    ConvIR *active;
+    float head_in[4 * HEAD_BLOCK];  // Last two head blocks, packed (re = left, im = right)
+    float head_out[2 * HEAD_BLOCK]; // Wet output of the previous head block (interleaved L/R)
+    float head_acc[HEAD_SPECTRUM];
+    float *tail_in;               // Last two tail blocks, packed
+    float *tail_out[2];           // [0] = block being played, [1] = block being computed
+    float *tail_acc;
+    int pos;                      // Sample position in the current head block
+    int phase;                    // Head block index within the current tail block
+
+    // Hand-off between the loader thread, the audio thread and the main thread
+    void *pending;                // ConvIR published by the loader, taken by the audio thread
+    void *retired;                // ConvIR replaced by the audio thread, freed by the main thread
+    SDL_atomic_t active_frames;   // Length + latency of the active IR (0 = none)
+    SDL_atomic_t loading;
+    SDL_Thread *loader;
+    int load_rate;
+    char ir_path[1024];
+};
+
+// --- FFT ---
+
+static int fft_plan_init(FftPlan* p, int n) {
+    p->n = n;
+    p->bitrev = (int*)malloc(n * sizeof(int));
+    p->twiddle = (float*)malloc(n * sizeof(float));
+    if (!p->bitrev || !p->twiddle) return -1;
+
+    int bits = 0;
+    while ((1 << bits) < n) bits++;
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        p->bitrev[i] = r;
+    }
+    for (int k = 0; k < n / 2; k++) {
+        p->twiddle[2 * k] = (float)cos(2.0 * CONV_PI * k / n);
+        p->twiddle[2 * k + 1] = (float)-sin(2.0 * CONV_PI * k / n);
+    }
+    return 0;
+}
+
+static void fft_plan_free(FftPlan* p) {
+    free(p->bitrev);
+    free(p->twiddle);
+    p->bitrev = NULL;
+    p->twiddle = NULL;
+}
+
+// In-place forward FFT
+static void fft_forward(const FftPlan* p, float* x) {
+    const int n = p->n;
+    for (int i = 0; i < n; i++) {
+        int j = p->bitrev[i];
+        if (j > i) {
+            float tr = x[2 * i], ti = x[2 * i + 1];
+            x[2 * i] = x[2 * j];
+            x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j] = tr;
+            x[2 * j + 1] = ti;
+        }
+    }
+    for (int size = 2; size <= n; size <<= 1) {
+        int half = size >> 1;
+        int step = n / size;
+        for (int start = 0; start < n; start += size) {
+            for (int k = 0; k < half; k++) {
+                float wr = p->twiddle[2 * k * step];
+                float wi = p->twiddle[2 * k * step + 1];
+                int a = start + k;
+                int b = a + half;
+                float br = x[2 * b] * wr - x[2 * b + 1] * wi;
+                float bi = x[2 * b] * wi + x[2 * b + 1] * wr;
+                x[2 * b] = x[2 * a] - br;
+                x[2 * b + 1] = x[2 * a + 1] - bi;
+                x[2 * a] += br;
+                x[2 * a + 1] += bi;
+            }
+        }
+    }
+}
+
+// In-place inverse FFT without the 1/n scale (folded into the IR spectra)
+static void fft_inverse(const FftPlan* p, float* x) {
+    for (int i = 0; i < p->n; i++) x[2 * i + 1] = -x[2 * i + 1];
+    fft_forward(p, x);
+    for (int i = 0; i < p->n; i++) x[2 * i + 1] = -x[2 * i + 1];
+}
+
+// Split the FFT of (left + i*right) into the half spectra of left and right (bins 0..n/2)
+static void split_stereo_spectrum(const float* z, int n, float* xl, float* xr) {
+    for (int k = 0; k <= n / 2; k++) {
+        int nk = (n - k) & (n - 1);
+        float zr = z[2 * k], zi = z[2 * k + 1];
+        float cr = z[2 * nk], ci = -z[2 * nk + 1];  // conj(Z[n-k])
+        xl[2 * k] = 0.5f * (zr + cr);
+        xl[2 * k + 1] = 0.5f * (zi + ci);
+        xr[2 * k] = 0.5f * (zi - ci);
+        xr[2 * k + 1] = -0.5f * (zr - cr);
+    }
+}
+
+// Combine the half spectra of two real signals into the full spectrum of (left + i*right)
+static void merge_stereo_spectrum(const float* yl, const float* yr, int n, float* z) {
+    for (int k = 0; k <= n / 2; k++) {
+        z[2 * k] = yl[2 * k] - yr[2 * k + 1];
+        z[2 * k + 1] = yl[2 * k + 1] + yr[2 * k];
+        if (k > 0 && k < n / 2) {
+            int nk = n - k;
+            z[2 * nk] = yl[2 * k] + yr[2 * k + 1];
+            z[2 * nk + 1] = yr[2 * k] - yl[2 * k + 1];
+        }
+    }
+}
+
+// acc += x * h over count complex values (left and right spectra are contiguous)
+static inline void spectrum_mac(float* acc, const float* x, const float* h, int count) {
+    for (int k = 0; k < count; k++) {
+        float xr = x[2 * k], xi = x[2 * k + 1];
+        float hr = h[2 * k], hi = h[2 * k + 1];
+        acc[2 * k] += xr * hr - xi * hi;
+        acc[2 * k + 1] += xr * hi + xi * hr;
+    }
+}
+
+// FFT a packed block pair (2 * block complex samples) into a partition spectrum
+static void analyze_block(const FftPlan* plan, float* scratch, const float* packed, float* dst) {
+    int n = plan->n;
+    memcpy(scratch, packed, 2 * n * sizeof(float));
+    fft_forward(plan, scratch);
+    split_stereo_spectrum(scratch, n, dst, dst + 2 * (n / 2 + 1));
+}
+
+// Inverse FFT an accumulated spectrum; the last n/2 samples are the valid output
+static void synthesize_block(const FftPlan* plan, float* scratch, const float* acc, float* out) {
+    int n = plan->n;
+    merge_stereo_spectrum(acc, acc + 2 * (n / 2 + 1), n, scratch);
+    fft_inverse(plan, scratch);
+    memcpy(out, scratch + n, n * sizeof(float));  // n/2 frames, interleaved L/R
+}
+
+// --- Impulse response loading (loader thread) ---
+
+static uint16_t read_u16(const unsigned char* b) {
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static uint32_t read_u32(const unsigned char* b) {
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+// Read a WAV file into interleaved float (at most 2 channels kept)
+static float* read_wav(const char* path, int* out_frames, int* out_channels, int* out_rate) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open impulse response: %s\n", path);
+        return NULL;
+    }
+
+    unsigned char header[12];
+    if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "Impulse response is not a WAV file: %s\n", path);
+        fclose(f);
+        return NULL;
+    }
+
+    int format = 0, channels = 0, rate = 0, bits = 0;
+    float* pcm = NULL;
+    unsigned char chunk[8];
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = read_u32(chunk + 4);
+        long skip = (long)size + (size & 1);  // Chunks are word aligned
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = {0};
+            uint32_t n = size < sizeof(fmt) ? size : (uint32_t)sizeof(fmt);
+            if (fread(fmt, 1, n, f) != n) break;
+            skip -= n;
+            format = read_u16(fmt);
+            channels = read_u16(fmt + 2);
+            rate = (int)read_u32(fmt + 4);
+            bits = read_u16(fmt + 14);
+            if (format == 0xFFFE && n >= 26) format = read_u16(fmt + 24);  // WAVE_FORMAT_EXTENSIBLE
+        } else if (memcmp(chunk, "data", 4) == 0 && channels > 0 && rate > 0) {
+            int bytes = bits / 8;
+            int supported = (format == 1 && (bits == 16 || bits == 24 || bits == 32)) ||
+                            (format == 3 && bits == 32);
+            if (!supported) {
+                fprintf(stderr, "Unsupported impulse response format (%d, %d-bit): %s\n", format, bits, path);
+                break;
+            }
+
+            int frames = (int)(size / (uint32_t)(bytes * channels));
+            int max_frames = REGROOVE_CONV_MAX_IR_SECONDS * rate;
+            if (frames > max_frames) frames = max_frames;
+            int keep = channels > 2 ? 2 : channels;
+
+            unsigned char* raw = (unsigned char*)malloc((size_t)frames * bytes * channels);
+            pcm = (float*)malloc((size_t)frames * keep * sizeof(float) + 1);
+            if (!raw || !pcm) {
+                free(raw);
+                free(pcm);
+                pcm = NULL;
+                break;
+            }
+            frames = (int)(fread(raw, (size_t)bytes * channels, frames, f));
+
+            for (int i = 0; i < frames; i++) {
+                for (int c = 0; c < keep; c++) {
+                    const unsigned char* s = raw + ((size_t)i * channels + c) * bytes;
+                    float v;
+                    if (format == 3) {
+                        uint32_t u = read_u32(s);
+                        memcpy(&v, &u, sizeof(v));
+                    } else if (bits == 16) {
+                        v = (int16_t)read_u16(s) / 32768.0f;
+                    } else if (bits == 24) {
+                        int32_t x = (int32_t)(((uint32_t)s[0] << 8) | ((uint32_t)s[1] << 16) | ((uint32_t)s[2] << 24)) >> 8;
+                        v = x / 8388608.0f;
+                    } else {
+                        v = (int32_t)read_u32(s) / 2147483648.0f;
+                    }
+                    pcm[i * keep + c] = v;
+                }
+            }
+            free(raw);
+
+            *out_frames = frames;
+            *out_channels = keep;
+            *out_rate = rate;
+            break;
+        }
+
+        if (skip > 0 && fseek(f, skip, SEEK_CUR) != 0) break;
+    }
+
+    fclose(f);
+    if (!pcm) fprintf(stderr, "No usable audio data in impulse response: %s\n", path);
+    return pcm;
+}
+
+// Band-limited resampling (Blackman-windowed sinc, 16 zero crossings)
+static float* resample_channel(const float* in, int in_frames, int stride,
+                               int in_rate, int out_rate, int* out_frames) {
+    double ratio = (double)out_rate / in_rate;
+    int n_out = (int)ceil(in_frames * ratio);
+    float* out = (float*)calloc(n_out > 0 ? n_out : 1, sizeof(float));
+    if (!out) return NULL;
+
+    double cutoff = ratio < 1.0 ? ratio : 1.0;
+    double half_width = 16.0 / cutoff;
+    for (int n = 0; n < n_out; n++) {
+        double t = n / ratio;
+        int first = (int)ceil(t - half_width);
+        int last = (int)floor(t + half_width);
+        if (first < 0) first = 0;
+        if (last >= in_frames) last = in_frames - 1;
+
+        double sum = 0.0;
+        for (int k = first; k <= last; k++) {
+            double x = t - k;
+            double w = 0.42 + 0.5 * cos(CONV_PI * x / half_width) + 0.08 * cos(2.0 * CONV_PI * x / half_width);
+            double arg = CONV_PI * cutoff * x;
+            double s = (fabs(arg) < 1e-9) ? 1.0 : sin(arg) / arg;
+            sum += in[(size_t)k * stride] * cutoff * s * w;
+        }
+        out[n] = (float)sum;
+    }
+
+    *out_frames = n_out;
+    return out;
+}
+
+static void conv_ir_free(ConvIR* ir) {
+    if (!ir) return;
+    free(ir->head_h);
+    free(ir->tail_h);
+    free(ir->head_fdl);
+    free(ir->tail_fdl);
+    free(ir);
+}
+
+// FFT one zero-padded IR partition into dst (gain includes the inverse FFT scale)
+static void ir_partition_spectrum(const FftPlan* plan, float* scratch, const float* left, const float* right,
+                                  int length, int offset, float gain, float* dst) {
+    int n = plan->n;
+    int block = n / 2;
+    memset(scratch, 0, 2 * n * sizeof(float));
+    for (int i = 0; i < block && offset + i < length; i++) {
+        scratch[2 * i] = left[offset + i] * gain;
+        scratch[2 * i + 1] = right[offset + i] * gain;
+    }
+    fft_forward(plan, scratch);
+    split_stereo_spectrum(scratch, n, dst, dst + 2 * (block + 1));
+}
+
+// Read, resample, normalize and partition an IR for the given device rate
+static ConvIR* conv_ir_build(RegrooveConvolver* conv, const char* path, int sample_rate) {
+    int frames = 0, channels = 0, file_rate = 0;
+    float* pcm = read_wav(path, &frames, &channels, &file_rate);
+    if (!pcm) return NULL;
+
+    // Resample each channel to the device rate (mono IRs feed both channels)
+    int length = 0, length_r = 0;
+    float* left = resample_channel(pcm, frames, channels, file_rate, sample_rate, &length);
+    float* right = (channels > 1) ? resample_channel(pcm + 1, frames, channels, file_rate, sample_rate, &length_r)
+                                  : NULL;
+    free(pcm);
+    if (!left || (channels > 1 && !right)) {
+        free(left);
+        free(right);
+        return NULL;
+    }
+    if (!right) right = left;
+
+    // Normalize to unit energy on the louder channel so IRs of any length sit at a similar level
+    double energy_l = 0.0, energy_r = 0.0;
+    for (int i = 0; i < length; i++) {
+        energy_l += (double)left[i] * left[i];
+        energy_r += (double)right[i] * right[i];
+    }
+    double energy = energy_l > energy_r ? energy_l : energy_r;
+    float gain = energy > 1e-12 ? (float)(1.0 / sqrt(energy)) : 0.0f;
+
+    ConvIR* ir = (ConvIR*)calloc(1, sizeof(ConvIR));
+    float* scratch = (float*)malloc(2 * TAIL_FFT * sizeof(float));
+    int ok = (ir != NULL && scratch != NULL && length > 0 && gain > 0.0f);
+    if (ok) {
+        int head_length = length < HEAD_LENGTH ? length : HEAD_LENGTH;
+        ir->length = length;
+        ir->head_parts = (head_length + HEAD_BLOCK - 1) / HEAD_BLOCK;
+        ir->tail_parts = length > HEAD_LENGTH ? (length - HEAD_LENGTH + TAIL_BLOCK - 1) / TAIL_BLOCK : 0;
+        ir->tail_slice = (ir->tail_parts + TAIL_SLICES - 1) / TAIL_SLICES;
+
+        ir->head_h = (float*)calloc((size_t)ir->head_parts * HEAD_SPECTRUM, sizeof(float));
+        ir->head_fdl = (float*)calloc((size_t)ir->head_parts * HEAD_SPECTRUM, sizeof(float));
+        ok = ir->head_h && ir->head_fdl;
+        if (ok && ir->tail_parts > 0) {
+            ir->tail_h = (float*)calloc((size_t)ir->tail_parts * TAIL_SPECTRUM, sizeof(float));
+            ir->tail_fdl = (float*)calloc((size_t)ir->tail_parts * TAIL_SPECTRUM, sizeof(float));
+            ok = ir->tail_h && ir->tail_fdl;
+        }
+    }
+
+    if (ok) {
+        for (int p = 0; p < ir->head_parts; p++) {
+            ir_partition_spectrum(&conv->head_plan, scratch, left, right, length, p * HEAD_BLOCK,
+                                  gain / HEAD_FFT, ir->head_h + (size_t)p * HEAD_SPECTRUM);
+        }
+        for (int p = 0; p < ir->tail_parts; p++) {
+            ir_partition_spectrum(&conv->tail_plan, scratch, left, right, length, HEAD_LENGTH + p * TAIL_BLOCK,
+                                  gain / TAIL_FFT, ir->tail_h + (size_t)p * TAIL_SPECTRUM);
+        }
+        printf("Loaded impulse response %s (%.2fs, %d Hz -> %d Hz, %d+%d partitions)\n",
+               path, (double)length / sample_rate, file_rate, sample_rate, ir->head_parts, ir->tail_parts);
+    } else {
+        conv_ir_free(ir);
+        ir = NULL;
+    }
+
+    free(scratch);
+    if (right != left) free(right);
+    free(left);
+    return ir;
+}
+
+// Hand an IR to the audio thread; an IR it never picked up is freed here
+static void publish_ir(RegrooveConvolver* conv, ConvIR* ir) {
+    ConvIR* unused = (ConvIR*)SDL_AtomicSetPtr(&conv->pending, ir);
+    conv_ir_free(unused);
+}
+
+static int convolver_loader_thread(void* data) {
+    RegrooveConvolver* conv = (RegrooveConvolver*)data;
+    ConvIR* ir = conv_ir_build(conv, conv->ir_path, conv->load_rate);
+    if (ir) publish_ir(conv, ir);
+    else conv->load_rate = 0;  // Allow retrying the same file
+    SDL_AtomicSet(&conv->loading, 0);
+    return 0;
+}
+
+// Wait for the loader and free the IR the audio thread has let go of (main thread)
+static void collect_retired(RegrooveConvolver* conv) {
+    if (conv->loader) {
+        SDL_WaitThread(conv->loader, NULL);
+        conv->loader = NULL;
+    }
+    conv_ir_free((ConvIR*)SDL_AtomicSetPtr(&conv->retired, NULL));
+}
+
+// --- Public API ---
+
+RegrooveConvolver* regroove_convolver_create(int sample_rate) {
+    RegrooveConvolver* conv = (RegrooveConvolver*)calloc(1, sizeof(RegrooveConvolver));
+    if (!conv) return NULL;
+
+    conv->sample_rate = sample_rate;
+    conv->scratch = (float*)malloc(2 * TAIL_FFT * sizeof(float));
+    conv->tail_in = (float*)calloc(4 * TAIL_BLOCK, sizeof(float));
+    conv->tail_out[0] = (float*)calloc(2 * TAIL_BLOCK, sizeof(float));
+    conv->tail_out[1] = (float*)calloc(2 * TAIL_BLOCK, sizeof(float));
+    conv->tail_acc = (float*)calloc(TAIL_SPECTRUM, sizeof(float));
+    if (!conv->scratch || !conv->tail_in || !conv->tail_out[0] || !conv->tail_out[1] || !conv->tail_acc ||
+        fft_plan_init(&conv->head_plan, HEAD_FFT) != 0 || fft_plan_init(&conv->tail_plan, TAIL_FFT) != 0) {
+        regroove_convolver_destroy(conv);
+        return NULL;
+    }
+
+    SDL_AtomicSet(&conv->active_frames, 0);
+    SDL_AtomicSet(&conv->loading, 0);
+    return conv;
+}
+
+void regroove_convolver_destroy(RegrooveConvolver* conv) {
+    if (!conv) return;
+
+    collect_retired(conv);
+    conv_ir_free((ConvIR*)SDL_AtomicSetPtr(&conv->pending, NULL));
+    conv_ir_free(conv->active);
+
+    fft_plan_free(&conv->head_plan);
+    fft_plan_free(&conv->tail_plan);
+    free(conv->scratch);
+    free(conv->tail_in);
+    free(conv->tail_out[0]);
+    free(conv->tail_out[1]);
+    free(conv->tail_acc);
+    free(conv);
+}
+
+int regroove_convolver_load_ir(RegrooveConvolver* conv, const char* path) {
+    if (!conv) return -1;
+
+    // One load at a time; the loader reads ir_path
+    collect_retired(conv);
+
+    // Already loaded (or loading) at this rate
+    if (path && path[0] != '\0' && strcmp(path, conv->ir_path) == 0 && conv->load_rate == conv->sample_rate) {
+        return 0;
+    }
+
+    if (!path || path[0] == '\0') {
+        conv->ir_path[0] = '\0';
+        conv->load_rate = 0;
+        ConvIR* empty = (ConvIR*)calloc(1, sizeof(ConvIR));
+        if (!empty) return -1;
+        publish_ir(conv, empty);
+        return 0;
+    }
+
+    if (path != conv->ir_path) snprintf(conv->ir_path, sizeof(conv->ir_path), "%s", path);
+    conv->load_rate = conv->sample_rate;
+
+    SDL_AtomicSet(&conv->loading, 1);
+    conv->loader = SDL_CreateThread(convolver_loader_thread, "IR Loader", conv);
+    if (!conv->loader) {
+        SDL_AtomicSet(&conv->loading, 0);
+        fprintf(stderr, "Failed to create impulse response loader thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+const char* regroove_convolver_get_ir_path(RegrooveConvolver* conv) {
+    return conv ? conv->ir_path : "";
+}
+
+void regroove_convolver_set_sample_rate(RegrooveConvolver* conv, int sample_rate) {
+    if (!conv || sample_rate <= 0 || sample_rate == conv->sample_rate) return;
+    conv->sample_rate = sample_rate;
+    if (conv->ir_path[0] != '\0') {
+        regroove_convolver_load_ir(conv, conv->ir_path);
+    }
+}
+
+void regroove_convolver_reset(RegrooveConvolver* conv) {
+    if (!conv) return;
+
+    memset(conv->head_in, 0, sizeof(conv->head_in));
+    memset(conv->head_out, 0, sizeof(conv->head_out));
+    memset(conv->tail_in, 0, 4 * TAIL_BLOCK * sizeof(float));
+    memset(conv->tail_out[0], 0, 2 * TAIL_BLOCK * sizeof(float));
+    memset(conv->tail_out[1], 0, 2 * TAIL_BLOCK * sizeof(float));
+    memset(conv->tail_acc, 0, TAIL_SPECTRUM * sizeof(float));
+    conv->pos = 0;
+    conv->phase = 0;
+
+    ConvIR* ir = conv->active;
+    if (ir) {
+        if (ir->head_fdl) memset(ir->head_fdl, 0, (size_t)ir->head_parts * HEAD_SPECTRUM * sizeof(float));
+        if (ir->tail_fdl) memset(ir->tail_fdl, 0, (size_t)ir->tail_parts * TAIL_SPECTRUM * sizeof(float));
+        ir->head_fdl_pos = 0;
+        ir->tail_fdl_pos = 0;
+    }
+}
+
+// Swap in a freshly loaded IR at a block boundary (audio thread)
+static void adopt_pending_ir(RegrooveConvolver* conv) {
+    if (!SDL_AtomicGetPtr(&conv->pending)) return;
+    if (SDL_AtomicGetPtr(&conv->retired)) return;  // Previous IR not collected yet
+
+    ConvIR* ir = (ConvIR*)SDL_AtomicSetPtr(&conv->pending, NULL);
+    if (!ir) return;
+    SDL_AtomicSetPtr(&conv->retired, conv->active);
+    conv->active = ir;
+    regroove_convolver_reset(conv);
+    SDL_AtomicSet(&conv->active_frames, ir->head_parts > 0 ? ir->length + HEAD_BLOCK : 0);
+}
+
+// End of a head block: one head partition FFT plus one slice of the tail work
+static void process_head_block(RegrooveConvolver* conv, ConvIR* ir) {
+    const int phase = conv->phase;
+
+    // Start of a tail block: the block computed during the previous one becomes audible
+    if (phase == 0 && ir->tail_parts > 0) {
+        float* t = conv->tail_out[0];
+        conv->tail_out[0] = conv->tail_out[1];
+        conv->tail_out[1] = t;
+    }
+
+    // Head segment: new input spectrum, multiply against every head partition
+    ir->head_fdl_pos = (ir->head_fdl_pos + 1) % ir->head_parts;
+    analyze_block(&conv->head_plan, conv->scratch, conv->head_in,
+                  ir->head_fdl + (size_t)ir->head_fdl_pos * HEAD_SPECTRUM);
+    memset(conv->head_acc, 0, sizeof(conv->head_acc));
+    for (int p = 0; p < ir->head_parts; p++) {
+        int slot = (ir->head_fdl_pos - p + ir->head_parts) % ir->head_parts;
+        spectrum_mac(conv->head_acc, ir->head_fdl + (size_t)slot * HEAD_SPECTRUM,
+                     ir->head_h + (size_t)p * HEAD_SPECTRUM, 2 * HEAD_BINS);
+    }
+    synthesize_block(&conv->head_plan, conv->scratch, conv->head_acc, conv->head_out);
+    memcpy(conv->head_in, conv->head_in + 2 * HEAD_BLOCK, 2 * HEAD_BLOCK * sizeof(float));
+
+    if (ir->tail_parts > 0) {
+        // Add this head block's share of the tail output
+        const float* t = conv->tail_out[0] + 2 * phase * HEAD_BLOCK;
+        for (int i = 0; i < 2 * HEAD_BLOCK; i++) conv->head_out[i] += t[i];
+
+        if (phase < TAIL_SLICES) {
+            // Multiply one slice of the tail partitions
+            int first = phase * ir->tail_slice;
+            int last = first + ir->tail_slice;
+            if (last > ir->tail_parts) last = ir->tail_parts;
+            for (int p = first; p < last; p++) {
+                int slot = (ir->tail_fdl_pos - p + ir->tail_parts) % ir->tail_parts;
+                spectrum_mac(conv->tail_acc, ir->tail_fdl + (size_t)slot * TAIL_SPECTRUM,
+                             ir->tail_h + (size_t)p * TAIL_SPECTRUM, 2 * TAIL_BINS);
+            }
+            if (phase == TAIL_SLICES - 1) {
+                synthesize_block(&conv->tail_plan, conv->scratch, conv->tail_acc, conv->tail_out[1]);
+                memset(conv->tail_acc, 0, TAIL_SPECTRUM * sizeof(float));
+            }
+        } else {
+            // Tail input block complete: transform it for the next cycle
+            ir->tail_fdl_pos = (ir->tail_fdl_pos + 1) % ir->tail_parts;
+            analyze_block(&conv->tail_plan, conv->scratch, conv->tail_in,
+                          ir->tail_fdl + (size_t)ir->tail_fdl_pos * TAIL_SPECTRUM);
+            memcpy(conv->tail_in, conv->tail_in + 2 * TAIL_BLOCK, 2 * TAIL_BLOCK * sizeof(float));
+        }
+    }
+
+    conv->phase = (phase + 1) % TAIL_RATIO;
+}
+
+int regroove_convolver_tick(RegrooveConvolver* conv, float in_left, float in_right,
+                            float* out_left, float* out_right) {
+    if (conv->pos == 0) adopt_pending_ir(conv);
+
+    ConvIR* ir = conv->active;
+    if (!ir || ir->head_parts == 0) {
+        if (++conv->pos >= HEAD_BLOCK) conv->pos = 0;
+        *out_left = 0.0f;
+        *out_right = 0.0f;
+        return 0;
+    }
+
+    const int i = conv->pos;
+    conv->head_in[2 * (HEAD_BLOCK + i)] = in_left;
+    conv->head_in[2 * (HEAD_BLOCK + i) + 1] = in_right;
+    const int t = TAIL_BLOCK + conv->phase * HEAD_BLOCK + i;
+    conv->tail_in[2 * t] = in_left;
+    conv->tail_in[2 * t + 1] = in_right;
+
+    *out_left = conv->head_out[2 * i];
+    *out_right = conv->head_out[2 * i + 1];
+
+    if (++conv->pos >= HEAD_BLOCK) {
+        conv->pos = 0;
+        process_head_block(conv, ir);
+    }
+    return 1;
+}
+
+int regroove_convolver_has_ir(RegrooveConvolver* conv) {
+    return conv ? SDL_AtomicGet(&conv->active_frames) > 0 : 0;
+}
+
+int regroove_convolver_is_loading(RegrooveConvolver* conv) {
+    return conv ? SDL_AtomicGet(&conv->loading) : 0;
+}
+
+int regroove_convolver_get_tail_frames(RegrooveConvolver* conv) {
+    return conv ? SDL_AtomicGet(&conv->active_frames) : 0;
+}
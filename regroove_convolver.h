@@ -0,0 +1,57 @@
+#ifndef REGROOVE_CONVOLVER_H
+#define REGROOVE_CONVOLVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Uniformly partitioned FFT convolution in two segments:
+// - head: partitions of REGROOVE_CONV_HEAD_BLOCK samples covering the first
+//   2 * REGROOVE_CONV_TAIL_BLOCK samples of the IR (one FFT per head block,
+//   this is the only latency added to the wet signal)
+// - tail: partitions of REGROOVE_CONV_TAIL_BLOCK samples for the rest of the IR,
+//   with the FFT work spread over the head blocks so no single block pays for it
+#define REGROOVE_CONV_HEAD_BLOCK 128
+#define REGROOVE_CONV_TAIL_BLOCK 2048
+
+// Longest impulse response accepted (longer files are truncated)
+#define REGROOVE_CONV_MAX_IR_SECONDS 10
+
+typedef struct RegrooveConvolver RegrooveConvolver;
+
+// Create convolver (no IR loaded)
+RegrooveConvolver* regroove_convolver_create(int sample_rate);
+
+// Free convolver (waits for a pending IR load to finish)
+void regroove_convolver_destroy(RegrooveConvolver* conv);
+
+// Load an impulse response WAV (16/24/32-bit PCM or 32-bit float, mono or stereo).
+// Reading, resampling to the device rate and the partition FFTs run on a background
+// thread; the audio thread swaps the new IR in at its next block boundary.
+// path NULL or "" unloads the IR. Returns 0 if the load was started, -1 on failure.
+// Call from the main thread only.
+int regroove_convolver_load_ir(RegrooveConvolver* conv, const char* path);
+const char* regroove_convolver_get_ir_path(RegrooveConvolver* conv);
+
+// Device rate change: reloads the current IR at the new rate in the background
+void regroove_convolver_set_sample_rate(RegrooveConvolver* conv, int sample_rate);
+
+// Clear convolution state (real-time safe)
+void regroove_convolver_reset(RegrooveConvolver* conv);
+
+// Process one stereo sample. The wet output is delayed by REGROOVE_CONV_HEAD_BLOCK samples.
+// Returns 1 if an IR is active, 0 if not (outputs are then silent)
+int regroove_convolver_tick(RegrooveConvolver* conv, float in_left, float in_right,
+                            float* out_left, float* out_right);
+
+// Status (for UI and auto-sleep)
+int regroove_convolver_has_ir(RegrooveConvolver* conv);
+int regroove_convolver_is_loading(RegrooveConvolver* conv);
+// Length of the active IR plus latency, in frames (0 if none)
+int regroove_convolver_get_tail_frames(RegrooveConvolver* conv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_CONVOLVER_H
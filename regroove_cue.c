@@ -0,0 +1,380 @@
+#include "regroove_cue.h"
+#include "regroove_engine.h"
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+// The master hand-off ring is read at the cue device's clock; its fill is held around
+// the target by dropping back to it when it runs too far ahead, and re-priming after
+// an underrun (a rare, short glitch on the headphones only).
+#define CUE_MASTER_TARGET_MS 20
+#define CUE_MASTER_MAX_FACTOR 3
+
+// The cue player only jumps to the main player's position when the two are further
+// apart than this many rows in the song (block timing alone puts them a row apart,
+// also across an order boundary)
+#define CUE_FOLLOW_TOLERANCE_ROWS 2
+
+// Main player position packed into one atomic value, so order and row are read as a pair
+#define CUE_PACK_POSITION(order, row) (((order) << 16) | ((row) & 0xFFFF))
+#define CUE_POSITION_ORDER(pos) ((pos) >> 16)
+#define CUE_POSITION_ROW(pos) ((pos) & 0xFFFF)
+
+struct RegrooveCue {
+    int sample_rate;
+    int max_frames;
+    int16_t *cue_scratch;       // Cue player render (max_frames stereo frames)
+    int16_t *master_scratch;    // Master frames read from the ring
+
+    // Master hand-off ring (main output callback writes, cue callback reads).
+    // Counts run freely and wrap; the capacity is a power of two.
+    int16_t *ring;
+    int ring_capacity;          // In samples
+    int ring_mask;
+    int ring_target;            // Target fill in samples
+    SDL_atomic_t ring_write;
+    SDL_atomic_t ring_read;
+    int ring_primed;            // Cue callback only
+
+    // Player hand-off (same scheme as the convolver's IR swap)
+    void *pending;              // Regroove loaded by the main thread, taken by the cue callback
+    void *retired;              // Regroove replaced by the cue callback, freed by the main thread
+    Regroove *player;           // Cue callback only
+    char path[1024];            // Main thread only
+
+    // Parameters (written by the main thread)
+    SDL_atomic_t mode;
+    SDL_atomic_t playing;
+    SDL_atomic_t channel_mask[2];  // Cued channels 0-31 and 32-63
+    float volume;
+    float mix;
+
+    // Main player state (written by the main output callback)
+    SDL_atomic_t main_playing;
+    SDL_atomic_t main_position;    // CUE_PACK_POSITION(order, row)
+    SDL_atomic_t main_pitch;       // Pitch * 100, as the engine stores it
+
+    // Applied to the cue player (cue callback only)
+    int applied_mask[2];
+    int applied_pitch;
+    int applied_valid;
+};
+
+static float clampf(float v, float min, float max) {
+    if (v < min) return min;
+    if (v > max) return max;
+    return v;
+}
+
+RegrooveCue* regroove_cue_create(int sample_rate) {
+    RegrooveCue* cue = (RegrooveCue*)calloc(1, sizeof(RegrooveCue));
+    if (!cue) return NULL;
+
+    cue->sample_rate = sample_rate > 0 ? sample_rate : 48000;
+    cue->volume = 1.0f;
+    cue->mix = 0.0f;
+    SDL_AtomicSet(&cue->mode, REGROOVE_CUE_OFF);
+    SDL_AtomicSet(&cue->main_pitch, 100);
+
+    return cue;
+}
+
+void regroove_cue_destroy(RegrooveCue* cue) {
+    if (!cue) return;
+
+    regroove_cue_collect(cue);
+    regroove_destroy((Regroove*)SDL_AtomicSetPtr(&cue->pending, NULL));
+    regroove_destroy(cue->player);
+    free(cue->cue_scratch);
+    free(cue->master_scratch);
+    free(cue->ring);
+    free(cue);
+}
+
+int regroove_cue_prepare(RegrooveCue* cue, int sample_rate, int max_frames) {
+    if (!cue || sample_rate <= 0 || max_frames <= 0) return -1;
+
+    int target_frames = sample_rate * CUE_MASTER_TARGET_MS / 1000;
+    if (target_frames < max_frames * 2) target_frames = max_frames * 2;
+    int capacity = 2;
+    while (capacity < target_frames * 2 * (CUE_MASTER_MAX_FACTOR + 1)) capacity <<= 1;
+
+    int16_t *cue_scratch = (int16_t*)calloc(max_frames * 2, sizeof(int16_t));
+    int16_t *master_scratch = (int16_t*)calloc(max_frames * 2, sizeof(int16_t));
+    int16_t *ring = (int16_t*)calloc(capacity, sizeof(int16_t));
+    if (!cue_scratch || !master_scratch || !ring) {
+        free(cue_scratch);
+        free(master_scratch);
+        free(ring);
+        return -1;
+    }
+
+    free(cue->cue_scratch);
+    free(cue->master_scratch);
+    free(cue->ring);
+    cue->cue_scratch = cue_scratch;
+    cue->master_scratch = master_scratch;
+    cue->ring = ring;
+    cue->max_frames = max_frames;
+    cue->ring_capacity = capacity;
+    cue->ring_mask = capacity - 1;
+    cue->ring_target = target_frames * 2;
+    cue->ring_primed = 0;
+    SDL_AtomicSet(&cue->ring_write, 0);
+    SDL_AtomicSet(&cue->ring_read, 0);
+
+    // A rate change needs the player reloaded at the new rate
+    if (sample_rate != cue->sample_rate) {
+        cue->sample_rate = sample_rate;
+        if (cue->path[0]) {
+            char path[sizeof(cue->path)];
+            strcpy(path, cue->path);
+            regroove_cue_load(cue, path);
+        }
+    }
+
+    return 0;
+}
+
+int regroove_cue_load(RegrooveCue* cue, const char* path) {
+    if (!cue || !path || !path[0]) return -1;
+
+    regroove_cue_collect(cue);
+    Regroove* player = regroove_create(path, cue->sample_rate);
+    if (!player) return -1;
+
+    // Replaces a load the cue callback has not taken yet
+    regroove_destroy((Regroove*)SDL_AtomicSetPtr(&cue->pending, player));
+
+    strncpy(cue->path, path, sizeof(cue->path) - 1);
+    cue->path[sizeof(cue->path) - 1] = '\0';
+    return 0;
+}
+
+const char* regroove_cue_get_path(RegrooveCue* cue) {
+    return cue ? cue->path : "";
+}
+
+void regroove_cue_collect(RegrooveCue* cue) {
+    if (!cue) return;
+    regroove_destroy((Regroove*)SDL_AtomicSetPtr(&cue->retired, NULL));
+}
+
+void regroove_cue_set_mode(RegrooveCue* cue, RegrooveCueMode mode) {
+    if (!cue) return;
+    if (mode < 0 || mode >= REGROOVE_CUE_MODE_COUNT) mode = REGROOVE_CUE_OFF;
+    SDL_AtomicSet(&cue->mode, mode);
+}
+
+RegrooveCueMode regroove_cue_get_mode(RegrooveCue* cue) {
+    return cue ? (RegrooveCueMode)SDL_AtomicGet(&cue->mode) : REGROOVE_CUE_OFF;
+}
+
+void regroove_cue_set_channel(RegrooveCue* cue, int channel, int cued) {
+    if (!cue || channel < 0 || channel >= REGROOVE_CUE_MAX_CHANNELS) return;
+    SDL_atomic_t* word = &cue->channel_mask[channel / 32];
+    int bit = (int)(1u << (channel % 32));
+    int mask = SDL_AtomicGet(word);
+    SDL_AtomicSet(word, cued ? (mask | bit) : (mask & ~bit));
+}
+
+int regroove_cue_get_channel(RegrooveCue* cue, int channel) {
+    if (!cue || channel < 0 || channel >= REGROOVE_CUE_MAX_CHANNELS) return 0;
+    return (SDL_AtomicGet(&cue->channel_mask[channel / 32]) >> (channel % 32)) & 1;
+}
+
+void regroove_cue_set_playing(RegrooveCue* cue, int playing) {
+    if (!cue) return;
+    SDL_AtomicSet(&cue->playing, playing ? 1 : 0);
+}
+
+int regroove_cue_get_playing(RegrooveCue* cue) {
+    return cue ? SDL_AtomicGet(&cue->playing) : 0;
+}
+
+void regroove_cue_set_volume(RegrooveCue* cue, float volume) {
+    if (!cue) return;
+    cue->volume = clampf(volume, 0.0f, 1.0f);
+}
+
+float regroove_cue_get_volume(RegrooveCue* cue) {
+    return cue ? cue->volume : 1.0f;
+}
+
+void regroove_cue_set_mix(RegrooveCue* cue, float mix) {
+    if (!cue) return;
+    cue->mix = clampf(mix, 0.0f, 1.0f);
+}
+
+float regroove_cue_get_mix(RegrooveCue* cue) {
+    return cue ? cue->mix : 0.0f;
+}
+
+const char* regroove_cue_mode_name(RegrooveCueMode mode) {
+    switch (mode) {
+        case REGROOVE_CUE_OFF:      return "Off";
+        case REGROOVE_CUE_CHANNELS: return "Channels";
+        case REGROOVE_CUE_MODULE:   return "Module";
+        default:                    return "Unknown";
+    }
+}
+
+void regroove_cue_follow(RegrooveCue* cue, int playing, int order, int row, double pitch) {
+    if (!cue) return;
+    SDL_AtomicSet(&cue->main_playing, playing ? 1 : 0);
+    SDL_AtomicSet(&cue->main_position, CUE_PACK_POSITION(order, row));
+    SDL_AtomicSet(&cue->main_pitch, (int)(pitch * 100.0));
+}
+
+void regroove_cue_push_master(RegrooveCue* cue, const int16_t* buffer, int frames) {
+    if (!cue || !cue->ring || !buffer || frames <= 0) return;
+
+    unsigned int w = (unsigned int)SDL_AtomicGet(&cue->ring_write);
+    int fill = (int)(w - (unsigned int)SDL_AtomicGet(&cue->ring_read));
+    int to_write = frames * 2;
+    if (to_write > cue->ring_capacity - fill) to_write = (cue->ring_capacity - fill) & ~1;
+
+    int start = (int)(w & (unsigned int)cue->ring_mask);
+    int first = cue->ring_capacity - start;
+    if (first > to_write) first = to_write;
+    memcpy(cue->ring + start, buffer, first * sizeof(int16_t));
+    memcpy(cue->ring, buffer + first, (to_write - first) * sizeof(int16_t));
+
+    SDL_AtomicSet(&cue->ring_write, (int)(w + (unsigned int)to_write));
+}
+
+// Cue callback: read frames of master into master_scratch (silence while priming)
+static void read_master(RegrooveCue* cue, int frames) {
+    int needed = frames * 2;
+    unsigned int w = (unsigned int)SDL_AtomicGet(&cue->ring_write);
+    unsigned int r = (unsigned int)SDL_AtomicGet(&cue->ring_read);
+    int fill = (int)(w - r);
+
+    if (!cue->ring_primed) {
+        if (fill < cue->ring_target) {
+            memset(cue->master_scratch, 0, needed * sizeof(int16_t));
+            return;
+        }
+        cue->ring_primed = 1;
+    }
+
+    // The main output runs ahead (its clock is faster): drop back to the target
+    if (fill > cue->ring_target * CUE_MASTER_MAX_FACTOR) {
+        r = w - (unsigned int)cue->ring_target;
+        fill = cue->ring_target;
+    }
+
+    int to_read = needed;
+    if (to_read > fill) {
+        // Fell behind the cue clock: play out what is there, then wait for the target again
+        to_read = fill;
+        cue->ring_primed = 0;
+        memset(cue->master_scratch + to_read, 0, (needed - to_read) * sizeof(int16_t));
+    }
+
+    int start = (int)(r & (unsigned int)cue->ring_mask);
+    int first = cue->ring_capacity - start;
+    if (first > to_read) first = to_read;
+    memcpy(cue->master_scratch, cue->ring + start, first * sizeof(int16_t));
+    memcpy(cue->master_scratch + first, cue->ring, (to_read - first) * sizeof(int16_t));
+
+    SDL_AtomicSet(&cue->ring_read, (int)(r + (unsigned int)to_read));
+}
+
+// Cue callback: swap in a newly loaded player once the previous one has been collected
+static void adopt_pending_player(RegrooveCue* cue) {
+    if (!SDL_AtomicGetPtr(&cue->pending)) return;
+    if (SDL_AtomicGetPtr(&cue->retired)) return;
+
+    Regroove* player = (Regroove*)SDL_AtomicSetPtr(&cue->pending, NULL);
+    if (cue->player) SDL_AtomicSetPtr(&cue->retired, cue->player);
+    cue->player = player;
+    cue->applied_valid = 0;
+}
+
+// Linear song position in rows (rows of all orders before this one, plus the row)
+static int song_row(Regroove* p, int order, int row) {
+    for (int o = 0; o < order; o++) {
+        row += regroove_get_pattern_num_rows(p, regroove_get_order_pattern(p, o));
+    }
+    return row;
+}
+
+// Cue callback, CHANNELS mode: mute all but the cued channels and follow the main player
+static void follow_main_player(RegrooveCue* cue) {
+    Regroove* p = cue->player;
+
+    int mask[2] = { SDL_AtomicGet(&cue->channel_mask[0]), SDL_AtomicGet(&cue->channel_mask[1]) };
+    if (!cue->applied_valid || mask[0] != cue->applied_mask[0] || mask[1] != cue->applied_mask[1]) {
+        int channels = regroove_get_num_channels(p);
+        if (channels > REGROOVE_CUE_MAX_CHANNELS) channels = REGROOVE_CUE_MAX_CHANNELS;
+        for (int ch = 0; ch < channels; ch++) {
+            int muted = !((mask[ch / 32] >> (ch % 32)) & 1);
+            if (regroove_is_channel_muted(p, ch) != muted) regroove_toggle_channel_mute(p, ch);
+        }
+        cue->applied_mask[0] = mask[0];
+        cue->applied_mask[1] = mask[1];
+    }
+
+    int pitch = SDL_AtomicGet(&cue->main_pitch);
+    if (!cue->applied_valid || pitch != cue->applied_pitch) {
+        regroove_set_pitch(p, pitch / 100.0);
+        cue->applied_pitch = pitch;
+    }
+    cue->applied_valid = 1;
+
+    // Jump along when the main player jumped (or the two have drifted apart)
+    int position = SDL_AtomicGet(&cue->main_position);
+    int order = CUE_POSITION_ORDER(position);
+    int row = CUE_POSITION_ROW(position);
+    int distance = song_row(p, regroove_get_current_order(p), regroove_get_current_row(p)) -
+                   song_row(p, order, row);
+    if (distance > CUE_FOLLOW_TOLERANCE_ROWS || distance < -CUE_FOLLOW_TOLERANCE_ROWS) {
+        regroove_set_position(p, order, row);
+    }
+}
+
+void regroove_cue_process(RegrooveCue* cue, int16_t* output, int frames) {
+    if (!cue || !output || frames <= 0) return;
+    if (!cue->ring || cue->max_frames <= 0) {
+        memset(output, 0, frames * 2 * sizeof(int16_t));
+        return;
+    }
+
+    adopt_pending_player(cue);
+
+    int mode = SDL_AtomicGet(&cue->mode);
+    int render = 0;
+    if (cue->player && mode == REGROOVE_CUE_CHANNELS && SDL_AtomicGet(&cue->main_playing)) {
+        follow_main_player(cue);
+        render = 1;
+    } else if (cue->player && mode == REGROOVE_CUE_MODULE && SDL_AtomicGet(&cue->playing)) {
+        if (cue->applied_valid) {
+            // Back from CHANNELS mode: all channels audible
+            regroove_unmute_all(cue->player);
+            cue->applied_valid = 0;
+        }
+        render = 1;
+    }
+
+    float cue_gain = cue->volume * (1.0f - cue->mix);
+    float master_gain = cue->volume * cue->mix;
+
+    for (int offset = 0; offset < frames; offset += cue->max_frames) {
+        int chunk = frames - offset;
+        if (chunk > cue->max_frames) chunk = cue->max_frames;
+
+        if (render) {
+            regroove_render_audio(cue->player, cue->cue_scratch, chunk);
+        } else {
+            memset(cue->cue_scratch, 0, chunk * 2 * sizeof(int16_t));
+        }
+        read_master(cue, chunk);
+
+        int16_t* out = output + offset * 2;
+        for (int i = 0; i < chunk * 2; i++) {
+            float v = cue->cue_scratch[i] * cue_gain + cue->master_scratch[i] * master_gain;
+            out[i] = (int16_t)(v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v));
+        }
+    }
+}
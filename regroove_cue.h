@@ -0,0 +1,74 @@
+#ifndef REGROOVE_CUE_H
+#define REGROOVE_CUE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cue (headphone pre-listen) bus for a second audio device. The cue device callback
+// renders its own player; the main output only hands over its master mix through a
+// lock-free ring (for blending into the headphones), so it never waits on the cue.
+//
+// Threads: main thread (configuration, loading), main output callback (follow and
+// push_master), cue device callback (process).
+
+// Most channels selectable in channel mode
+#define REGROOVE_CUE_MAX_CHANNELS 64
+
+typedef enum {
+    REGROOVE_CUE_OFF = 0,
+    REGROOVE_CUE_CHANNELS,   // Selected channels of the playing module, following its position
+    REGROOVE_CUE_MODULE,     // A second module with its own transport
+    REGROOVE_CUE_MODE_COUNT
+} RegrooveCueMode;
+
+typedef struct RegrooveCue RegrooveCue;
+
+// Create cue bus (no module loaded)
+RegrooveCue* regroove_cue_create(int sample_rate);
+
+// Free cue bus and its player (the cue device must be closed)
+void regroove_cue_destroy(RegrooveCue* cue);
+
+// Size scratch buffers and the master hand-off ring for the cue device (call at
+// device-open time, while the cue device is closed or paused). Returns 0 on success, -1 on failure
+int regroove_cue_prepare(RegrooveCue* cue, int sample_rate, int max_frames);
+
+// Load the cue player's module (main thread). The cue callback swaps it in at its next
+// block. CHANNELS mode loads the playing module's file, MODULE mode any other file.
+// Returns 0 on success, -1 on failure
+int regroove_cue_load(RegrooveCue* cue, const char* path);
+const char* regroove_cue_get_path(RegrooveCue* cue);
+
+// Free players replaced by load() (main thread, e.g. once per UI frame)
+void regroove_cue_collect(RegrooveCue* cue);
+
+// Parameters (main thread)
+void regroove_cue_set_mode(RegrooveCue* cue, RegrooveCueMode mode);
+RegrooveCueMode regroove_cue_get_mode(RegrooveCue* cue);
+void regroove_cue_set_channel(RegrooveCue* cue, int channel, int cued);
+int regroove_cue_get_channel(RegrooveCue* cue, int channel);
+void regroove_cue_set_playing(RegrooveCue* cue, int playing);  // MODULE mode transport
+int regroove_cue_get_playing(RegrooveCue* cue);
+void regroove_cue_set_volume(RegrooveCue* cue, float volume);  // 0.0 - 1.0
+float regroove_cue_get_volume(RegrooveCue* cue);
+void regroove_cue_set_mix(RegrooveCue* cue, float mix);        // 0.0 = cue only, 1.0 = master only
+float regroove_cue_get_mix(RegrooveCue* cue);
+const char* regroove_cue_mode_name(RegrooveCueMode mode);
+
+// Main output callback, once per block: position and pitch of the main player
+// (CHANNELS mode follows it), and the final master mix. Never blocks; master
+// frames that do not fit in the ring are dropped.
+void regroove_cue_follow(RegrooveCue* cue, int playing, int order, int row, double pitch);
+void regroove_cue_push_master(RegrooveCue* cue, const int16_t* buffer, int frames);
+
+// Cue device callback: render one block (interleaved stereo)
+void regroove_cue_process(RegrooveCue* cue, int16_t* output, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_CUE_H
@@ -32,17 +32,56 @@ static inline float rb338_shaper(float x) {
     }
 }
 
+// Tempo-synced delay divisions (length in beats), shortest to longest.
+// delay_time 0.0-1.0 selects an entry in sync mode.
+static const struct {
+    const char *name;
+    float beats;
+} delay_divisions[] = {
+    { "1/32",  0.125f },
+    { "1/16T", 1.0f / 6.0f },
+    { "1/16",  0.25f },
+    { "1/8T",  1.0f / 3.0f },
+    { "1/16D", 0.375f },
+    { "1/8",   0.5f },
+    { "1/4T",  2.0f / 3.0f },
+    { "1/8D",  0.75f },
+    { "1/4",   1.0f },
+    { "1/2T",  4.0f / 3.0f },
+    { "1/4D",  1.5f },
+    { "1/2",   2.0f },
+};
+#define NUM_DELAY_DIVISIONS ((int)(sizeof(delay_divisions) / sizeof(delay_divisions[0])))
+
+static int delay_division_index(float time) {
+    int idx = (int)(time * (NUM_DELAY_DIVISIONS - 1) + 0.5f);
+    if (idx < 0) idx = 0;
+    if (idx >= NUM_DELAY_DIVISIONS) idx = NUM_DELAY_DIVISIONS - 1;
+    return idx;
+}
+
+// Helper: 4-point cubic Hermite interpolation between x0 and x1 (t = 0..1)
+static inline float hermite4(float t, float xm1, float x0, float x1, float x2) {
+    float c1 = 0.5f * (x1 - xm1);
+    float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * t + c2) * t + c1) * t + x0;
+}
+
+// Helper: One-pole smoothing coefficient for a cutoff frequency
+static inline float onepole_alpha(float freq, int sample_rate) {
+    return 1.0f - expf(-2.0f * 3.14159f * freq / (float)sample_rate);
+}
+
 // Helper: Simple one-pole highpass filter for pre-emphasis
-static inline float highpass_tick(float input, float *state, float cutoff_norm) {
-    float alpha = 1.0f - expf(-2.0f * 3.14159f * cutoff_norm);
+static inline float highpass_tick(float input, float *state, float alpha) {
     *state += alpha * (input - *state);
     return input - *state;
 }
 
 // Helper: Simple resonant bandpass bump (for punch at 120Hz)
-static inline float bandpass_bump(float input, float *lp_state, float *bp_state, float freq_norm, float q) {
+static inline float bandpass_bump(float input, float *lp_state, float *bp_state, float f, float q) {
     // State-variable filter bandpass output
-    float f = 2.0f * sinf(3.14159f * freq_norm);
     *lp_state += f * *bp_state;
     float hp = input - *lp_state - q * *bp_state;
     *bp_state += f * hp;
@@ -57,16 +96,112 @@ static inline float envelope_follower(float input, float *state, float attack, f
     return *state;
 }
 
-RegrooveEffects* regroove_effects_create(void) {
+// Recompute compressor attack/release coefficients (depend on params and sample rate)
+static void update_compressor_coefficients(RegrooveEffects* fx) {
+    // Attack: 0.5ms to 50ms (0.0-1.0 maps to fast to slow)
+    // Release: 10ms to 500ms (0.0-1.0 maps to fast to slow)
+    float attack_time = 0.0005f + fx->compressor_attack * 0.0495f;
+    float release_time = 0.01f + fx->compressor_release * 0.49f;
+    fx->compressor_attack_coeff = 1.0f - expf(-1.0f / (fx->sample_rate * attack_time));
+    fx->compressor_release_coeff = 1.0f - expf(-1.0f / (fx->sample_rate * release_time));
+}
+
+// Helper: TPT state-variable filter coefficients (a1, a2, a3, k) for a cutoff and damping
+static void svf_coefficients(float *c, float freq, float k, int sample_rate) {
+    float nyquist_limit = 0.49f * (float)sample_rate;
+    if (freq > nyquist_limit) freq = nyquist_limit;
+    float g = tanf(3.14159265f * freq / (float)sample_rate);
+    c[0] = 1.0f / (1.0f + g * (g + k));
+    c[1] = g * c[0];
+    c[2] = g * c[1];
+    c[3] = k;
+}
+
+// Helper: Run `lanes` independent TPT SVFs sharing one set of coefficients.
+// Lane loops with a constant count are laid out for the compiler to vectorize.
+static inline void svf_tick_lanes(const float *c, float ic[2][4], const float *in,
+                                  float *lp, float *bp, float *hp, int lanes) {
+    for (int i = 0; i < lanes; i++) {
+        float v3 = in[i] - ic[1][i];
+        float v1 = c[0] * ic[0][i] + c[1] * v3;
+        float v2 = ic[1][i] + c[1] * ic[0][i] + c[2] * v3;
+        ic[0][i] = 2.0f * v1 - ic[0][i];
+        ic[1][i] = 2.0f * v2 - ic[1][i];
+        lp[i] = v2;
+        bp[i] = v1;
+        hp[i] = in[i] - c[3] * v1 - v2;
+    }
+}
+
+// Recompute filter coefficients once per block from the smoothed cutoff
+static void update_filter_coefficients(RegrooveEffects* fx, int frames) {
+    // Glide toward the target cutoff (~10ms) so stepped MIDI knob values don't zipper
+    if (fx->filter_cutoff_smoothed < 0.0f) {
+        fx->filter_cutoff_smoothed = fx->filter_cutoff;
+    } else {
+        float glide = 1.0f - expf(-(float)frames / (fx->sample_rate * 0.01f));
+        fx->filter_cutoff_smoothed += glide * (fx->filter_cutoff - fx->filter_cutoff_smoothed);
+    }
+
+    // Cutoff: 0.0-1.0 maps exponentially to 20Hz-20kHz (limited below Nyquist)
+    float freq = 20.0f * powf(1000.0f, fx->filter_cutoff_smoothed);
+
+    // Resonance: 0.0-1.0 maps to Q 0.707 to ~20. Damping stays above zero, so the
+    // filter is stable at every setting
+    float k = 1.41421356f * (1.0f - 0.965f * fx->filter_resonance);
+    svf_coefficients(fx->filter_coeffs, freq, k, fx->sample_rate);
+}
+
+// Recompute multiband crossover, gain computer and envelope coefficients
+static void update_multiband_coefficients(RegrooveEffects* fx) {
+    // Butterworth sections (k = sqrt(2)); two in series make a 4th order Linkwitz-Riley
+    const float k = 1.41421356f;
+    float low_freq = 60.0f * powf(10.0f, fx->multiband_low_crossover);
+    float high_freq = 1000.0f * powf(10.0f, fx->multiband_high_crossover);
+    svf_coefficients(fx->mb_xover_coeffs[0], low_freq, k, fx->sample_rate);
+    svf_coefficients(fx->mb_xover_coeffs[1], high_freq, k, fx->sample_rate);
+
+    // Ratio (0.0-1.0 maps to 1:1 to 20:1)
+    float ratio = 1.0f + fx->multiband_ratio * 19.0f;
+    fx->mb_slope = 1.0f / ratio - 1.0f;
+
+    // Attack/release per band: slower for the lows so the detector doesn't follow the waveform
+    static const float attack_time[REGROOVE_FX_MB_BANDS] = { 0.010f, 0.005f, 0.002f };
+    static const float release_time[REGROOVE_FX_MB_BANDS] = { 0.200f, 0.120f, 0.080f };
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        fx->mb_threshold_lin[b] = powf(10.0f, (-40.0f + fx->multiband_threshold[b] * 40.0f) / 20.0f);
+        fx->mb_gain_lin[b] = powf(10.0f, (fx->multiband_gain[b] - 0.5f) * 24.0f / 20.0f);
+        fx->mb_attack_coeff[b] = 1.0f - expf(-1.0f / (fx->sample_rate * attack_time[b]));
+        fx->mb_release_coeff[b] = 1.0f - expf(-1.0f / (fx->sample_rate * release_time[b]));
+    }
+}
+
+// Recompute ducker release coefficient (20ms to 500ms)
+static void update_ducker_coefficients(RegrooveEffects* fx) {
+    float release_time = 0.02f + fx->ducker_release * 0.48f;
+    fx->ducker_release_coeff = 1.0f - expf(-1.0f / (fx->sample_rate * release_time));
+}
+
+// Recompute all fixed-frequency coefficients for the current sample rate
+static void update_rate_coefficients(RegrooveEffects* fx) {
+    fx->dist_hp_alpha = onepole_alpha(80.0f, fx->sample_rate);
+    fx->dist_bp_f = 2.0f * sinf(3.14159f * 120.0f / (float)fx->sample_rate);
+    fx->dist_lp_alpha = onepole_alpha(8000.0f, fx->sample_rate);
+    fx->eq_low_alpha = onepole_alpha(250.0f, fx->sample_rate);
+    fx->eq_mid_alpha = onepole_alpha(6000.0f, fx->sample_rate);
+    fx->delay_smooth_coeff = 1.0f - expf(-1.0f / (fx->sample_rate * 0.05f));
+    fx->ducker_attack_coeff = 1.0f - expf(-1.0f / (fx->sample_rate * 0.001f));
+    update_compressor_coefficients(fx);
+    update_multiband_coefficients(fx);
+    update_ducker_coefficients(fx);
+}
+
+RegrooveEffects* regroove_effects_create(int sample_rate) {
     RegrooveEffects* fx = (RegrooveEffects*)calloc(1, sizeof(RegrooveEffects));
     if (!fx) return NULL;
 
-    // Allocate delay buffers
-    fx->delay_buffer[0] = (float*)calloc(MAX_DELAY_SAMPLES, sizeof(float));
-    fx->delay_buffer[1] = (float*)calloc(MAX_DELAY_SAMPLES, sizeof(float));
-    if (!fx->delay_buffer[0] || !fx->delay_buffer[1]) {
-        free(fx->delay_buffer[0]);
-        free(fx->delay_buffer[1]);
+    // Allocate delay buffers sized for the sample rate
+    if (regroove_effects_set_sample_rate(fx, sample_rate) != 0) {
         free(fx);
         return NULL;
     }
@@ -79,6 +214,8 @@ RegrooveEffects* regroove_effects_create(void) {
     fx->filter_enabled = 0;
     fx->filter_cutoff = 1.0f;
     fx->filter_resonance = 0.0f;
+    fx->filter_mode = REGROOVE_FX_FILTER_LOWPASS;
+    fx->filter_cutoff_smoothed = -1.0f;
 
     fx->eq_enabled = 0;
     fx->eq_low = 0.5f;
@@ -106,12 +243,87 @@ RegrooveEffects* regroove_effects_create(void) {
     fx->delay_time = 0.375f;  // ~375ms
     fx->delay_feedback = 0.4f;
     fx->delay_mix = 0.3f;
+    fx->delay_sync = 0;
+    fx->tempo_bpm = 125.0;
+
+    fx->multiband_enabled = 0;
+    fx->multiband_low_crossover = 0.52f;   // ~200Hz
+    fx->multiband_high_crossover = 0.40f;  // ~2.5kHz
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        fx->multiband_threshold[b] = 0.7f; // -12dB
+        fx->multiband_gain[b] = 0.5f;      // Unity
+    }
+    fx->multiband_ratio = 0.15f;           // ~4:1
+    update_multiband_coefficients(fx);
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        fx->mb_gain[b] = fx->mb_gain_lin[b];
+    }
+
+    fx->ducker_enabled = 0;
+    fx->ducker_depth = 0.7f;
+    fx->ducker_release = 0.3f;  // ~165ms
+
+    fx->convolution_enabled = 0;
+    fx->convolution_mix = 0.3f;
+    fx->convolver = regroove_convolver_create(fx->sample_rate);
+    if (!fx->convolver) {
+        regroove_effects_destroy(fx);
+        return NULL;
+    }
+
+    // Default stage order
+    for (int i = 0; i < REGROOVE_FX_STAGE_COUNT; i++) {
+        fx->stage_order[i] = i;
+    }
+
+    update_compressor_coefficients(fx);
+    update_ducker_coefficients(fx);
 
     return fx;
 }
 
+int regroove_effects_set_sample_rate(RegrooveEffects* fx, int sample_rate) {
+    if (!fx) return -1;
+    if (sample_rate <= 0) sample_rate = REGROOVE_FX_DEFAULT_SAMPLE_RATE;
+
+    // Longest of the free-running and tempo-synced maxima, plus interpolation headroom
+    double max_seconds = REGROOVE_FX_MAX_DELAY_MS / 1000.0;
+    double max_sync_seconds = REGROOVE_FX_SYNC_MAX_BEATS * 60.0 / REGROOVE_FX_SYNC_MIN_BPM;
+    if (max_sync_seconds > max_seconds) max_seconds = max_sync_seconds;
+    int size = (int)(sample_rate * max_seconds) + 4;
+
+    if (size != fx->delay_buffer_size || !fx->delay_buffer[0] || !fx->delay_buffer[1]) {
+        float *left = (float*)calloc(size, sizeof(float));
+        float *right = (float*)calloc(size, sizeof(float));
+        if (!left || !right) {
+            free(left);
+            free(right);
+            return -1;
+        }
+        free(fx->delay_buffer[0]);
+        free(fx->delay_buffer[1]);
+        fx->delay_buffer[0] = left;
+        fx->delay_buffer[1] = right;
+        fx->delay_buffer_size = size;
+        fx->delay_write_pos = 0;
+    }
+    fx->delay_current = 0.0f;  // Snap to the new target on the next block
+
+    fx->sample_rate = sample_rate;
+    update_rate_coefficients(fx);
+
+    // Impulse response is resampled for the new rate in the background
+    regroove_convolver_set_sample_rate(fx->convolver, sample_rate);
+    return 0;
+}
+
+int regroove_effects_get_sample_rate(RegrooveEffects* fx) {
+    return fx ? fx->sample_rate : REGROOVE_FX_DEFAULT_SAMPLE_RATE;
+}
+
 void regroove_effects_destroy(RegrooveEffects* fx) {
     if (fx) {
+        regroove_convolver_destroy(fx->convolver);
         free(fx->delay_buffer[0]);
         free(fx->delay_buffer[1]);
         free(fx);
@@ -122,8 +334,7 @@ void regroove_effects_reset(RegrooveEffects* fx) {
     if (!fx) return;
 
     // Clear filter state
-    memset(fx->filter_lp, 0, sizeof(fx->filter_lp));
-    memset(fx->filter_bp, 0, sizeof(fx->filter_bp));
+    memset(fx->filter_ic, 0, sizeof(fx->filter_ic));
 
     // Clear distortion state
     memset(fx->distortion_hp, 0, sizeof(fx->distortion_hp));
@@ -144,247 +355,556 @@ void regroove_effects_reset(RegrooveEffects* fx) {
     memset(fx->compressor_envelope, 0, sizeof(fx->compressor_envelope));
     memset(fx->compressor_rms, 0, sizeof(fx->compressor_rms));
 
+    // Clear multiband crossovers and envelopes
+    memset(fx->mb_split_ic, 0, sizeof(fx->mb_split_ic));
+    memset(fx->mb_low_ic, 0, sizeof(fx->mb_low_ic));
+    memset(fx->mb_high_ic, 0, sizeof(fx->mb_high_ic));
+    memset(fx->mb_top_ic, 0, sizeof(fx->mb_top_ic));
+    memset(fx->mb_envelope, 0, sizeof(fx->mb_envelope));
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        fx->mb_gain[b] = fx->mb_gain_lin[b];
+        fx->mb_gain_step[b] = 0.0f;
+    }
+    fx->mb_control_countdown = 0;
+
     // Clear delay buffers and reset write position
     if (fx->delay_buffer[0]) {
-        memset(fx->delay_buffer[0], 0, MAX_DELAY_SAMPLES * sizeof(float));
+        memset(fx->delay_buffer[0], 0, fx->delay_buffer_size * sizeof(float));
     }
     if (fx->delay_buffer[1]) {
-        memset(fx->delay_buffer[1], 0, MAX_DELAY_SAMPLES * sizeof(float));
+        memset(fx->delay_buffer[1], 0, fx->delay_buffer_size * sizeof(float));
     }
     fx->delay_write_pos = 0;
+    fx->delay_current = 0.0f;
+
+    // Clear ducker envelope
+    fx->ducker_env = 0.0f;
+
+    // Clear convolution input and frequency-domain delay lines
+    regroove_convolver_reset(fx->convolver);
+
+    // Wake up (next block is processed normally)
+    fx->sleeping = 0;
+    fx->silent_frames = 0;
 }
 
-void regroove_effects_process(RegrooveEffects* fx, int16_t* buffer, int frames, int sample_rate) {
-    if (!fx || !buffer || frames <= 0) return;
+// Known decay length of the enabled effects, in frames, after the input goes silent.
+// Output energy must also be below REGROOVE_FX_SLEEP_ENERGY before the chain sleeps.
+static int fx_tail_frames(RegrooveEffects* fx) {
+    // Filters, EQ and distortion envelopes ring out well within 50ms
+    int tail = fx->sample_rate / 20;
 
-    // Convert to float for processing
-    const float scale_to_float = 1.0f / 32768.0f;
-    const float scale_to_int16 = 32767.0f;
+    if (fx->delay_enabled && fx->delay_buffer_size > 0) {
+        int delay_samples = (int)fx->delay_target;
 
-    for (int i = 0; i < frames; i++) {
-        // Get stereo samples
-        float left = (float)buffer[i * 2] * scale_to_float;
-        float right = (float)buffer[i * 2 + 1] * scale_to_float;
+        // Echoes needed for feedback^n to drop below -120 dB; capped for runaway feedback
+        int repeats = 64;
+        if (fx->delay_feedback < 0.999f) {
+            repeats = (fx->delay_feedback > 0.0f)
+                ? (int)ceilf(logf(1e-6f) / logf(fx->delay_feedback)) : 0;
+            if (repeats > 64) repeats = 64;
+        }
+        tail += delay_samples * (repeats + 1);
+    }
+
+    if (fx->convolution_enabled) {
+        tail += regroove_convolver_get_tail_frames(fx->convolver);
+    }
+
+    return tail;
+}
+
+int regroove_effects_is_sleeping(RegrooveEffects* fx) {
+    return fx ? fx->sleeping : 1;
+}
 
-        // --- DISTORTION (RB338-style aggressive overdrive for 909 kicks) ---
-        if (fx->distortion_enabled) {
-            float dry_left = left;
-            float dry_right = right;
-
-            // Pre-emphasis EQ chain:
-            // 1. Highpass at 80Hz to remove sub-rumble
-            float hp_cutoff = 80.0f / sample_rate;
-            float emphasized_left = highpass_tick(left, &fx->distortion_hp[0], hp_cutoff);
-            float emphasized_right = highpass_tick(right, &fx->distortion_hp[1], hp_cutoff);
-
-            // 2. Add resonant bandpass bump at 120Hz for punch (909 kick fundamental)
-            float bp_freq = 120.0f / sample_rate;
-            float bp_q = 0.5f;  // Resonance for punch
-            float bp_left = bandpass_bump(emphasized_left, &fx->distortion_bp_lp[0],
-                                         &fx->distortion_bp_bp[0], bp_freq, bp_q);
-            float bp_right = bandpass_bump(emphasized_right, &fx->distortion_bp_lp[1],
-                                          &fx->distortion_bp_bp[1], bp_freq, bp_q);
-
-            // Mix in the punch bump
-            emphasized_left += bp_left * 0.5f;
-            emphasized_right += bp_right * 0.5f;
-
-            // Dynamic envelope detection for transient emphasis
-            float attack_coeff = 0.9f;   // Fast attack
-            float release_coeff = 0.001f; // Slow release
-            float env_l = envelope_follower(emphasized_left, &fx->distortion_env[0], attack_coeff, release_coeff);
-            float env_r = envelope_follower(emphasized_right, &fx->distortion_env[1], attack_coeff, release_coeff);
-
-            // Dynamic drive: more aggressive on transients (kicks, snares)
-            // Drive amount: 0.0 = 1x, 1.0 = 8x
-            float base_drive = 1.0f + fx->distortion_drive * 7.0f;
-            float dynamic_drive_l = base_drive * (0.7f + env_l * 0.6f);
-            float dynamic_drive_r = base_drive * (0.7f + env_r * 0.6f);
-
-            // Apply drive gain
-            float driven_left = emphasized_left * dynamic_drive_l;
-            float driven_right = emphasized_right * dynamic_drive_r;
-
-            // Aggressive distortion chain: foldback -> rb338_shaper
-            float folded_left = foldback(driven_left);
-            float folded_right = foldback(driven_right);
-
-            float shaped_left = rb338_shaper(folded_left);
-            float shaped_right = rb338_shaper(folded_right);
-
-            // Post-EQ: lowpass at 8kHz to tame harshness, add warmth
-            float lp_cutoff = 8000.0f / sample_rate;
-            float lp_alpha = 1.0f - expf(-2.0f * 3.14159f * lp_cutoff);
-            fx->distortion_lp[0] += lp_alpha * (shaped_left - fx->distortion_lp[0]);
-            fx->distortion_lp[1] += lp_alpha * (shaped_right - fx->distortion_lp[1]);
-
-            float wet_left = fx->distortion_lp[0];
-            float wet_right = fx->distortion_lp[1];
-
-            // Mix dry/wet
-            left = dry_left * (1.0f - fx->distortion_mix) + wet_left * fx->distortion_mix;
-            right = dry_right * (1.0f - fx->distortion_mix) + wet_right * fx->distortion_mix;
+int regroove_effects_set_stage_order(RegrooveEffects* fx, const int* order, int count) {
+    if (!fx || !order || count != REGROOVE_FX_STAGE_COUNT) return -1;
+
+    // Every stage must appear exactly once
+    int seen[REGROOVE_FX_STAGE_COUNT] = {0};
+    for (int i = 0; i < count; i++) {
+        if (order[i] < 0 || order[i] >= REGROOVE_FX_STAGE_COUNT || seen[order[i]]) return -1;
+        seen[order[i]] = 1;
+    }
+
+    memcpy(fx->stage_order, order, sizeof(fx->stage_order));
+    return 0;
+}
+
+RegrooveFxStage regroove_effects_get_stage(RegrooveEffects* fx, int position) {
+    if (!fx || position < 0 || position >= REGROOVE_FX_STAGE_COUNT) return REGROOVE_FX_STAGE_COUNT;
+    return (RegrooveFxStage)fx->stage_order[position];
+}
+
+void regroove_effects_move_stage(RegrooveEffects* fx, int position, int direction) {
+    if (!fx || position < 0 || position >= REGROOVE_FX_STAGE_COUNT) return;
+    int other = position + (direction < 0 ? -1 : 1);
+    if (other < 0 || other >= REGROOVE_FX_STAGE_COUNT) return;
+
+    int tmp = fx->stage_order[position];
+    fx->stage_order[position] = fx->stage_order[other];
+    fx->stage_order[other] = tmp;
+}
+
+const char* regroove_effects_stage_name(RegrooveFxStage stage) {
+    switch (stage) {
+        case REGROOVE_FX_STAGE_DISTORTION: return "Distortion";
+        case REGROOVE_FX_STAGE_FILTER:     return "Filter";
+        case REGROOVE_FX_STAGE_EQ:         return "EQ";
+        case REGROOVE_FX_STAGE_COMPRESSOR: return "Compressor";
+        case REGROOVE_FX_STAGE_MULTIBAND:  return "Multiband";
+        case REGROOVE_FX_STAGE_DUCKER:     return "Ducker";
+        case REGROOVE_FX_STAGE_DELAY:      return "Delay";
+        case REGROOVE_FX_STAGE_CONVOLUTION: return "Convolution";
+        default:                           return "Unknown";
+    }
+}
+
+// Delay length in samples for the current parameters and tempo
+static float fx_delay_target_samples(RegrooveEffects* fx) {
+    float samples;
+    if (fx->delay_sync && fx->tempo_bpm > 0.0) {
+        float beats = delay_divisions[delay_division_index(fx->delay_time)].beats;
+        samples = (float)(beats * 60.0 / fx->tempo_bpm * fx->sample_rate);
+    } else {
+        samples = fx->delay_time * (REGROOVE_FX_MAX_DELAY_MS / 1000.0f) * fx->sample_rate;
+    }
+
+    // Keep 3 samples of headroom on both ends for the 4-point interpolator
+    float max_samples = (float)(fx->delay_buffer_size - 3);
+    if (samples > max_samples) samples = max_samples;
+    if (samples < 3.0f) samples = 3.0f;
+    return samples;
+}
+
+// Effect stages: each processes one stereo sample in place
+
+// --- DISTORTION (RB338-style aggressive overdrive for 909 kicks) ---
+static inline void fx_stage_distortion(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float left = *io_left;
+    float right = *io_right;
+
+    float dry_left = left;
+    float dry_right = right;
+
+    // Pre-emphasis EQ chain:
+    // 1. Highpass at 80Hz to remove sub-rumble
+    float emphasized_left = highpass_tick(left, &fx->distortion_hp[0], fx->dist_hp_alpha);
+    float emphasized_right = highpass_tick(right, &fx->distortion_hp[1], fx->dist_hp_alpha);
+
+    // 2. Add resonant bandpass bump at 120Hz for punch (909 kick fundamental)
+    float bp_freq = fx->dist_bp_f;
+    float bp_q = 0.5f;  // Resonance for punch
+    float bp_left = bandpass_bump(emphasized_left, &fx->distortion_bp_lp[0],
+                                 &fx->distortion_bp_bp[0], bp_freq, bp_q);
+    float bp_right = bandpass_bump(emphasized_right, &fx->distortion_bp_lp[1],
+                                  &fx->distortion_bp_bp[1], bp_freq, bp_q);
+
+    // Mix in the punch bump
+    emphasized_left += bp_left * 0.5f;
+    emphasized_right += bp_right * 0.5f;
+
+    // Dynamic envelope detection for transient emphasis
+    float attack_coeff = 0.9f;   // Fast attack
+    float release_coeff = 0.001f; // Slow release
+    float env_l = envelope_follower(emphasized_left, &fx->distortion_env[0], attack_coeff, release_coeff);
+    float env_r = envelope_follower(emphasized_right, &fx->distortion_env[1], attack_coeff, release_coeff);
+
+    // Dynamic drive: more aggressive on transients (kicks, snares)
+    // Drive amount: 0.0 = 1x, 1.0 = 8x
+    float base_drive = 1.0f + fx->distortion_drive * 7.0f;
+    float dynamic_drive_l = base_drive * (0.7f + env_l * 0.6f);
+    float dynamic_drive_r = base_drive * (0.7f + env_r * 0.6f);
+
+    // Apply drive gain
+    float driven_left = emphasized_left * dynamic_drive_l;
+    float driven_right = emphasized_right * dynamic_drive_r;
+
+    // Aggressive distortion chain: foldback -> rb338_shaper
+    float folded_left = foldback(driven_left);
+    float folded_right = foldback(driven_right);
+
+    float shaped_left = rb338_shaper(folded_left);
+    float shaped_right = rb338_shaper(folded_right);
+
+    // Post-EQ: lowpass at 8kHz to tame harshness, add warmth
+    float lp_alpha = fx->dist_lp_alpha;
+    fx->distortion_lp[0] += lp_alpha * (shaped_left - fx->distortion_lp[0]);
+    fx->distortion_lp[1] += lp_alpha * (shaped_right - fx->distortion_lp[1]);
+
+    float wet_left = fx->distortion_lp[0];
+    float wet_right = fx->distortion_lp[1];
+
+    // Mix dry/wet
+    left = dry_left * (1.0f - fx->distortion_mix) + wet_left * fx->distortion_mix;
+    right = dry_right * (1.0f - fx->distortion_mix) + wet_right * fx->distortion_mix;
+
+    *io_left = left;
+    *io_right = right;
+}
+
+// --- RESONANT STATE-VARIABLE FILTER (TPT, coefficients per block) ---
+static inline void fx_stage_filter(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float in[2] = { *io_left, *io_right };
+    float lp[2], bp[2], hp[2];
+
+    svf_tick_lanes(fx->filter_coeffs, fx->filter_ic, in, lp, bp, hp, 2);
+
+    switch (fx->filter_mode) {
+        case REGROOVE_FX_FILTER_BANDPASS: {
+            // Scaled by the damping for unity gain at the peak, whatever the resonance
+            const float k = fx->filter_coeffs[3];
+            *io_left = k * bp[0];
+            *io_right = k * bp[1];
+            break;
         }
+        case REGROOVE_FX_FILTER_HIGHPASS:
+            *io_left = hp[0];
+            *io_right = hp[1];
+            break;
+        case REGROOVE_FX_FILTER_NOTCH:
+            *io_left = lp[0] + hp[0];
+            *io_right = lp[1] + hp[1];
+            break;
+        default:
+            *io_left = lp[0];
+            *io_right = lp[1];
+            break;
+    }
+}
+
+// --- 3-BAND EQ ---
+static inline void fx_stage_eq(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float left = *io_left;
+    float right = *io_right;
+
+    // 3-band EQ using stable cascaded filters
+    // Low shelf (~250Hz), Mid band (~1kHz), High shelf (~6kHz)
+    // Gain range: 0.5 = neutral, 0.0 = -12dB cut, 1.0 = +12dB boost
+    float low_gain = fx->eq_low;   // 0.0 to 1.0
+    float mid_gain = fx->eq_mid;   // 0.0 to 1.0
+    float high_gain = fx->eq_high; // 0.0 to 1.0
+
+    // Convert to linear gain (0.25x to 4x, with 1.0x at 0.5)
+    float low_mult = powf(4.0f, (low_gain - 0.5f) * 2.0f);   // 0.25 to 4.0
+    float mid_mult = powf(4.0f, (mid_gain - 0.5f) * 2.0f);
+    float high_mult = powf(4.0f, (high_gain - 0.5f) * 2.0f);
+
+    for (int ch = 0; ch < 2; ch++) {
+        float sample = (ch == 0) ? left : right;
+
+        // Low shelf: one-pole lowpass filter for bass (below 250Hz)
+        float low_alpha = fx->eq_low_alpha;
+        fx->eq_lp1[ch] += low_alpha * (sample - fx->eq_lp1[ch]);
+        float low_out = fx->eq_lp1[ch] * low_mult + (sample - fx->eq_lp1[ch]);
+
+        // Mid band: bandpass (250Hz to 6kHz) - what's left after low and high
+        float mid_alpha = fx->eq_mid_alpha;
+        fx->eq_lp2[ch] += mid_alpha * (low_out - fx->eq_lp2[ch]);
+        float mid_band = fx->eq_lp2[ch] - fx->eq_lp1[ch];
+        float mid_out = low_out + mid_band * (mid_mult - 1.0f);
 
-        // --- RESONANT LOW-PASS FILTER ---
-        if (fx->filter_enabled) {
-            // Simple state-variable filter (Chamberlin)
-            // Normalized cutoff to actual frequency (linear mapping)
-            float nyquist = sample_rate * 0.5f;
-            float freq = fx->filter_cutoff * nyquist * 0.48f; // Linear for predictable response
-            float f = 2.0f * sinf(3.14159265f * freq / (float)sample_rate);
-
-            // Resonance (Q) - limit range for stability
-            // 0.0 resonance = q of 0.7 (gentle)
-            // 1.0 resonance = q of 0.1 (strong but stable)
-            float q = 0.7f - fx->filter_resonance * 0.6f;
-            if (q < 0.1f) q = 0.1f;
-
-            // Process left channel
-            fx->filter_lp[0] += f * fx->filter_bp[0];
-            float hp = left - fx->filter_lp[0] - q * fx->filter_bp[0];
-            fx->filter_bp[0] += f * hp;
-            left = fx->filter_lp[0];
-
-            // Process right channel
-            fx->filter_lp[1] += f * fx->filter_bp[1];
-            hp = right - fx->filter_lp[1] - q * fx->filter_bp[1];
-            fx->filter_bp[1] += f * hp;
-            right = fx->filter_lp[1];
+        // High shelf: boost/cut high frequencies (above 6kHz)
+        float high_band = mid_out - fx->eq_lp2[ch];
+        float final_out = mid_out + high_band * (high_mult - 1.0f);
+
+        if (ch == 0) left = final_out;
+        else right = final_out;
+    }
+
+    *io_left = left;
+    *io_right = right;
+}
+
+// --- COMPRESSOR (Professional RMS with soft knee and makeup gain) ---
+static inline void fx_stage_compressor(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float left = *io_left;
+    float right = *io_right;
+
+    for (int ch = 0; ch < 2; ch++) {
+        float input = (ch == 0) ? left : right;
+
+        // 1. Compute RMS level (smoother than peak for musical compression)
+        float squared = input * input;
+        float rms_alpha = 0.01f;  // Smoothing coefficient for RMS
+        fx->compressor_rms[ch] += rms_alpha * (squared - fx->compressor_rms[ch]);
+        float rms_level = sqrtf(fmaxf(fx->compressor_rms[ch], 0.0f));
+
+        // 2. Attack/release envelope follower (coefficients precomputed by setters)
+        float attack_coeff = fx->compressor_attack_coeff;
+        float release_coeff = fx->compressor_release_coeff;
+
+        if (rms_level > fx->compressor_envelope[ch]) {
+            fx->compressor_envelope[ch] += attack_coeff * (rms_level - fx->compressor_envelope[ch]);
+        } else {
+            fx->compressor_envelope[ch] += release_coeff * (rms_level - fx->compressor_envelope[ch]);
         }
 
-        // --- 3-BAND EQ ---
-        if (fx->eq_enabled) {
-            // 3-band EQ using stable cascaded filters
-            // Low shelf (~250Hz), Mid band (~1kHz), High shelf (~6kHz)
-            // Gain range: 0.5 = neutral, 0.0 = -12dB cut, 1.0 = +12dB boost
-            float low_gain = fx->eq_low;   // 0.0 to 1.0
-            float mid_gain = fx->eq_mid;   // 0.0 to 1.0
-            float high_gain = fx->eq_high; // 0.0 to 1.0
-
-            // Convert to linear gain (0.25x to 4x, with 1.0x at 0.5)
-            float low_mult = powf(4.0f, (low_gain - 0.5f) * 2.0f);   // 0.25 to 4.0
-            float mid_mult = powf(4.0f, (mid_gain - 0.5f) * 2.0f);
-            float high_mult = powf(4.0f, (high_gain - 0.5f) * 2.0f);
-
-            for (int ch = 0; ch < 2; ch++) {
-                float sample = (ch == 0) ? left : right;
-
-                // Low shelf: one-pole lowpass filter for bass (below 250Hz)
-                float low_freq = 250.0f / sample_rate;
-                float low_alpha = 1.0f - expf(-2.0f * 3.14159f * low_freq);
-                fx->eq_lp1[ch] += low_alpha * (sample - fx->eq_lp1[ch]);
-                float low_out = fx->eq_lp1[ch] * low_mult + (sample - fx->eq_lp1[ch]);
-
-                // Mid band: bandpass (250Hz to 6kHz) - what's left after low and high
-                float mid_freq = 6000.0f / sample_rate;
-                float mid_alpha = 1.0f - expf(-2.0f * 3.14159f * mid_freq);
-                fx->eq_lp2[ch] += mid_alpha * (low_out - fx->eq_lp2[ch]);
-                float mid_band = fx->eq_lp2[ch] - fx->eq_lp1[ch];
-                float mid_out = low_out + mid_band * (mid_mult - 1.0f);
-
-                // High shelf: boost/cut high frequencies (above 6kHz)
-                float high_band = mid_out - fx->eq_lp2[ch];
-                float final_out = mid_out + high_band * (high_mult - 1.0f);
-
-                if (ch == 0) left = final_out;
-                else right = final_out;
+        // 3. Threshold (0.0-1.0 maps to -40dB to -6dB, linear domain: 0.01 to 0.5)
+        float threshold = 0.01f + fx->compressor_threshold * 0.49f;
+
+        // 4. Ratio (0.0-1.0 maps to 1:1 to 20:1)
+        float ratio = 1.0f + fx->compressor_ratio * 19.0f;
+
+        // 5. Soft knee (0.1 = ±10% threshold for smooth transition)
+        float knee_width = 0.1f;
+        float gain = 1.0f;
+        float envelope = fx->compressor_envelope[ch];
+
+        if (envelope > threshold) {
+            float delta = envelope - threshold;
+            float knee_range = threshold * knee_width;
+
+            if (delta < knee_range) {
+                // Soft knee: smooth polynomial transition
+                float x = delta / knee_range;  // 0.0 to 1.0
+                float curve = x * x * (3.0f - 2.0f * x);  // Smoothstep
+                float hard_gain = (threshold + delta / ratio) / envelope;
+                gain = 1.0f - curve * (1.0f - hard_gain);
+            } else {
+                // Hard compression above knee
+                gain = (threshold + delta / ratio) / envelope;
             }
         }
 
-        // --- COMPRESSOR (Professional RMS with soft knee and makeup gain) ---
-        if (fx->compressor_enabled) {
-            for (int ch = 0; ch < 2; ch++) {
-                float input = (ch == 0) ? left : right;
-
-                // 1. Compute RMS level (smoother than peak for musical compression)
-                float squared = input * input;
-                float rms_alpha = 0.01f;  // Smoothing coefficient for RMS
-                fx->compressor_rms[ch] += rms_alpha * (squared - fx->compressor_rms[ch]);
-                float rms_level = sqrtf(fmaxf(fx->compressor_rms[ch], 0.0f));
-
-                // 2. Attack/release envelope follower
-                // Attack: 0.5ms to 50ms (0.0-1.0 maps to fast to slow)
-                // Release: 10ms to 500ms (0.0-1.0 maps to fast to slow)
-                float attack_time = 0.0005f + fx->compressor_attack * 0.0495f;
-                float release_time = 0.01f + fx->compressor_release * 0.49f;
-                float attack_coeff = 1.0f - expf(-1.0f / (sample_rate * attack_time));
-                float release_coeff = 1.0f - expf(-1.0f / (sample_rate * release_time));
-
-                if (rms_level > fx->compressor_envelope[ch]) {
-                    fx->compressor_envelope[ch] += attack_coeff * (rms_level - fx->compressor_envelope[ch]);
-                } else {
-                    fx->compressor_envelope[ch] += release_coeff * (rms_level - fx->compressor_envelope[ch]);
-                }
-
-                // 3. Threshold (0.0-1.0 maps to -40dB to -6dB, linear domain: 0.01 to 0.5)
-                float threshold = 0.01f + fx->compressor_threshold * 0.49f;
-
-                // 4. Ratio (0.0-1.0 maps to 1:1 to 20:1)
-                float ratio = 1.0f + fx->compressor_ratio * 19.0f;
-
-                // 5. Soft knee (0.1 = ±10% threshold for smooth transition)
-                float knee_width = 0.1f;
-                float gain = 1.0f;
-                float envelope = fx->compressor_envelope[ch];
-
-                if (envelope > threshold) {
-                    float delta = envelope - threshold;
-                    float knee_range = threshold * knee_width;
-
-                    if (delta < knee_range) {
-                        // Soft knee: smooth polynomial transition
-                        float x = delta / knee_range;  // 0.0 to 1.0
-                        float curve = x * x * (3.0f - 2.0f * x);  // Smoothstep
-                        float hard_gain = (threshold + delta / ratio) / envelope;
-                        gain = 1.0f - curve * (1.0f - hard_gain);
-                    } else {
-                        // Hard compression above knee
-                        gain = (threshold + delta / ratio) / envelope;
-                    }
-                }
-
-                // 6. Makeup gain (0.0-1.0 maps to 1x to 8x, compensates for level loss)
-                // At 0.5 (neutral), makeup is 1x. At 1.0, makeup is 8x.
-                float makeup = powf(8.0f, (fx->compressor_makeup - 0.5f) * 2.0f);
-
-                // 7. Apply compression and makeup gain
-                float compressed = input * gain * makeup;
-
-                if (ch == 0) left = compressed;
-                else right = compressed;
+        // 6. Makeup gain (0.0-1.0 maps to 1x to 8x, compensates for level loss)
+        // At 0.5 (neutral), makeup is 1x. At 1.0, makeup is 8x.
+        float makeup = powf(8.0f, (fx->compressor_makeup - 0.5f) * 2.0f);
+
+        // 7. Apply compression and makeup gain
+        float compressed = input * gain * makeup;
+
+        if (ch == 0) left = compressed;
+        else right = compressed;
+    }
+
+    *io_left = left;
+    *io_right = right;
+}
+
+// --- MULTIBAND COMPRESSOR (3 bands, LR4 crossovers) ---
+// Each crossover is a Butterworth SVF section followed by a second one on its LP and HP
+// outputs (LR4 = Butterworth squared). Filters at the same frequency share coefficients,
+// so the stereo pairs are run as 4-lane groups:
+//   low xover:  [L, R] -> [LP L, LP R, HP L, HP R]          => low band, upper part
+//   high xover: [upper L, upper R, low L, low R]            => split upper part, allpass low band
+//               -> [LP L, LP R, HP L, HP R]                 => mid band, high band
+// The low band gets the high crossover's allpass so the three bands sum flat.
+static inline void fx_stage_multiband(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float in[4], lp[4], bp[4], hp[4];
+    float band[REGROOVE_FX_MB_BANDS][2];
+
+    // Low crossover, first section (2 lanes)
+    in[0] = *io_left;
+    in[1] = *io_right;
+    svf_tick_lanes(fx->mb_xover_coeffs[0], fx->mb_split_ic, in, lp, bp, hp, 2);
+
+    // Low crossover, second sections
+    in[2] = hp[0];
+    in[3] = hp[1];
+    in[0] = lp[0];
+    in[1] = lp[1];
+    svf_tick_lanes(fx->mb_xover_coeffs[0], fx->mb_low_ic, in, lp, bp, hp, 4);
+    float low_left = lp[0], low_right = lp[1];
+
+    // High crossover, first section on the upper part + allpass on the low band
+    in[0] = hp[2];
+    in[1] = hp[3];
+    in[2] = low_left;
+    in[3] = low_right;
+    svf_tick_lanes(fx->mb_xover_coeffs[1], fx->mb_high_ic, in, lp, bp, hp, 4);
+    const float k = fx->mb_xover_coeffs[1][3];
+    band[REGROOVE_FX_MB_LOW][0] = in[2] - 2.0f * k * bp[2];
+    band[REGROOVE_FX_MB_LOW][1] = in[3] - 2.0f * k * bp[3];
+
+    // High crossover, second sections
+    in[0] = lp[0];
+    in[1] = lp[1];
+    in[2] = hp[0];
+    in[3] = hp[1];
+    svf_tick_lanes(fx->mb_xover_coeffs[1], fx->mb_top_ic, in, lp, bp, hp, 4);
+    band[REGROOVE_FX_MB_MID][0] = lp[0];
+    band[REGROOVE_FX_MB_MID][1] = lp[1];
+    band[REGROOVE_FX_MB_HIGH][0] = hp[2];
+    band[REGROOVE_FX_MB_HIGH][1] = hp[3];
+
+    // Per-band stereo-linked peak envelopes run every sample
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        float level = fmaxf(fabsf(band[b][0]), fabsf(band[b][1]));
+        float coeff = (level > fx->mb_envelope[b]) ? fx->mb_attack_coeff[b] : fx->mb_release_coeff[b];
+        fx->mb_envelope[b] += coeff * (level - fx->mb_envelope[b]);
+    }
+
+    // Gain computer at control rate in the log domain; the applied gain ramps to
+    // the new target over the interval so there's no zipper noise
+    if (--fx->mb_control_countdown < 0) {
+        fx->mb_control_countdown = REGROOVE_FX_MB_CONTROL_INTERVAL - 1;
+        for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+            float target = fx->mb_gain_lin[b];
+            if (fx->mb_envelope[b] > fx->mb_threshold_lin[b]) {
+                target *= exp2f(fx->mb_slope * log2f(fx->mb_envelope[b] / fx->mb_threshold_lin[b]));
             }
+            fx->mb_gain_step[b] = (target - fx->mb_gain[b]) * (1.0f / REGROOVE_FX_MB_CONTROL_INTERVAL);
         }
+    }
+
+    float left = 0.0f, right = 0.0f;
+    for (int b = 0; b < REGROOVE_FX_MB_BANDS; b++) {
+        fx->mb_gain[b] += fx->mb_gain_step[b];
+        left += band[b][0] * fx->mb_gain[b];
+        right += band[b][1] * fx->mb_gain[b];
+    }
+
+    *io_left = left;
+    *io_right = right;
+}
+
+// --- SIDECHAIN DUCKER ---
+static inline void fx_stage_ducker(RegrooveEffects* fx, float *io_left, float *io_right) {
+    // Fast attack / adjustable release follower on the block's key level
+    float key = fx->ducker_key;
+    float coeff = (key > fx->ducker_env) ? fx->ducker_attack_coeff : fx->ducker_release_coeff;
+    fx->ducker_env += coeff * (key - fx->ducker_env);
+
+    float gain = 1.0f - fx->ducker_depth * fx->ducker_env;
+    *io_left *= gain;
+    *io_right *= gain;
+}
 
-        // --- DELAY/ECHO ---
-        if (fx->delay_enabled && fx->delay_buffer[0] && fx->delay_buffer[1]) {
-            // Delay time in samples (0-1000ms)
-            int delay_samples = (int)(fx->delay_time * sample_rate);
-            if (delay_samples > MAX_DELAY_SAMPLES - 1) delay_samples = MAX_DELAY_SAMPLES - 1;
+// --- DELAY/ECHO ---
+static inline void fx_stage_delay(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float left = *io_left;
+    float right = *io_right;
+    const int size = fx->delay_buffer_size;
 
-            // Read from delay buffer
-            int read_pos = fx->delay_write_pos - delay_samples;
-            if (read_pos < 0) read_pos += MAX_DELAY_SAMPLES;
+    // Glide the delay length toward its target so time changes don't click
+    fx->delay_current += fx->delay_smooth_coeff * (fx->delay_target - fx->delay_current);
 
-            float delayed_left = fx->delay_buffer[0][read_pos];
-            float delayed_right = fx->delay_buffer[1][read_pos];
+    // Fractional read position behind the write head
+    float read = (float)fx->delay_write_pos - fx->delay_current;
+    if (read < 0.0f) read += (float)size;
+    int i0 = (int)read;
+    float t = read - (float)i0;
+    int im1 = (i0 == 0) ? size - 1 : i0 - 1;
+    int i1 = (i0 + 1 >= size) ? i0 + 1 - size : i0 + 1;
+    int i2 = (i0 + 2 >= size) ? i0 + 2 - size : i0 + 2;
 
-            // Write to delay buffer (input + feedback)
-            fx->delay_buffer[0][fx->delay_write_pos] = left + delayed_left * fx->delay_feedback;
-            fx->delay_buffer[1][fx->delay_write_pos] = right + delayed_right * fx->delay_feedback;
+    float delayed_left = hermite4(t, fx->delay_buffer[0][im1], fx->delay_buffer[0][i0],
+                                  fx->delay_buffer[0][i1], fx->delay_buffer[0][i2]);
+    float delayed_right = hermite4(t, fx->delay_buffer[1][im1], fx->delay_buffer[1][i0],
+                                   fx->delay_buffer[1][i1], fx->delay_buffer[1][i2]);
 
-            // Mix dry/wet
-            left = left * (1.0f - fx->delay_mix) + delayed_left * fx->delay_mix;
-            right = right * (1.0f - fx->delay_mix) + delayed_right * fx->delay_mix;
+    // Write to delay buffer (input + feedback)
+    fx->delay_buffer[0][fx->delay_write_pos] = left + delayed_left * fx->delay_feedback;
+    fx->delay_buffer[1][fx->delay_write_pos] = right + delayed_right * fx->delay_feedback;
 
-            // Advance write position
-            fx->delay_write_pos = (fx->delay_write_pos + 1) % MAX_DELAY_SAMPLES;
+    // Mix dry/wet
+    left = left * (1.0f - fx->delay_mix) + delayed_left * fx->delay_mix;
+    right = right * (1.0f - fx->delay_mix) + delayed_right * fx->delay_mix;
+
+    // Advance write position
+    fx->delay_write_pos = (fx->delay_write_pos + 1) % size;
+
+    *io_left = left;
+    *io_right = right;
+}
+
+// --- CONVOLUTION REVERB ---
+static inline void fx_stage_convolution(RegrooveEffects* fx, float *io_left, float *io_right) {
+    float wet_left, wet_right;
+
+    // Always feed the convolver so a newly loaded IR is picked up; dry passes while none is active
+    if (!regroove_convolver_tick(fx->convolver, *io_left, *io_right, &wet_left, &wet_right)) return;
+
+    *io_left = *io_left * (1.0f - fx->convolution_mix) + wet_left * fx->convolution_mix;
+    *io_right = *io_right * (1.0f - fx->convolution_mix) + wet_right * fx->convolution_mix;
+}
+
+void regroove_effects_process(RegrooveEffects* fx, int16_t* buffer, int frames) {
+    if (!fx || !buffer || frames <= 0) return;
+
+    // Auto-sleep: skip silent blocks once tails have decayed, wake on any signal
+    int input_silent = 1;
+    for (int i = 0; i < frames * 2; i++) {
+        if (buffer[i] != 0) {
+            input_silent = 0;
+            break;
         }
+    }
+    if (input_silent) {
+        if (fx->sleeping) return;
+        if (fx->silent_frames < INT32_MAX - frames) fx->silent_frames += frames;
+    } else {
+        fx->sleeping = 0;
+        fx->silent_frames = 0;
+    }
+
+    float energy = 0.0f;
+
+    // Per-block delay target (free-running time or tempo-synced division)
+    fx->delay_target = fx_delay_target_samples(fx);
+    if (fx->delay_current <= 0.0f) fx->delay_current = fx->delay_target;
+
+    // Per-block filter coefficients (snap to the cutoff when the filter is switched on)
+    if (fx->filter_enabled) update_filter_coefficients(fx, frames);
+    else fx->filter_cutoff_smoothed = -1.0f;
+
+    // Convert to float for processing
+    const float scale_to_float = 1.0f / 32768.0f;
+    const float scale_to_int16 = 32767.0f;
+
+    for (int i = 0; i < frames; i++) {
+        // Get stereo samples
+        float left = (float)buffer[i * 2] * scale_to_float;
+        float right = (float)buffer[i * 2 + 1] * scale_to_float;
+
+        // Run enabled stages in the configured order
+        for (int s = 0; s < REGROOVE_FX_STAGE_COUNT; s++) {
+            switch (fx->stage_order[s]) {
+                case REGROOVE_FX_STAGE_DISTORTION:
+                    if (fx->distortion_enabled) fx_stage_distortion(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_FILTER:
+                    if (fx->filter_enabled) fx_stage_filter(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_EQ:
+                    if (fx->eq_enabled) fx_stage_eq(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_COMPRESSOR:
+                    if (fx->compressor_enabled) fx_stage_compressor(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_MULTIBAND:
+                    if (fx->multiband_enabled) fx_stage_multiband(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_DUCKER:
+                    if (fx->ducker_enabled) fx_stage_ducker(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_DELAY:
+                    if (fx->delay_enabled && fx->delay_buffer[0] && fx->delay_buffer[1]) fx_stage_delay(fx, &left, &right);
+                    break;
+                case REGROOVE_FX_STAGE_CONVOLUTION:
+                    if (fx->convolution_enabled) fx_stage_convolution(fx, &left, &right);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        energy += left * left + right * right;
 
         // Convert back to int16 with clamping
         buffer[i * 2] = (int16_t)clampf(left * scale_to_int16, -32768.0f, 32767.0f);
         buffer[i * 2 + 1] = (int16_t)clampf(right * scale_to_int16, -32768.0f, 32767.0f);
     }
+
+    // Go to sleep once the tail has run its known length and the output is below -120 dB.
+    // State is cleared so waking starts from silence rather than stale (denormal) values.
+    if (input_silent && fx->silent_frames >= fx_tail_frames(fx) &&
+        energy / (float)(frames * 2) < REGROOVE_FX_SLEEP_ENERGY) {
+        regroove_effects_reset(fx);
+        fx->sleeping = 1;
+    }
 }
 
 // Parameter setters
@@ -415,6 +935,10 @@ void regroove_effects_set_filter_resonance(RegrooveEffects* fx, float resonance)
     if (fx) fx->filter_resonance = clampf(resonance, 0.0f, 1.0f);
 }
 
+void regroove_effects_set_filter_mode(RegrooveEffects* fx, int mode) {
+    if (fx && mode >= 0 && mode < REGROOVE_FX_FILTER_MODE_COUNT) fx->filter_mode = mode;
+}
+
 // Parameter getters
 int regroove_effects_get_distortion_enabled(RegrooveEffects* fx) {
     return fx ? fx->distortion_enabled : 0;
@@ -440,6 +964,19 @@ float regroove_effects_get_filter_resonance(RegrooveEffects* fx) {
     return fx ? fx->filter_resonance : 0.0f;
 }
 
+int regroove_effects_get_filter_mode(RegrooveEffects* fx) {
+    return fx ? fx->filter_mode : REGROOVE_FX_FILTER_LOWPASS;
+}
+
+const char* regroove_effects_filter_mode_name(int mode) {
+    switch (mode) {
+        case REGROOVE_FX_FILTER_BANDPASS: return "BP";
+        case REGROOVE_FX_FILTER_HIGHPASS: return "HP";
+        case REGROOVE_FX_FILTER_NOTCH:    return "Notch";
+        default:                          return "LP";
+    }
+}
+
 // EQ setters/getters
 void regroove_effects_set_eq_enabled(RegrooveEffects* fx, int enabled) {
     if (fx) fx->eq_enabled = enabled;
@@ -477,10 +1014,16 @@ void regroove_effects_set_compressor_ratio(RegrooveEffects* fx, float ratio) {
     if (fx) fx->compressor_ratio = clampf(ratio, 0.0f, 1.0f);
 }
 void regroove_effects_set_compressor_attack(RegrooveEffects* fx, float attack) {
-    if (fx) fx->compressor_attack = clampf(attack, 0.0f, 1.0f);
+    if (fx) {
+        fx->compressor_attack = clampf(attack, 0.0f, 1.0f);
+        update_compressor_coefficients(fx);
+    }
 }
 void regroove_effects_set_compressor_release(RegrooveEffects* fx, float release) {
-    if (fx) fx->compressor_release = clampf(release, 0.0f, 1.0f);
+    if (fx) {
+        fx->compressor_release = clampf(release, 0.0f, 1.0f);
+        update_compressor_coefficients(fx);
+    }
 }
 void regroove_effects_set_compressor_makeup(RegrooveEffects* fx, float makeup) {
     if (fx) fx->compressor_makeup = clampf(makeup, 0.0f, 1.0f);
@@ -504,6 +1047,56 @@ float regroove_effects_get_compressor_makeup(RegrooveEffects* fx) {
     return fx ? fx->compressor_makeup : 0.5f;
 }
 
+// Multiband compressor setters/getters
+void regroove_effects_set_multiband_enabled(RegrooveEffects* fx, int enabled) {
+    if (fx) fx->multiband_enabled = enabled;
+}
+void regroove_effects_set_multiband_low_crossover(RegrooveEffects* fx, float crossover) {
+    if (!fx) return;
+    fx->multiband_low_crossover = clampf(crossover, 0.0f, 1.0f);
+    update_multiband_coefficients(fx);
+}
+void regroove_effects_set_multiband_high_crossover(RegrooveEffects* fx, float crossover) {
+    if (!fx) return;
+    fx->multiband_high_crossover = clampf(crossover, 0.0f, 1.0f);
+    update_multiband_coefficients(fx);
+}
+void regroove_effects_set_multiband_threshold(RegrooveEffects* fx, int band, float threshold) {
+    if (!fx || band < 0 || band >= REGROOVE_FX_MB_BANDS) return;
+    fx->multiband_threshold[band] = clampf(threshold, 0.0f, 1.0f);
+    update_multiband_coefficients(fx);
+}
+void regroove_effects_set_multiband_gain(RegrooveEffects* fx, int band, float gain) {
+    if (!fx || band < 0 || band >= REGROOVE_FX_MB_BANDS) return;
+    fx->multiband_gain[band] = clampf(gain, 0.0f, 1.0f);
+    update_multiband_coefficients(fx);
+}
+void regroove_effects_set_multiband_ratio(RegrooveEffects* fx, float ratio) {
+    if (!fx) return;
+    fx->multiband_ratio = clampf(ratio, 0.0f, 1.0f);
+    update_multiband_coefficients(fx);
+}
+int regroove_effects_get_multiband_enabled(RegrooveEffects* fx) {
+    return fx ? fx->multiband_enabled : 0;
+}
+float regroove_effects_get_multiband_low_crossover(RegrooveEffects* fx) {
+    return fx ? fx->multiband_low_crossover : 0.52f;
+}
+float regroove_effects_get_multiband_high_crossover(RegrooveEffects* fx) {
+    return fx ? fx->multiband_high_crossover : 0.40f;
+}
+float regroove_effects_get_multiband_threshold(RegrooveEffects* fx, int band) {
+    if (!fx || band < 0 || band >= REGROOVE_FX_MB_BANDS) return 0.7f;
+    return fx->multiband_threshold[band];
+}
+float regroove_effects_get_multiband_gain(RegrooveEffects* fx, int band) {
+    if (!fx || band < 0 || band >= REGROOVE_FX_MB_BANDS) return 0.5f;
+    return fx->multiband_gain[band];
+}
+float regroove_effects_get_multiband_ratio(RegrooveEffects* fx) {
+    return fx ? fx->multiband_ratio : 0.15f;
+}
+
 // Phaser setters/getters
 void regroove_effects_set_phaser_enabled(RegrooveEffects* fx, int enabled) {
     if (fx) fx->phaser_enabled = enabled;
@@ -569,6 +1162,15 @@ void regroove_effects_set_delay_feedback(RegrooveEffects* fx, float feedback) {
 void regroove_effects_set_delay_mix(RegrooveEffects* fx, float mix) {
     if (fx) fx->delay_mix = clampf(mix, 0.0f, 1.0f);
 }
+void regroove_effects_set_delay_sync(RegrooveEffects* fx, int enabled) {
+    if (fx) fx->delay_sync = enabled;
+}
+void regroove_effects_set_tempo(RegrooveEffects* fx, double bpm) {
+    if (fx && bpm > 0.0) fx->tempo_bpm = bpm;
+}
+const char* regroove_effects_get_delay_division_name(RegrooveEffects* fx) {
+    return delay_divisions[delay_division_index(fx ? fx->delay_time : 0.0f)].name;
+}
 int regroove_effects_get_delay_enabled(RegrooveEffects* fx) {
     return fx ? fx->delay_enabled : 0;
 }
@@ -581,3 +1183,58 @@ float regroove_effects_get_delay_feedback(RegrooveEffects* fx) {
 float regroove_effects_get_delay_mix(RegrooveEffects* fx) {
     return fx ? fx->delay_mix : 0.3f;
 }
+int regroove_effects_get_delay_sync(RegrooveEffects* fx) {
+    return fx ? fx->delay_sync : 0;
+}
+
+// Ducker setters/getters
+void regroove_effects_set_ducker_enabled(RegrooveEffects* fx, int enabled) {
+    if (fx) fx->ducker_enabled = enabled;
+}
+void regroove_effects_set_ducker_depth(RegrooveEffects* fx, float depth) {
+    if (fx) fx->ducker_depth = clampf(depth, 0.0f, 1.0f);
+}
+void regroove_effects_set_ducker_release(RegrooveEffects* fx, float release) {
+    if (fx) {
+        fx->ducker_release = clampf(release, 0.0f, 1.0f);
+        update_ducker_coefficients(fx);
+    }
+}
+void regroove_effects_set_sidechain_key(RegrooveEffects* fx, float level) {
+    if (fx) fx->ducker_key = clampf(level, 0.0f, 1.0f);
+}
+int regroove_effects_get_ducker_enabled(RegrooveEffects* fx) {
+    return fx ? fx->ducker_enabled : 0;
+}
+float regroove_effects_get_ducker_depth(RegrooveEffects* fx) {
+    return fx ? fx->ducker_depth : 0.7f;
+}
+float regroove_effects_get_ducker_release(RegrooveEffects* fx) {
+    return fx ? fx->ducker_release : 0.3f;
+}
+
+// Convolution setters/getters
+void regroove_effects_set_convolution_enabled(RegrooveEffects* fx, int enabled) {
+    if (fx) fx->convolution_enabled = enabled;
+}
+void regroove_effects_set_convolution_mix(RegrooveEffects* fx, float mix) {
+    if (fx) fx->convolution_mix = clampf(mix, 0.0f, 1.0f);
+}
+int regroove_effects_load_convolution_ir(RegrooveEffects* fx, const char* path) {
+    return fx ? regroove_convolver_load_ir(fx->convolver, path) : -1;
+}
+int regroove_effects_get_convolution_enabled(RegrooveEffects* fx) {
+    return fx ? fx->convolution_enabled : 0;
+}
+float regroove_effects_get_convolution_mix(RegrooveEffects* fx) {
+    return fx ? fx->convolution_mix : 0.3f;
+}
+const char* regroove_effects_get_convolution_ir(RegrooveEffects* fx) {
+    return fx ? regroove_convolver_get_ir_path(fx->convolver) : "";
+}
+int regroove_effects_get_convolution_ir_loaded(RegrooveEffects* fx) {
+    return fx ? regroove_convolver_has_ir(fx->convolver) : 0;
+}
+int regroove_effects_get_convolution_ir_loading(RegrooveEffects* fx) {
+    return fx ? regroove_convolver_is_loading(fx->convolver) : 0;
+}
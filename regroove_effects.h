@@ -2,13 +2,57 @@
 #define REGROOVE_EFFECTS_H
 
 #include <stdint.h>
+#include "regroove_convolver.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Delay line size (1 second at 48kHz)
-#define MAX_DELAY_SAMPLES 48000
+// Default sample rate used until the audio device reports its obtained rate
+#define REGROOVE_FX_DEFAULT_SAMPLE_RATE 48000
+
+// Maximum free-running delay time
+#define REGROOVE_FX_MAX_DELAY_MS 1000
+
+// Tempo-synced delay: the longest note division (in beats) at the slowest
+// supported tempo. The delay line is sized for the larger of the two maxima.
+#define REGROOVE_FX_SYNC_MIN_BPM 40.0
+#define REGROOVE_FX_SYNC_MAX_BEATS 2.0
+
+// Auto-sleep: the chain stops processing once its output energy is below
+// -120 dBFS (power 1e-12) and the known tail length has elapsed on silent input
+#define REGROOVE_FX_SLEEP_ENERGY 1e-12f
+
+// Multiband compressor bands
+#define REGROOVE_FX_MB_BANDS 3
+#define REGROOVE_FX_MB_LOW 0
+#define REGROOVE_FX_MB_MID 1
+#define REGROOVE_FX_MB_HIGH 2
+
+// Multiband gain computer runs once per this many samples; gains ramp linearly in between
+#define REGROOVE_FX_MB_CONTROL_INTERVAL 16
+
+// Filter responses (outputs of the state-variable filter)
+typedef enum {
+    REGROOVE_FX_FILTER_LOWPASS = 0,
+    REGROOVE_FX_FILTER_BANDPASS,
+    REGROOVE_FX_FILTER_HIGHPASS,
+    REGROOVE_FX_FILTER_NOTCH,
+    REGROOVE_FX_FILTER_MODE_COUNT
+} RegrooveFxFilterMode;
+
+// Effect stages (processing order within a chain is configurable)
+typedef enum {
+    REGROOVE_FX_STAGE_DISTORTION = 0,
+    REGROOVE_FX_STAGE_FILTER,
+    REGROOVE_FX_STAGE_EQ,
+    REGROOVE_FX_STAGE_COMPRESSOR,
+    REGROOVE_FX_STAGE_MULTIBAND,
+    REGROOVE_FX_STAGE_DUCKER,
+    REGROOVE_FX_STAGE_DELAY,
+    REGROOVE_FX_STAGE_CONVOLUTION,
+    REGROOVE_FX_STAGE_COUNT
+} RegrooveFxStage;
 
 // Effects chain structure
 typedef struct {
@@ -17,10 +61,11 @@ typedef struct {
     float distortion_drive;    // 0.0 - 1.0
     float distortion_mix;      // 0.0 - 1.0 (dry/wet)
 
-    // Filter parameters (simple resonant low-pass)
+    // Filter parameters (resonant state-variable filter)
     int filter_enabled;
-    float filter_cutoff;       // 0.0 - 1.0 (normalized frequency)
+    float filter_cutoff;       // 0.0 - 1.0 (maps exponentially to 20Hz-20kHz)
     float filter_resonance;    // 0.0 - 1.0 (Q factor)
+    int filter_mode;           // RegrooveFxFilterMode
 
     // 3-band EQ parameters
     int eq_enabled;
@@ -36,6 +81,14 @@ typedef struct {
     float compressor_release;   // 0.0 - 1.0 (fast to slow)
     float compressor_makeup;    // 0.0 - 1.0 (makeup gain)
 
+    // Multiband compressor parameters (bands split by Linkwitz-Riley crossovers)
+    int multiband_enabled;
+    float multiband_low_crossover;   // 0.0 - 1.0 (maps to 60-600Hz)
+    float multiband_high_crossover;  // 0.0 - 1.0 (maps to 1-10kHz)
+    float multiband_threshold[REGROOVE_FX_MB_BANDS]; // 0.0 - 1.0 (maps to -40dB to 0dB)
+    float multiband_gain[REGROOVE_FX_MB_BANDS];      // 0.0 - 1.0 (-12dB to +12dB, 0.5 = unity)
+    float multiband_ratio;           // 0.0 - 1.0 (maps to 1:1 to 20:1, all bands)
+
     // Phaser parameters
     int phaser_enabled;
     float phaser_rate;         // 0.0 - 1.0 (LFO speed)
@@ -50,13 +103,49 @@ typedef struct {
 
     // Delay/Echo parameters
     int delay_enabled;
-    float delay_time;          // 0.0 - 1.0 (maps to 0-1000ms)
+    float delay_time;          // 0.0 - 1.0 (maps to 0-1000ms, or a note division when synced)
     float delay_feedback;      // 0.0 - 1.0
     float delay_mix;           // 0.0 - 1.0 (dry/wet)
+    int delay_sync;            // 1 = lock delay time to note divisions of the song tempo
+
+    // Sidechain ducker parameters (keyed from a tracker channel)
+    int ducker_enabled;
+    float ducker_depth;        // 0.0 - 1.0 (gain reduction at full key level)
+    float ducker_release;      // 0.0 - 1.0 (maps to 20-500ms)
+
+    // Convolution reverb parameters (impulse response loaded from a WAV file)
+    int convolution_enabled;
+    float convolution_mix;     // 0.0 - 1.0 (dry/wet)
+
+    // Processing order (a permutation of RegrooveFxStage)
+    int stage_order[REGROOVE_FX_STAGE_COUNT];
+
+    // Sample rate and coefficients precomputed for it
+    int sample_rate;
+    float dist_hp_alpha;       // Distortion pre-emphasis highpass (80Hz)
+    float dist_bp_f;           // Distortion punch bandpass (120Hz)
+    float dist_lp_alpha;       // Distortion post lowpass (8kHz)
+    float eq_low_alpha;        // EQ low shelf crossover (250Hz)
+    float eq_mid_alpha;        // EQ high shelf crossover (6kHz)
+    float compressor_attack_coeff;
+    float compressor_release_coeff;
+    float delay_smooth_coeff;  // Per-sample slew of the delay length (~50ms)
+    float ducker_attack_coeff; // Ducker envelope attack (~1ms)
+    float ducker_release_coeff;
+    float filter_coeffs[4];    // Filter SVF coefficients (a1, a2, a3, k), updated per block
+    float filter_cutoff_smoothed; // Cutoff glided per block (< 0 = snap to target)
+    float mb_xover_coeffs[2][4];       // Low/high crossover SVF coefficients (a1, a2, a3, k)
+    float mb_threshold_lin[REGROOVE_FX_MB_BANDS];
+    float mb_gain_lin[REGROOVE_FX_MB_BANDS];
+    float mb_slope;                    // Gain computer slope (1/ratio - 1)
+    float mb_attack_coeff[REGROOVE_FX_MB_BANDS];
+    float mb_release_coeff[REGROOVE_FX_MB_BANDS];
+
+    // Effective song tempo (BPM) for tempo-synced effects
+    double tempo_bpm;
 
     // Internal state
-    float filter_lp[2];        // Low-pass state (L, R)
-    float filter_bp[2];        // Band-pass state (L, R)
+    float filter_ic[2][4];     // Filter SVF integrator states (L, R lanes)
 
     float distortion_hp[2];    // Distortion pre-emphasis highpass state
     float distortion_bp_lp[2]; // Distortion bandpass lowpass state
@@ -71,6 +160,16 @@ typedef struct {
     float compressor_envelope[2]; // Compressor envelope followers
     float compressor_rms[2];      // RMS state for smoother detection
 
+    // Multiband crossover SVF states, 4 lanes per filter (see fx_stage_multiband)
+    float mb_split_ic[2][4];      // Low crossover, first section (L, R)
+    float mb_low_ic[2][4];        // Low crossover, second sections
+    float mb_high_ic[2][4];       // High crossover, first section + low band allpass
+    float mb_top_ic[2][4];        // High crossover, second sections
+    float mb_envelope[REGROOVE_FX_MB_BANDS]; // Per-band envelope followers (stereo linked)
+    float mb_gain[REGROOVE_FX_MB_BANDS];      // Per-band gain, ramped toward the control-rate target
+    float mb_gain_step[REGROOVE_FX_MB_BANDS]; // Per-sample gain increment of the current ramp
+    int mb_control_countdown;                 // Samples until the next gain computer update
+
     float phaser_lfo_phase;    // Phaser LFO phase
     float phaser_ap[4][2];     // Phaser all-pass filter states (4 stages, stereo)
 
@@ -78,11 +177,24 @@ typedef struct {
     int reverb_comb_pos[8];    // Comb filter read positions
 
     float *delay_buffer[2];    // Delay buffers (L, R)
+    int delay_buffer_size;     // Delay buffer length in samples (longest free or synced delay)
     int delay_write_pos;       // Delay write position
+    float delay_target;        // Target delay length in samples (updated per block)
+    float delay_current;       // Smoothed fractional delay length in samples
+
+    float ducker_key;          // Sidechain key level for the current block (0.0 - 1.0)
+    float ducker_env;          // Ducker envelope follower state
+
+    RegrooveConvolver *convolver; // Partitioned convolution engine (owns the IR)
+
+    // Auto-sleep state
+    int sleeping;              // 1 = tails decayed, processing skipped until non-silent input
+    int silent_frames;         // Frames of silent input since the last signal
 } RegrooveEffects;
 
 // Initialize effects with default parameters
-RegrooveEffects* regroove_effects_create(void);
+// sample_rate: device sample rate in Hz (buffers and coefficients are sized for it)
+RegrooveEffects* regroove_effects_create(int sample_rate);
 
 // Free effects
 void regroove_effects_destroy(RegrooveEffects* fx);
@@ -90,11 +202,28 @@ void regroove_effects_destroy(RegrooveEffects* fx);
 // Reset effect state (clear filter memory, etc.)
 void regroove_effects_reset(RegrooveEffects* fx);
 
-// Process audio buffer through effects chain
+// Change the sample rate: reallocates the delay line and recomputes coefficients.
+// Allocates memory - only call while the audio device is closed or locked.
+// Returns 0 on success, -1 on failure (previous buffers are kept)
+int regroove_effects_set_sample_rate(RegrooveEffects* fx, int sample_rate);
+int regroove_effects_get_sample_rate(RegrooveEffects* fx);
+
+// Process audio buffer through effects chain at the configured sample rate
 // buffer: interleaved stereo int16 samples (L, R, L, R, ...)
 // frames: number of stereo frames
-// sample_rate: sample rate in Hz
-void regroove_effects_process(RegrooveEffects* fx, int16_t* buffer, int frames, int sample_rate);
+// Silent input is skipped entirely while the chain is sleeping (buffer left untouched)
+void regroove_effects_process(RegrooveEffects* fx, int16_t* buffer, int frames);
+
+// Stage order control
+// order: permutation of all RegrooveFxStage values; returns 0 on success, -1 if invalid
+int regroove_effects_set_stage_order(RegrooveEffects* fx, const int* order, int count);
+RegrooveFxStage regroove_effects_get_stage(RegrooveEffects* fx, int position);
+// Swap the stage at position with its neighbour (direction -1 = earlier, +1 = later)
+void regroove_effects_move_stage(RegrooveEffects* fx, int position, int direction);
+const char* regroove_effects_stage_name(RegrooveFxStage stage);
+
+// Returns 1 if the chain is asleep (tails decayed, next silent block will be skipped)
+int regroove_effects_is_sleeping(RegrooveEffects* fx);
 
 // Parameter setters (normalized 0.0 - 1.0 for MIDI mapping)
 void regroove_effects_set_distortion_enabled(RegrooveEffects* fx, int enabled);
@@ -104,6 +233,7 @@ void regroove_effects_set_distortion_mix(RegrooveEffects* fx, float mix);
 void regroove_effects_set_filter_enabled(RegrooveEffects* fx, int enabled);
 void regroove_effects_set_filter_cutoff(RegrooveEffects* fx, float cutoff);     // 0.0 - 1.0
 void regroove_effects_set_filter_resonance(RegrooveEffects* fx, float resonance); // 0.0 - 1.0
+void regroove_effects_set_filter_mode(RegrooveEffects* fx, int mode);           // RegrooveFxFilterMode
 
 void regroove_effects_set_eq_enabled(RegrooveEffects* fx, int enabled);
 void regroove_effects_set_eq_low(RegrooveEffects* fx, float gain);     // 0.0 - 1.0
@@ -117,6 +247,13 @@ void regroove_effects_set_compressor_attack(RegrooveEffects* fx, float attack);
 void regroove_effects_set_compressor_release(RegrooveEffects* fx, float release);
 void regroove_effects_set_compressor_makeup(RegrooveEffects* fx, float makeup);
 
+void regroove_effects_set_multiband_enabled(RegrooveEffects* fx, int enabled);
+void regroove_effects_set_multiband_low_crossover(RegrooveEffects* fx, float crossover);
+void regroove_effects_set_multiband_high_crossover(RegrooveEffects* fx, float crossover);
+void regroove_effects_set_multiband_threshold(RegrooveEffects* fx, int band, float threshold);
+void regroove_effects_set_multiband_gain(RegrooveEffects* fx, int band, float gain);
+void regroove_effects_set_multiband_ratio(RegrooveEffects* fx, float ratio);
+
 void regroove_effects_set_phaser_enabled(RegrooveEffects* fx, int enabled);
 void regroove_effects_set_phaser_rate(RegrooveEffects* fx, float rate);
 void regroove_effects_set_phaser_depth(RegrooveEffects* fx, float depth);
@@ -131,6 +268,29 @@ void regroove_effects_set_delay_enabled(RegrooveEffects* fx, int enabled);
 void regroove_effects_set_delay_time(RegrooveEffects* fx, float time);
 void regroove_effects_set_delay_feedback(RegrooveEffects* fx, float feedback);
 void regroove_effects_set_delay_mix(RegrooveEffects* fx, float mix);
+void regroove_effects_set_delay_sync(RegrooveEffects* fx, int enabled);
+
+// Effective song tempo for synced effects (song BPM divided by pitch factor)
+// Call once per block from the audio callback
+void regroove_effects_set_tempo(RegrooveEffects* fx, double bpm);
+
+// Note division selected by delay_time in sync mode (e.g. "1/8D")
+const char* regroove_effects_get_delay_division_name(RegrooveEffects* fx);
+
+void regroove_effects_set_ducker_enabled(RegrooveEffects* fx, int enabled);
+void regroove_effects_set_ducker_depth(RegrooveEffects* fx, float depth);
+void regroove_effects_set_ducker_release(RegrooveEffects* fx, float release);
+
+// Sidechain key level (0.0 - 1.0) driving the ducker
+// Call once per block from the audio callback (see regroove_get_sidechain_level)
+void regroove_effects_set_sidechain_key(RegrooveEffects* fx, float level);
+
+void regroove_effects_set_convolution_enabled(RegrooveEffects* fx, int enabled);
+void regroove_effects_set_convolution_mix(RegrooveEffects* fx, float mix);
+
+// Load the convolution impulse response (WAV) in the background; NULL or "" unloads.
+// Call from the main thread only. Returns 0 if the load was started, -1 on failure
+int regroove_effects_load_convolution_ir(RegrooveEffects* fx, const char* path);
 
 // Parameter getters (normalized 0.0 - 1.0)
 int regroove_effects_get_distortion_enabled(RegrooveEffects* fx);
@@ -140,6 +300,8 @@ float regroove_effects_get_distortion_mix(RegrooveEffects* fx);
 int regroove_effects_get_filter_enabled(RegrooveEffects* fx);
 float regroove_effects_get_filter_cutoff(RegrooveEffects* fx);
 float regroove_effects_get_filter_resonance(RegrooveEffects* fx);
+int regroove_effects_get_filter_mode(RegrooveEffects* fx);
+const char* regroove_effects_filter_mode_name(int mode);  // Short label ("LP", "BP", "HP", "Notch")
 
 int regroove_effects_get_eq_enabled(RegrooveEffects* fx);
 float regroove_effects_get_eq_low(RegrooveEffects* fx);
@@ -153,6 +315,13 @@ float regroove_effects_get_compressor_attack(RegrooveEffects* fx);
 float regroove_effects_get_compressor_release(RegrooveEffects* fx);
 float regroove_effects_get_compressor_makeup(RegrooveEffects* fx);
 
+int regroove_effects_get_multiband_enabled(RegrooveEffects* fx);
+float regroove_effects_get_multiband_low_crossover(RegrooveEffects* fx);
+float regroove_effects_get_multiband_high_crossover(RegrooveEffects* fx);
+float regroove_effects_get_multiband_threshold(RegrooveEffects* fx, int band);
+float regroove_effects_get_multiband_gain(RegrooveEffects* fx, int band);
+float regroove_effects_get_multiband_ratio(RegrooveEffects* fx);
+
 int regroove_effects_get_phaser_enabled(RegrooveEffects* fx);
 float regroove_effects_get_phaser_rate(RegrooveEffects* fx);
 float regroove_effects_get_phaser_depth(RegrooveEffects* fx);
@@ -167,6 +336,17 @@ int regroove_effects_get_delay_enabled(RegrooveEffects* fx);
 float regroove_effects_get_delay_time(RegrooveEffects* fx);
 float regroove_effects_get_delay_feedback(RegrooveEffects* fx);
 float regroove_effects_get_delay_mix(RegrooveEffects* fx);
+int regroove_effects_get_delay_sync(RegrooveEffects* fx);
+
+int regroove_effects_get_ducker_enabled(RegrooveEffects* fx);
+float regroove_effects_get_ducker_depth(RegrooveEffects* fx);
+float regroove_effects_get_ducker_release(RegrooveEffects* fx);
+
+int regroove_effects_get_convolution_enabled(RegrooveEffects* fx);
+float regroove_effects_get_convolution_mix(RegrooveEffects* fx);
+const char* regroove_effects_get_convolution_ir(RegrooveEffects* fx);  // "" if none
+int regroove_effects_get_convolution_ir_loaded(RegrooveEffects* fx);   // 1 = IR active on the audio thread
+int regroove_effects_get_convolution_ir_loading(RegrooveEffects* fx);  // 1 = background load in progress
 
 #ifdef __cplusplus
 }
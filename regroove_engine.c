@@ -2,11 +2,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <libopenmpt/libopenmpt.h>
 #include <libopenmpt/libopenmpt_ext.h>
 
 #define REGROOVE_MIN_PITCH 0.01
 #define REGROOVE_MAX_PITCH 4.0
+#define REGROOVE_MAX_TEMPO_NUDGE 0.05
 
 typedef enum {
     RG_CMD_NONE,
@@ -29,19 +31,22 @@ typedef enum {
     RG_CMD_SET_CHANNEL_VOLUME,
     RG_CMD_SET_CHANNEL_PANNING,
     RG_CMD_QUEUE_CHANNEL_MUTE,      // Queued mute toggle
-    RG_CMD_QUEUE_CHANNEL_SOLO       // Queued solo toggle
+    RG_CMD_QUEUE_CHANNEL_SOLO,      // Queued solo toggle
+    RG_CMD_SET_NOTE_LOOKAHEAD
 } RegrooveCommandType;
 
 typedef struct {
     RegrooveCommandType type;
     int arg1;
     int arg2;
-    double dval; // For volume
+    double dval; // For volume, panning and pitch
     int arg3;    // For loop range (end_order)
     int arg4;    // For loop range (end_row)
 } RegrooveCommand;
 
 #define RG_MAX_COMMANDS 8
+#define RG_MAX_AHEAD_ROWS 64        // Rows reported ahead of the playing row
+#define RG_MAX_NOTE_LOOKAHEAD 1.0   // Seconds
 
 struct Regroove {
     openmpt_module_ext* modext;
@@ -63,6 +68,9 @@ struct Regroove {
     double* channel_pannings;  // 0.0 = full left, 0.5 = center, 1.0 = full right
 
     int num_orders;
+    int num_patterns;
+    RegrooveInstrumentRun *instrument_runs;  // All patterns' runs, in pattern order
+    int *pattern_runs;                       // First run of each pattern (num_patterns + 1 entries)
     int pattern_mode;
     int loop_pattern;
     int loop_order;
@@ -91,6 +99,30 @@ struct Regroove {
     int prev_row;
     int prev_order;
 
+    // Sidechain key (computed once per rendered block)
+    int sidechain_channel;         // -1 = disabled
+    int sidechain_source;          // RegrooveSidechainSource
+    float sidechain_level;         // 0.0 - 1.0
+    int sidechain_last_pattern;
+    int sidechain_last_row;
+
+    // Beat grid (24 ticks per beat, rows counted from the pattern start)
+    double beat_position;          // Beats into the pattern at the end of the last block
+    int beat_last_row;
+    double tempo_nudge;            // Playback speed factor for phase alignment (1.0 = none)
+
+    // MIDI note lookahead: rows reported ahead of the playing row, in playing order
+    double note_lookahead;         // Seconds (0 = off)
+    int ahead_started;             // Reporting ahead since the playing row below
+    int ahead_order;               // Playing row (-1 = none yet)
+    int ahead_row;
+    int ahead_count;
+    int ahead_orders[RG_MAX_AHEAD_ROWS];
+    int ahead_rows[RG_MAX_AHEAD_ROWS];
+    int ahead_boundaries[RG_MAX_AHEAD_ROWS];  // Pattern boundaries between the playing row and this one
+    int *ahead_mutes;              // Mutes the reported rows were filtered with (before/past a boundary)
+    int ahead_repredict;           // A command changed where playback goes next
+
     // Pending mute/solo state (queued until pattern boundary)
     int* pending_mute_states;      // NULL if no pending changes
     int has_pending_mute_changes;  // Flag to indicate pending changes exist
@@ -105,6 +137,9 @@ struct Regroove {
     RegrooveLoopSongCallback     on_loop_song;
     RegroovePatternModeCallback  on_pattern_mode_change;
     RegrooveNoteCallback         on_note;
+    RegrooveNoteAheadCallback    on_note_ahead;
+    RegrooveNoteCancelCallback   on_note_cancel;
+    RegrooveNoteRowCallback      on_note_row;
     void *callback_userdata;
 
     // --- For feedback ---
@@ -143,6 +178,33 @@ static void reapply_pannings(struct Regroove* g) {
     }
 }
 
+static void apply_channel_volume(struct Regroove* g, int ch, double vol) {
+    if (ch < 0 || ch >= g->num_channels) return;
+    if (vol < 0.0) vol = 0.0;
+    if (vol > 1.0) vol = 1.0;
+    g->channel_volumes[ch] = vol;
+    if (g->interactive_ok && !g->mute_states[ch])
+        g->interactive.set_channel_volume(g->modext, ch, vol);
+}
+
+static void apply_channel_panning(struct Regroove* g, int ch, double pan) {
+    if (ch < 0 || ch >= g->num_channels) return;
+    if (pan < 0.0) pan = 0.0;
+    if (pan > 1.0) pan = 1.0;
+    g->channel_pannings[ch] = pan;
+    if (g->interactive2_ok && g->interactive2) {
+        // Convert 0.0..1.0 to -1.0..1.0 for libopenmpt
+        double libopenmpt_pan = (pan * 2.0) - 1.0;
+        g->interactive2->set_channel_panning(g->modext, ch, libopenmpt_pan);
+    }
+}
+
+static void apply_pitch(struct Regroove* g, double pitch) {
+    if (pitch < REGROOVE_MIN_PITCH) pitch = REGROOVE_MIN_PITCH;
+    if (pitch > REGROOVE_MAX_PITCH) pitch = REGROOVE_MAX_PITCH;
+    g->pitch_factor = pitch;
+}
+
 static void apply_pending_mute_changes(struct Regroove* g) {
     if (!g->has_pending_mute_changes || !g->pending_mute_states) return;
 
@@ -205,343 +267,393 @@ static void enqueue_command_range(struct Regroove* g, RegrooveCommandType type,
     }
 }
 
-static void process_commands(struct Regroove* g) {
-    while (g->command_queue_head != g->command_queue_tail) {
-        RegrooveCommand* cmd = &g->command_queue[g->command_queue_head];
-        switch (cmd->type) {
-            case RG_CMD_TOGGLE_CHANNEL_MUTE:
-                if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
-                    g->mute_states[cmd->arg1] = !g->mute_states[cmd->arg1];
-                    if (g->interactive_ok)
-                        g->interactive.set_channel_mute_status(g->modext, cmd->arg1, g->mute_states[cmd->arg1]);
-                }
-                break;
-            case RG_CMD_TOGGLE_CHANNEL_SINGLE:
-                if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
-                    // Check if this channel is already soloed (unmuted while all others are muted)
-                    int is_soloed = (g->mute_states[cmd->arg1] == 0);
-                    if (is_soloed) {
-                        for (int i = 0; i < g->num_channels; i++) {
-                            if (i != cmd->arg1 && g->mute_states[i] == 0) {
-                                is_soloed = 0;
-                                break;
-                            }
+// Execute one command (audio thread: from the queue, or directly, see regroove_apply_action)
+static void execute_command(struct Regroove* g, const RegrooveCommand* cmd) {
+    switch (cmd->type) {
+        case RG_CMD_TOGGLE_CHANNEL_MUTE:
+            if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
+                g->mute_states[cmd->arg1] = !g->mute_states[cmd->arg1];
+                if (g->interactive_ok)
+                    g->interactive.set_channel_mute_status(g->modext, cmd->arg1, g->mute_states[cmd->arg1]);
+            }
+            break;
+        case RG_CMD_TOGGLE_CHANNEL_SINGLE:
+            if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
+                // Check if this channel is already soloed (unmuted while all others are muted)
+                int is_soloed = (g->mute_states[cmd->arg1] == 0);
+                if (is_soloed) {
+                    for (int i = 0; i < g->num_channels; i++) {
+                        if (i != cmd->arg1 && g->mute_states[i] == 0) {
+                            is_soloed = 0;
+                            break;
                         }
                     }
+                }
 
-                    if (is_soloed) {
-                        // Un-solo: unmute all channels
-                        for (int i = 0; i < g->num_channels; ++i) {
-                            g->mute_states[i] = 0;
-                            if (g->interactive_ok)
-                                g->interactive.set_channel_mute_status(g->modext, i, 0);
-                        }
-                    } else {
-                        // Solo: mute all except this channel
-                        for (int i = 0; i < g->num_channels; ++i) {
-                            int mute = (i != cmd->arg1);
-                            g->mute_states[i] = mute;
-                            if (g->interactive_ok)
-                                g->interactive.set_channel_mute_status(g->modext, i, mute);
-                        }
+                if (is_soloed) {
+                    // Un-solo: unmute all channels
+                    for (int i = 0; i < g->num_channels; ++i) {
+                        g->mute_states[i] = 0;
+                        if (g->interactive_ok)
+                            g->interactive.set_channel_mute_status(g->modext, i, 0);
                     }
-                }
-                break;
-            case RG_CMD_SET_CHANNEL_VOLUME: {
-                int ch = cmd->arg1;
-                double vol = cmd->dval;
-                if (ch >= 0 && ch < g->num_channels) {
-                    if (vol < 0.0) vol = 0.0;
-                    if (vol > 1.0) vol = 1.0;
-                    g->channel_volumes[ch] = vol;
-                    if (g->interactive_ok && !g->mute_states[ch])
-                        g->interactive.set_channel_volume(g->modext, ch, vol);
-                }
-                break;
-            }
-            case RG_CMD_SET_CHANNEL_PANNING: {
-                int ch = cmd->arg1;
-                double pan = cmd->dval;
-                if (ch >= 0 && ch < g->num_channels) {
-                    if (pan < 0.0) pan = 0.0;
-                    if (pan > 1.0) pan = 1.0;
-                    g->channel_pannings[ch] = pan;
-                    if (g->interactive2_ok && g->interactive2) {
-                        // Convert 0.0..1.0 to -1.0..1.0 for libopenmpt
-                        double libopenmpt_pan = (pan * 2.0) - 1.0;
-                        g->interactive2->set_channel_panning(g->modext, ch, libopenmpt_pan);
+                } else {
+                    // Solo: mute all except this channel
+                    for (int i = 0; i < g->num_channels; ++i) {
+                        int mute = (i != cmd->arg1);
+                        g->mute_states[i] = mute;
+                        if (g->interactive_ok)
+                            g->interactive.set_channel_mute_status(g->modext, i, mute);
                     }
                 }
-                break;
             }
-            case RG_CMD_MUTE_ALL:
-                for (int ch = 0; ch < g->num_channels; ++ch) {
-                    g->mute_states[ch] = 1;
-                    if (g->interactive_ok)
-                        g->interactive.set_channel_volume(g->modext, ch, 0.0);
-                }
-                break;
-            case RG_CMD_UNMUTE_ALL:
-                for (int ch = 0; ch < g->num_channels; ++ch) {
-                    g->mute_states[ch] = 0;
-                    if (g->interactive_ok)
-                        g->interactive.set_channel_volume(g->modext, ch, g->channel_volumes[ch]);
-                }
-                break;
-            case RG_CMD_SET_PITCH: {
-                double val = cmd->arg1 / 100.0;
-                if (val < REGROOVE_MIN_PITCH) val = REGROOVE_MIN_PITCH;
-                if (val > REGROOVE_MAX_PITCH) val = REGROOVE_MAX_PITCH;
-                g->pitch_factor = val;
-                break;
+            break;
+        case RG_CMD_SET_CHANNEL_VOLUME:
+            apply_channel_volume(g, cmd->arg1, cmd->dval);
+            break;
+        case RG_CMD_SET_CHANNEL_PANNING:
+            apply_channel_panning(g, cmd->arg1, cmd->dval);
+            break;
+        case RG_CMD_MUTE_ALL:
+            for (int ch = 0; ch < g->num_channels; ++ch) {
+                g->mute_states[ch] = 1;
+                if (g->interactive_ok)
+                    g->interactive.set_channel_volume(g->modext, ch, 0.0);
             }
-            case RG_CMD_QUEUE_NEXT_ORDER: {
-                int cur_order = openmpt_module_get_current_order(g->mod);
-                int next_order = cur_order + 1;
-                if (next_order < g->num_orders) {
-                    if (g->pattern_mode) {
-                        g->pending_pattern_mode_order = next_order;
-                        g->queued_jump_type = 1; // next
-                    } else {
-                        g->queued_order = next_order;
-                        g->queued_row = 0;
-                        g->has_queued_jump = 1;
-                        g->queued_jump_type = 1; // next
-                    }
-                }
-                break;
+            break;
+        case RG_CMD_UNMUTE_ALL:
+            for (int ch = 0; ch < g->num_channels; ++ch) {
+                g->mute_states[ch] = 0;
+                if (g->interactive_ok)
+                    g->interactive.set_channel_volume(g->modext, ch, g->channel_volumes[ch]);
             }
-            case RG_CMD_QUEUE_PREV_ORDER: {
-                int cur_order = openmpt_module_get_current_order(g->mod);
-                int prev_order = cur_order > 0 ? cur_order - 1 : 0;
+            break;
+        case RG_CMD_SET_PITCH:
+            apply_pitch(g, cmd->dval);
+            break;
+        case RG_CMD_SET_NOTE_LOOKAHEAD:
+            // Withdraw what was reported and start again from the playing row
+            if (g->ahead_started && g->on_note_cancel) {
+                g->on_note_cancel(REGROOVE_ALL_CHANNELS, 0.0, g->callback_userdata);
+            }
+            g->note_lookahead = cmd->dval;
+            g->ahead_started = 0;
+            g->ahead_count = 0;
+            break;
+        case RG_CMD_QUEUE_NEXT_ORDER: {
+            int cur_order = openmpt_module_get_current_order(g->mod);
+            int next_order = cur_order + 1;
+            if (next_order < g->num_orders) {
                 if (g->pattern_mode) {
-                    g->pending_pattern_mode_order = prev_order;
-                    g->queued_jump_type = 2; // prev
+                    g->pending_pattern_mode_order = next_order;
+                    g->queued_jump_type = 1; // next
                 } else {
-                    g->queued_order = prev_order;
+                    g->queued_order = next_order;
                     g->queued_row = 0;
                     g->has_queued_jump = 1;
-                    g->queued_jump_type = 2; // prev
+                    g->queued_jump_type = 1; // next
                 }
-                break;
             }
-            case RG_CMD_QUEUE_ORDER:
-                if (g->pattern_mode) {
-                    g->pending_pattern_mode_order = cmd->arg1;
-                    g->queued_jump_type = 3; // specific order
-                } else {
-                    g->queued_order = cmd->arg1;
-                    g->queued_row = cmd->arg2;
-                    g->has_queued_jump = 1;
-                    g->queued_jump_type = 3; // specific order
+            break;
+        }
+        case RG_CMD_QUEUE_PREV_ORDER: {
+            int cur_order = openmpt_module_get_current_order(g->mod);
+            int prev_order = cur_order > 0 ? cur_order - 1 : 0;
+            if (g->pattern_mode) {
+                g->pending_pattern_mode_order = prev_order;
+                g->queued_jump_type = 2; // prev
+            } else {
+                g->queued_order = prev_order;
+                g->queued_row = 0;
+                g->has_queued_jump = 1;
+                g->queued_jump_type = 2; // prev
+            }
+            break;
+        }
+        case RG_CMD_QUEUE_ORDER:
+            if (g->pattern_mode) {
+                g->pending_pattern_mode_order = cmd->arg1;
+                g->queued_jump_type = 3; // specific order
+            } else {
+                g->queued_order = cmd->arg1;
+                g->queued_row = cmd->arg2;
+                g->has_queued_jump = 1;
+                g->queued_jump_type = 3; // specific order
+            }
+            break;
+        case RG_CMD_QUEUE_PATTERN: {
+            // Find first order containing this pattern
+            int pattern_index = cmd->arg1;
+            int target_order = -1;
+            for (int i = 0; i < g->num_orders; ++i) {
+                if (openmpt_module_get_order_pattern(g->mod, i) == pattern_index) {
+                    target_order = i;
+                    break;
                 }
-                break;
-            case RG_CMD_QUEUE_PATTERN: {
-                // Find first order containing this pattern
-                int pattern_index = cmd->arg1;
-                int target_order = -1;
+            }
+            if (target_order == -1) target_order = 0; // fallback
+
+            // Queue this order (will jump at pattern end)
+            if (g->pattern_mode) {
+                g->pending_pattern_mode_order = target_order;
+                g->queued_jump_type = 4; // pattern
+            } else {
+                g->queued_order = target_order;
+                g->queued_row = 0;
+                g->has_queued_jump = 1;
+                g->queued_jump_type = 4; // pattern
+            }
+            break;
+        }
+        case RG_CMD_JUMP_TO_PATTERN: {
+            int pattern_index = cmd->arg1;
+            int target_order = cmd->arg2; // arg2 now carries explicit order, or -1 to search
+
+            // If order not specified, find first order that contains this pattern
+            if (target_order == -1) {
                 for (int i = 0; i < g->num_orders; ++i) {
                     if (openmpt_module_get_order_pattern(g->mod, i) == pattern_index) {
                         target_order = i;
                         break;
                     }
                 }
-                if (target_order == -1) target_order = 0; // fallback
-
-                // Queue this order (will jump at pattern end)
-                if (g->pattern_mode) {
-                    g->pending_pattern_mode_order = target_order;
-                    g->queued_jump_type = 4; // pattern
-                } else {
-                    g->queued_order = target_order;
-                    g->queued_row = 0;
-                    g->has_queued_jump = 1;
-                    g->queued_jump_type = 4; // pattern
-                }
-                break;
-            }
-            case RG_CMD_JUMP_TO_PATTERN: {
-                int pattern_index = cmd->arg1;
-                int target_order = cmd->arg2; // arg2 now carries explicit order, or -1 to search
-
-                // If order not specified, find first order that contains this pattern
+                // If pattern not found in order list, use order 0 as fallback
                 if (target_order == -1) {
-                    for (int i = 0; i < g->num_orders; ++i) {
-                        if (openmpt_module_get_order_pattern(g->mod, i) == pattern_index) {
-                            target_order = i;
-                            break;
-                        }
-                    }
-                    // If pattern not found in order list, use order 0 as fallback
-                    if (target_order == -1) {
-                        target_order = 0;
-                    }
-                    printf("RG_CMD_JUMP_TO_PATTERN: pattern %d, searched and found order %d\n", pattern_index, target_order);
-                } else {
-                    printf("RG_CMD_JUMP_TO_PATTERN: pattern %d, explicit order %d\n", pattern_index, target_order);
+                    target_order = 0;
                 }
+                printf("RG_CMD_JUMP_TO_PATTERN: pattern %d, searched and found order %d\n", pattern_index, target_order);
+            } else {
+                printf("RG_CMD_JUMP_TO_PATTERN: pattern %d, explicit order %d\n", pattern_index, target_order);
+            }
 
-                // Update loop state for pattern mode
-                g->loop_order = target_order;
-                g->loop_pattern = pattern_index;
-                g->full_loop_rows = openmpt_module_get_pattern_num_rows(g->mod, pattern_index);
-                g->custom_loop_rows = 0;
-                g->prev_row = -1;
+            // Update loop state for pattern mode
+            g->loop_order = target_order;
+            g->loop_pattern = pattern_index;
+            g->full_loop_rows = openmpt_module_get_pattern_num_rows(g->mod, pattern_index);
+            g->custom_loop_rows = 0;
+            g->prev_row = -1;
 
-                // Jump to the position immediately
-                openmpt_module_set_position_order_row(g->mod, target_order, 0);
-                printf("RG_CMD_JUMP_TO_PATTERN: Executed jump to order %d, row 0\n", target_order);
-                if (g->interactive_ok) {
-                    // reapply_mutes(g);  // Testing if this is still needed
-                    reapply_volumes(g);
-                    reapply_pannings(g);
-                }
-                break;
+            // Jump to the position immediately
+            openmpt_module_set_position_order_row(g->mod, target_order, 0);
+            printf("RG_CMD_JUMP_TO_PATTERN: Executed jump to order %d, row 0\n", target_order);
+            if (g->interactive_ok) {
+                // reapply_mutes(g);  // Testing if this is still needed
+                reapply_volumes(g);
+                reapply_pannings(g);
             }
-            case RG_CMD_SET_LOOP_RANGE:
-                // Set loop range: arg1=start_order, arg2=start_row, arg3=end_order, arg4=end_row
-                g->loop_start_order = cmd->arg1;
-                g->loop_start_row = cmd->arg2;
-                g->loop_end_order = cmd->arg3;
-                g->loop_end_row = cmd->arg4;
-                // Don't activate loop yet (that's done by TRIGGER_LOOP or PLAY_TO_LOOP)
-                break;
-            case RG_CMD_TRIGGER_LOOP:
-                // Jump to loop start immediately and begin looping
-                if (g->loop_start_order >= 0 && g->loop_start_order < g->num_orders) {
-                    openmpt_module_set_position_order_row(g->mod, g->loop_start_order, g->loop_start_row);
-                } else {
-                    // Single pattern mode: use current order
-                    int cur_order = openmpt_module_get_current_order(g->mod);
-                    openmpt_module_set_position_order_row(g->mod, cur_order, g->loop_start_row);
-                }
-                g->loop_range_enabled = 2; // ACTIVE
-                apply_pending_mute_changes(g);
-                if (g->interactive_ok) {
-                    // reapply_mutes(g);  // Testing if this is still needed
-                    reapply_volumes(g);
-                    reapply_pannings(g);
-                }
-                g->prev_row = -1;
-                break;
-            case RG_CMD_PLAY_TO_LOOP:
-                // Toggle: OFF→ARMED, ARMED→OFF, ACTIVE→OFF
-                if (g->loop_range_enabled == 0) {
-                    g->loop_range_enabled = 1; // OFF → ARMED
-                } else {
-                    g->loop_range_enabled = 0; // ARMED or ACTIVE → OFF
-                }
-                break;
-            case RG_CMD_SET_PATTERN_MODE:
-                g->pattern_mode = cmd->arg1;
-                if (g->pattern_mode) {
-                    g->loop_order   = openmpt_module_get_current_order(g->mod);
-                    g->loop_pattern = openmpt_module_get_current_pattern(g->mod);
-                    g->full_loop_rows = openmpt_module_get_pattern_num_rows(g->mod, g->loop_pattern);
-                    g->custom_loop_rows = 0;
-                    g->pending_pattern_mode_order = -1;
-                    g->queued_jump_type = 0;  // Clear any queued jumps when toggling mode
-                    g->prev_row = -1;
-                }
-                break;
-            case RG_CMD_RETRIGGER_PATTERN: {
+            break;
+        }
+        case RG_CMD_SET_LOOP_RANGE:
+            // Set loop range: arg1=start_order, arg2=start_row, arg3=end_order, arg4=end_row
+            g->loop_start_order = cmd->arg1;
+            g->loop_start_row = cmd->arg2;
+            g->loop_end_order = cmd->arg3;
+            g->loop_end_row = cmd->arg4;
+            // Don't activate loop yet (that's done by TRIGGER_LOOP or PLAY_TO_LOOP)
+            break;
+        case RG_CMD_TRIGGER_LOOP:
+            // Jump to loop start immediately and begin looping
+            if (g->loop_start_order >= 0 && g->loop_start_order < g->num_orders) {
+                openmpt_module_set_position_order_row(g->mod, g->loop_start_order, g->loop_start_row);
+            } else {
+                // Single pattern mode: use current order
                 int cur_order = openmpt_module_get_current_order(g->mod);
-                openmpt_module_set_position_order_row(g->mod, cur_order, 0);
-                if (g->interactive_ok) {
-                    // reapply_mutes(g);  // Testing if this is still needed
-                    reapply_volumes(g);
-                    reapply_pannings(g);
-                }
-                g->prev_row = -1;
-                break;
+                openmpt_module_set_position_order_row(g->mod, cur_order, g->loop_start_row);
+            }
+            g->loop_range_enabled = 2; // ACTIVE
+            apply_pending_mute_changes(g);
+            if (g->interactive_ok) {
+                // reapply_mutes(g);  // Testing if this is still needed
+                reapply_volumes(g);
+                reapply_pannings(g);
+            }
+            g->prev_row = -1;
+            break;
+        case RG_CMD_PLAY_TO_LOOP:
+            // Toggle: OFF→ARMED, ARMED→OFF, ACTIVE→OFF
+            if (g->loop_range_enabled == 0) {
+                g->loop_range_enabled = 1; // OFF → ARMED
+            } else {
+                g->loop_range_enabled = 0; // ARMED or ACTIVE → OFF
             }
-            case RG_CMD_SET_CUSTOM_LOOP_ROWS:
-                g->custom_loop_rows = cmd->arg1;
-                if (g->custom_loop_rows < 0) g->custom_loop_rows = 0;
+            break;
+        case RG_CMD_SET_PATTERN_MODE:
+            g->pattern_mode = cmd->arg1;
+            if (g->pattern_mode) {
+                g->loop_order   = openmpt_module_get_current_order(g->mod);
+                g->loop_pattern = openmpt_module_get_current_pattern(g->mod);
+                g->full_loop_rows = openmpt_module_get_pattern_num_rows(g->mod, g->loop_pattern);
+                g->custom_loop_rows = 0;
+                g->pending_pattern_mode_order = -1;
+                g->queued_jump_type = 0;  // Clear any queued jumps when toggling mode
                 g->prev_row = -1;
-                break;
-            case RG_CMD_QUEUE_CHANNEL_MUTE:
-                if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
-                    // Allocate pending states if not yet allocated
-                    if (!g->pending_mute_states) {
-                        g->pending_mute_states = (int*)malloc(g->num_channels * sizeof(int));
-                        // Copy current mute states as starting point
-                        memcpy(g->pending_mute_states, g->mute_states, g->num_channels * sizeof(int));
+            }
+            break;
+        case RG_CMD_RETRIGGER_PATTERN: {
+            int cur_order = openmpt_module_get_current_order(g->mod);
+            openmpt_module_set_position_order_row(g->mod, cur_order, 0);
+            if (g->interactive_ok) {
+                // reapply_mutes(g);  // Testing if this is still needed
+                reapply_volumes(g);
+                reapply_pannings(g);
+            }
+            g->prev_row = -1;
+            break;
+        }
+        case RG_CMD_SET_CUSTOM_LOOP_ROWS:
+            g->custom_loop_rows = cmd->arg1;
+            if (g->custom_loop_rows < 0) g->custom_loop_rows = 0;
+            g->prev_row = -1;
+            break;
+        case RG_CMD_QUEUE_CHANNEL_MUTE:
+            if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
+                // Allocate pending states if not yet allocated
+                if (!g->pending_mute_states) {
+                    g->pending_mute_states = (int*)malloc(g->num_channels * sizeof(int));
+                    // Copy current mute states as starting point
+                    memcpy(g->pending_mute_states, g->mute_states, g->num_channels * sizeof(int));
+                }
+                // Toggle pending mute state for this channel
+                g->pending_mute_states[cmd->arg1] = !g->pending_mute_states[cmd->arg1];
+
+                // Track that this specific channel had MUTE queued
+                // BUT: if pending state == current state, that means we're canceling the change
+                if (g->queued_action_per_channel) {
+                    if (g->pending_mute_states[cmd->arg1] != g->mute_states[cmd->arg1]) {
+                        // There IS a pending change - mark it
+                        g->queued_action_per_channel[cmd->arg1] = 1; // mute
+                    } else {
+                        // No change - cancel the queued action
+                        g->queued_action_per_channel[cmd->arg1] = 0;
                     }
-                    // Toggle pending mute state for this channel
-                    g->pending_mute_states[cmd->arg1] = !g->pending_mute_states[cmd->arg1];
+                }
 
-                    // Track that this specific channel had MUTE queued
-                    // BUT: if pending state == current state, that means we're canceling the change
-                    if (g->queued_action_per_channel) {
-                        if (g->pending_mute_states[cmd->arg1] != g->mute_states[cmd->arg1]) {
-                            // There IS a pending change - mark it
-                            g->queued_action_per_channel[cmd->arg1] = 1; // mute
-                        } else {
-                            // No change - cancel the queued action
-                            g->queued_action_per_channel[cmd->arg1] = 0;
-                        }
+                // Check if there are ANY pending changes left across all channels
+                int has_changes = 0;
+                for (int i = 0; i < g->num_channels; i++) {
+                    if (g->pending_mute_states[i] != g->mute_states[i]) {
+                        has_changes = 1;
+                        break;
                     }
-
-                    // Check if there are ANY pending changes left across all channels
-                    int has_changes = 0;
+                }
+                g->has_pending_mute_changes = has_changes;
+            }
+            break;
+        case RG_CMD_QUEUE_CHANNEL_SOLO:
+            if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
+                // Allocate pending states if not yet allocated
+                if (!g->pending_mute_states) {
+                    g->pending_mute_states = (int*)malloc(g->num_channels * sizeof(int));
+                    // Copy current mute states as starting point
+                    memcpy(g->pending_mute_states, g->mute_states, g->num_channels * sizeof(int));
+                }
+                // Check if this channel is currently pending solo (all others muted in pending)
+                int is_pending_solo = g->pending_mute_states[cmd->arg1] == 0;
+                if (is_pending_solo) {
+                    // Check if all other channels are muted in pending
                     for (int i = 0; i < g->num_channels; i++) {
-                        if (g->pending_mute_states[i] != g->mute_states[i]) {
-                            has_changes = 1;
+                        if (i != cmd->arg1 && g->pending_mute_states[i] == 0) {
+                            is_pending_solo = 0;
                             break;
                         }
                     }
-                    g->has_pending_mute_changes = has_changes;
                 }
-                break;
-            case RG_CMD_QUEUE_CHANNEL_SOLO:
-                if (cmd->arg1 >= 0 && cmd->arg1 < g->num_channels) {
-                    // Allocate pending states if not yet allocated
-                    if (!g->pending_mute_states) {
-                        g->pending_mute_states = (int*)malloc(g->num_channels * sizeof(int));
-                        // Copy current mute states as starting point
-                        memcpy(g->pending_mute_states, g->mute_states, g->num_channels * sizeof(int));
+
+                if (!is_pending_solo) {
+                    // Set to solo: mute all, unmute this one
+                    for (int i = 0; i < g->num_channels; i++) {
+                        g->pending_mute_states[i] = (i != cmd->arg1) ? 1 : 0;
                     }
-                    // Check if this channel is currently pending solo (all others muted in pending)
-                    int is_pending_solo = g->pending_mute_states[cmd->arg1] == 0;
-                    if (is_pending_solo) {
-                        // Check if all other channels are muted in pending
-                        for (int i = 0; i < g->num_channels; i++) {
-                            if (i != cmd->arg1 && g->pending_mute_states[i] == 0) {
-                                is_pending_solo = 0;
-                                break;
-                            }
-                        }
+                    // Track that this specific channel had SOLO queued
+                    // Clear all previous queued actions and set only this channel to SOLO
+                    if (g->queued_action_per_channel) {
+                        memset(g->queued_action_per_channel, 0, g->num_channels * sizeof(int));
+                        g->queued_action_per_channel[cmd->arg1] = 2; // solo
                     }
+                } else {
+                    // Un-solo: unmute all
+                    for (int i = 0; i < g->num_channels; i++) {
+                        g->pending_mute_states[i] = 0;
+                    }
+                    // Clear all queued action flags
+                    if (g->queued_action_per_channel) {
+                        memset(g->queued_action_per_channel, 0, g->num_channels * sizeof(int));
+                    }
+                }
+                g->has_pending_mute_changes = 1;
+            }
+            break;
+        default: break;
+    }
 
-                    if (!is_pending_solo) {
-                        // Set to solo: mute all, unmute this one
-                        for (int i = 0; i < g->num_channels; i++) {
-                            g->pending_mute_states[i] = (i != cmd->arg1) ? 1 : 0;
-                        }
-                        // Track that this specific channel had SOLO queued
-                        // Clear all previous queued actions and set only this channel to SOLO
-                        if (g->queued_action_per_channel) {
-                            memset(g->queued_action_per_channel, 0, g->num_channels * sizeof(int));
-                            g->queued_action_per_channel[cmd->arg1] = 2; // solo
-                        }
-                    } else {
-                        // Un-solo: unmute all
-                        for (int i = 0; i < g->num_channels; i++) {
-                            g->pending_mute_states[i] = 0;
-                        }
-                        // Clear all queued action flags
-                        if (g->queued_action_per_channel) {
-                            memset(g->queued_action_per_channel, 0, g->num_channels * sizeof(int));
-                        }
+    // Commands that change where playback goes next invalidate the rows reported ahead
+    switch (cmd->type) {
+        case RG_CMD_QUEUE_ORDER:
+        case RG_CMD_QUEUE_NEXT_ORDER:
+        case RG_CMD_QUEUE_PREV_ORDER:
+        case RG_CMD_QUEUE_PATTERN:
+        case RG_CMD_SET_LOOP_RANGE:
+        case RG_CMD_PLAY_TO_LOOP:
+        case RG_CMD_SET_PATTERN_MODE:
+        case RG_CMD_SET_CUSTOM_LOOP_ROWS:
+            g->ahead_repredict = 1;
+            break;
+        default: break;
+    }
+}
+
+static void process_commands(struct Regroove* g) {
+    while (g->command_queue_head != g->command_queue_tail) {
+        execute_command(g, &g->command_queue[g->command_queue_head]);
+        g->command_queue_head = (g->command_queue_head + 1) % RG_MAX_COMMANDS;
+    }
+}
+
+// Read the instrument runs of every pattern (see regroove_get_pattern_instruments)
+static void build_instrument_runs(Regroove *g) {
+    g->num_patterns = openmpt_module_get_num_patterns(g->mod);
+    if (g->num_patterns < 0) g->num_patterns = 0;
+    g->pattern_runs = (int*)calloc(g->num_patterns + 1, sizeof(int));
+    if (!g->pattern_runs) return;
+
+    int count = 0, capacity = 0;
+    for (int p = 0; p < g->num_patterns; p++) {
+        g->pattern_runs[p] = count;
+        int rows = openmpt_module_get_pattern_num_rows(g->mod, p);
+        for (int ch = 0; ch < g->num_channels; ch++) {
+            int open = -1;  // Run of this channel that the next note may extend
+            for (int row = 0; row < rows; row++) {
+                // Notes 1-120 (note-off/cut/fade are above), instruments from 1
+                int note = openmpt_module_get_pattern_row_channel_command(g->mod, p, row, ch, OPENMPT_MODULE_COMMAND_NOTE);
+                int instrument = openmpt_module_get_pattern_row_channel_command(g->mod, p, row, ch, OPENMPT_MODULE_COMMAND_INSTRUMENT);
+                if (note < 1 || note > 120 || instrument == 0) continue;
+
+                if (open >= 0 && g->instrument_runs[open].instrument == instrument) {
+                    g->instrument_runs[open].last_row = row;
+                    continue;
+                }
+                if (count == capacity) {
+                    int new_capacity = capacity ? capacity * 2 : 256;
+                    RegrooveInstrumentRun *runs = (RegrooveInstrumentRun*)realloc(
+                        g->instrument_runs, new_capacity * sizeof(RegrooveInstrumentRun));
+                    if (!runs) {
+                        free(g->instrument_runs);
+                        g->instrument_runs = NULL;
+                        memset(g->pattern_runs, 0, (g->num_patterns + 1) * sizeof(int));
+                        return;
                     }
-                    g->has_pending_mute_changes = 1;
+                    g->instrument_runs = runs;
+                    capacity = new_capacity;
                 }
-                break;
-            default: break;
+                open = count++;
+                g->instrument_runs[open].channel = ch;
+                g->instrument_runs[open].instrument = instrument;
+                g->instrument_runs[open].first_row = row;
+                g->instrument_runs[open].last_row = row;
+            }
         }
-        g->command_queue_head = (g->command_queue_head + 1) % RG_MAX_COMMANDS;
     }
+    g->pattern_runs[g->num_patterns] = count;
 }
 
 Regroove *regroove_create(const char *filename, double samplerate) {
@@ -562,6 +674,13 @@ Regroove *regroove_create(const char *filename, double samplerate) {
     g->pattern_mode = 0;
     g->pending_pattern_mode_order = -1;
     g->queued_jump_type = 0;
+    g->sidechain_channel = -1;
+    g->sidechain_last_pattern = -1;
+    g->sidechain_last_row = -1;
+    g->beat_last_row = -1;
+    g->tempo_nudge = 1.0;
+    g->ahead_order = -1;
+    g->ahead_row = -1;
 
     FILE* f = fopen(filename, "rb");
     if (!f) { free(g); return NULL; }
@@ -585,6 +704,8 @@ Regroove *regroove_create(const char *filename, double samplerate) {
     g->mute_states = (int*)calloc(g->num_channels, sizeof(int));
     g->channel_volumes = (double*)calloc(g->num_channels, sizeof(double));
     g->channel_pannings = (double*)calloc(g->num_channels, sizeof(double));
+    g->ahead_mutes = (int*)calloc(2 * g->num_channels, sizeof(int));
+    build_instrument_runs(g);
     for (int i = 0; i < g->num_channels; ++i) {
         g->channel_volumes[i] = 1.0;
         g->channel_pannings[i] = 0.5;  // Center
@@ -666,6 +787,9 @@ Regroove *regroove_create(const char *filename, double samplerate) {
     g->on_loop_pattern = NULL;
     g->on_loop_song = NULL;
     g->on_note = NULL;
+    g->on_note_ahead = NULL;
+    g->on_note_cancel = NULL;
+    g->on_note_row = NULL;
     g->callback_userdata = NULL;
 
     g->last_msg_order = -1;
@@ -679,10 +803,14 @@ Regroove *regroove_create(const char *filename, double samplerate) {
 }
 
 void regroove_destroy(Regroove *g) {
+    if (!g) return;
     if (g->modext) openmpt_module_ext_destroy(g->modext);
     if (g->mute_states) free(g->mute_states);
     if (g->channel_volumes) free(g->channel_volumes);
     if (g->channel_pannings) free(g->channel_pannings);
+    if (g->ahead_mutes) free(g->ahead_mutes);
+    if (g->instrument_runs) free(g->instrument_runs);
+    if (g->pattern_runs) free(g->pattern_runs);
     if (g->interactive2) free(g->interactive2);
     if (g->pending_mute_states) free(g->pending_mute_states);
     if (g->queued_action_per_channel) free(g->queued_action_per_channel);
@@ -696,9 +824,435 @@ void regroove_set_callbacks(Regroove *g, struct RegrooveCallbacks *cb) {
     g->on_loop_pattern = cb->on_loop_pattern;
     g->on_loop_song = cb->on_loop_song;
     g->on_note = cb->on_note;
+    g->on_note_ahead = cb->on_note_ahead;
+    g->on_note_cancel = cb->on_note_cancel;
+    g->on_note_row = cb->on_note_row;
     g->callback_userdata = cb->userdata;
 }
 
+// Does a pattern cell trigger a note? (raw command, no allocation on the audio thread)
+static int cell_has_note(const Regroove* g, int pattern, int row, int ch) {
+    int note = openmpt_module_get_pattern_row_channel_command(g->mod, pattern, row, ch, OPENMPT_MODULE_COMMAND_NOTE);
+    return note >= 1 && note <= 120;
+}
+
+// Any note in rows [from, to] of a pattern (clamped to the pattern)
+static int rows_have_note(const Regroove* g, int pattern, int from, int to, int ch) {
+    int rows = openmpt_module_get_pattern_num_rows(g->mod, pattern);
+    if (from < 0) from = 0;
+    if (to >= rows) to = rows - 1;
+    for (int r = from; r <= to; r++) {
+        if (cell_has_note(g, pattern, r, ch)) return 1;
+    }
+    return 0;
+}
+
+// Update the sidechain key from the key channel (VU meter or note trigger on a new row)
+static void update_sidechain(Regroove* g, int pattern, int row) {
+    int ch = g->sidechain_channel;
+    if (ch < 0 || ch >= g->num_channels) {
+        g->sidechain_level = 0.0f;
+        return;
+    }
+
+    float level = 0.0f;
+    if (g->sidechain_source == REGROOVE_SIDECHAIN_NOTE) {
+        // A note on any row entered during the block gives a full-scale pulse; the
+        // ducker's release shapes it. Several rows can pass in one block: the rows
+        // after the last one seen up to this one, and the rest of the previous pattern
+        // when playback moved to another pattern or wrapped
+        int last_pattern = g->sidechain_last_pattern;
+        int last_row = g->sidechain_last_row;
+        if (pattern == last_pattern && row > last_row) {
+            level = rows_have_note(g, pattern, last_row + 1, row, ch) ? 1.0f : 0.0f;
+        } else if (pattern != last_pattern || row != last_row) {
+            int hit = rows_have_note(g, pattern, 0, row, ch);
+            if (!hit && last_pattern >= 0 && last_row >= 0) {
+                hit = rows_have_note(g, last_pattern, last_row + 1,
+                                     openmpt_module_get_pattern_num_rows(g->mod, last_pattern) - 1, ch);
+            }
+            level = hit ? 1.0f : 0.0f;
+        }
+    } else {
+        level = openmpt_module_get_current_channel_vu_mono(g->mod, ch);
+        if (level < 0.0f) level = 0.0f;
+        if (level > 1.0f) level = 1.0f;
+    }
+
+    g->sidechain_level = level;
+    g->sidechain_last_pattern = pattern;
+    g->sidechain_last_row = row;
+}
+
+// Rate passed to libopenmpt: pitch scales it (lower = faster), the nudge speeds up above 1.0
+static double render_rate(const Regroove* g) {
+    return g->samplerate * g->pitch_factor / g->tempo_nudge;
+}
+
+// Advance the beat grid by a rendered block. With the tracker tempo convention a beat
+// is 24 ticks, so a row starts speed / 24 beats after the previous one. The position
+// moves with the rendered module time; a new row in this block (its start is known to
+// within the block only) pulls the phase towards it, a jump or wrap snaps to it.
+#define BEAT_ROW_LOCK_GAIN 0.125
+static void update_beat_position(Regroove* g, int frames, int row) {
+    double tempo = openmpt_module_get_current_tempo2(g->mod);
+    int speed = openmpt_module_get_current_speed(g->mod);
+    if (speed <= 0) speed = 6;
+
+    double module_seconds = frames / render_rate(g);
+    double advance = module_seconds * tempo / 60.0;
+    double start = g->beat_position;
+
+    if (row != g->beat_last_row) {
+        double row_beat = row * speed / 24.0;
+        double error = (start + 0.5 * advance) - row_beat;
+        if (fabs(error) > 0.5) {
+            start = row_beat - 0.5 * advance;
+        } else {
+            start -= error * BEAT_ROW_LOCK_GAIN;
+        }
+        g->beat_last_row = row;
+    }
+
+    g->beat_position = start + advance;
+}
+
+// Report the note events of a row to the note callback, or ahead of time to the
+// lookahead callback (ahead = 1, with the row's delay). Muted channels are skipped.
+// only_channel: report just this channel (-1 = all)
+static void report_row_notes(Regroove *g, int pattern, int row, int only_channel,
+                             int ahead, double delay, const int *mutes) {
+    for (int ch = 0; ch < g->num_channels; ch++) {
+        if (only_channel >= 0 && ch != only_channel) continue;
+
+        // Skip muted channels - don't send MIDI notes for muted channels
+        if (mutes && mutes[ch]) {
+            continue;
+        }
+
+        // Get pattern cell data for this channel
+        const char *note_str = openmpt_module_format_pattern_row_channel(
+            g->mod, pattern, row, ch, 0, 1);
+
+        if (note_str && strlen(note_str) > 0) {
+            // Parse note, instrument, volume, and effect from formatted string
+            // Format is typically: "C-5 01 .. ..."
+            int note = -1;
+            int instrument = -1;
+            int volume = -1;
+            int effect_cmd = 0;
+            int effect_param = 0;
+
+            // Parse note (first 3 chars)
+            if (strlen(note_str) >= 3) {
+                if (note_str[0] >= 'A' && note_str[0] <= 'G') {
+                    // Calculate MIDI note number from tracker note
+                    // C-4 should be MIDI note 48 (tracker's middle C)
+                    int octave = note_str[2] - '0';
+                    int base_note = 0;
+                    switch (note_str[0]) {
+                        case 'C': base_note = 0; break;
+                        case 'D': base_note = 2; break;
+                        case 'E': base_note = 4; break;
+                        case 'F': base_note = 5; break;
+                        case 'G': base_note = 7; break;
+                        case 'A': base_note = 9; break;
+                        case 'B': base_note = 11; break;
+                    }
+                    if (note_str[1] == '#' || note_str[1] == '-') {
+                        if (note_str[1] == '#') base_note++;
+                    }
+                    note = octave * 12 + base_note;
+                } else if (strncmp(note_str, "===", 3) == 0 ||
+                           strncmp(note_str, "OFF", 3) == 0) {
+                    // Note-off or key-off indicator
+                    note = -2; // Special value for note-off
+                }
+            }
+
+            // Parse instrument (chars 4-5, hex)
+            if (strlen(note_str) >= 6 && note_str[4] != '.' && note_str[5] != '.') {
+                char inst_str[3] = {note_str[4], note_str[5], 0};
+                instrument = (int)strtol(inst_str, NULL, 16);
+            }
+
+            // Parse volume (chars 7-8)
+            if (strlen(note_str) >= 9 && note_str[7] != '.' && note_str[8] != '.') {
+                char vol_str[3] = {note_str[7], note_str[8], 0};
+                volume = (int)strtol(vol_str, NULL, 16);
+            }
+
+            // Parse effect command and parameter (chars 10-12)
+            if (strlen(note_str) >= 13) {
+                if (note_str[10] != '.' && note_str[11] != '.' && note_str[12] != '.') {
+                    char cmd_str[2] = {note_str[10], 0};
+                    char param_str[3] = {note_str[11], note_str[12], 0};
+                    effect_cmd = (int)strtol(cmd_str, NULL, 16);
+                    effect_param = (int)strtol(param_str, NULL, 16);
+                }
+            }
+
+            // Only call callback if there's a note or an effect command
+            if (note >= -2 || effect_cmd != 0) {
+                // Apply channel volume slider to the velocity
+                int adjusted_volume = volume;
+                if (g->channel_volumes) {
+                    if (volume >= 0) {
+                        // Apply channel volume slider (0.0-1.0) directly to tracker volume
+                        adjusted_volume = (int)(volume * g->channel_volumes[ch]);
+                    } else {
+                        // No volume specified in pattern - use default max (64) and apply slider
+                        adjusted_volume = (int)(64 * g->channel_volumes[ch]);
+                    }
+                }
+                if (ahead) {
+                    g->on_note_ahead(ch, note, instrument, adjusted_volume, effect_cmd, effect_param,
+                                     delay, g->callback_userdata);
+                } else {
+                    g->on_note(ch, note, instrument, adjusted_volume, effect_cmd, effect_param,
+                               g->callback_userdata);
+                }
+            }
+        }
+        if (note_str) openmpt_free_string(note_str);
+    }
+}
+
+// Next order song playback moves on to (skipping empty/marker orders), -1 at the end
+static int next_song_order(const Regroove *g, int order) {
+    for (int o = order + 1; o < g->num_orders; o++) {
+        int pattern = openmpt_module_get_order_pattern(g->mod, o);
+        if (openmpt_module_get_pattern_num_rows(g->mod, pattern) > 0) return o;
+    }
+    return -1;
+}
+
+// Predict the row played after (order, row), following the loop and jump handling of
+// regroove_render_audio. boundary is set where pending mutes would apply. Pattern breaks
+// and jumps in the pattern data are not predicted; they are caught when playback reaches
+// a row that was not reported. Returns 0 when playback stops there (end of song).
+static int predict_next_row(const Regroove *g, int order, int row,
+                            int *next_order, int *next_row, int *boundary) {
+    int pattern = openmpt_module_get_order_pattern(g->mod, order);
+    int o = order;
+    int r = row + 1;
+    *boundary = 0;
+
+    if (g->loop_range_enabled > 0) {
+        // Plays on through the song; ARMED turns ACTIVE inside the range, ACTIVE jumps
+        // back to the loop start at the loop end
+        if (r >= openmpt_module_get_pattern_num_rows(g->mod, pattern)) {
+            o = next_song_order(g, order);
+            r = 0;
+            if (o < 0) return 0;
+        }
+        int start_order = (g->loop_start_order >= 0) ? g->loop_start_order : o;
+        int end_order = (g->loop_end_order >= 0) ? g->loop_end_order : o;
+        int active = (g->loop_range_enabled == 2) ||
+                     (o == start_order && r >= g->loop_start_row) ||
+                     (o > start_order && o <= end_order);
+        if (active && ((o == end_order && r >= g->loop_end_row) || o > end_order)) {
+            o = start_order;
+            r = g->loop_start_row;
+            *boundary = 1;
+        }
+    } else if (g->pattern_mode) {
+        // Wraps to the loop order, or moves to the pending one
+        int loop_rows = g->custom_loop_rows > 0 ? g->custom_loop_rows : g->full_loop_rows;
+        if (r >= loop_rows) {
+            o = (g->pending_pattern_mode_order != -1) ? g->pending_pattern_mode_order : g->loop_order;
+            r = 0;
+            *boundary = 1;
+        }
+    } else if (r >= openmpt_module_get_pattern_num_rows(g->mod, pattern)) {
+        // Song playback: the queued jump, or the next order
+        if (g->has_queued_jump) {
+            o = g->queued_order;
+            r = g->queued_row;
+        } else {
+            o = next_song_order(g, order);
+            r = 0;
+            if (o < 0) return 0;
+        }
+        *boundary = 1;
+    }
+
+    *next_order = o;
+    *next_row = r;
+    return 1;
+}
+
+// Mute state rows reported ahead are filtered with: queued mute changes apply at the
+// next boundary (class 1 = rows past it)
+static int lookahead_muted(const Regroove *g, int ch, int after_boundary) {
+    if (after_boundary && g->has_pending_mute_changes && g->pending_mute_states) {
+        return g->pending_mute_states[ch];
+    }
+    return g->mute_states[ch];
+}
+
+// Order predicted to play after `order` (-1 = end of song)
+static int predict_next_order(const Regroove *g, int order) {
+    int pattern = openmpt_module_get_order_pattern(g->mod, order);
+    int last_row = openmpt_module_get_pattern_num_rows(g->mod, pattern) - 1;
+    if (g->pattern_mode && g->custom_loop_rows > 0) last_row = g->custom_loop_rows - 1;
+    int next_order, next_row, boundary;
+    if (!predict_next_row(g, order, last_row, &next_order, &next_row, &boundary)) return -1;
+    return next_order;
+}
+
+static void report_note_row(Regroove *g, int order, int row, double delay) {
+    if (!g->on_note_row) return;
+    g->on_note_row(order, row, predict_next_order(g, order), delay, g->callback_userdata);
+}
+
+static int *lookahead_mutes(Regroove *g, int after_boundary) {
+    return g->ahead_mutes + (after_boundary ? g->num_channels : 0);
+}
+
+static void report_ahead_row(Regroove *g, int index, int only_channel, double delay) {
+    int pattern = openmpt_module_get_order_pattern(g->mod, g->ahead_orders[index]);
+    if (only_channel < 0) report_note_row(g, g->ahead_orders[index], g->ahead_rows[index], delay);
+    report_row_notes(g, pattern, g->ahead_rows[index], only_channel, 1, delay,
+                     lookahead_mutes(g, g->ahead_boundaries[index] > 0));
+}
+
+// Report rows ahead of playback (see regroove_set_note_lookahead). Called once per
+// rendered block with the row playing at its end. Rows are timed on the beat grid from
+// the playing row, so the delays follow tempo, pitch and the phase nudge.
+static void update_note_lookahead(Regroove *g, int frames, int order, int row) {
+    if (g->note_lookahead <= 0.0 || !g->on_note_ahead) return;
+
+    double tempo = openmpt_module_get_current_tempo2(g->mod);
+    int speed = openmpt_module_get_current_speed(g->mod);
+    if (tempo <= 0.0) tempo = 125.0;
+    if (speed <= 0) speed = 6;
+    double beat_seconds = 60.0 / tempo * g->pitch_factor / g->tempo_nudge;
+    double row_seconds = speed / 24.0 * beat_seconds;
+    double block_end = frames / g->samplerate;
+
+    // Start of the row after the playing one, from the block start
+    double row_left = ((row + 1) * speed / 24.0 - g->beat_position) * beat_seconds;
+    if (row_left < 0.0) row_left = 0.0;
+    if (row_left > row_seconds) row_left = row_seconds;
+    double next_start = block_end + row_left;
+
+    if (!g->ahead_started || order != g->ahead_order || row != g->ahead_row) {
+        // A new row is playing: normally the first one reported ahead
+        int found = -1;
+        for (int i = 0; g->ahead_started && i < g->ahead_count; i++) {
+            if (g->ahead_orders[i] == order && g->ahead_rows[i] == row) {
+                found = i;
+                break;
+            }
+        }
+
+        if (found >= 0) {
+            // Crossing a boundary applied the queued mutes the rows past it were filtered with
+            int crossed = g->ahead_boundaries[found];
+            if (crossed) {
+                memcpy(lookahead_mutes(g, 0), lookahead_mutes(g, 1), g->num_channels * sizeof(int));
+            }
+            g->ahead_count -= found + 1;
+            for (int i = 0; i < g->ahead_count; i++) {
+                g->ahead_orders[i] = g->ahead_orders[i + found + 1];
+                g->ahead_rows[i] = g->ahead_rows[i + found + 1];
+                g->ahead_boundaries[i] = g->ahead_boundaries[i + found + 1] - crossed;
+            }
+        } else {
+            // Started, or playback went where it was not predicted (immediate jump,
+            // pattern break): withdraw what was reported and report this row now, late
+            if (g->ahead_started && g->on_note_cancel) {
+                g->on_note_cancel(REGROOVE_ALL_CHANNELS, 0.0, g->callback_userdata);
+            }
+            int new_row = (order != g->ahead_order || row != g->ahead_row);
+            g->ahead_count = 0;
+            for (int ch = 0; ch < g->num_channels; ch++) {
+                lookahead_mutes(g, 0)[ch] = lookahead_muted(g, ch, 0);
+                lookahead_mutes(g, 1)[ch] = lookahead_muted(g, ch, 1);
+            }
+            if (new_row) {
+                int pattern = openmpt_module_get_order_pattern(g->mod, order);
+                report_note_row(g, order, row, 0.0);
+                report_row_notes(g, pattern, row, -1, 1, 0.0, lookahead_mutes(g, 0));
+            }
+            g->ahead_started = 1;
+        }
+        g->ahead_order = order;
+        g->ahead_row = row;
+    }
+
+    // A command changed where playback goes: withdraw the rows from the first one that
+    // is no longer predicted (they are reported again below)
+    if (g->ahead_repredict) {
+        g->ahead_repredict = 0;
+        int o = order, r = row;
+        for (int i = 0; i < g->ahead_count; i++) {
+            int next_order, next_row, boundary;
+            if (!predict_next_row(g, o, r, &next_order, &next_row, &boundary) ||
+                next_order != g->ahead_orders[i] || next_row != g->ahead_rows[i]) {
+                if (g->on_note_cancel) {
+                    g->on_note_cancel(REGROOVE_ALL_CHANNELS, next_start + (i - 0.5) * row_seconds, g->callback_userdata);
+                }
+                g->ahead_count = i;
+                break;
+            }
+            o = next_order;
+            r = next_row;
+        }
+    }
+
+    // Mute changes: withdraw the newly muted channels, report the newly unmuted ones.
+    // Per boundary class, one cancel covers every channel whose mute changed (solo or
+    // unmuting a group changes many at once)
+    for (int k = 0; k < 2; k++) {
+        int first = -1;
+        for (int i = 0; i < g->ahead_count && first < 0; i++) {
+            if ((g->ahead_boundaries[i] > 0) == k) first = i;
+        }
+
+        uint64_t changed = 0;
+        int any_changed = 0;
+        for (int ch = 0; ch < g->num_channels; ch++) {
+            if (lookahead_muted(g, ch, k) == lookahead_mutes(g, k)[ch]) continue;
+            any_changed = 1;
+            if (ch < 64) changed |= (uint64_t)1 << ch;
+        }
+        if (!any_changed) continue;
+        if (first >= 0 && changed && g->on_note_cancel) {
+            g->on_note_cancel(changed, next_start + (first - 0.5) * row_seconds, g->callback_userdata);
+        }
+
+        for (int ch = 0; ch < g->num_channels; ch++) {
+            int muted = lookahead_muted(g, ch, k);
+            if (muted == lookahead_mutes(g, k)[ch]) continue;
+            lookahead_mutes(g, k)[ch] = muted;
+            if (muted || first < 0) continue;
+            for (int i = first; i < g->ahead_count; i++) {
+                if ((g->ahead_boundaries[i] > 0) == k) report_ahead_row(g, i, ch, next_start + i * row_seconds);
+            }
+        }
+    }
+
+    // Report the rows starting before the next block can report them in time
+    while (g->ahead_count < RG_MAX_AHEAD_ROWS) {
+        double start = next_start + g->ahead_count * row_seconds;
+        if (start > block_end + g->note_lookahead) break;
+
+        int last = g->ahead_count - 1;
+        int from_order = (last >= 0) ? g->ahead_orders[last] : order;
+        int from_row = (last >= 0) ? g->ahead_rows[last] : row;
+        int next_order, next_row, boundary;
+        if (!predict_next_row(g, from_order, from_row, &next_order, &next_row, &boundary)) break;
+
+        int i = g->ahead_count++;
+        g->ahead_orders[i] = next_order;
+        g->ahead_rows[i] = next_row;
+        g->ahead_boundaries[i] = ((last >= 0) ? g->ahead_boundaries[last] : 0) + boundary;
+        report_ahead_row(g, i, -1, start);
+    }
+}
+
 int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     process_commands(g);
 
@@ -710,7 +1264,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     int prev_row_before = openmpt_module_get_current_row(g->mod);
 
     int count = openmpt_module_read_interleaved_stereo(
-        g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+        g->mod, render_rate(g), frames, buffer);
 
     // Get position AFTER rendering
     int cur_order = openmpt_module_get_current_order(g->mod);
@@ -744,7 +1298,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
         }
         // Re-render a clean buffer starting from the beginning
         count = openmpt_module_read_interleaved_stereo(
-            g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+            g->mod, render_rate(g), frames, buffer);
         cur_order = 0;
         cur_pattern = openmpt_module_get_current_pattern(g->mod);
         cur_row = openmpt_module_get_current_row(g->mod);
@@ -766,7 +1320,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
         }
         // Re-render a clean buffer from pattern start
         count = openmpt_module_read_interleaved_stereo(
-            g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+            g->mod, render_rate(g), frames, buffer);
         cur_order = g->loop_order;
         cur_pattern = openmpt_module_get_current_pattern(g->mod);
         cur_row = openmpt_module_get_current_row(g->mod);
@@ -877,7 +1431,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
                     }
                     // Re-render a clean buffer from the new pattern start to avoid glitches
                     count = openmpt_module_read_interleaved_stereo(
-                        g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+                        g->mod, render_rate(g), frames, buffer);
                     cur_order = g->loop_order;
                     cur_pattern = g->loop_pattern;
                     cur_row = openmpt_module_get_current_row(g->mod);
@@ -893,6 +1447,9 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
             g->queued_jump_type = 0;  // Clear visual feedback
 
             // Return regardless of whether jump happened
+            update_sidechain(g, cur_pattern, cur_row);
+            update_beat_position(g, frames, cur_row);
+            update_note_lookahead(g, frames, cur_order, cur_row);
             return count;
         }
 
@@ -974,6 +1531,10 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     int final_pattern = openmpt_module_get_current_pattern(g->mod);
     int final_row = openmpt_module_get_current_row(g->mod);
 
+    // Sidechain key for the effects chain (no extra render pass needed)
+    update_sidechain(g, final_pattern, final_row);
+    update_beat_position(g, frames, final_row);
+
     if (g->on_order_change && g->last_msg_order != final_order) {
         // Update full_loop_rows to reflect the current pattern's row count
         // This is needed for MPTM files where patterns have different lengths
@@ -985,94 +1546,12 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
     // --- Call note callback for MIDI output (if registered) ---
     // Do this BEFORE updating last_msg_row so it triggers on row changes
     if (g->on_note && g->last_msg_row != final_row) {
-        // Process all channels for note events at the current row
-        for (int ch = 0; ch < g->num_channels; ch++) {
-            // Skip muted channels - don't send MIDI notes for muted channels
-            if (g->mute_states && g->mute_states[ch]) {
-                continue;
-            }
-
-            // Get pattern cell data for this channel
-            const char *note_str = openmpt_module_format_pattern_row_channel(
-                g->mod, final_pattern, final_row, ch, 0, 1);
-
-            if (note_str && strlen(note_str) > 0) {
-                // Parse note, instrument, volume, and effect from formatted string
-                // Format is typically: "C-5 01 .. ..."
-                int note = -1;
-                int instrument = -1;
-                int volume = -1;
-                int effect_cmd = 0;
-                int effect_param = 0;
-
-                // Parse note (first 3 chars)
-                if (strlen(note_str) >= 3) {
-                    if (note_str[0] >= 'A' && note_str[0] <= 'G') {
-                        // Calculate MIDI note number from tracker note
-                        // C-4 should be MIDI note 48 (tracker's middle C)
-                        int octave = note_str[2] - '0';
-                        int base_note = 0;
-                        switch (note_str[0]) {
-                            case 'C': base_note = 0; break;
-                            case 'D': base_note = 2; break;
-                            case 'E': base_note = 4; break;
-                            case 'F': base_note = 5; break;
-                            case 'G': base_note = 7; break;
-                            case 'A': base_note = 9; break;
-                            case 'B': base_note = 11; break;
-                        }
-                        if (note_str[1] == '#' || note_str[1] == '-') {
-                            if (note_str[1] == '#') base_note++;
-                        }
-                        note = octave * 12 + base_note;
-                    } else if (strncmp(note_str, "===", 3) == 0 ||
-                               strncmp(note_str, "OFF", 3) == 0) {
-                        // Note-off or key-off indicator
-                        note = -2; // Special value for note-off
-                    }
-                }
-
-                // Parse instrument (chars 4-5, hex)
-                if (strlen(note_str) >= 6 && note_str[4] != '.' && note_str[5] != '.') {
-                    char inst_str[3] = {note_str[4], note_str[5], 0};
-                    instrument = (int)strtol(inst_str, NULL, 16);
-                }
-
-                // Parse volume (chars 7-8)
-                if (strlen(note_str) >= 9 && note_str[7] != '.' && note_str[8] != '.') {
-                    char vol_str[3] = {note_str[7], note_str[8], 0};
-                    volume = (int)strtol(vol_str, NULL, 16);
-                }
-
-                // Parse effect command and parameter (chars 10-12)
-                if (strlen(note_str) >= 13) {
-                    if (note_str[10] != '.' && note_str[11] != '.' && note_str[12] != '.') {
-                        char cmd_str[2] = {note_str[10], 0};
-                        char param_str[3] = {note_str[11], note_str[12], 0};
-                        effect_cmd = (int)strtol(cmd_str, NULL, 16);
-                        effect_param = (int)strtol(param_str, NULL, 16);
-                    }
-                }
-
-                // Only call callback if there's a note or an effect command
-                if (note >= -2 || effect_cmd != 0) {
-                    // Apply channel volume slider to the velocity
-                    int adjusted_volume = volume;
-                    if (g->channel_volumes) {
-                        if (volume >= 0) {
-                            // Apply channel volume slider (0.0-1.0) directly to tracker volume
-                            adjusted_volume = (int)(volume * g->channel_volumes[ch]);
-                        } else {
-                            // No volume specified in pattern - use default max (64) and apply slider
-                            adjusted_volume = (int)(64 * g->channel_volumes[ch]);
-                        }
-                    }
-                    g->on_note(ch, note, instrument, adjusted_volume, effect_cmd, effect_param,
-                              g->callback_userdata);
-                }
-            }
-        }
+        // Process all channels for note events at the current row (with the lookahead on,
+        // rows go through on_note_ahead, and so does their on_note_row)
+        if (g->note_lookahead <= 0.0) report_note_row(g, final_order, final_row, 0.0);
+        report_row_notes(g, final_pattern, final_row, -1, 0, 0.0, g->mute_states);
     }
+    update_note_lookahead(g, frames, final_order, final_row);
 
     // --- Call row change callback (after note callback so notes are processed first) ---
     if (g->on_row_change && g->last_msg_row != final_row) {
@@ -1092,7 +1571,7 @@ int regroove_render_audio(Regroove* g, int16_t* buffer, int frames) {
         }
         // Re-render to get audio for the loop start
         count = openmpt_module_read_interleaved_stereo(
-            g->mod, g->samplerate * g->pitch_factor, frames, buffer);
+            g->mod, render_rate(g), frames, buffer);
         cur_order = 0;
         cur_row = 0;
         g->prev_row = -1;
@@ -1166,12 +1645,24 @@ void regroove_set_position_row(Regroove* g, int row) {
     // Set position immediately (not queued)
     openmpt_module_set_position_order_row(g->mod, current_order, row);
 }
+void regroove_set_position(Regroove* g, int order, int row) {
+    if (!g || !g->mod || order < 0 || order >= g->num_orders) return;
+
+    int pattern = openmpt_module_get_order_pattern(g->mod, order);
+    int num_rows = openmpt_module_get_pattern_num_rows(g->mod, pattern);
+    if (row < 0) row = 0;
+    if (row >= num_rows) row = num_rows - 1;
+
+    // Set position immediately (not queued, no logging - safe to call per audio block)
+    openmpt_module_set_position_order_row(g->mod, order, row);
+}
 void regroove_clear_pending_jump(Regroove* g) {
     if (!g) return;
     // Clear pending jump state without affecting pattern mode
     g->pending_pattern_mode_order = -1;
     g->queued_jump_type = 0;
     g->has_queued_jump = 0;
+    g->ahead_repredict = 1;
 }
 // Loop range system
 void regroove_set_loop_range(Regroove* g, int start_order, int start_row, int end_order, int end_row) {
@@ -1246,9 +1737,87 @@ void regroove_unmute_all(Regroove* g) {
     enqueue_command(g, RG_CMD_UNMUTE_ALL, 0, 0);
 }
 void regroove_set_pitch(Regroove* g, double pitch) {
-    enqueue_command(g, RG_CMD_SET_PITCH, (int)(pitch * 100), 0);
+    enqueue_command_d(g, RG_CMD_SET_PITCH, 0, pitch);
 }
 
+void regroove_apply_channel_volume(Regroove* g, int ch, double vol) {
+    if (g) apply_channel_volume(g, ch, vol);
+}
+void regroove_apply_channel_panning(Regroove* g, int ch, double pan) {
+    if (g) apply_channel_panning(g, ch, pan);
+}
+void regroove_apply_pitch(Regroove* g, double pitch) {
+    if (g) apply_pitch(g, pitch);
+}
+void regroove_apply_action(Regroove* g, RegrooveApplyAction action, int arg) {
+    if (!g || !g->mod) return;
+
+    RegrooveCommand cmd = { RG_CMD_NONE, arg, 0, 0.0, 0, 0 };
+    switch (action) {
+        case REGROOVE_APPLY_QUEUE_NEXT_ORDER:    cmd.type = RG_CMD_QUEUE_NEXT_ORDER; break;
+        case REGROOVE_APPLY_QUEUE_PREV_ORDER:    cmd.type = RG_CMD_QUEUE_PREV_ORDER; break;
+        case REGROOVE_APPLY_QUEUE_ORDER:
+            if (arg < 0 || arg >= g->num_orders) return;
+            cmd.type = RG_CMD_QUEUE_ORDER;
+            break;
+        case REGROOVE_APPLY_QUEUE_PATTERN:
+            if (arg < 0 || arg >= openmpt_module_get_num_patterns(g->mod)) return;
+            cmd.type = RG_CMD_QUEUE_PATTERN;
+            break;
+        case REGROOVE_APPLY_RETRIGGER_PATTERN:   cmd.type = RG_CMD_RETRIGGER_PATTERN; break;
+        case REGROOVE_APPLY_TOGGLE_CHANNEL_MUTE: cmd.type = RG_CMD_TOGGLE_CHANNEL_MUTE; break;
+        case REGROOVE_APPLY_TOGGLE_CHANNEL_SOLO: cmd.type = RG_CMD_TOGGLE_CHANNEL_SINGLE; break;
+        case REGROOVE_APPLY_QUEUE_CHANNEL_MUTE:  cmd.type = RG_CMD_QUEUE_CHANNEL_MUTE; break;
+        case REGROOVE_APPLY_QUEUE_CHANNEL_SOLO:  cmd.type = RG_CMD_QUEUE_CHANNEL_SOLO; break;
+        case REGROOVE_APPLY_MUTE_ALL:            cmd.type = RG_CMD_MUTE_ALL; break;
+        case REGROOVE_APPLY_UNMUTE_ALL:          cmd.type = RG_CMD_UNMUTE_ALL; break;
+        default: return;
+    }
+    execute_command(g, &cmd);
+}
+
+void regroove_set_sidechain(Regroove* g, int channel, RegrooveSidechainSource source) {
+    if (!g) return;
+    if (channel >= g->num_channels) channel = -1;
+    g->sidechain_source = source;
+    g->sidechain_channel = channel < 0 ? -1 : channel;
+}
+
+int regroove_get_sidechain_channel(const Regroove* g) { return g ? g->sidechain_channel : -1; }
+
+RegrooveSidechainSource regroove_get_sidechain_source(const Regroove* g) {
+    return g ? (RegrooveSidechainSource)g->sidechain_source : REGROOVE_SIDECHAIN_VU;
+}
+
+float regroove_get_sidechain_level(const Regroove* g) { return g ? g->sidechain_level : 0.0f; }
+
+void regroove_set_samplerate(Regroove* g, double samplerate) {
+    if (!g || samplerate <= 0.0) return;
+    g->samplerate = samplerate;
+}
+
+double regroove_get_samplerate(const Regroove* g) { return g ? g->samplerate : 0.0; }
+
+void regroove_set_tempo_nudge(Regroove* g, double nudge) {
+    if (!g) return;
+    if (nudge < 1.0 - REGROOVE_MAX_TEMPO_NUDGE) nudge = 1.0 - REGROOVE_MAX_TEMPO_NUDGE;
+    if (nudge > 1.0 + REGROOVE_MAX_TEMPO_NUDGE) nudge = 1.0 + REGROOVE_MAX_TEMPO_NUDGE;
+    g->tempo_nudge = nudge;
+}
+
+double regroove_get_tempo_nudge(const Regroove* g) { return g ? g->tempo_nudge : 1.0; }
+
+double regroove_get_beat_position(const Regroove* g) { return g ? g->beat_position : 0.0; }
+
+void regroove_set_note_lookahead(Regroove* g, double seconds) {
+    if (!g) return;
+    if (seconds < 0.0) seconds = 0.0;
+    if (seconds > RG_MAX_NOTE_LOOKAHEAD) seconds = RG_MAX_NOTE_LOOKAHEAD;
+    enqueue_command_d(g, RG_CMD_SET_NOTE_LOOKAHEAD, 0, seconds);
+}
+
+double regroove_get_note_lookahead(const Regroove* g) { return g ? g->note_lookahead : 0.0; }
+
 void regroove_set_interpolation_filter(Regroove* g, int filter) {
     if (!g || !g->mod) return;
     // Validate filter value: 0, 1, 2, or 4
@@ -1378,6 +1947,13 @@ int regroove_get_current_speed(const Regroove* g) {
     return openmpt_module_get_current_speed(g->mod);
 }
 
+int regroove_get_pattern_instruments(const Regroove *g, int pattern, const RegrooveInstrumentRun **runs) {
+    if (runs) *runs = NULL;
+    if (!g || !g->instrument_runs || pattern < 0 || pattern >= g->num_patterns) return 0;
+    if (runs) *runs = g->instrument_runs + g->pattern_runs[pattern];
+    return g->pattern_runs[pattern + 1] - g->pattern_runs[pattern];
+}
+
 int regroove_get_pattern_cell(const Regroove *g, int pattern, int row, int channel, char *buffer, size_t buffer_size) {
     if (!g || !g->mod || !buffer || buffer_size < 32) return -1;
 
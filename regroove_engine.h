@@ -26,6 +26,20 @@ typedef void (*RegroovePatternModeCallback)(int pattern_mode, int reason, void *
 // effect_param: effect parameter (0-255, e.g. 0xFF for 0FFF)
 typedef void (*RegrooveNoteCallback)(int channel, int note, int instrument, int volume,
                                      int effect_cmd, int effect_param, void *userdata);
+// Note events of a row reported ahead of time (see regroove_set_note_lookahead)
+// delay: seconds from the start of the block being rendered to the start of the row
+typedef void (*RegrooveNoteAheadCallback)(int channel, int note, int instrument, int volume,
+                                          int effect_cmd, int effect_param, double delay,
+                                          void *userdata);
+// Rows reported ahead that start `delay` seconds or more after the start of the block
+// being rendered will not play as reported on the channels in the mask (bit n =
+// channel n; channels from 64 up are not covered, REGROOVE_ALL_CHANNELS = all)
+#define REGROOVE_ALL_CHANNELS (~(uint64_t)0)
+typedef void (*RegrooveNoteCancelCallback)(uint64_t channels, double delay, void *userdata);
+// Row whose notes are reported next (through on_note, or through on_note_ahead with the
+// same delay when the note lookahead is on), so MIDI output can prepare what follows
+// next_order: order predicted to play after this row's order (-1 = end of song)
+typedef void (*RegrooveNoteRowCallback)(int order, int row, int next_order, double delay, void *userdata);
 
 struct RegrooveCallbacks {
     RegrooveOrderCallback       on_order_change;
@@ -34,9 +48,18 @@ struct RegrooveCallbacks {
     RegrooveLoopSongCallback    on_loop_song;
     RegroovePatternModeCallback on_pattern_mode_change;
     RegrooveNoteCallback        on_note;
+    RegrooveNoteAheadCallback   on_note_ahead;
+    RegrooveNoteCancelCallback  on_note_cancel;
+    RegrooveNoteRowCallback     on_note_row;
     void *userdata;
 };
 
+// Sidechain key source: activity of one tracker channel, computed once per rendered block
+typedef enum {
+    REGROOVE_SIDECHAIN_VU = 0,    // libopenmpt channel VU meter (follows the audible channel)
+    REGROOVE_SIDECHAIN_NOTE = 1   // note triggers in the pattern (also works on muted "ghost" channels)
+} RegrooveSidechainSource;
+
 // Creation & lifetime
 Regroove *regroove_create(const char *filename, double samplerate);
 void regroove_destroy(Regroove *g);
@@ -55,6 +78,7 @@ void regroove_queue_pattern(Regroove *g, int pattern);
 void regroove_jump_to_order(Regroove *g, int order);
 void regroove_jump_to_pattern(Regroove *g, int pattern);
 void regroove_set_position_row(Regroove *g, int row);  // Set row within current order
+void regroove_set_position(Regroove *g, int order, int row);  // Set order and row immediately
 void regroove_clear_pending_jump(Regroove *g);  // Clear any pending order/pattern jump
 
 // Loop range system (replaces loop_till_row)
@@ -80,6 +104,60 @@ double regroove_get_channel_panning(const Regroove* g, int ch);
 
 void regroove_set_pitch(Regroove *g, double pitch);
 
+// Immediate variants of the channel volume/panning and pitch commands, for controller
+// events applied between partial renders. Not queued: call from the audio thread only.
+void regroove_apply_channel_volume(Regroove *g, int ch, double vol);
+void regroove_apply_channel_panning(Regroove *g, int ch, double pan);
+void regroove_apply_pitch(Regroove *g, double pitch);
+
+// Immediate variants of the discrete playback controls, for MIDI pads applied between
+// partial renders (same behaviour as the regroove_queue_*, _toggle_*, _mute_all and
+// _retrigger_pattern calls). Not queued: call from the audio thread only.
+typedef enum {
+    REGROOVE_APPLY_QUEUE_NEXT_ORDER = 0,
+    REGROOVE_APPLY_QUEUE_PREV_ORDER,
+    REGROOVE_APPLY_QUEUE_ORDER,          // arg = order
+    REGROOVE_APPLY_QUEUE_PATTERN,        // arg = pattern
+    REGROOVE_APPLY_RETRIGGER_PATTERN,
+    REGROOVE_APPLY_TOGGLE_CHANNEL_MUTE,  // arg = channel
+    REGROOVE_APPLY_TOGGLE_CHANNEL_SOLO,  // arg = channel
+    REGROOVE_APPLY_QUEUE_CHANNEL_MUTE,   // arg = channel
+    REGROOVE_APPLY_QUEUE_CHANNEL_SOLO,   // arg = channel
+    REGROOVE_APPLY_MUTE_ALL,
+    REGROOVE_APPLY_UNMUTE_ALL
+} RegrooveApplyAction;
+void regroove_apply_action(Regroove *g, RegrooveApplyAction action, int arg);
+
+// Beat-phase alignment to an external clock
+// Position in beats (24 ticks each) from the start of the current pattern, at the end
+// of the last rendered block. Pattern starts are on the beat grid.
+double regroove_get_beat_position(const Regroove *g);
+// Fine playback speed factor on top of pitch (1.0 = none, above 1.0 = faster, max +/-5%)
+// Not queued: call from the audio thread, before rendering
+void regroove_set_tempo_nudge(Regroove *g, double nudge);
+double regroove_get_tempo_nudge(const Regroove *g);
+
+// Note lookahead for MIDI output latency compensation: rows are reported through
+// on_note_ahead up to `seconds` before they are heard, predicted from the pattern data
+// and the queued jumps, loops and mutes. Rows that then play differently (pattern
+// breaks, immediate jumps, changed queues or mutes) are withdrawn through on_note_cancel
+// and reported again. 0 = off (default): notes only go through on_note as rows render.
+// Setting it also restarts the lookahead from the playing row (call when resuming).
+void regroove_set_note_lookahead(Regroove *g, double seconds);
+double regroove_get_note_lookahead(const Regroove *g);
+
+// Sidechain key channel (-1 = disabled)
+void regroove_set_sidechain(Regroove *g, int channel, RegrooveSidechainSource source);
+int regroove_get_sidechain_channel(const Regroove *g);
+RegrooveSidechainSource regroove_get_sidechain_source(const Regroove *g);
+// Key level for the last rendered block (0.0 - 1.0), for the effects chain
+float regroove_get_sidechain_level(const Regroove *g);
+
+// Output sample rate (must match the audio device's obtained rate)
+// Not queued: lock the audio device around the call
+void regroove_set_samplerate(Regroove *g, double samplerate);
+double regroove_get_samplerate(const Regroove *g);
+
 // Interpolation filter control
 // filter: 0 = none, 1 = linear, 2 = cubic, 4 = FIR (high quality)
 void regroove_set_interpolation_filter(Regroove *g, int filter);
@@ -130,6 +208,18 @@ int regroove_get_current_speed(const Regroove *g);  // Get current speed (ticks
 // buffer should be at least 32 bytes
 int regroove_get_pattern_cell(const Regroove *g, int pattern, int row, int channel, char *buffer, size_t buffer_size);
 
+// Instruments played in a pattern, read from the pattern data when the module is loaded:
+// one run per series of notes with the same instrument on a channel, by channel then row
+// (notes without an instrument are left out)
+typedef struct {
+    int channel;     // Tracker channel
+    int instrument;  // Instrument number, as reported to on_note
+    int first_row;   // Row of the run's first note
+    int last_row;    // Row of its last note
+} RegrooveInstrumentRun;
+// Returns the number of runs; *runs stays valid while the module is loaded
+int regroove_get_pattern_instruments(const Regroove *g, int pattern, const RegrooveInstrumentRun **runs);
+
 // Get number of instruments in module
 int regroove_get_num_instruments(const Regroove *g);
 
@@ -0,0 +1,157 @@
+#include "regroove_fx_graph.h"
+#include <stdlib.h>
+#include <string.h>
+
+RegrooveFxGraph* regroove_fx_graph_create(int num_chains, int sample_rate) {
+    if (num_chains < 1) num_chains = 1;
+    if (num_chains > REGROOVE_FX_GRAPH_MAX_CHAINS) num_chains = REGROOVE_FX_GRAPH_MAX_CHAINS;
+
+    RegrooveFxGraph* graph = (RegrooveFxGraph*)calloc(1, sizeof(RegrooveFxGraph));
+    if (!graph) return NULL;
+
+    graph->sample_rate = sample_rate;
+    for (int i = 0; i < num_chains; i++) {
+        graph->chains[i] = regroove_effects_create(sample_rate);
+        if (!graph->chains[i]) {
+            regroove_fx_graph_destroy(graph);
+            return NULL;
+        }
+        graph->chain_bus[i] = REGROOVE_FX_BUS_NONE;
+        graph->num_chains++;
+    }
+
+    return graph;
+}
+
+void regroove_fx_graph_destroy(RegrooveFxGraph* graph) {
+    if (!graph) return;
+
+    for (int i = 0; i < graph->num_chains; i++) {
+        regroove_effects_destroy(graph->chains[i]);
+    }
+    for (int b = 0; b < REGROOVE_FX_BUS_COUNT; b++) {
+        free(graph->bus_buffer[b]);
+    }
+    free(graph);
+}
+
+int regroove_fx_graph_prepare(RegrooveFxGraph* graph, int sample_rate, int max_frames) {
+    if (!graph || max_frames <= 0) return -1;
+
+    for (int i = 0; i < graph->num_chains; i++) {
+        if (regroove_effects_set_sample_rate(graph->chains[i], sample_rate) != 0) return -1;
+    }
+    graph->sample_rate = regroove_effects_get_sample_rate(graph->chains[0]);
+
+    // Only grow the bus buffers; a smaller device block fits in the existing ones.
+    // All new buffers are allocated before any is swapped in, so a failure keeps the
+    // old set and max_frames consistent
+    if (max_frames > graph->max_frames) {
+        int16_t *bufs[REGROOVE_FX_BUS_COUNT];
+        for (int b = 0; b < REGROOVE_FX_BUS_COUNT; b++) {
+            bufs[b] = (int16_t*)calloc(max_frames * 2, sizeof(int16_t));
+            if (!bufs[b]) {
+                while (--b >= 0) free(bufs[b]);
+                return -1;
+            }
+        }
+        for (int b = 0; b < REGROOVE_FX_BUS_COUNT; b++) {
+            free(graph->bus_buffer[b]);
+            graph->bus_buffer[b] = bufs[b];
+        }
+        graph->max_frames = max_frames;
+    }
+
+    return 0;
+}
+
+void regroove_fx_graph_reset(RegrooveFxGraph* graph) {
+    if (!graph) return;
+    for (int i = 0; i < graph->num_chains; i++) {
+        regroove_effects_reset(graph->chains[i]);
+    }
+}
+
+void regroove_fx_graph_set_tempo(RegrooveFxGraph* graph, double bpm) {
+    if (!graph) return;
+    for (int i = 0; i < graph->num_chains; i++) {
+        regroove_effects_set_tempo(graph->chains[i], bpm);
+    }
+}
+
+void regroove_fx_graph_set_sidechain_key(RegrooveFxGraph* graph, float level) {
+    if (!graph) return;
+    for (int i = 0; i < graph->num_chains; i++) {
+        regroove_effects_set_sidechain_key(graph->chains[i], level);
+    }
+}
+
+void regroove_fx_graph_load_convolution_ir(RegrooveFxGraph* graph, const char* path) {
+    if (!graph) return;
+    for (int i = 0; i < graph->num_chains; i++) {
+        regroove_effects_load_convolution_ir(graph->chains[i], path);
+    }
+}
+
+int regroove_fx_graph_get_num_chains(RegrooveFxGraph* graph) {
+    return graph ? graph->num_chains : 0;
+}
+
+RegrooveEffects* regroove_fx_graph_get_chain(RegrooveFxGraph* graph, int index) {
+    if (!graph || index < 0 || index >= graph->num_chains) return NULL;
+    return graph->chains[index];
+}
+
+void regroove_fx_graph_set_chain_bus(RegrooveFxGraph* graph, int index, RegrooveFxBus bus) {
+    if (!graph || index < 0 || index >= graph->num_chains) return;
+    if (bus < REGROOVE_FX_BUS_NONE || bus >= REGROOVE_FX_BUS_COUNT) bus = REGROOVE_FX_BUS_NONE;
+    graph->chain_bus[index] = bus;
+}
+
+RegrooveFxBus regroove_fx_graph_get_chain_bus(RegrooveFxGraph* graph, int index) {
+    if (!graph || index < 0 || index >= graph->num_chains) return REGROOVE_FX_BUS_NONE;
+    return (RegrooveFxBus)graph->chain_bus[index];
+}
+
+const char* regroove_fx_graph_bus_name(RegrooveFxBus bus) {
+    switch (bus) {
+        case REGROOVE_FX_BUS_PLAYBACK: return "Playback";
+        case REGROOVE_FX_BUS_INPUT:    return "Input";
+        case REGROOVE_FX_BUS_MASTER:   return "Master";
+        default:                       return "None";
+    }
+}
+
+int regroove_fx_graph_bus_has_chains(RegrooveFxGraph* graph, RegrooveFxBus bus) {
+    if (!graph) return 0;
+    for (int i = 0; i < graph->num_chains; i++) {
+        if (graph->chain_bus[i] == bus) return 1;
+    }
+    return 0;
+}
+
+int regroove_fx_graph_bus_is_sleeping(RegrooveFxGraph* graph, RegrooveFxBus bus) {
+    if (!graph) return 1;
+    for (int i = 0; i < graph->num_chains; i++) {
+        if (graph->chain_bus[i] == bus && !regroove_effects_is_sleeping(graph->chains[i])) return 0;
+    }
+    return 1;
+}
+
+int16_t* regroove_fx_graph_get_bus_buffer(RegrooveFxGraph* graph, RegrooveFxBus bus) {
+    if (!graph || bus < 0 || bus >= REGROOVE_FX_BUS_COUNT) return NULL;
+    return graph->bus_buffer[bus];
+}
+
+int regroove_fx_graph_get_max_frames(RegrooveFxGraph* graph) {
+    return graph ? graph->max_frames : 0;
+}
+
+void regroove_fx_graph_process_bus(RegrooveFxGraph* graph, RegrooveFxBus bus, int16_t* buffer, int frames) {
+    if (!graph || !buffer || frames <= 0) return;
+    for (int i = 0; i < graph->num_chains; i++) {
+        if (graph->chain_bus[i] == bus) {
+            regroove_effects_process(graph->chains[i], buffer, frames);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef REGROOVE_FX_GRAPH_H
+#define REGROOVE_FX_GRAPH_H
+
+#include <stdint.h>
+#include "regroove_effects.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of effect chain instances in the graph
+#define REGROOVE_FX_GRAPH_MAX_CHAINS 4
+
+// Buses a chain can be assigned to
+typedef enum {
+    REGROOVE_FX_BUS_NONE = -1,
+    REGROOVE_FX_BUS_PLAYBACK = 0,
+    REGROOVE_FX_BUS_INPUT,
+    REGROOVE_FX_BUS_MASTER,
+    REGROOVE_FX_BUS_COUNT
+} RegrooveFxBus;
+
+// Effects routing graph: N chain instances, each assigned to one bus.
+// Chains on the same bus run in chain index order.
+typedef struct {
+    RegrooveEffects *chains[REGROOVE_FX_GRAPH_MAX_CHAINS];
+    int chain_bus[REGROOVE_FX_GRAPH_MAX_CHAINS];  // RegrooveFxBus per chain
+    int num_chains;
+
+    // Per-bus scratch buffers (interleaved stereo), allocated by prepare()
+    int16_t *bus_buffer[REGROOVE_FX_BUS_COUNT];
+    int max_frames;
+    int sample_rate;
+} RegrooveFxGraph;
+
+// Create graph with num_chains chain instances (all unassigned)
+RegrooveFxGraph* regroove_fx_graph_create(int num_chains, int sample_rate);
+
+// Free graph and all chains
+void regroove_fx_graph_destroy(RegrooveFxGraph* graph);
+
+// Size chains and bus buffers for an audio device (call at device-open time).
+// Allocates memory - only call while the audio device is closed, paused or locked.
+// Returns 0 on success, -1 on failure
+int regroove_fx_graph_prepare(RegrooveFxGraph* graph, int sample_rate, int max_frames);
+
+// Reset state of all chains
+void regroove_fx_graph_reset(RegrooveFxGraph* graph);
+
+// Pass the effective song tempo to every chain (once per block)
+void regroove_fx_graph_set_tempo(RegrooveFxGraph* graph, double bpm);
+
+// Pass the sidechain key level to every chain's ducker (once per block)
+void regroove_fx_graph_set_sidechain_key(RegrooveFxGraph* graph, float level);
+
+// Load the convolution impulse response into every chain (background load, main thread only)
+void regroove_fx_graph_load_convolution_ir(RegrooveFxGraph* graph, const char* path);
+
+// Chain access
+int regroove_fx_graph_get_num_chains(RegrooveFxGraph* graph);
+RegrooveEffects* regroove_fx_graph_get_chain(RegrooveFxGraph* graph, int index);
+
+// Bus assignment
+void regroove_fx_graph_set_chain_bus(RegrooveFxGraph* graph, int index, RegrooveFxBus bus);
+RegrooveFxBus regroove_fx_graph_get_chain_bus(RegrooveFxGraph* graph, int index);
+const char* regroove_fx_graph_bus_name(RegrooveFxBus bus);
+
+// Returns 1 if any chain is assigned to the bus
+int regroove_fx_graph_bus_has_chains(RegrooveFxGraph* graph, RegrooveFxBus bus);
+
+// Returns 1 if every chain on the bus is asleep (or none is assigned)
+int regroove_fx_graph_bus_is_sleeping(RegrooveFxGraph* graph, RegrooveFxBus bus);
+
+// Preallocated scratch buffer for a bus (holds max_frames stereo frames)
+int16_t* regroove_fx_graph_get_bus_buffer(RegrooveFxGraph* graph, RegrooveFxBus bus);
+int regroove_fx_graph_get_max_frames(RegrooveFxGraph* graph);
+
+// Run all chains assigned to the bus over buffer (in place, real-time safe)
+void regroove_fx_graph_process_bus(RegrooveFxGraph* graph, RegrooveFxBus bus, int16_t* buffer, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_FX_GRAPH_H
@@ -0,0 +1,202 @@
+#include "regroove_latency.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+
+#define MLS_PERIODS 3           // One to settle, two captured and averaged
+#define MLS_LEVEL 0.25f         // Test signal level (-12 dBFS)
+
+struct RegrooveLatencyCal {
+    float* mls;                 // Sequence as +/-1, one period
+    float* capture;             // Captured input, folded into one period (then doubled)
+    SDL_atomic_t state;         // RegrooveLatencyState
+    SDL_Thread* thread;
+
+    // Written by start() before the audio thread sees RUNNING
+    int sample_rate;
+    int position;               // Frames since the sequence started (audio thread)
+    int wait_frames;            // Frames waited for input before starting (audio thread)
+    double ring_sum;            // Input path latency summed over the captured frames
+    int ring_count;             // Captured frames in ring_sum
+
+    // Written by the analysis thread before it publishes DONE
+    float result_ms;
+    float confidence;
+};
+
+// Fibonacci LFSR for x^15 + x^14 + 1 (maximal length 2^15 - 1)
+static void generate_mls(float* out) {
+    unsigned int s = 1;
+    for (int i = 0; i < REGROOVE_LATENCY_MLS_LENGTH; i++) {
+        unsigned int bit = ((s >> 14) ^ (s >> 13)) & 1u;
+        s = ((s << 1) | bit) & 0x7FFFu;
+        out[i] = bit ? 1.0f : -1.0f;
+    }
+}
+
+RegrooveLatencyCal* regroove_latency_create(void) {
+    RegrooveLatencyCal* cal = (RegrooveLatencyCal*)calloc(1, sizeof(RegrooveLatencyCal));
+    if (!cal) return NULL;
+
+    cal->mls = (float*)malloc(REGROOVE_LATENCY_MLS_LENGTH * sizeof(float));
+    cal->capture = (float*)calloc(REGROOVE_LATENCY_MLS_LENGTH * 2, sizeof(float));
+    if (!cal->mls || !cal->capture) {
+        regroove_latency_destroy(cal);
+        return NULL;
+    }
+    generate_mls(cal->mls);
+    SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_IDLE);
+
+    return cal;
+}
+
+static void join_analysis(RegrooveLatencyCal* cal) {
+    if (cal->thread) {
+        SDL_WaitThread(cal->thread, NULL);
+        cal->thread = NULL;
+    }
+}
+
+void regroove_latency_destroy(RegrooveLatencyCal* cal) {
+    if (!cal) return;
+    join_analysis(cal);
+    free(cal->mls);
+    free(cal->capture);
+    free(cal);
+}
+
+int regroove_latency_start(RegrooveLatencyCal* cal, int sample_rate) {
+    if (!cal || sample_rate <= 0) return -1;
+    int state = SDL_AtomicGet(&cal->state);
+    if (state == REGROOVE_LATENCY_RUNNING || state == REGROOVE_LATENCY_CAPTURED ||
+        state == REGROOVE_LATENCY_ANALYZING) {
+        return -1;
+    }
+    join_analysis(cal);
+
+    cal->sample_rate = sample_rate;
+    cal->position = 0;
+    cal->wait_frames = 0;
+    cal->ring_sum = 0.0;
+    cal->ring_count = 0;
+    cal->result_ms = 0.0f;
+    cal->confidence = 0.0f;
+    memset(cal->capture, 0, REGROOVE_LATENCY_MLS_LENGTH * 2 * sizeof(float));
+
+    // Publish last: the audio thread starts playing on its next block
+    SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_RUNNING);
+    return 0;
+}
+
+void regroove_latency_cancel(RegrooveLatencyCal* cal) {
+    if (!cal) return;
+    join_analysis(cal);
+    SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_IDLE);
+}
+
+int regroove_latency_process(RegrooveLatencyCal* cal, int16_t* output, const int16_t* input,
+                             int ring_frames, int frames) {
+    if (!cal || SDL_AtomicGet(&cal->state) != REGROOVE_LATENCY_RUNNING) return 0;
+
+    // Hold off until the input path delivers (e.g. the input ring refilled after a flush)
+    if (cal->position == 0 && !input) {
+        memset(output, 0, frames * 2 * sizeof(int16_t));
+        cal->wait_frames += frames;
+        if (cal->wait_frames >= cal->sample_rate) {
+            SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_FAILED);
+        }
+        return 1;
+    }
+
+    const int period = REGROOVE_LATENCY_MLS_LENGTH;
+    const int total = period * MLS_PERIODS;
+    if (input && cal->position + frames > period && cal->position < total) {
+        cal->ring_sum += (double)ring_frames * frames;
+        cal->ring_count += frames;
+    }
+    for (int i = 0; i < frames; i++) {
+        int pos = cal->position + i;
+        int16_t v = 0;
+        if (pos < total) {
+            int phase = pos % period;
+            v = (int16_t)(cal->mls[phase] * MLS_LEVEL * 32767.0f);
+
+            // After the first period the loop is in steady state: every captured
+            // period is the sequence delayed by the round trip
+            if (pos >= period && input) {
+                cal->capture[phase] += (float)input[i * 2] + (float)input[i * 2 + 1];
+            }
+        }
+        output[i * 2] = v;
+        output[i * 2 + 1] = v;
+    }
+    cal->position += frames;
+
+    if (cal->position >= total) {
+        SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_CAPTURED);
+    }
+    return 1;
+}
+
+static int latency_analysis_thread(void* data) {
+    RegrooveLatencyCal* cal = (RegrooveLatencyCal*)data;
+    const int period = REGROOVE_LATENCY_MLS_LENGTH;
+
+    // Double the captured period so every circular lag is a contiguous window
+    memcpy(cal->capture + period, cal->capture, period * sizeof(float));
+
+    // r[k] = sum(capture[n + k] * mls[n]) peaks at k = round trip. Independent
+    // partial sums keep the inner loop vectorizable.
+    double peak = 0.0, sum_sq = 0.0;
+    int peak_lag = 0;
+    for (int k = 0; k < period; k++) {
+        const float* c = cal->capture + k;
+        float acc[8] = { 0 };
+        int n = 0;
+        for (; n + 8 <= period; n += 8) {
+            for (int j = 0; j < 8; j++) acc[j] += c[n + j] * cal->mls[n + j];
+        }
+        float r = 0.0f;
+        for (int j = 0; j < 8; j++) r += acc[j];
+        for (; n < period; n++) r += c[n] * cal->mls[n];
+
+        sum_sq += (double)r * r;
+        if (fabs(r) > peak) {
+            peak = fabs(r);
+            peak_lag = k;
+        }
+    }
+
+    double rms = sqrt(sum_sq / period);
+    cal->confidence = rms > 0.0 ? (float)(peak / rms) : 0.0f;
+    int ring_frames = cal->ring_count > 0 ? (int)lrint(cal->ring_sum / cal->ring_count) : 0;
+    int device_frames = peak_lag - ring_frames;
+    cal->result_ms = (float)(device_frames * 1000.0 / cal->sample_rate);
+
+    int ok = cal->confidence >= REGROOVE_LATENCY_MIN_CONFIDENCE && device_frames >= 0;
+    SDL_AtomicSet(&cal->state, ok ? REGROOVE_LATENCY_DONE : REGROOVE_LATENCY_FAILED);
+    return 0;
+}
+
+void regroove_latency_poll(RegrooveLatencyCal* cal) {
+    if (!cal || SDL_AtomicGet(&cal->state) != REGROOVE_LATENCY_CAPTURED) return;
+
+    SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_ANALYZING);
+    cal->thread = SDL_CreateThread(latency_analysis_thread, "regroove_latency", cal);
+    if (!cal->thread) {
+        SDL_AtomicSet(&cal->state, REGROOVE_LATENCY_FAILED);
+    }
+}
+
+RegrooveLatencyState regroove_latency_get_state(RegrooveLatencyCal* cal) {
+    return cal ? (RegrooveLatencyState)SDL_AtomicGet(&cal->state) : REGROOVE_LATENCY_IDLE;
+}
+
+float regroove_latency_get_ms(RegrooveLatencyCal* cal) {
+    return cal ? cal->result_ms : 0.0f;
+}
+
+float regroove_latency_get_confidence(RegrooveLatencyCal* cal) {
+    return cal ? cal->confidence : 0.0f;
+}
@@ -0,0 +1,71 @@
+#ifndef REGROOVE_LATENCY_H
+#define REGROOVE_LATENCY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Round-trip latency calibration. A maximum length sequence (MLS) is played on the
+// output while the input is captured; the circular cross-correlation of one captured
+// period with the sequence peaks at the output-to-input delay. Requires the output
+// to be routed back to the input (loopback cable or speaker/microphone).
+
+// Sequence length (2^15 - 1 samples); also the longest measurable round trip
+#define REGROOVE_LATENCY_MLS_ORDER 15
+#define REGROOVE_LATENCY_MLS_LENGTH ((1 << REGROOVE_LATENCY_MLS_ORDER) - 1)
+
+// Minimum correlation peak to RMS ratio for a valid measurement
+#define REGROOVE_LATENCY_MIN_CONFIDENCE 8.0f
+
+typedef enum {
+    REGROOVE_LATENCY_IDLE = 0,
+    REGROOVE_LATENCY_RUNNING,     // Playing the sequence and capturing (audio thread)
+    REGROOVE_LATENCY_CAPTURED,    // Waiting for poll() to start the analysis
+    REGROOVE_LATENCY_ANALYZING,   // Correlating on a background thread
+    REGROOVE_LATENCY_DONE,
+    REGROOVE_LATENCY_FAILED
+} RegrooveLatencyState;
+
+typedef struct RegrooveLatencyCal RegrooveLatencyCal;
+
+// Create calibrator (allocates the sequence and capture buffers)
+RegrooveLatencyCal* regroove_latency_create(void);
+
+// Free calibrator (waits for a running analysis)
+void regroove_latency_destroy(RegrooveLatencyCal* cal);
+
+// Start a measurement (main thread). Returns 0 on success, -1 if a measurement is
+// in progress.
+int regroove_latency_start(RegrooveLatencyCal* cal, int sample_rate);
+
+// Abort a measurement (main thread, returns to IDLE)
+void regroove_latency_cancel(RegrooveLatencyCal* cal);
+
+// Audio thread, once per block while running: writes the test signal to output
+// (interleaved stereo) and captures input (may be NULL for silence). The sequence
+// starts with the first block that has input, so the input path can settle first;
+// the output stays silent until then (FAILED if no input arrives within a second).
+// ring_frames is the latency the caller's input path added to this block's input
+// (e.g. the input ring fill before it was read); its average over the capture is
+// subtracted from the result.
+// Returns 1 if the calibration owns the output this block, 0 if not.
+int regroove_latency_process(RegrooveLatencyCal* cal, int16_t* output, const int16_t* input,
+                             int ring_frames, int frames);
+
+// Main thread, once per UI frame: starts the analysis once capture has finished
+void regroove_latency_poll(RegrooveLatencyCal* cal);
+
+RegrooveLatencyState regroove_latency_get_state(RegrooveLatencyCal* cal);
+
+// Result of the last measurement (valid in DONE): device round trip in
+// milliseconds, and the correlation peak to RMS ratio
+float regroove_latency_get_ms(RegrooveLatencyCal* cal);
+float regroove_latency_get_confidence(RegrooveLatencyCal* cal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_LATENCY_H
@@ -39,10 +39,19 @@ RegrooveMetadata* regroove_metadata_create(void) {
     meta->midi_note_offset = 0;  // No offset by default
     for (int i = 0; i < RGX_MAX_INSTRUMENTS; i++) {
         meta->instrument_midi_channels[i] = -2;  // Disabled (no MIDI output)
+        meta->instrument_midi_port[i] = 0;  // First MIDI output
         meta->instrument_names[i][0] = '\0';  // Empty = use module's name
         meta->instrument_program[i] = -1;  // No program change by default
+        meta->instrument_note_length[i] = 0;  // Device default note length
+        meta->instrument_note_length_unit[i] = RGX_NOTE_LENGTH_TICKS;
     }
 
+    // Sidechain disabled by default
+    meta->sidechain_channel = -1;
+    meta->sidechain_source = 0;
+
+    meta->convolution_ir[0] = '\0';
+
     // Initialize loop ranges
     meta->loop_range_count = 0;
     for (int i = 0; i < 16; i++) {
@@ -262,12 +271,28 @@ int regroove_metadata_load(RegrooveMetadata *meta, const char *rgx_path) {
                     }
                 }
             }
+        } else if (strcmp(section, "Sidechain") == 0) {
+            // Sidechain key: channel=N, source=vu|note
+            if (strcmp(key, "channel") == 0) {
+                int ch = atoi(value);
+                if (ch >= -1 && ch < 64) {
+                    meta->sidechain_channel = ch;
+                }
+            } else if (strcmp(key, "source") == 0) {
+                meta->sidechain_source = (strcmp(value, "note") == 0) ? 1 : 0;
+            }
+        } else if (strcmp(section, "Convolution") == 0) {
+            // Convolution reverb: ir="path/to/impulse.wav"
+            if (strcmp(key, "ir") == 0) {
+                snprintf(meta->convolution_ir, RGX_MAX_FILEPATH, "%s", value);
+            }
         } else if (strcmp(section, "MIDIMapping") == 0) {
             // Global MIDI settings
             if (strcmp(key, "note_offset") == 0) {
                 meta->midi_note_offset = atoi(value);
             }
-            // MIDI mapping configuration: instrument_X_channel, instrument_X_name, instrument_X_program
+            // MIDI mapping configuration: instrument_X_channel, instrument_X_port, instrument_X_name, instrument_X_program,
+            // instrument_X_length
             else if (strncmp(key, "instrument_", 11) == 0) {
                 int inst_idx = atoi(key + 11);
                 if (inst_idx >= 0 && inst_idx < RGX_MAX_INSTRUMENTS) {
@@ -279,6 +304,11 @@ int regroove_metadata_load(RegrooveMetadata *meta, const char *rgx_path) {
                                 meta->has_midi_mapping = 1;
                             }
                         }
+                    } else if (strstr(key, "_port")) {
+                        int port = atoi(value);
+                        if (port >= 0 && port < RGX_MAX_MIDI_PORTS) {
+                            meta->instrument_midi_port[inst_idx] = port;
+                        }
                     } else if (strstr(key, "_name")) {
                         strncpy(meta->instrument_names[inst_idx], value, RGX_MAX_INSTRUMENT_NAME - 1);
                         meta->instrument_names[inst_idx][RGX_MAX_INSTRUMENT_NAME - 1] = '\0';
@@ -287,6 +317,17 @@ int regroove_metadata_load(RegrooveMetadata *meta, const char *rgx_path) {
                         if (program >= -1 && program <= 127) {
                             meta->instrument_program[inst_idx] = program;
                         }
+                    } else if (strstr(key, "_length")) {
+                        // "<n> ticks", "<n> rows" or "<n> ms" (no unit = ticks)
+                        char *unit = NULL;
+                        long length = strtol(value, &unit, 10);
+                        RegrooveNoteLengthUnit length_unit = RGX_NOTE_LENGTH_TICKS;
+                        if (unit && strstr(unit, "ms")) {
+                            length_unit = RGX_NOTE_LENGTH_MS;
+                        } else if (unit && strstr(unit, "row")) {
+                            length_unit = RGX_NOTE_LENGTH_ROWS;
+                        }
+                        regroove_metadata_set_note_length(meta, inst_idx, (int)length, length_unit);
                     }
                 }
             }
@@ -425,24 +466,50 @@ int regroove_metadata_save(const RegrooveMetadata *meta, const char *rgx_path) {
         fprintf(f, "\n");
     }
 
+    // Write Sidechain section if a key channel is set
+    if (meta->sidechain_channel >= 0) {
+        fprintf(f, "[Sidechain]\n");
+        fprintf(f, "# Key channel for the effects ducker; source: vu = channel level, note = note triggers\n");
+        fprintf(f, "channel=%d\n", meta->sidechain_channel);
+        fprintf(f, "source=%s\n", meta->sidechain_source == 1 ? "note" : "vu");
+        fprintf(f, "\n");
+    }
+
+    // Write Convolution section if an impulse response is set
+    if (meta->convolution_ir[0] != '\0') {
+        fprintf(f, "[Convolution]\n");
+        fprintf(f, "# Impulse response WAV for the convolution reverb (relative to this file or absolute)\n");
+        fprintf(f, "ir=\"%s\"\n", meta->convolution_ir);
+        fprintf(f, "\n");
+    }
+
     // Write MIDI Mapping section if any custom mappings exist
     int has_midi_mapping = 0;
+    int has_port_routing = 0;
     int has_name_overrides = 0;
     int has_program_changes = 0;
+    int has_note_lengths = 0;
     for (int i = 0; i < RGX_MAX_INSTRUMENTS; i++) {
         if (meta->instrument_midi_channels[i] != -2) {
             has_midi_mapping = 1;
         }
+        if (meta->instrument_midi_port[i] != 0) {
+            has_port_routing = 1;
+        }
         if (meta->instrument_names[i][0] != '\0') {
             has_name_overrides = 1;
         }
         if (meta->instrument_program[i] != -1) {
             has_program_changes = 1;
         }
-        if (has_midi_mapping && has_name_overrides && has_program_changes) break;
+        if (meta->instrument_note_length[i] != 0) {
+            has_note_lengths = 1;
+        }
+        if (has_midi_mapping && has_port_routing && has_name_overrides && has_program_changes && has_note_lengths) break;
     }
 
-    if (has_midi_mapping || has_name_overrides || has_program_changes || meta->midi_note_offset != 0) {
+    if (has_midi_mapping || has_port_routing || has_name_overrides || has_program_changes || has_note_lengths ||
+        meta->midi_note_offset != 0) {
         fprintf(f, "[MIDIMapping]\n");
         fprintf(f, "# Global MIDI settings\n");
         fprintf(f, "# note_offset: Shift all MIDI notes by N semitones (positive = up, negative = down)\n");
@@ -460,6 +527,17 @@ int regroove_metadata_save(const RegrooveMetadata *meta, const char *rgx_path) {
             fprintf(f, "\n");
         }
 
+        // Write MIDI output ports (skip 0 = first output)
+        if (has_port_routing) {
+            fprintf(f, "# MIDI output port per instrument: 0=first output, 1-3=additional outputs\n");
+            for (int i = 0; i < RGX_MAX_INSTRUMENTS; i++) {
+                if (meta->instrument_midi_port[i] != 0) {
+                    fprintf(f, "instrument_%d_port=%d\n", i, meta->instrument_midi_port[i]);
+                }
+            }
+            fprintf(f, "\n");
+        }
+
         // Write program changes
         if (has_program_changes) {
             fprintf(f, "# MIDI program change per instrument: -1=none, 0-127=program number\n");
@@ -471,6 +549,19 @@ int regroove_metadata_save(const RegrooveMetadata *meta, const char *rgx_path) {
             fprintf(f, "\n");
         }
 
+        // Write note lengths (skip 0 = device default)
+        if (has_note_lengths) {
+            static const char *unit_names[] = { "ticks", "rows", "ms" };
+            fprintf(f, "# MIDI note length per instrument: <n> ticks, <n> rows or <n> ms (note-off after that long)\n");
+            for (int i = 0; i < RGX_MAX_INSTRUMENTS; i++) {
+                if (meta->instrument_note_length[i] != 0) {
+                    fprintf(f, "instrument_%d_length=%d %s\n", i, meta->instrument_note_length[i],
+                            unit_names[meta->instrument_note_length_unit[i]]);
+                }
+            }
+            fprintf(f, "\n");
+        }
+
         // Write instrument name overrides
         if (has_name_overrides) {
             fprintf(f, "# Custom instrument names\n");
@@ -598,6 +689,26 @@ void regroove_metadata_set_midi_channel(RegrooveMetadata *meta, int instrument_i
     }
 }
 
+int regroove_metadata_get_midi_port(const RegrooveMetadata *meta, int instrument_index) {
+    if (!meta || instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
+        return 0;  // Default: first output
+    }
+    return meta->instrument_midi_port[instrument_index];
+}
+
+void regroove_metadata_set_midi_port(RegrooveMetadata *meta, int instrument_index, int port) {
+    if (!meta || instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
+        return;
+    }
+
+    // Validate port (0 = first output)
+    if (port < 0 || port >= RGX_MAX_MIDI_PORTS) {
+        return;
+    }
+
+    meta->instrument_midi_port[instrument_index] = port;
+}
+
 const char* regroove_metadata_get_instrument_name(const RegrooveMetadata *meta, int instrument_index) {
     if (!meta || instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
         return NULL;
@@ -654,3 +765,29 @@ void regroove_metadata_set_program(RegrooveMetadata *meta, int instrument_index,
 
     meta->instrument_program[instrument_index] = program;
 }
+
+int regroove_metadata_get_note_length(const RegrooveMetadata *meta, int instrument_index, RegrooveNoteLengthUnit *unit_out) {
+    if (unit_out) *unit_out = RGX_NOTE_LENGTH_TICKS;
+    if (!meta || instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
+        return 0;  // Device default
+    }
+    if (unit_out) *unit_out = meta->instrument_note_length_unit[instrument_index];
+    return meta->instrument_note_length[instrument_index];
+}
+
+void regroove_metadata_set_note_length(RegrooveMetadata *meta, int instrument_index, int length, RegrooveNoteLengthUnit unit) {
+    if (!meta || instrument_index < 0 || instrument_index >= RGX_MAX_INSTRUMENTS) {
+        return;
+    }
+
+    // Validate length (0 = device default) and unit
+    if (length < 0 || length > 9999) {
+        return;
+    }
+    if (unit < RGX_NOTE_LENGTH_TICKS || unit > RGX_NOTE_LENGTH_MS) {
+        return;
+    }
+
+    meta->instrument_note_length[instrument_index] = length;
+    meta->instrument_note_length_unit[instrument_index] = unit;
+}
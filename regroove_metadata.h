@@ -16,6 +16,14 @@ extern "C" {
 #define RGX_MAX_PHRASES 64
 #define RGX_MAX_INSTRUMENTS 256  // Max instruments/samples we can map
 #define RGX_MAX_INSTRUMENT_NAME 64  // Max length for custom instrument names
+#define RGX_MAX_MIDI_PORTS 4  // MIDI output ports instruments can be routed to (MIDI_OUT_MAX_DEVICES)
+
+// Units of an instrument's MIDI note length
+typedef enum {
+    RGX_NOTE_LENGTH_TICKS = 0,
+    RGX_NOTE_LENGTH_ROWS,
+    RGX_NOTE_LENGTH_MS
+} RegrooveNoteLengthUnit;
 
 // Metadata for a single pattern
 typedef struct {
@@ -80,6 +88,9 @@ typedef struct {
     int instrument_midi_channels[RGX_MAX_INSTRUMENTS];
     int has_midi_mapping;  // 0 = no custom mapping, 1 = custom mapping exists
 
+    // MIDI output port per instrument/sample (0 = first output, up to MIDI_OUT_MAX_DEVICES-1)
+    int instrument_midi_port[RGX_MAX_INSTRUMENTS];
+
     // Custom instrument/sample name overrides (for MIDI mapping display)
     // Empty string means use the module's original name
     char instrument_names[RGX_MAX_INSTRUMENTS][RGX_MAX_INSTRUMENT_NAME];
@@ -91,6 +102,20 @@ typedef struct {
     // MIDI program change (preset) per instrument
     // -1 = no program change, 0-127 = MIDI program number
     int instrument_program[RGX_MAX_INSTRUMENTS];
+
+    // MIDI note length per instrument: the note-off is sent this long after the note-on
+    // (or earlier, at the next note/off command). 0 = device default
+    int instrument_note_length[RGX_MAX_INSTRUMENTS];
+    RegrooveNoteLengthUnit instrument_note_length_unit[RGX_MAX_INSTRUMENTS];
+
+    // Sidechain key channel for the effects ducker
+    // -1 = disabled, 0-63 = tracker channel; source: 0 = channel VU, 1 = note triggers
+    int sidechain_channel;
+    int sidechain_source;
+
+    // Convolution reverb impulse response (WAV, relative to the .rgx file or absolute)
+    // Empty = use the device config default
+    char convolution_ir[RGX_MAX_FILEPATH];
 } RegrooveMetadata;
 
 // Create new metadata structure
@@ -120,6 +145,12 @@ int regroove_metadata_get_midi_channel(const RegrooveMetadata *meta, int instrum
 // Set MIDI channel for instrument/sample (-1 = use default, 0-15 = specific channel)
 void regroove_metadata_set_midi_channel(RegrooveMetadata *meta, int instrument_index, int midi_channel);
 
+// Get MIDI output port for instrument/sample (0 = first output)
+int regroove_metadata_get_midi_port(const RegrooveMetadata *meta, int instrument_index);
+
+// Set MIDI output port for instrument/sample (0-3)
+void regroove_metadata_set_midi_port(RegrooveMetadata *meta, int instrument_index, int port);
+
 // Get custom instrument name (returns NULL or empty string if using module's original name)
 const char* regroove_metadata_get_instrument_name(const RegrooveMetadata *meta, int instrument_index);
 
@@ -138,6 +169,12 @@ int regroove_metadata_get_program(const RegrooveMetadata *meta, int instrument_i
 // Set MIDI program change for instrument (-1 = no program change, 0-127 = program number)
 void regroove_metadata_set_program(RegrooveMetadata *meta, int instrument_index, int program);
 
+// Get MIDI note length for instrument (0 = device default); unit_out (may be NULL) gets its unit
+int regroove_metadata_get_note_length(const RegrooveMetadata *meta, int instrument_index, RegrooveNoteLengthUnit *unit_out);
+
+// Set MIDI note length for instrument (0 = device default)
+void regroove_metadata_set_note_length(RegrooveMetadata *meta, int instrument_index, int length, RegrooveNoteLengthUnit unit);
+
 #ifdef __cplusplus
 }
 #endif
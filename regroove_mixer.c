@@ -0,0 +1,208 @@
+#include "regroove_mixer.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define MIXER_HALF_PI 1.57079632679f
+#define MIXER_SQRT2 1.41421356237f
+
+struct RegrooveMixer {
+    float volume[REGROOVE_MIXER_STRIP_COUNT];
+    float pan[REGROOVE_MIXER_STRIP_COUNT];
+    int mute[REGROOVE_MIXER_STRIP_COUNT];
+    int pan_law;
+
+    // Left/right gain reached at the end of the last block, per strip
+    float gain[REGROOVE_MIXER_STRIP_COUNT][2];
+};
+
+static float clampf(float v, float min, float max) {
+    if (v < min) return min;
+    if (v > max) return max;
+    return v;
+}
+
+static int valid_strip(RegrooveMixerStrip strip) {
+    return strip >= 0 && strip < REGROOVE_MIXER_STRIP_COUNT;
+}
+
+// Left/right gain of a strip from its volume, pan and mute
+static void strip_target(RegrooveMixer* mixer, int strip, float* left, float* right) {
+    if (mixer->mute[strip]) {
+        *left = *right = 0.0f;
+        return;
+    }
+
+    float pan = mixer->pan[strip];
+    float theta = pan * MIXER_HALF_PI;
+    int law = mixer->pan_law;
+    if (strip == REGROOVE_MIXER_MASTER && law != REGROOVE_MIXER_PAN_LINEAR) law = REGROOVE_MIXER_PAN_BALANCE;
+    float l, r;
+    switch (law) {
+        case REGROOVE_MIXER_PAN_BALANCE:
+            l = fminf(1.0f, MIXER_SQRT2 * cosf(theta));
+            r = fminf(1.0f, MIXER_SQRT2 * sinf(theta));
+            break;
+        case REGROOVE_MIXER_PAN_LINEAR:
+            l = 1.0f - pan;
+            r = pan;
+            break;
+        default:
+            l = cosf(theta);
+            r = sinf(theta);
+            break;
+    }
+    *left = mixer->volume[strip] * l;
+    *right = mixer->volume[strip] * r;
+}
+
+RegrooveMixer* regroove_mixer_create(void) {
+    RegrooveMixer* mixer = (RegrooveMixer*)calloc(1, sizeof(RegrooveMixer));
+    if (!mixer) return NULL;
+
+    for (int s = 0; s < REGROOVE_MIXER_STRIP_COUNT; s++) {
+        mixer->volume[s] = 1.0f;
+        mixer->pan[s] = 0.5f;
+    }
+    mixer->pan_law = REGROOVE_MIXER_PAN_LINEAR;
+    for (int s = 0; s < REGROOVE_MIXER_STRIP_COUNT; s++) {
+        strip_target(mixer, s, &mixer->gain[s][0], &mixer->gain[s][1]);
+    }
+
+    return mixer;
+}
+
+void regroove_mixer_destroy(RegrooveMixer* mixer) {
+    free(mixer);
+}
+
+void regroove_mixer_set_volume(RegrooveMixer* mixer, RegrooveMixerStrip strip, float volume) {
+    if (!mixer || !valid_strip(strip)) return;
+    mixer->volume[strip] = clampf(volume, 0.0f, 1.0f);
+}
+
+void regroove_mixer_set_pan(RegrooveMixer* mixer, RegrooveMixerStrip strip, float pan) {
+    if (!mixer || !valid_strip(strip)) return;
+    mixer->pan[strip] = clampf(pan, 0.0f, 1.0f);
+}
+
+void regroove_mixer_set_mute(RegrooveMixer* mixer, RegrooveMixerStrip strip, int mute) {
+    if (!mixer || !valid_strip(strip)) return;
+    mixer->mute[strip] = mute ? 1 : 0;
+}
+
+float regroove_mixer_get_volume(RegrooveMixer* mixer, RegrooveMixerStrip strip) {
+    return (mixer && valid_strip(strip)) ? mixer->volume[strip] : 0.0f;
+}
+
+float regroove_mixer_get_pan(RegrooveMixer* mixer, RegrooveMixerStrip strip) {
+    return (mixer && valid_strip(strip)) ? mixer->pan[strip] : 0.5f;
+}
+
+int regroove_mixer_get_mute(RegrooveMixer* mixer, RegrooveMixerStrip strip) {
+    return (mixer && valid_strip(strip)) ? mixer->mute[strip] : 0;
+}
+
+void regroove_mixer_set_pan_law(RegrooveMixer* mixer, RegrooveMixerPanLaw law) {
+    if (!mixer) return;
+    if (law < 0 || law >= REGROOVE_MIXER_PAN_LAW_COUNT) law = REGROOVE_MIXER_PAN_LINEAR;
+    mixer->pan_law = law;
+}
+
+RegrooveMixerPanLaw regroove_mixer_get_pan_law(RegrooveMixer* mixer) {
+    return mixer ? (RegrooveMixerPanLaw)mixer->pan_law : REGROOVE_MIXER_PAN_LINEAR;
+}
+
+const char* regroove_mixer_pan_law_name(RegrooveMixerPanLaw law) {
+    switch (law) {
+        case REGROOVE_MIXER_PAN_CONSTANT_POWER: return "Constant power (-3 dB)";
+        case REGROOVE_MIXER_PAN_BALANCE:        return "Balance (0 dB)";
+        case REGROOVE_MIXER_PAN_LINEAR:         return "Linear (-6 dB)";
+        default:                                return "Unknown";
+    }
+}
+
+static inline float saturate(float v) {
+    return v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+}
+
+// One pass over the block: out = a * buffer + b * input, with a and b (per side)
+// ramped linearly from their start to end values. Straight-line float math on
+// independent samples so the compiler can vectorize it.
+static void mix_pass(int16_t* buffer, const int16_t* input, int frames,
+                     const float a0[2], const float a1[2], const float b0[2], const float b1[2]) {
+    float inv = 1.0f / (float)frames;
+    float al = a0[0], ar = a0[1], dal = (a1[0] - a0[0]) * inv, dar = (a1[1] - a0[1]) * inv;
+
+    if (input) {
+        float bl = b0[0], br = b0[1], dbl = (b1[0] - b0[0]) * inv, dbr = (b1[1] - b0[1]) * inv;
+        for (int i = 0; i < frames; i++) {
+            float t = (float)(i + 1);
+            float l = (float)buffer[i * 2] * (al + dal * t) + (float)input[i * 2] * (bl + dbl * t);
+            float r = (float)buffer[i * 2 + 1] * (ar + dar * t) + (float)input[i * 2 + 1] * (br + dbr * t);
+            buffer[i * 2] = (int16_t)saturate(l);
+            buffer[i * 2 + 1] = (int16_t)saturate(r);
+        }
+    } else {
+        for (int i = 0; i < frames; i++) {
+            float t = (float)(i + 1);
+            float l = (float)buffer[i * 2] * (al + dal * t);
+            float r = (float)buffer[i * 2 + 1] * (ar + dar * t);
+            buffer[i * 2] = (int16_t)saturate(l);
+            buffer[i * 2 + 1] = (int16_t)saturate(r);
+        }
+    }
+}
+
+void regroove_mixer_process(RegrooveMixer* mixer, int16_t* buffer, const int16_t* input,
+                            int frames, int with_master) {
+    if (!mixer || !buffer || frames <= 0) return;
+
+    float target[REGROOVE_MIXER_STRIP_COUNT][2];
+    for (int s = 0; s < REGROOVE_MIXER_STRIP_COUNT; s++) {
+        strip_target(mixer, s, &target[s][0], &target[s][1]);
+    }
+
+    // Master folded into both strip gains (or unity if it is applied separately)
+    float m0[2] = { 1.0f, 1.0f }, m1[2] = { 1.0f, 1.0f };
+    if (with_master) {
+        for (int c = 0; c < 2; c++) {
+            m0[c] = mixer->gain[REGROOVE_MIXER_MASTER][c];
+            m1[c] = target[REGROOVE_MIXER_MASTER][c];
+        }
+    }
+
+    float a0[2], a1[2], b0[2], b1[2];
+    for (int c = 0; c < 2; c++) {
+        a0[c] = mixer->gain[REGROOVE_MIXER_PLAYBACK][c] * m0[c];
+        a1[c] = target[REGROOVE_MIXER_PLAYBACK][c] * m1[c];
+        b0[c] = mixer->gain[REGROOVE_MIXER_INPUT][c] * m0[c];
+        b1[c] = target[REGROOVE_MIXER_INPUT][c] * m1[c];
+    }
+
+    // Nothing to do at unity gain without input (e.g. the TUI's balance-law strips
+    // while centred at full volume)
+    if (input || a0[0] != 1.0f || a0[1] != 1.0f || a1[0] != 1.0f || a1[1] != 1.0f) {
+        mix_pass(buffer, input, frames, a0, a1, b0, b1);
+    }
+
+    for (int c = 0; c < 2; c++) {
+        mixer->gain[REGROOVE_MIXER_PLAYBACK][c] = target[REGROOVE_MIXER_PLAYBACK][c];
+        mixer->gain[REGROOVE_MIXER_INPUT][c] = target[REGROOVE_MIXER_INPUT][c];
+        if (with_master) mixer->gain[REGROOVE_MIXER_MASTER][c] = target[REGROOVE_MIXER_MASTER][c];
+    }
+}
+
+void regroove_mixer_apply_master(RegrooveMixer* mixer, int16_t* buffer, int frames) {
+    if (!mixer || !buffer || frames <= 0) return;
+
+    float m1[2];
+    strip_target(mixer, REGROOVE_MIXER_MASTER, &m1[0], &m1[1]);
+    float* m0 = mixer->gain[REGROOVE_MIXER_MASTER];
+
+    if (m0[0] != 1.0f || m0[1] != 1.0f || m1[0] != 1.0f || m1[1] != 1.0f) {
+        mix_pass(buffer, NULL, frames, m0, m1, m0, m1);
+    }
+
+    m0[0] = m1[0];
+    m0[1] = m1[1];
+}
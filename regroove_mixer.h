@@ -0,0 +1,64 @@
+#ifndef REGROOVE_MIXER_H
+#define REGROOVE_MIXER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mixer strips (playback and input are summed, master is applied to the sum)
+typedef enum {
+    REGROOVE_MIXER_PLAYBACK = 0,
+    REGROOVE_MIXER_INPUT,
+    REGROOVE_MIXER_MASTER,
+    REGROOVE_MIXER_STRIP_COUNT
+} RegrooveMixerStrip;
+
+// Pan law of the playback and input strips (value of the mixer_pan_law config key).
+// The master strip is a balance control, except under the linear law where it pans
+// linearly as well, so a centred strip through a centred master is -12 dB as before
+// the mixer existed.
+typedef enum {
+    REGROOVE_MIXER_PAN_CONSTANT_POWER = 0,  // sin/cos, -3 dB per side at center
+    REGROOVE_MIXER_PAN_BALANCE,             // 0 dB at center, constant-power taper of the far side
+    REGROOVE_MIXER_PAN_LINEAR,              // -6 dB per side at center (legacy, default)
+    REGROOVE_MIXER_PAN_LAW_COUNT
+} RegrooveMixerPanLaw;
+
+typedef struct RegrooveMixer RegrooveMixer;
+
+// Create mixer (all strips at full volume, centered, unmuted, linear pan law)
+RegrooveMixer* regroove_mixer_create(void);
+
+// Free mixer
+void regroove_mixer_destroy(RegrooveMixer* mixer);
+
+// Strip parameters (volume and pan 0.0 - 1.0). Gain changes are ramped over
+// the next processed block, so these can be set once per audio block.
+void regroove_mixer_set_volume(RegrooveMixer* mixer, RegrooveMixerStrip strip, float volume);
+void regroove_mixer_set_pan(RegrooveMixer* mixer, RegrooveMixerStrip strip, float pan);
+void regroove_mixer_set_mute(RegrooveMixer* mixer, RegrooveMixerStrip strip, int mute);
+float regroove_mixer_get_volume(RegrooveMixer* mixer, RegrooveMixerStrip strip);
+float regroove_mixer_get_pan(RegrooveMixer* mixer, RegrooveMixerStrip strip);
+int regroove_mixer_get_mute(RegrooveMixer* mixer, RegrooveMixerStrip strip);
+
+void regroove_mixer_set_pan_law(RegrooveMixer* mixer, RegrooveMixerPanLaw law);
+RegrooveMixerPanLaw regroove_mixer_get_pan_law(RegrooveMixer* mixer);
+const char* regroove_mixer_pan_law_name(RegrooveMixerPanLaw law);
+
+// Mix one block (interleaved stereo, in place, real-time safe). buffer holds the
+// playback bus on entry and the mix on return; input may be NULL. With
+// with_master set, the master strip is folded into the same pass - pass 0 when
+// master effects must run on the sum first and call apply_master() after them.
+void regroove_mixer_process(RegrooveMixer* mixer, int16_t* buffer, const int16_t* input,
+                            int frames, int with_master);
+
+// Apply only the master strip (in place, real-time safe)
+void regroove_mixer_apply_master(RegrooveMixer* mixer, int16_t* buffer, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_MIXER_H
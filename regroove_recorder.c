@@ -0,0 +1,251 @@
+#include "regroove_recorder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define WRITE_CHUNK_SAMPLES 32768    // Writer waits for this much (64 KB) per stream
+#define WRITE_BUFFER_BYTES (256 * 1024)
+#define WRITER_POLL_MS 20
+
+// One stream: single-producer/single-consumer ring (audio callback writes, writer
+// thread reads). Counts run freely and wrap; the capacity is a power of two.
+typedef struct {
+    int16_t* ring;
+    int capacity;               // In samples
+    int mask;
+    SDL_atomic_t write_count;
+    SDL_atomic_t read_count;
+    FILE* file;                 // Writer thread while recording
+    uint32_t data_bytes;        // Written to the data chunk so far
+    int skip_samples;           // Still to drop from the start of the stream
+} RecorderStream;
+
+struct RegrooveRecorder {
+    RecorderStream streams[REGROOVE_RECORDER_STREAM_COUNT];
+    int sample_rate;
+    SDL_Thread* thread;
+    SDL_atomic_t active;        // Audio callback may push
+    SDL_atomic_t pushing;       // Audio callback is inside push()
+    SDL_atomic_t stop;          // Writer thread drains and exits
+    SDL_atomic_t overruns;
+    SDL_atomic_t master_frames;
+};
+
+RegrooveRecorder* regroove_recorder_create(void) {
+    return (RegrooveRecorder*)calloc(1, sizeof(RegrooveRecorder));
+}
+
+void regroove_recorder_destroy(RegrooveRecorder* rec) {
+    if (!rec) return;
+    regroove_recorder_stop(rec);
+    free(rec);
+}
+
+// 44-byte PCM header; the sizes are patched in when the file is finalized
+static void write_wav_header(FILE* f, int sample_rate, uint32_t data_size) {
+    uint32_t riff_size = 36 + data_size;
+    uint32_t fmt_size = 16, byte_rate = (uint32_t)sample_rate * 2 * sizeof(int16_t);
+    uint32_t rate = (uint32_t)sample_rate;
+    uint16_t format = 1, channels = 2, block_align = 2 * sizeof(int16_t), bits = 16;
+
+    // WAV fields are little-endian, as on every platform regroove targets
+    fwrite("RIFF", 1, 4, f);
+    fwrite(&riff_size, 4, 1, f);
+    fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fmt_size, 4, 1, f);
+    fwrite(&format, 2, 1, f);
+    fwrite(&channels, 2, 1, f);
+    fwrite(&rate, 4, 1, f);
+    fwrite(&byte_rate, 4, 1, f);
+    fwrite(&block_align, 2, 1, f);
+    fwrite(&bits, 2, 1, f);
+    fwrite("data", 1, 4, f);
+    fwrite(&data_size, 4, 1, f);
+}
+
+static void close_stream(RegrooveRecorder* rec, RecorderStream* s) {
+    if (s->file) {
+        fflush(s->file);
+        fseek(s->file, 0, SEEK_SET);
+        write_wav_header(s->file, rec->sample_rate, s->data_bytes);
+        fclose(s->file);
+        s->file = NULL;
+    }
+    free(s->ring);
+    memset(s, 0, sizeof(*s));
+}
+
+// Writer thread: move buffered samples from the ring to the file. Waits for a full
+// chunk unless final, so the disk sees few large writes.
+static void drain_stream(RegrooveRecorder* rec, RecorderStream* s, int is_master, int final) {
+    unsigned int w = (unsigned int)SDL_AtomicGet(&s->write_count);
+    unsigned int r = (unsigned int)SDL_AtomicGet(&s->read_count);
+    int fill = (int)(w - r);
+    if (fill <= 0 || (!final && fill < WRITE_CHUNK_SAMPLES)) return;
+
+    // Leading samples dropped to line the stream up with the master
+    if (s->skip_samples > 0) {
+        int skip = fill < s->skip_samples ? fill : s->skip_samples;
+        s->skip_samples -= skip;
+        r += (unsigned int)skip;
+        fill -= skip;
+    }
+
+    // Stay below the 4 GB WAV limit (about six hours of 48 kHz stereo)
+    uint32_t room = (0xFFFFFFFFu - 36u - s->data_bytes) / sizeof(int16_t);
+    int to_write = (uint32_t)fill < room ? fill : (int)(room & ~1u);
+
+    int start = (int)(r & (unsigned int)s->mask);
+    int first = s->capacity - start;
+    if (first > to_write) first = to_write;
+    size_t written = fwrite(s->ring + start, sizeof(int16_t), first, s->file);
+    if (to_write > first) written += fwrite(s->ring, sizeof(int16_t), to_write - first, s->file);
+    s->data_bytes += (uint32_t)(written * sizeof(int16_t));
+
+    // Release the space even if the disk refused the data (the file is short then)
+    SDL_AtomicSet(&s->read_count, (int)(r + (unsigned int)fill));
+
+    if (is_master) {
+        SDL_AtomicSet(&rec->master_frames, (int)(s->data_bytes / (2 * sizeof(int16_t))));
+    }
+}
+
+static int recorder_writer_thread(void* data) {
+    RegrooveRecorder* rec = (RegrooveRecorder*)data;
+
+    while (!SDL_AtomicGet(&rec->stop)) {
+        for (int i = 0; i < REGROOVE_RECORDER_STREAM_COUNT; i++) {
+            if (rec->streams[i].file) drain_stream(rec, &rec->streams[i], i == REGROOVE_RECORDER_MASTER, 0);
+        }
+        SDL_Delay(WRITER_POLL_MS);
+    }
+
+    // Stopped: the audio callback no longer pushes, write out the rest
+    for (int i = 0; i < REGROOVE_RECORDER_STREAM_COUNT; i++) {
+        if (rec->streams[i].file) drain_stream(rec, &rec->streams[i], i == REGROOVE_RECORDER_MASTER, 1);
+    }
+    return 0;
+}
+
+int regroove_recorder_start(RegrooveRecorder* rec, const char* base_path, int sample_rate,
+                            int stems, int input_offset_frames) {
+    if (!rec || !base_path || sample_rate <= 0) return -1;
+    if (SDL_AtomicGet(&rec->active)) return -1;
+
+    rec->sample_rate = sample_rate;
+    int requested = sample_rate * REGROOVE_RECORDER_RING_SECONDS * 2;
+    int capacity = 2;
+    while (capacity < requested) capacity <<= 1;
+
+    for (int i = 0; i < REGROOVE_RECORDER_STREAM_COUNT; i++) {
+        if (i != REGROOVE_RECORDER_MASTER && !stems) continue;
+
+        RecorderStream* s = &rec->streams[i];
+        char path[1024];
+        snprintf(path, sizeof(path), "%s-%s.wav", base_path,
+                 regroove_recorder_stream_name((RegrooveRecorderStream)i));
+        s->ring = (int16_t*)malloc(capacity * sizeof(int16_t));
+        s->file = fopen(path, "wb");
+        if (!s->ring || !s->file) {
+            fprintf(stderr, "Failed to start recording: %s\n", path);
+            for (int j = 0; j <= i; j++) close_stream(rec, &rec->streams[j]);
+            return -1;
+        }
+        setvbuf(s->file, NULL, _IOFBF, WRITE_BUFFER_BYTES);
+        write_wav_header(s->file, sample_rate, 0);
+
+        s->capacity = capacity;
+        s->mask = capacity - 1;
+        s->data_bytes = 0;
+        s->skip_samples = (i == REGROOVE_RECORDER_INPUT && input_offset_frames > 0) ? input_offset_frames * 2 : 0;
+        SDL_AtomicSet(&s->write_count, 0);
+        SDL_AtomicSet(&s->read_count, 0);
+        printf("Recording %s\n", path);
+    }
+
+    SDL_AtomicSet(&rec->stop, 0);
+    SDL_AtomicSet(&rec->overruns, 0);
+    SDL_AtomicSet(&rec->master_frames, 0);
+    rec->thread = SDL_CreateThread(recorder_writer_thread, "regroove_recorder", rec);
+    if (!rec->thread) {
+        for (int i = 0; i < REGROOVE_RECORDER_STREAM_COUNT; i++) close_stream(rec, &rec->streams[i]);
+        return -1;
+    }
+
+    // Publish last: the audio callback starts pushing on its next block
+    SDL_AtomicSet(&rec->active, 1);
+    return 0;
+}
+
+void regroove_recorder_stop(RegrooveRecorder* rec) {
+    if (!rec || !SDL_AtomicGet(&rec->active)) return;
+
+    // Keep the audio callback out, then wait for a push already under way
+    SDL_AtomicSet(&rec->active, 0);
+    while (SDL_AtomicGet(&rec->pushing)) SDL_Delay(1);
+
+    SDL_AtomicSet(&rec->stop, 1);
+    SDL_WaitThread(rec->thread, NULL);
+    rec->thread = NULL;
+
+    int overruns = SDL_AtomicGet(&rec->overruns);
+    printf("Recording stopped: %d frames", SDL_AtomicGet(&rec->master_frames));
+    if (overruns > 0) printf(", %d blocks dropped (disk too slow)", overruns);
+    printf("\n");
+
+    for (int i = 0; i < REGROOVE_RECORDER_STREAM_COUNT; i++) close_stream(rec, &rec->streams[i]);
+}
+
+int regroove_recorder_is_recording(RegrooveRecorder* rec) {
+    return rec ? SDL_AtomicGet(&rec->active) : 0;
+}
+
+void regroove_recorder_push(RegrooveRecorder* rec, RegrooveRecorderStream stream,
+                            const int16_t* buffer, int frames) {
+    if (!rec || stream < 0 || stream >= REGROOVE_RECORDER_STREAM_COUNT || frames <= 0) return;
+
+    // Announce before checking active, so stop() either sees us or we see it
+    SDL_AtomicAdd(&rec->pushing, 1);
+    RecorderStream* s = &rec->streams[stream];
+    if (SDL_AtomicGet(&rec->active) && s->ring) {
+        unsigned int w = (unsigned int)SDL_AtomicGet(&s->write_count);
+        int fill = (int)(w - (unsigned int)SDL_AtomicGet(&s->read_count));
+        int samples = frames * 2;
+
+        if (samples > s->capacity - fill) {
+            // Writer fell behind: drop the whole block rather than wait
+            SDL_AtomicAdd(&rec->overruns, 1);
+        } else {
+            int start = (int)(w & (unsigned int)s->mask);
+            int first = s->capacity - start;
+            if (first > samples) first = samples;
+            if (buffer) {
+                memcpy(s->ring + start, buffer, first * sizeof(int16_t));
+                memcpy(s->ring, buffer + first, (samples - first) * sizeof(int16_t));
+            } else {
+                memset(s->ring + start, 0, first * sizeof(int16_t));
+                memset(s->ring, 0, (samples - first) * sizeof(int16_t));
+            }
+            SDL_AtomicSet(&s->write_count, (int)(w + (unsigned int)samples));
+        }
+    }
+    SDL_AtomicAdd(&rec->pushing, -1);
+}
+
+int64_t regroove_recorder_get_frames(RegrooveRecorder* rec) {
+    return rec ? (int64_t)(unsigned int)SDL_AtomicGet(&rec->master_frames) : 0;
+}
+
+int regroove_recorder_get_overruns(RegrooveRecorder* rec) {
+    return rec ? SDL_AtomicGet(&rec->overruns) : 0;
+}
+
+const char* regroove_recorder_stream_name(RegrooveRecorderStream stream) {
+    switch (stream) {
+        case REGROOVE_RECORDER_MASTER:   return "master";
+        case REGROOVE_RECORDER_PLAYBACK: return "playback";
+        case REGROOVE_RECORDER_INPUT:    return "input";
+        default:                         return "unknown";
+    }
+}
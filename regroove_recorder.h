@@ -0,0 +1,61 @@
+#ifndef REGROOVE_RECORDER_H
+#define REGROOVE_RECORDER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background disk recorder. The audio callback copies each block into a preallocated
+// lock-free ring per stream; a writer thread drains the rings to 16-bit stereo WAV
+// files with large sequential writes. The audio callback never blocks, allocates or
+// touches the disk: if the writer falls behind, blocks that do not fit are dropped
+// and counted as overruns.
+
+typedef enum {
+    REGROOVE_RECORDER_MASTER = 0,   // Final master output
+    REGROOVE_RECORDER_PLAYBACK,     // Module playback before effects and mixing
+    REGROOVE_RECORDER_INPUT,        // Audio input before effects and mixing
+    REGROOVE_RECORDER_STREAM_COUNT
+} RegrooveRecorderStream;
+
+// Seconds of audio each ring holds (how long the disk may stall without overruns)
+#define REGROOVE_RECORDER_RING_SECONDS 4
+
+typedef struct RegrooveRecorder RegrooveRecorder;
+
+// Create recorder (idle, nothing allocated until start)
+RegrooveRecorder* regroove_recorder_create(void);
+
+// Free recorder (stops a running recording)
+void regroove_recorder_destroy(RegrooveRecorder* rec);
+
+// Start recording (main thread). Opens "<base_path>-master.wav", plus
+// "<base_path>-playback.wav" and "<base_path>-input.wav" when stems is set.
+// input_offset_frames are dropped from the start of the input stream to line it up
+// with the master (the measured round trip). Returns 0 on success, -1 on failure
+int regroove_recorder_start(RegrooveRecorder* rec, const char* base_path, int sample_rate,
+                            int stems, int input_offset_frames);
+
+// Stop recording (main thread): writes out what is buffered, finalizes and closes the files
+void regroove_recorder_stop(RegrooveRecorder* rec);
+
+int regroove_recorder_is_recording(RegrooveRecorder* rec);
+
+// Audio thread, once per block and stream: copy interleaved stereo frames into the
+// stream's ring (buffer may be NULL for silence). No-op when not recording.
+void regroove_recorder_push(RegrooveRecorder* rec, RegrooveRecorderStream stream,
+                            const int16_t* buffer, int frames);
+
+// Status (any thread): frames written to the master file, and blocks dropped
+// because the writer could not keep up (all streams)
+int64_t regroove_recorder_get_frames(RegrooveRecorder* rec);
+int regroove_recorder_get_overruns(RegrooveRecorder* rec);
+const char* regroove_recorder_stream_name(RegrooveRecorderStream stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REGROOVE_RECORDER_H
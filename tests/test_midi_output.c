@@ -0,0 +1,136 @@
+// test-midi-output: MIDI output scheduler timing
+//
+// Runs midi_output.c against a stub RtMidi output that records when each note-on is
+// sent. Notes queued from the audio thread (the thread calling midi_output_begin_block)
+// while a far-off timed note-off is pending must still go out within the scheduler's
+// lead time of when they are due (the audio thread does not wake the scheduler). A few
+// may be late when the OS runs the scheduler thread late; without polling for audio
+// messages about half of them are.
+//
+// Usage: test-midi-output (exit status 0 = pass)
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <rtmidi/rtmidi_c.h>
+#include <SDL2/SDL.h>
+#include "midi_output.h"
+
+#define TEST_SAMPLE_RATE 48000
+#define TEST_BLOCK_FRAMES 256
+#define TEST_NOTES 64
+#define TEST_FIRST_NOTE 36
+#define TEST_NOTE_LENGTH_MS 10000    // Timed note-off far beyond the scheduler's longest wait
+#define TEST_BLOCK_GAP_NS 30000000   // Between blocks: the audio timeline restarts at each
+#define TEST_MAX_LATE_NS 2000000     // MIDI_OUT_LEAD_NS
+#define TEST_MAX_LATE_NOTES (TEST_NOTES / 4)
+
+static Uint64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);  // The clock midi_output.c schedules on
+    return (Uint64)ts.tv_sec * 1000000000ull + (Uint64)ts.tv_nsec;
+}
+
+static void sleep_ns(Uint64 ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ull);
+    ts.tv_nsec = (long)(ns % 1000000000ull);
+    nanosleep(&ts, NULL);
+}
+
+// --- Stub RtMidi output (called from the port's scheduler thread only) ---
+
+static struct RtMidiWrapper stub_device;
+static Uint64 sent_time[128];          // When each note's note-on was sent (0 = not yet)
+static SDL_atomic_t sent_count;
+
+RtMidiOutPtr rtmidi_out_create_default(void) {
+    return &stub_device;
+}
+
+void rtmidi_out_free(RtMidiOutPtr device) {
+    (void)device;
+}
+
+unsigned int rtmidi_get_port_count(RtMidiPtr device) {
+    (void)device;
+    return 1;
+}
+
+int rtmidi_get_port_name(RtMidiPtr device, unsigned int port_number, char *buf_out, int *buf_len) {
+    (void)device;
+    (void)port_number;
+    if (buf_out && buf_len && *buf_len > 0) snprintf(buf_out, (size_t)*buf_len, "Stub");
+    return 5;
+}
+
+void rtmidi_open_port(RtMidiPtr device, unsigned int port_number, const char *port_name) {
+    (void)device;
+    (void)port_number;
+    (void)port_name;
+}
+
+void rtmidi_close_port(RtMidiPtr device) {
+    (void)device;
+}
+
+int rtmidi_out_send_message(RtMidiOutPtr device, const unsigned char *message, int length) {
+    (void)device;
+    if (length == 3 && (message[0] & 0xF0) == 0x90 && message[2] > 0 && sent_time[message[1]] == 0) {
+        sent_time[message[1]] = now_ns();
+        SDL_AtomicAdd(&sent_count, 1);
+    }
+    return 0;
+}
+
+// --- Test ---
+
+int main(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    if (midi_output_open(0, 0) != 0) {
+        fprintf(stderr, "FAIL: could not open the stub MIDI output\n");
+        return 1;
+    }
+    midi_output_set_metadata(NULL);  // Default routing: instrument 1 -> port 1, channel 1
+
+    // One note per block, each on its own tracker channel. The first has a note length,
+    // so its timed note-off is pending and the scheduler is in its long wait for the
+    // others (held notes, no note-offs of their own)
+    Uint64 block_ns = (Uint64)TEST_BLOCK_FRAMES * 1000000000ull / TEST_SAMPLE_RATE;
+    Uint64 due[TEST_NOTES];
+    for (int i = 0; i < TEST_NOTES; i++) {
+        midi_output_set_default_note_length(i == 0 ? TEST_NOTE_LENGTH_MS : 0, RGX_NOTE_LENGTH_MS);
+        sleep_ns(TEST_BLOCK_GAP_NS);
+        due[i] = now_ns() + block_ns;  // Notes of this block are due when it is heard
+        midi_output_begin_block(TEST_BLOCK_FRAMES, TEST_SAMPLE_RATE);
+        midi_output_handle_note_at(i, TEST_FIRST_NOTE + i, 1, 64, 0.0);
+    }
+    sleep_ns(TEST_BLOCK_GAP_NS);
+
+    // The first note went out before any note-off was pending
+    int sent = SDL_AtomicGet(&sent_count);
+    int late_notes = 0;
+    Sint64 worst = 0;
+    for (int i = 1; i < TEST_NOTES; i++) {
+        Uint64 t = sent_time[TEST_FIRST_NOTE + i];
+        if (t == 0) continue;
+        Sint64 late = (Sint64)(t - due[i]);
+        if (late > TEST_MAX_LATE_NS) late_notes++;
+        if (late > worst) worst = late;
+    }
+    midi_output_close(0);
+
+    printf("midi-output: %d/%d notes sent, %d more than %.3f ms after due (latest %.3f ms)\n",
+           sent, TEST_NOTES, late_notes, TEST_MAX_LATE_NS / 1e6, worst / 1e6);
+    if (sent != TEST_NOTES) {
+        fprintf(stderr, "FAIL: notes not sent\n");
+        return 1;
+    }
+    if (late_notes > TEST_MAX_LATE_NOTES) {
+        fprintf(stderr, "FAIL: audio-thread notes sent late while a timed note-off was pending\n");
+        return 1;
+    }
+    return 0;
+}